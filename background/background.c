@@ -0,0 +1,223 @@
+#include "background.h"
+#include "../core/resources.h"
+#include "../core/blit.h"
+#include <string.h>
+
+// Layers of level 1, far to near. Paths are relative to the player folder;
+// the optional ones are skipped when the file is missing. Only main_bg.png
+// is in the repository so far: until middle.png and front.png are drawn,
+// level 1 shows that single layer.
+typedef struct {
+    const char *path;
+    int rate, rateY, y, wrap, optional;
+} layerDesc;
+
+static const layerDesc level1[] = {
+    {"assets/backgrounds/main_bg.png", 128, 0, 0, 1, 0},   // Far: half the camera speed
+    {"assets/backgrounds/middle.png", 192, 0, 0, 1, 1},
+    {"assets/backgrounds/front.png", 256, 0, 0, 1, 1},
+};
+
+static int isOpaque(SDL_Surface *sprite) {
+    for (int y = 0; y < sprite->h; y++) {
+        const Uint32 *row = (const Uint32 *)((Uint8 *)sprite->pixels + y * sprite->pitch);
+        for (int x = 0; x < sprite->w; x++) {
+            if ((row[x] >> 24) != 0xFF) return 0;
+        }
+    }
+    return 1;
+}
+
+int addBackLayer(background *bg, const char *path, int rate, int rateY, int y, int wrap) {
+    if (bg->layerCount == BACK_MAX_LAYERS) {
+        printf("Too many background layers, %s ignored\n", path);
+        return -1;
+    }
+    SDL_Surface *image = loadSprite(path);
+    if (!image) return -1;
+
+    backLayer *layer = &bg->layers[bg->layerCount++];
+    layer->image = image;
+    layer->rate = rate;
+    layer->rateY = rateY;
+    layer->y = y;
+    layer->wrap = wrap;
+    layer->opaque = isOpaque(image);
+    return 0;
+}
+
+static void updateCameraRect(background *bg) {
+    bg->camera.x = bg->camX >> BACK_FIXED_SHIFT;
+    bg->camera.y = bg->camY >> BACK_FIXED_SHIFT;
+    bg->camera.w = bg->viewport.w;
+    bg->camera.h = bg->viewport.h;
+}
+
+void initback(background *bg, Mix_Music *musique) {
+    memset(bg, 0, sizeof(*bg));
+    bg->music = musique;
+
+    SDL_Surface *screen = SDL_GetVideoSurface();
+    bg->viewport.w = screen ? screen->w : 1600;
+    bg->viewport.h = screen ? screen->h : 900;
+    bg->levelW = BACK_LEVEL_WIDTH;
+    bg->levelH = bg->viewport.h;
+
+    char key[RESOURCE_PATH_MAX];
+    for (size_t i = 0; i < sizeof(level1) / sizeof(level1[0]); i++) {
+        const layerDesc *d = &level1[i];
+        if (d->optional && resourceKey(d->path, key) < 0) continue;
+        addBackLayer(bg, d->path, d->rate, d->rateY, d->y, d->wrap);
+    }
+    updateCameraRect(bg);
+}
+
+void initpartage(background *bg1, background *bg2, Mix_Music *musique) {
+    initback(bg1, musique);
+    initback(bg2, NULL);
+
+    // Left and right halves of the screen
+    SDL_Rect half = {0, 0, bg1->viewport.w / 2, bg1->viewport.h};
+    bg1->viewport = half;
+    half.x = half.w;
+    bg2->viewport = half;
+    updateCameraRect(bg1);
+    updateCameraRect(bg2);
+}
+
+void liberer_back(background *bg) {
+    for (int i = 0; i < bg->layerCount; i++) {
+        releaseResource(bg->layers[i].image);
+        bg->layers[i].image = NULL;
+    }
+    bg->layerCount = 0;
+}
+
+// Offset of a layer for the camera, in layer pixels
+static int layerOffset(Sint32 cam, int rate) {
+    return (int)(((Sint64)cam * rate) >> (BACK_FIXED_SHIFT + 8));
+}
+
+static void drawSpan(backLayer *layer, SDL_Rect *srcRect, SDL_Surface *screen, int x, int y) {
+    if (layer->opaque) {
+        copySprite(layer->image, srcRect, screen, x, y);
+    } else {
+        SDL_Rect pos = {x, y, 0, 0};
+        blitSprite(layer->image, srcRect, screen, &pos);
+    }
+}
+
+static void drawLayer(background *bg, backLayer *layer, SDL_Surface *screen) {
+    SDL_Surface *image = layer->image;
+    int y = bg->viewport.y + layer->y - layerOffset(bg->camY, layer->rateY);
+    int offset = layerOffset(bg->camX, layer->rate);
+
+    if (!layer->wrap) {
+        SDL_Rect src = {0, 0, image->w, image->h};
+        drawSpan(layer, &src, screen, bg->viewport.x - offset, y);
+        return;
+    }
+
+    // Tiled: spans from the wrapped offset until the viewport is covered
+    int sx = offset % image->w;
+    if (sx < 0) sx += image->w;
+    int x = bg->viewport.x;
+    int end = bg->viewport.x + bg->viewport.w;
+    while (x < end) {
+        int w = image->w - sx;
+        if (w > end - x) w = end - x;
+        SDL_Rect src = {sx, 0, w, image->h};
+        drawSpan(layer, &src, screen, x, y);
+        x += w;
+        sx = 0;
+    }
+}
+
+// Index of the nearest layer that hides everything behind it
+static int firstVisibleLayer(background *bg) {
+    for (int i = bg->layerCount - 1; i > 0; i--) {
+        backLayer *layer = &bg->layers[i];
+        int top = layer->y - layerOffset(bg->camY, layer->rateY);
+        if (layer->opaque && layer->wrap && top <= 0 && top + layer->image->h >= bg->viewport.h) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+void afficher_back(background *bg, SDL_Surface *ecran) {
+    SDL_Rect oldClip = ecran->clip_rect;
+    SDL_SetClipRect(ecran, &bg->viewport);
+
+    int first = firstVisibleLayer(bg);
+    if (first == 0 && (bg->layerCount == 0 || !bg->layers[0].opaque)) {
+        // Nothing opaque at the back: start from a plain color
+        SDL_Rect fill = bg->viewport;
+        fillRect(ecran, &fill, SDL_MapRGB(ecran->format, 0, 0, 128));
+    }
+    for (int i = first; i < bg->layerCount; i++) {
+        drawLayer(bg, &bg->layers[i], ecran);
+    }
+
+    SDL_SetClipRect(ecran, &oldClip);
+}
+
+static void clampCamera(background *bg) {
+    Sint32 maxX = (Sint32)(bg->levelW - bg->viewport.w) << BACK_FIXED_SHIFT;
+    Sint32 maxY = (Sint32)(bg->levelH - bg->viewport.h) << BACK_FIXED_SHIFT;
+    if (maxX < 0) maxX = 0;
+    if (maxY < 0) maxY = 0;
+    if (bg->camX < 0) bg->camX = 0;
+    if (bg->camX > maxX) bg->camX = maxX;
+    if (bg->camY < 0) bg->camY = 0;
+    if (bg->camY > maxY) bg->camY = maxY;
+}
+
+int scrolling(background *bg, SDL_Rect *pos, int vitesse, int d) {
+    int oldX = bg->camera.x, oldY = bg->camera.y;
+    Sint32 step = (Sint32)vitesse << BACK_FIXED_SHIFT;
+
+    switch (d) {
+        case SCROLL_RIGHT: bg->camX += step; break;
+        case SCROLL_LEFT:  bg->camX -= step; break;
+        case SCROLL_UP:    bg->camY -= step; break;
+        case SCROLL_DOWN:  bg->camY += step; break;
+    }
+    clampCamera(bg);
+    updateCameraRect(bg);
+
+    int dx = bg->camera.x - oldX;
+    int dy = bg->camera.y - oldY;
+    if (pos) {
+        pos->x -= dx;
+        pos->y -= dy;
+    }
+    return dx ? abs(dx) : abs(dy);
+}
+
+int followCamera(background *bg, int levelX, int levelY) {
+    int oldX = bg->camera.x;
+
+    // Aim at a camera that centers the target, and cover an eighth of the
+    // distance per frame
+    Sint32 targetX = (Sint32)(levelX - bg->viewport.w / 2) << BACK_FIXED_SHIFT;
+    Sint32 targetY = (Sint32)(levelY - bg->viewport.h / 2) << BACK_FIXED_SHIFT;
+    bg->camX += (targetX - bg->camX) / 8;
+    bg->camY += (targetY - bg->camY) / 8;
+    clampCamera(bg);
+    updateCameraRect(bg);
+
+    return bg->camera.x - oldX;
+}
+
+void clamp_player(SDL_Rect *pos, background *bg, SDL_Surface *player_surf, int view_w, int view_h) {
+    int w = pos->w ? pos->w : (player_surf ? player_surf->w : 0);
+    int h = pos->h ? pos->h : (player_surf ? player_surf->h : 0);
+    int left = bg->viewport.x;
+    int top = bg->viewport.y;
+
+    if (pos->x < left) pos->x = left;
+    if (pos->y < top) pos->y = top;
+    if (pos->x + w > left + view_w) pos->x = left + view_w - w;
+    if (pos->y + h > top + view_h) pos->y = top + view_h - h;
+}
@@ -0,0 +1,77 @@
+#ifndef back_H_INCLUDED
+#define back_H_INCLUDED
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <SDL/SDL.h>
+#include <SDL/SDL_image.h>
+#include <SDL/SDL_ttf.h>
+#include <SDL/SDL_mixer.h>
+
+// Parallax background: several layers scrolled at their own rate behind a
+// camera that moves over a level wider than the screen.
+//
+// Camera positions are kept in fixed point (BACK_FIXED_ONE = 1 pixel) so slow
+// far layers move smoothly. Layers marked wrap are tiled horizontally. Layers
+// without transparent pixels are copied row by row, and everything behind
+// the nearest opaque layer that covers the view is not drawn at all, so the
+// per-frame cost stays about one screen copy plus the visible parts of the
+// transparent layers.
+
+#define BACK_MAX_LAYERS 6
+#define BACK_FIXED_SHIFT 8
+#define BACK_FIXED_ONE (1 << BACK_FIXED_SHIFT)
+#define BACK_RATE_ONE 256          // Layer rate of something that moves with the camera
+#define BACK_LEVEL_WIDTH 6400      // Level 1: four screens wide
+
+// Directions of scrolling()
+#define SCROLL_RIGHT 0
+#define SCROLL_LEFT 1
+#define SCROLL_UP 2
+#define SCROLL_DOWN 3
+
+typedef struct {
+    SDL_Surface *image;  // Premultiplied sprite from the resource cache (loadSprite)
+    int rate;            // Horizontal scroll in 1/256 of the camera: 0 = fixed, 256 = foreground
+    int rateY;           // Same, vertical
+    int y;               // Top of the layer in the level
+    int wrap;            // Tiled horizontally
+    int opaque;          // No transparent pixel
+} backLayer;
+
+typedef struct background
+	{
+        backLayer layers[BACK_MAX_LAYERS];  // Far to near
+        int layerCount;
+        SDL_Rect camera;     // Visible part of the level, in level pixels
+        Sint32 camX, camY;   // Camera position in 1/BACK_FIXED_ONE pixels
+        int levelW, levelH;  // Size of the level
+        SDL_Rect viewport;   // Part of the screen the background is drawn in
+        Mix_Music *music;
+    }background;
+
+// Level 1 layers, a full screen viewport and the camera at the start
+void initback(background *bg, Mix_Music *musique);
+// Split screen: two backgrounds with the same layers and their own camera,
+// bg1 on the left half of the screen and bg2 on the right half. Only bg1
+// keeps the music.
+void initpartage(background *bg1, background *bg2, Mix_Music *musique);
+// Add a layer on top of the others. Returns -1 if the image cannot be loaded.
+int addBackLayer(background *bg, const char *path, int rate, int rateY, int y, int wrap);
+void afficher_back(background *bg, SDL_Surface *ecran);
+
+// Move the camera by vitesse pixels in direction d (SCROLL_*), within the
+// level. pos, a position on the screen, is moved back by the distance the
+// camera travelled so it stays at the same place in the level (can be NULL).
+// Returns the distance travelled.
+int scrolling(background *bg, SDL_Rect *pos, int vitesse, int d);
+// Move the camera a fraction of the way to a level position (sub-pixel
+// smoothing); returns how many whole pixels the view moved on x
+int followCamera(background *bg, int levelX, int levelY);
+// Keep a position on the screen inside the view_w x view_h viewport.
+// The size comes from pos->w/h, or from player_surf when they are 0.
+void clamp_player(SDL_Rect *pos, background *bg, SDL_Surface *player_surf, int view_w, int view_h);
+
+void liberer_back(background *bg);
+
+#endif 
@@ -0,0 +1,187 @@
+#include "archive.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static struct {
+    const Uint8 *base;
+    size_t size;
+    const ArchiveHeader *header;
+    const ArchiveEntry *entries;
+    char root[512];       // Folder of the .pak, with a trailing '/'
+    size_t rootLen;
+} archive;
+
+Uint64 archiveHash(const void *data, size_t size) {
+    const Uint8 *bytes = (const Uint8 *)data;
+    Uint64 hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Packets of 32-bit words: a header word with the top bit set is a run of
+// (header & 0x7fffffff) copies of the next word, otherwise it is followed
+// by that many literal words. Transparent borders of sprites compress well.
+size_t archiveRleEncode(const Uint32 *src, size_t count, Uint32 *dst) {
+    size_t out = 0;
+    size_t i = 0;
+    while (i < count) {
+        size_t run = 1;
+        while (i + run < count && src[i + run] == src[i] && run < 0x7fffffff) run++;
+        if (run >= 3) {
+            dst[out++] = 0x80000000u | (Uint32)run;
+            dst[out++] = src[i];
+            i += run;
+            continue;
+        }
+        // Literals until the next run of 3
+        size_t start = i;
+        while (i < count && (i + 2 >= count || src[i] != src[i + 1] || src[i] != src[i + 2])) i++;
+        dst[out++] = (Uint32)(i - start);
+        memcpy(&dst[out], &src[start], (i - start) * sizeof(Uint32));
+        out += i - start;
+    }
+    return out;
+}
+
+int archiveRleDecode(const Uint32 *src, size_t srcWords, Uint32 *dst, size_t count) {
+    size_t in = 0, out = 0;
+    while (in < srcWords) {
+        Uint32 header = src[in++];
+        size_t n = header & 0x7fffffff;
+        if (out + n > count) return -1;
+        if (header & 0x80000000u) {
+            if (in >= srcWords) return -1;
+            Uint32 value = src[in++];
+            for (size_t k = 0; k < n; k++) dst[out++] = value;
+        } else {
+            if (in + n > srcWords) return -1;
+            memcpy(&dst[out], &src[in], n * sizeof(Uint32));
+            in += n;
+            out += n;
+        }
+    }
+    return out == count ? 0 : -1;
+}
+
+int mountArchive(const char *path) {
+    if (archive.base) unmountArchive();
+
+    char *full = realpath(path, NULL);
+    if (!full) {
+        printf("Archive not found: %s\n", path);
+        return -1;
+    }
+
+    int fd = open(full, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(ArchiveHeader)) {
+        printf("Cannot open archive %s\n", full);
+        if (fd >= 0) close(fd);
+        free(full);
+        return -1;
+    }
+
+    // MAP_SHARED: the page cache pages are shared with other processes
+    void *base = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        printf("Cannot map archive %s\n", full);
+        free(full);
+        return -1;
+    }
+
+    const ArchiveHeader *header = (const ArchiveHeader *)base;
+    if (memcmp(header->magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0 ||
+        header->version != ARCHIVE_VERSION ||
+        header->byteOrder != ARCHIVE_BYTE_ORDER ||
+        header->indexOffset + (Uint64)header->entryCount * sizeof(ArchiveEntry) > (Uint64)st.st_size) {
+        printf("Invalid archive %s (rebuild it with the pack tool)\n", full);
+        munmap(base, st.st_size);
+        free(full);
+        return -1;
+    }
+
+    archive.base = (const Uint8 *)base;
+    archive.size = st.st_size;
+    archive.header = header;
+    archive.entries = (const ArchiveEntry *)(archive.base + header->indexOffset);
+
+    char *slash = strrchr(full, '/');
+    size_t len = slash ? (size_t)(slash - full) + 1 : 0;
+    if (len >= sizeof(archive.root)) len = sizeof(archive.root) - 1;
+    memcpy(archive.root, full, len);
+    archive.root[len] = '\0';
+    archive.rootLen = len;
+
+    printf("Archive %s: %u entries, %u blobs, %.1f MB mapped\n",
+           full, header->entryCount, header->blobCount, st.st_size / (1024.0 * 1024.0));
+    free(full);
+    return 0;
+}
+
+void unmountArchive(void) {
+    if (archive.base) {
+        munmap((void *)archive.base, archive.size);
+    }
+    memset(&archive, 0, sizeof(archive));
+}
+
+int archiveMounted(void) {
+    return archive.base != NULL;
+}
+
+typedef struct {
+    const char *name;
+    ArchiveKind kind;
+} EntryKey;
+
+static int compareEntry(const void *key, const void *entry) {
+    const EntryKey *k = (const EntryKey *)key;
+    const ArchiveEntry *e = (const ArchiveEntry *)entry;
+    int order = strcmp(k->name, e->name);
+    return order ? order : (int)k->kind - (int)e->kind;
+}
+
+const ArchiveEntry *findArchiveEntry(const char *absPath, ArchiveKind kind) {
+    if (!archive.base || strncmp(absPath, archive.root, archive.rootLen) != 0) {
+        return NULL;
+    }
+    EntryKey key = {absPath + archive.rootLen, kind};
+    return bsearch(&key, archive.entries, archive.header->entryCount, sizeof(ArchiveEntry), compareEntry);
+}
+
+SDL_Surface *archiveLoadImage(const ArchiveEntry *entry) {
+    if (entry->kind != ARCHIVE_PIXELS && entry->kind != ARCHIVE_SPRITE) return NULL;
+    const Uint8 *blob = archive.base + entry->offset;
+
+    if (entry->compression == ARCHIVE_STORED) {
+        // SDL does not free pixels it did not allocate (SDL_PREALLOC)
+        return SDL_CreateRGBSurfaceFrom((void *)blob, entry->w, entry->h, 32, entry->pitch,
+                                        entry->Rmask, entry->Gmask, entry->Bmask, entry->Amask);
+    }
+
+    SDL_Surface *surface = SDL_CreateRGBSurface(SDL_SWSURFACE, entry->w, entry->h, 32,
+                                                entry->Rmask, entry->Gmask, entry->Bmask, entry->Amask);
+    if (!surface) return NULL;
+    if (surface->pitch != entry->pitch ||
+        archiveRleDecode((const Uint32 *)blob, entry->size / 4, (Uint32 *)surface->pixels,
+                         entry->rawSize / 4) < 0) {
+        printf("Corrupted image in archive: %s\n", entry->name);
+        SDL_FreeSurface(surface);
+        return NULL;
+    }
+    return surface;
+}
+
+SDL_RWops *archiveOpen(const ArchiveEntry *entry) {
+    if (entry->kind != ARCHIVE_RAW) return NULL;
+    return SDL_RWFromConstMem(archive.base + entry->offset, entry->size);
+}
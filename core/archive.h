@@ -0,0 +1,81 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include <SDL/SDL.h>
+#include <stddef.h>
+
+// Asset archive (.pak) written by the pack tool (pack.c).
+//
+// Layout: ArchiveHeader, then the blobs (each aligned on ARCHIVE_ALIGN so
+// pixel data starts on its own page), then the ArchiveEntry index sorted by
+// name and kind. Images are stored already decoded as 32-bit pixels, twice:
+// as they are for loadImage(), and premultiplied in the blitSprite layout
+// for loadSprite() (blit.h). The other files (sounds, music, fonts) are
+// stored as their raw bytes. Entries with the same content share one blob,
+// so the two forms of an opaque image are stored once.
+//
+// The file is mapped read-only and shared, so every running copy of the
+// game uses the same physical pages and stored images are never copied.
+
+#define ARCHIVE_MAGIC "EOTPAK1"
+#define ARCHIVE_VERSION 2
+#define ARCHIVE_BYTE_ORDER 0x01020304
+#define ARCHIVE_NAME_MAX 128
+#define ARCHIVE_ALIGN 4096
+
+typedef enum {
+    ARCHIVE_RAW,     // File bytes (wav, mp3, ttf ...)
+    ARCHIVE_PIXELS,  // Decoded image, 32 bits per pixel
+    ARCHIVE_SPRITE   // Same image premultiplied by its alpha, SPRITE_ masks (blit.h)
+} ArchiveKind;
+
+typedef enum {
+    ARCHIVE_STORED,  // Used in place from the mapping
+    ARCHIVE_RLE      // Run-length encoded 32-bit words, decoded on load
+} ArchiveCompression;
+
+typedef struct {
+    char magic[8];
+    Uint32 byteOrder;   // ARCHIVE_BYTE_ORDER as written by the packer
+    Uint32 version;
+    Uint32 entryCount;
+    Uint32 blobCount;
+    Uint64 indexOffset;
+} ArchiveHeader;
+
+typedef struct {
+    char name[ARCHIVE_NAME_MAX];  // Path relative to the packed folder
+    Uint64 hash;                  // FNV-1a of the decoded content
+    Uint64 offset;                // Start of the blob in the file
+    Uint32 size;                  // Stored bytes
+    Uint32 rawSize;               // Bytes once decompressed
+    Uint16 kind;                  // ArchiveKind
+    Uint16 compression;           // ArchiveCompression
+    Uint16 w, h;                  // Image size
+    Uint32 pitch;
+    Uint32 Rmask, Gmask, Bmask, Amask;
+} ArchiveEntry;
+
+// Map an archive. Its entries are looked up by absolute path, relative to
+// the folder that contains the .pak file. Returns 0 on success, -1 on failure.
+int mountArchive(const char *path);
+void unmountArchive(void);
+int archiveMounted(void);
+
+// Find the entry of one kind for an absolute path, NULL if the archive does
+// not have it
+const ArchiveEntry *findArchiveEntry(const char *absPath, ArchiveKind kind);
+
+// Surface for a stored image or sprite. Uncompressed pixels are used straight from the
+// mapping (the surface is read-only), RLE images are decoded into a new surface.
+SDL_Surface *archiveLoadImage(const ArchiveEntry *entry);
+
+// Read-only stream over a raw entry, for Mix_LoadWAV_RW / TTF_OpenFontRW
+SDL_RWops *archiveOpen(const ArchiveEntry *entry);
+
+// Shared with the packer
+Uint64 archiveHash(const void *data, size_t size);
+size_t archiveRleEncode(const Uint32 *src, size_t count, Uint32 *dst);
+int archiveRleDecode(const Uint32 *src, size_t srcWords, Uint32 *dst, size_t count);
+
+#endif
@@ -0,0 +1,228 @@
+#include "audio.h"
+#include "mixer.h"
+#include "music.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Number of callbacks to skip before measuring (device start-up is irregular)
+#define AUDIO_WARMUP_CALLBACKS 8
+
+static int audioOpen = 0;
+static AudioConfig openedSpec;
+
+// Written by the audio thread, read by the main thread
+static volatile Uint32 framesMixed = 0;
+static volatile Uint32 callbackCount = 0;
+static volatile Uint32 firstCallbackTicks = 0;
+static volatile Uint32 lastCallbackTicks = 0;
+
+// Audio clock: time at which clockFrame was mixed, written by the audio
+// thread under the audio lock
+static Uint32 clockFrame = 0;
+static Uint64 clockUs = 0;
+// Used while the device is closed or before its first callback
+static Uint64 fallbackStartUs = 0;
+
+static void (*userPostMix)(void *udata, Uint8 *stream, int len) = NULL;
+static void *userPostMixData = NULL;
+
+static int bytesPerFrame(const AudioConfig *spec) {
+    int sampleBytes = (spec->format & 0xFF) / 8;
+    return sampleBytes * spec->channels;
+}
+
+// Runs on the audio thread after SDL_mixer has mixed one buffer (fallback
+// music only): the streamed music and our sound effect voices are mixed
+// over it here
+static void audioPostMix(void *udata, Uint8 *stream, int len) {
+    (void)udata;
+    Uint32 now = SDL_GetTicks();
+
+    callbackCount++;
+    if (callbackCount == AUDIO_WARMUP_CALLBACKS) {
+        firstCallbackTicks = now;
+    }
+    lastCallbackTicks = now;
+
+    // The clock follows the callbacks, each expected one buffer after the
+    // last; the error is taken in by 1/8 so a late callback does not jerk it
+    Uint32 start = framesMixed;
+    Uint64 nowUs = timerNowUs();
+    if (clockUs == 0 || openedSpec.frequency <= 0) {
+        clockUs = nowUs;
+    } else {
+        Uint64 expected = clockUs + (Uint64)(start - clockFrame) * 1000000 / (Uint32)openedSpec.frequency;
+        clockUs = expected + ((Sint64)(nowUs - expected)) / 8;
+    }
+    clockFrame = start;
+
+    int frameBytes = bytesPerFrame(&openedSpec);
+    if (frameBytes > 0) {
+        framesMixed += len / frameBytes;
+    }
+
+    if (openedSpec.format == AUDIO_S16SYS) {
+        mixMusic((Sint16 *)stream, len / (int)sizeof(Sint16), openedSpec.channels);
+        mixSounds((Sint16 *)stream, len / (int)sizeof(Sint16), openedSpec.channels, start);
+    }
+
+    if (userPostMix) {
+        userPostMix(userPostMixData, stream, len);
+    }
+}
+
+AudioConfig audioConfigFor(AudioLatency latency) {
+    AudioConfig config;
+    config.frequency = 44100;
+    config.format = MIX_DEFAULT_FORMAT;
+    config.channels = 2;
+
+    switch (latency) {
+        case AUDIO_LATENCY_LOW:
+            config.chunkSize = 512;
+            break;
+        case AUDIO_LATENCY_LOW_CPU:
+            config.chunkSize = 2048;
+            break;
+        case AUDIO_LATENCY_BALANCED:
+        default:
+            config.chunkSize = 1024;
+            break;
+    }
+    return config;
+}
+
+AudioLatency audioLatencySetting(void) {
+    const char *value = getenv("AUDIO_LATENCY");
+    if (!value) return AUDIO_LATENCY_BALANCED;
+    if (strcmp(value, "low") == 0) return AUDIO_LATENCY_LOW;
+    if (strcmp(value, "lowcpu") == 0) return AUDIO_LATENCY_LOW_CPU;
+    if (strcmp(value, "balanced") != 0) {
+        printf("Unknown AUDIO_LATENCY '%s' (low, balanced or lowcpu), using balanced\n", value);
+    }
+    return AUDIO_LATENCY_BALANCED;
+}
+
+int initAudio(AudioLatency latency) {
+    AudioConfig config = audioConfigFor(latency);
+    return initAudioWithConfig(&config);
+}
+
+int initAudioWithConfig(const AudioConfig *config) {
+    if (audioOpen) {
+        // Device already open: keep it, scenes must never reopen it
+        return 0;
+    }
+
+    if (!SDL_WasInit(SDL_INIT_AUDIO) && SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
+        printf("Audio subsystem init failed: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    if (Mix_OpenAudio(config->frequency, config->format, config->channels, config->chunkSize) < 0) {
+        printf("Error opening audio device: %s\n", Mix_GetError());
+        return -1;
+    }
+
+    // Read back what the device actually gave us
+    openedSpec.chunkSize = config->chunkSize;
+    if (!Mix_QuerySpec(&openedSpec.frequency, &openedSpec.format, &openedSpec.channels)) {
+        openedSpec = *config;
+    }
+
+    framesMixed = 0;
+    clockFrame = 0;
+    clockUs = 0;
+    callbackCount = 0;
+    firstCallbackTicks = 0;
+    lastCallbackTicks = 0;
+    Mix_SetPostMix(audioPostMix, NULL);
+
+    audioOpen = 1;
+    return 0;
+}
+
+void closeAudio(void) {
+    if (!audioOpen) return;
+
+    closeMusic();
+    stopAllSounds();
+    Mix_HaltChannel(-1);
+    Mix_HaltMusic();
+    Mix_SetPostMix(NULL, NULL);
+    Mix_CloseAudio();
+    audioOpen = 0;
+}
+
+int audioIsOpen(void) {
+    return audioOpen;
+}
+
+AudioConfig audioGetSpec(void) {
+    return openedSpec;
+}
+
+float audioBufferLatencyMs(void) {
+    if (!audioOpen || openedSpec.frequency <= 0) return 0.0f;
+    return (openedSpec.chunkSize * 1000.0f) / openedSpec.frequency;
+}
+
+float audioCallbackPeriodMs(void) {
+    Uint32 count = callbackCount;
+    Uint32 first = firstCallbackTicks;
+    Uint32 last = lastCallbackTicks;
+
+    // Average over many callbacks so the 1 ms tick resolution does not matter
+    if (count < AUDIO_WARMUP_CALLBACKS + 16) return 0.0f;
+    return (float)(last - first) / (float)(count - AUDIO_WARMUP_CALLBACKS);
+}
+
+Uint32 audioFramesMixed(void) {
+    return framesMixed;
+}
+
+Uint32 audioMsToFrames(int ms) {
+    int frequency = audioOpen && openedSpec.frequency > 0 ? openedSpec.frequency : 44100;
+    return (Uint32)((Uint64)ms * (Uint32)frequency / 1000);
+}
+
+Uint32 audioClock(void) {
+    if (audioOpen && callbackCount > 0) return framesMixed;
+    if (!fallbackStartUs) fallbackStartUs = timerNowUs();
+    return (Uint32)((timerNowUs() - fallbackStartUs) * 44100 / 1000000);
+}
+
+Uint64 audioFrameTimeUs(Uint32 frame) {
+    if (!audioOpen || callbackCount == 0) {
+        if (!fallbackStartUs) fallbackStartUs = timerNowUs();
+        return fallbackStartUs + (Uint64)frame * 1000000 / 44100;
+    }
+
+    SDL_LockAudio();
+    Uint32 baseFrame = clockFrame;
+    Uint64 baseUs = clockUs;
+    SDL_UnlockAudio();
+
+    Sint64 frames = (Sint32)(frame - baseFrame) + openedSpec.chunkSize;
+    return baseUs + frames * 1000000 / openedSpec.frequency;
+}
+
+void audioSetPostMix(void (*hook)(void *udata, Uint8 *stream, int len), void *udata) {
+    SDL_LockAudio();
+    userPostMix = hook;
+    userPostMixData = udata;
+    SDL_UnlockAudio();
+}
+
+void audioPrintInfo(void) {
+    if (!audioOpen) {
+        printf("Audio device is closed\n");
+        return;
+    }
+    printf("Audio: %d Hz, %d channels, %d frames per buffer\n",
+           openedSpec.frequency, openedSpec.channels, openedSpec.chunkSize);
+    printf("Audio latency: %.1f ms per buffer, callbacks every %.1f ms\n",
+           audioBufferLatencyMs(), audioCallbackPeriodMs());
+}
@@ -0,0 +1,75 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <SDL/SDL.h>
+#include <SDL/SDL_mixer.h>
+
+// Buffer size presets: smaller buffers mean lower latency but more callbacks (more CPU)
+typedef enum {
+    AUDIO_LATENCY_LOW,       // 512 frames  (~12 ms at 44100 Hz)
+    AUDIO_LATENCY_BALANCED,  // 1024 frames (~23 ms)
+    AUDIO_LATENCY_LOW_CPU    // 2048 frames (~46 ms)
+} AudioLatency;
+
+// Settings used to open the audio device
+typedef struct {
+    int frequency;   // Sample rate in Hz
+    Uint16 format;   // Sample format (AUDIO_S16SYS ...)
+    int channels;    // 1 = mono, 2 = stereo
+    int chunkSize;   // Buffer size in sample frames
+} AudioConfig;
+
+// Get the settings for one of the presets
+AudioConfig audioConfigFor(AudioLatency latency);
+
+// Preset chosen by the user: the AUDIO_LATENCY environment variable set to
+// low, balanced or lowcpu (balanced when unset or unknown). Every program
+// opens the device with this.
+AudioLatency audioLatencySetting(void);
+
+// Open the audio device once for the whole program.
+// Calling it again while the device is open does nothing and returns 0,
+// so menus and scenes can call it freely without reopening the device.
+// Returns 0 on success, -1 on failure.
+int initAudio(AudioLatency latency);
+int initAudioWithConfig(const AudioConfig *config);
+
+// Close the audio device (only at program exit)
+void closeAudio(void);
+
+int audioIsOpen(void);
+
+// Settings the device was actually opened with (may differ from the request)
+AudioConfig audioGetSpec(void);
+
+// Latency of one output buffer computed from the opened spec
+float audioBufferLatencyMs(void);
+
+// Average time between two mixer callbacks, measured: the period at which
+// the device asks for a buffer (close to audioBufferLatencyMs() when the
+// device keeps up). Returns 0 until enough callbacks have been seen.
+float audioCallbackPeriodMs(void);
+
+// Number of sample frames mixed since the device was opened (audio clock)
+Uint32 audioFramesMixed(void);
+
+// Audio clock to schedule sounds on (scheduleSound in mixer.h): the first
+// frame of the next buffer to be mixed. Runs from the timer while the device
+// is closed, so schedules still advance without sound.
+Uint32 audioClock(void);
+Uint32 audioMsToFrames(int ms);
+
+// When a frame of the audio clock is heard, in timerNowUs() time: the time
+// of the callback that mixed it plus one buffer of output latency. The
+// callback times are smoothed, so the jitter of a busy machine stays well
+// under a video frame.
+Uint64 audioFrameTimeUs(Uint32 frame);
+
+// Install a post-mix hook. The audio service owns Mix_SetPostMix for its
+// measurements, so other code must use this instead.
+void audioSetPostMix(void (*hook)(void *udata, Uint8 *stream, int len), void *udata);
+
+// Print the opened spec and latencies to stdout
+void audioPrintInfo(void);
+
+#endif
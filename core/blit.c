@@ -0,0 +1,315 @@
+#include "blit.h"
+#include "compositor.h"
+#include "renderqueue.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BLIT_X86
+#include <immintrin.h>
+#endif
+
+typedef void (*BlendRow)(Uint32 *dst, const Uint32 *src, int count);
+
+static BlitKernel currentKernel;
+static BlendRow blendRow = NULL;
+
+// x * y / 255 rounded, for x * y <= 255 * 255. Two channels at once in the
+// 0x00FF00FF lanes of v (same result as the (t * 257) >> 16 of the SIMD kernels).
+static inline Uint32 div255Pair(Uint32 v) {
+    v += 0x00800080;
+    return ((v + ((v >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+}
+
+static inline Uint32 blendPixel(Uint32 s, Uint32 d) {
+    Uint32 inv = 255 - (s >> 24);
+    Uint32 rb = div255Pair((d & 0x00FF00FF) * inv);
+    Uint32 ag = div255Pair(((d >> 8) & 0x00FF00FF) * inv);
+    return s + (rb | (ag << 8));
+}
+
+static void blendRowScalar(Uint32 *dst, const Uint32 *src, int count) {
+    for (int i = 0; i < count; i++) {
+        Uint32 s = src[i];
+        Uint32 a = s >> 24;
+        if (a == 255) {
+            dst[i] = s;
+        } else if (a) {
+            dst[i] = blendPixel(s, dst[i]);
+        }
+        // a == 0: premultiplied color is 0 too, dst is unchanged
+    }
+}
+
+#ifdef BLIT_X86
+// Blend 8-bit channels widened to 16 bits: d * (255 - a) / 255 + s
+__attribute__((target("sse2")))
+static inline __m128i blendHalfSSE2(__m128i s16, __m128i d16) {
+    const __m128i ff = _mm_set1_epi16(255);
+    const __m128i round = _mm_set1_epi16(128);
+    const __m128i div = _mm_set1_epi16(257);
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s16, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i t = _mm_add_epi16(_mm_mullo_epi16(d16, _mm_sub_epi16(ff, a)), round);
+    return _mm_mulhi_epu16(t, div);
+}
+
+__attribute__((target("sse2")))
+static void blendRowSSE2(Uint32 *dst, const Uint32 *src, int count) {
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+        // Fully transparent or fully opaque groups are common in sprites
+        int alpha = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_srli_epi32(s, 24), zero));
+        if (alpha == 0xFFFF) continue;
+        __m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+        __m128i lo = blendHalfSSE2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+        __m128i hi = blendHalfSSE2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_add_epi8(s, _mm_packus_epi16(lo, hi)));
+    }
+    blendRowScalar(dst + i, src + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i blendHalfAVX2(__m256i s16, __m256i d16) {
+    const __m256i ff = _mm256_set1_epi16(255);
+    const __m256i round = _mm256_set1_epi16(128);
+    const __m256i div = _mm256_set1_epi16(257);
+    __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s16, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(d16, _mm256_sub_epi16(ff, a)), round);
+    return _mm256_mulhi_epu16(t, div);
+}
+
+// Same as SSE2 with 8 pixels; unpack and pack work inside each 128-bit half
+// so the pixel order is kept
+__attribute__((target("avx2")))
+static void blendRowAVX2(Uint32 *dst, const Uint32 *src, int count) {
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+        int alpha = _mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_srli_epi32(s, 24), zero));
+        if (alpha == -1) continue;
+        __m256i d = _mm256_loadu_si256((const __m256i *)(dst + i));
+        __m256i lo = blendHalfAVX2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero));
+        __m256i hi = blendHalfAVX2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_add_epi8(s, _mm256_packus_epi16(lo, hi)));
+    }
+    blendRowSSE2(dst + i, src + i, count - i);
+}
+#endif
+
+int blitKernelSupported(BlitKernel kernel) {
+    switch (kernel) {
+        case BLIT_SCALAR: return 1;
+#ifdef BLIT_X86
+        case BLIT_SSE2: return __builtin_cpu_supports("sse2");
+        case BLIT_AVX2: return __builtin_cpu_supports("avx2");
+#else
+        default: return 0;
+#endif
+    }
+    return 0;
+}
+
+const char *blitKernelName(BlitKernel kernel) {
+    switch (kernel) {
+        case BLIT_SCALAR: return "scalar";
+        case BLIT_SSE2: return "sse2";
+        case BLIT_AVX2: return "avx2";
+    }
+    return "?";
+}
+
+void setBlitKernel(BlitKernel kernel) {
+    while (kernel > BLIT_SCALAR && !blitKernelSupported(kernel)) {
+        kernel--;
+    }
+    currentKernel = kernel;
+    switch (kernel) {
+#ifdef BLIT_X86
+        case BLIT_AVX2: blendRow = blendRowAVX2; break;
+        case BLIT_SSE2: blendRow = blendRowSSE2; break;
+#endif
+        default: blendRow = blendRowScalar; break;
+    }
+}
+
+BlitKernel blitKernel(void) {
+    if (!blendRow) setBlitKernel(BLIT_AVX2);
+    return currentKernel;
+}
+
+SDL_Surface *makeSprite(SDL_Surface *image) {
+    if (!image) return NULL;
+
+    SDL_PixelFormat format;
+    memset(&format, 0, sizeof(format));
+    format.BitsPerPixel = 32;
+    format.BytesPerPixel = 4;
+    format.Rmask = SPRITE_RMASK; format.Rshift = 16;
+    format.Gmask = SPRITE_GMASK; format.Gshift = 8;
+    format.Bmask = SPRITE_BMASK; format.Bshift = 0;
+    format.Amask = SPRITE_AMASK; format.Ashift = 24;
+    format.alpha = 255;
+    SDL_Surface *sprite = SDL_ConvertSurface(image, &format, SDL_SWSURFACE);
+    if (!sprite) return NULL;
+
+    // Images without alpha channel are opaque, except their color key
+    int opaque = image->format->Amask == 0;
+    int keyed = opaque && (image->flags & SDL_SRCCOLORKEY);
+    Uint32 key = 0;
+    if (keyed) {
+        Uint8 r, g, b;
+        SDL_GetRGB(image->format->colorkey, image->format, &r, &g, &b);
+        key = ((Uint32)r << 16) | ((Uint32)g << 8) | b;
+    }
+
+    for (int y = 0; y < sprite->h; y++) {
+        Uint32 *row = (Uint32 *)((Uint8 *)sprite->pixels + y * sprite->pitch);
+        for (int x = 0; x < sprite->w; x++) {
+            Uint32 p = row[x];
+            Uint32 a = opaque ? 255 : p >> 24;
+            if (keyed && (p & 0x00FFFFFF) == key) a = 0;
+            Uint32 rb = div255Pair((p & 0x00FF00FF) * a);
+            Uint32 g = div255Pair(((p >> 8) & 0xFF) * a);
+            row[x] = (a << 24) | rb | (g << 8);
+        }
+    }
+    return sprite;
+}
+
+// Clip like SDL_UpperBlit. Returns 0 if nothing is visible.
+static int clipBlit(SDL_Surface *src, SDL_Rect *srcRect, SDL_Surface *dst, SDL_Rect *dstRect,
+                    SDL_Rect *s, SDL_Rect *d) {
+    int sx = 0, sy = 0, w = src->w, h = src->h;
+    if (srcRect) {
+        sx = srcRect->x; sy = srcRect->y;
+        w = srcRect->w; h = srcRect->h;
+        if (sx < 0) { w += sx; if (dstRect) dstRect->x -= sx; sx = 0; }
+        if (sy < 0) { h += sy; if (dstRect) dstRect->y -= sy; sy = 0; }
+        if (sx + w > src->w) w = src->w - sx;
+        if (sy + h > src->h) h = src->h - sy;
+    }
+
+    int dx = dstRect ? dstRect->x : 0;
+    int dy = dstRect ? dstRect->y : 0;
+    const SDL_Rect *clip = &dst->clip_rect;
+    if (dx < clip->x) { int n = clip->x - dx; sx += n; w -= n; dx = clip->x; }
+    if (dy < clip->y) { int n = clip->y - dy; sy += n; h -= n; dy = clip->y; }
+    if (dx + w > clip->x + clip->w) w = clip->x + clip->w - dx;
+    if (dy + h > clip->y + clip->h) h = clip->y + clip->h - dy;
+
+    if (w <= 0 || h <= 0) {
+        if (dstRect) dstRect->w = dstRect->h = 0;
+        return 0;
+    }
+    s->x = sx; s->y = sy; s->w = w; s->h = h;
+    d->x = dx; d->y = dy; d->w = w; d->h = h;
+    if (dstRect) *dstRect = *d;
+    return 1;
+}
+
+// Destinations that are not 32-bit RGB: one pixel at a time through SDL
+static void blendGeneric(SDL_Surface *src, SDL_Rect *s, SDL_Surface *dst, SDL_Rect *d) {
+    int bpp = dst->format->BytesPerPixel;
+    for (int y = 0; y < s->h; y++) {
+        const Uint32 *in = (const Uint32 *)((Uint8 *)src->pixels + (s->y + y) * src->pitch) + s->x;
+        Uint8 *out = (Uint8 *)dst->pixels + (d->y + y) * dst->pitch + d->x * bpp;
+        for (int x = 0; x < s->w; x++, out += bpp) {
+            if ((in[x] >> 24) == 0) continue;
+
+            Uint32 pixel;
+            switch (bpp) {
+                case 1: pixel = *out; break;
+                case 2: pixel = *(Uint16 *)out; break;
+                default: pixel = *(Uint32 *)out; break;
+            }
+            Uint8 r, g, b;
+            SDL_GetRGB(pixel, dst->format, &r, &g, &b);
+            Uint32 blended = blendPixel(in[x], ((Uint32)r << 16) | ((Uint32)g << 8) | b);
+            pixel = SDL_MapRGB(dst->format, (blended >> 16) & 0xFF, (blended >> 8) & 0xFF, blended & 0xFF);
+            switch (bpp) {
+                case 1: *out = (Uint8)pixel; break;
+                case 2: *(Uint16 *)out = (Uint16)pixel; break;
+                default: *(Uint32 *)out = pixel; break;
+            }
+        }
+    }
+}
+
+int blitSprite(SDL_Surface *sprite, SDL_Rect *srcRect, SDL_Surface *dst, SDL_Rect *dstRect) {
+    if (!sprite || !dst) {
+        SDL_SetError("blitSprite: NULL surface");
+        return -1;
+    }
+    if (sprite->format->BytesPerPixel != 4 || dst->format->BytesPerPixel == 3) {
+        SDL_SetError("blitSprite: unsupported format");
+        return -1;
+    }
+
+    SDL_Rect s, d;
+    if (!clipBlit(sprite, srcRect, dst, dstRect, &s, &d)) return 0;
+    if (renderQueueRecords(dst) && renderQueueRecord(DRAW_SPRITE, sprite, &s, &d, 0) == 0) return 0;
+    if (compositeRecords(dst) && compositeRecord(DRAW_SPRITE, sprite, &s, &d, 0) == 0) return 0;
+    if (!blendRow) blitKernel();
+
+    if (SDL_MUSTLOCK(dst) && SDL_LockSurface(dst) < 0) return -1;
+
+    const SDL_PixelFormat *f = dst->format;
+    if (f->BytesPerPixel == 4 && f->Rmask == SPRITE_RMASK && f->Gmask == SPRITE_GMASK &&
+        f->Bmask == SPRITE_BMASK) {
+        for (int y = 0; y < s.h; y++) {
+            const Uint32 *in = (const Uint32 *)((Uint8 *)sprite->pixels + (s.y + y) * sprite->pitch) + s.x;
+            Uint32 *out = (Uint32 *)((Uint8 *)dst->pixels + (d.y + y) * dst->pitch) + d.x;
+            blendRow(out, in, s.w);
+        }
+    } else {
+        blendGeneric(sprite, &s, dst, &d);
+    }
+
+    if (SDL_MUSTLOCK(dst)) SDL_UnlockSurface(dst);
+    return 0;
+}
+
+int copySprite(SDL_Surface *sprite, SDL_Rect *srcRect, SDL_Surface *dst, int x, int y) {
+    SDL_PixelFormat *f = dst->format;
+    if (f->BytesPerPixel != 4 || f->Rmask != SPRITE_RMASK || f->Gmask != SPRITE_GMASK ||
+        f->Bmask != SPRITE_BMASK || SDL_MUSTLOCK(dst)) {
+        SDL_Rect pos = {x, y, 0, 0};
+        return blitSprite(sprite, srcRect, dst, &pos);
+    }
+
+    SDL_Rect pos = {x, y, 0, 0};
+    SDL_Rect s, d;
+    if (!clipBlit(sprite, srcRect, dst, &pos, &s, &d)) return 0;
+    if (renderQueueRecords(dst) && renderQueueRecord(DRAW_COPY, sprite, &s, &d, 0) == 0) return 0;
+    if (compositeRecords(dst) && compositeRecord(DRAW_COPY, sprite, &s, &d, 0) == 0) return 0;
+
+    for (int row = 0; row < s.h; row++) {
+        const Uint8 *in = (const Uint8 *)sprite->pixels + (s.y + row) * sprite->pitch + s.x * 4;
+        Uint8 *out = (Uint8 *)dst->pixels + (d.y + row) * dst->pitch + d.x * 4;
+        memcpy(out, in, (size_t)s.w * 4);
+    }
+    return 0;
+}
+
+int fillRect(SDL_Surface *dst, SDL_Rect *rect, Uint32 color) {
+    // Clipped like SDL_FillRect: rect receives the filled area
+    SDL_Rect d = dst->clip_rect;
+    if (rect) {
+        const SDL_Rect *clip = &dst->clip_rect;
+        int x0 = rect->x > clip->x ? rect->x : clip->x;
+        int y0 = rect->y > clip->y ? rect->y : clip->y;
+        int x1 = rect->x + rect->w < clip->x + clip->w ? rect->x + rect->w : clip->x + clip->w;
+        int y1 = rect->y + rect->h < clip->y + clip->h ? rect->y + rect->h : clip->y + clip->h;
+        if (x1 <= x0 || y1 <= y0) {
+            rect->w = rect->h = 0;
+            return 0;
+        }
+        d.x = x0; d.y = y0; d.w = x1 - x0; d.h = y1 - y0;
+        *rect = d;
+    }
+    if (renderQueueRecords(dst) && renderQueueRecord(DRAW_FILL, NULL, NULL, &d, color) == 0) return 0;
+    if (compositeRecords(dst) && compositeRecord(DRAW_FILL, NULL, NULL, &d, color) == 0) return 0;
+    return SDL_FillRect(dst, &d, color);
+}
@@ -0,0 +1,56 @@
+#ifndef BLIT_H
+#define BLIT_H
+
+#include <SDL/SDL.h>
+
+// Alpha blitter for sprites with premultiplied alpha.
+//
+// Sprites are 32-bit ARGB surfaces whose colors are already multiplied by
+// their alpha (makeSprite converts any image). Blending is then the same
+// operation on the four channels:
+//
+//     out = src + dst * (255 - srcAlpha) / 255
+//
+// computed with exact rounding. The SSE2 and AVX2 kernels give the same bytes
+// as the scalar one; compared with an exact blend of the original image the
+// error is at most 1 per channel (the rounding of the premultiplication).
+//
+// Sprites must only be drawn with blitSprite: SDL_BlitSurface would multiply
+// the colors by alpha a second time.
+
+typedef enum {
+    BLIT_SCALAR,
+    BLIT_SSE2,
+    BLIT_AVX2
+} BlitKernel;
+
+#define SPRITE_RMASK 0x00FF0000
+#define SPRITE_GMASK 0x0000FF00
+#define SPRITE_BMASK 0x000000FF
+#define SPRITE_AMASK 0xFF000000
+
+// Premultiplied ARGB copy of an image (any format). The image is not freed.
+// Thread safe, used by the asset loader workers.
+SDL_Surface *makeSprite(SDL_Surface *image);
+
+// Same clipping and rectangle rules as SDL_BlitSurface. dst can be any
+// format; 32-bit RGB destinations use the SIMD kernels. Recorded instead of
+// drawn while a render queue or a compositor records dst.
+int blitSprite(SDL_Surface *sprite, SDL_Rect *srcRect, SDL_Surface *dst, SDL_Rect *dstRect);
+
+// Opaque sprite (or opaque part of one): rows are copied without blending
+// when dst has the sprite format, otherwise same as blitSprite
+int copySprite(SDL_Surface *sprite, SDL_Rect *srcRect, SDL_Surface *dst, int x, int y);
+
+// SDL_FillRect that can be recorded by the render queue and the compositor
+// (see renderqueue.h, compositor.h)
+int fillRect(SDL_Surface *dst, SDL_Rect *rect, Uint32 color);
+
+// Kernel chosen from the CPU features on first use
+BlitKernel blitKernel(void);
+// Force a kernel (benchmark); falls back to the best supported one
+void setBlitKernel(BlitKernel kernel);
+int blitKernelSupported(BlitKernel kernel);
+const char *blitKernelName(BlitKernel kernel);
+
+#endif
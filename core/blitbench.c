@@ -0,0 +1,156 @@
+// Benchmark of blitSprite against SDL_BlitSurface
+//
+// Usage: blitbench [blits per size]
+//
+// Draws sprites of several sizes at random places of a 1600x900 screen
+// surface, with each kernel the CPU supports, and checks the results:
+// every kernel must give the same bytes as the scalar one, and stay within
+// BLIT_MAX_ERROR of an exact blend of the straight-alpha image.
+
+#include "blit.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define SCREEN_W 1600
+#define SCREEN_H 900
+#define BLIT_MAX_ERROR 1
+
+static const int sizes[] = {16, 32, 64, 128, 256};
+
+// Round sprite with an antialiased edge, like the game's characters
+static SDL_Surface *makeImage(int size) {
+    SDL_Surface *image = SDL_CreateRGBSurface(SDL_SWSURFACE, size, size, 32,
+                                              SPRITE_RMASK, SPRITE_GMASK, SPRITE_BMASK, SPRITE_AMASK);
+    float r = size / 2.0f;
+    for (int y = 0; y < size; y++) {
+        Uint32 *row = (Uint32 *)((Uint8 *)image->pixels + y * image->pitch);
+        for (int x = 0; x < size; x++) {
+            float d = sqrtf((x + 0.5f - r) * (x + 0.5f - r) + (y + 0.5f - r) * (y + 0.5f - r));
+            float edge = r - d;
+            Uint32 a = edge >= 2 ? 255 : edge <= 0 ? 0 : (Uint32)(edge * 127.5f);
+            if (a == 255 && (x + y) % 7 == 0) a = 160;  // Some translucent pixels inside
+            row[x] = (a << 24) | ((Uint32)(rand() & 0xFF) << 16) | ((x * 255 / size) << 8) | (y * 255 / size);
+        }
+    }
+    SDL_SetAlpha(image, SDL_SRCALPHA, SDL_ALPHA_OPAQUE);
+    return image;
+}
+
+static SDL_Surface *makeScreen(void) {
+    SDL_Surface *screen = SDL_CreateRGBSurface(SDL_SWSURFACE, SCREEN_W, SCREEN_H, 32,
+                                               SPRITE_RMASK, SPRITE_GMASK, SPRITE_BMASK, 0);
+    Uint32 *pixels = (Uint32 *)screen->pixels;
+    for (int i = 0; i < SCREEN_W * SCREEN_H; i++) {
+        pixels[i] = (Uint32)rand() & 0x00FFFFFF;
+    }
+    return screen;
+}
+
+static void copyScreen(SDL_Surface *to, SDL_Surface *from) {
+    memcpy(to->pixels, from->pixels, (size_t)from->pitch * from->h);
+}
+
+// Exact blend of the straight-alpha image at (x, y), checked against out
+static int maxError(SDL_Surface *image, SDL_Surface *before, SDL_Surface *out, int x, int y) {
+    int worst = 0;
+    for (int j = 0; j < image->h; j++) {
+        const Uint32 *src = (const Uint32 *)((Uint8 *)image->pixels + j * image->pitch);
+        const Uint32 *bg = (const Uint32 *)((Uint8 *)before->pixels + (y + j) * before->pitch) + x;
+        const Uint32 *res = (const Uint32 *)((Uint8 *)out->pixels + (y + j) * out->pitch) + x;
+        for (int i = 0; i < image->w; i++) {
+            float a = (src[i] >> 24) / 255.0f;
+            for (int shift = 0; shift < 24; shift += 8) {
+                float s = (src[i] >> shift) & 0xFF;
+                float d = (bg[i] >> shift) & 0xFF;
+                int exact = (int)(s * a + d * (1 - a) + 0.5f);
+                int err = abs((int)((res[i] >> shift) & 0xFF) - exact);
+                if (err > worst) worst = err;
+            }
+        }
+    }
+    return worst;
+}
+
+int main(int argc, char *argv[]) {
+    int blits = argc > 1 ? atoi(argv[1]) : 20000;
+    int failed = 0;
+
+    SDL_Surface *background = makeScreen();
+    SDL_Surface *screen = makeScreen();
+    SDL_Surface *reference = makeScreen();
+
+    printf("Default kernel: %s\n", blitKernelName(blitKernel()));
+    printf("%6s %-14s %10s %10s %8s\n", "size", "blitter", "ns/blit", "Mpix/s", "speedup");
+
+    for (size_t n = 0; n < sizeof(sizes) / sizeof(sizes[0]); n++) {
+        int size = sizes[n];
+        SDL_Surface *image = makeImage(size);
+        SDL_Surface *sprite = makeSprite(image);
+        int count = (int)(blits * (64.0 * 64.0) / (size * size)) + 100;
+
+        int *xs = malloc(count * sizeof(int));
+        int *ys = malloc(count * sizeof(int));
+        for (int i = 0; i < count; i++) {
+            xs[i] = rand() % (SCREEN_W - size);
+            ys[i] = rand() % (SCREEN_H - size);
+        }
+
+        // SDL's blitter on the straight-alpha image
+        copyScreen(screen, background);
+        Uint64 start = timerNowUs();
+        for (int i = 0; i < count; i++) {
+            SDL_Rect pos = {xs[i], ys[i], 0, 0};
+            SDL_BlitSurface(image, NULL, screen, &pos);
+        }
+        double sdlNs = (timerNowUs() - start) * 1000.0 / count;
+        printf("%6d %-14s %10.0f %10.1f %8s\n", size, "SDL_BlitSurface", sdlNs,
+               size * size / sdlNs * 1000.0, "1.00x");
+
+        // Single blit for the comparisons
+        SDL_Rect pos = {xs[0], ys[0], 0, 0};
+        copyScreen(reference, background);
+        setBlitKernel(BLIT_SCALAR);
+        blitSprite(sprite, NULL, reference, &pos);
+
+        for (BlitKernel kernel = BLIT_SCALAR; kernel <= BLIT_AVX2; kernel++) {
+            if (!blitKernelSupported(kernel)) continue;
+            setBlitKernel(kernel);
+
+            copyScreen(screen, background);
+            start = timerNowUs();
+            for (int i = 0; i < count; i++) {
+                SDL_Rect p = {xs[i], ys[i], 0, 0};
+                blitSprite(sprite, NULL, screen, &p);
+            }
+            double ns = (timerNowUs() - start) * 1000.0 / count;
+
+            copyScreen(screen, background);
+            pos.x = xs[0]; pos.y = ys[0];
+            blitSprite(sprite, NULL, screen, &pos);
+            int same = memcmp(screen->pixels, reference->pixels, (size_t)screen->pitch * screen->h) == 0;
+            int err = maxError(image, background, screen, xs[0], ys[0]);
+
+            char name[32];
+            snprintf(name, sizeof(name), "blitSprite %s", blitKernelName(kernel));
+            printf("%6d %-14s %10.0f %10.1f %7.2fx", size, name, ns, size * size / ns * 1000.0, sdlNs / ns);
+            if (!same) printf("  DIFFERS FROM SCALAR");
+            if (err > BLIT_MAX_ERROR) printf("  ERROR %d", err);
+            printf("\n");
+            if (!same || err > BLIT_MAX_ERROR) failed = 1;
+        }
+
+        free(xs);
+        free(ys);
+        SDL_FreeSurface(sprite);
+        SDL_FreeSurface(image);
+    }
+
+    SDL_FreeSurface(reference);
+    SDL_FreeSurface(screen);
+    SDL_FreeSurface(background);
+    setBlitKernel(BLIT_AVX2);
+    return failed;
+}
@@ -0,0 +1,73 @@
+#include "camera.h"
+#include <stdio.h>
+#include <string.h>
+
+static Camera screenCamera;
+static int screenCameraReady = 0;
+static __thread Camera *current = NULL;
+
+void initCamera(Camera *camera, SDL_Rect viewport) {
+    memset(camera, 0, sizeof(*camera));
+    camera->viewport = viewport;
+}
+
+void setCameraPosition(Camera *camera, int x, int y) {
+    camera->x = x;
+    camera->y = y;
+}
+
+Camera *activeCamera(void) {
+    if (current) return current;
+
+    // Follows the size of the video mode (options can change it)
+    SDL_Surface *screen = SDL_GetVideoSurface();
+    SDL_Rect full = {0, 0, screen ? screen->w : 1600, screen ? screen->h : 900};
+    if (!screenCameraReady) {
+        initCamera(&screenCamera, full);
+        screenCameraReady = 1;
+    }
+    screenCamera.viewport = full;
+    return &screenCamera;
+}
+
+void setActiveCamera(Camera *camera) {
+    current = camera;
+}
+
+int cameraVisible(Camera *camera, const SDL_Rect *bounds, int margin) {
+    camera->tested++;
+    int left = bounds->x - margin;
+    int top = bounds->y - margin;
+    int right = bounds->x + bounds->w + margin;
+    int bottom = bounds->y + bounds->h + margin;
+
+    if (right <= camera->x || bottom <= camera->y ||
+        left >= camera->x + camera->viewport.w || top >= camera->y + camera->viewport.h) {
+        camera->culled++;
+        return 0;
+    }
+    return 1;
+}
+
+SDL_Rect cameraToScreen(const Camera *camera, SDL_Rect bounds) {
+    bounds.x = bounds.x - camera->x + camera->viewport.x;
+    bounds.y = bounds.y - camera->y + camera->viewport.y;
+    return bounds;
+}
+
+void cameraEndFrame(Camera *camera) {
+    camera->lastTested = camera->tested;
+    camera->lastCulled = camera->culled;
+    camera->totalTested += camera->tested;
+    camera->totalCulled += camera->culled;
+    camera->frames++;
+    camera->tested = 0;
+    camera->culled = 0;
+}
+
+void printCullStats(const Camera *camera, const char *name) {
+    if (camera->frames == 0) return;
+    printf("Culling (%s): %.1f entities tested per frame, %.1f culled (%.0f%%)\n", name,
+           (double)camera->totalTested / camera->frames, (double)camera->totalCulled / camera->frames,
+           camera->totalTested ? 100.0 * camera->totalCulled / camera->totalTested : 0.0);
+}
@@ -0,0 +1,44 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <SDL/SDL.h>
+
+// View of the level: which part of the world is shown, and where on the
+// screen. Entities keep level (world) positions; draw functions ask the
+// active camera whether an entity is visible and where to draw it.
+//
+// The visibility test is conservative: an entity is culled only if its
+// bounds, grown by a margin (for a health bar, a shadow ...), do not touch
+// the view.
+
+typedef struct {
+    int x, y;            // Top-left of the view in the level
+    SDL_Rect viewport;   // Where the view is drawn on the screen
+
+    // Culling counters of the current frame and of the previous one
+    int tested, culled;
+    int lastTested, lastCulled;
+    Uint32 frames;
+    Uint64 totalTested, totalCulled;
+} Camera;
+
+void initCamera(Camera *camera, SDL_Rect viewport);
+void setCameraPosition(Camera *camera, int x, int y);
+
+// Camera used by the draw functions of the calling thread (each view of a
+// split screen is drawn by its own thread). Without one, a camera at (0, 0)
+// covering the whole screen is used (modules run on their own).
+Camera *activeCamera(void);
+void setActiveCamera(Camera *camera);
+
+// 1 if the level rectangle, grown by margin on every side, is in the view
+int cameraVisible(Camera *camera, const SDL_Rect *bounds, int margin);
+// Screen position of a level rectangle
+SDL_Rect cameraToScreen(const Camera *camera, SDL_Rect bounds);
+
+// Call once per frame after drawing: moves the counters to last*
+// (the caller shows them, e.g. with profilerSetCounter)
+void cameraEndFrame(Camera *camera);
+void printCullStats(const Camera *camera, const char *name);
+
+#endif
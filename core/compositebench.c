@@ -0,0 +1,138 @@
+// Benchmark of the tile compositor against drawing directly
+//
+// Usage: compositebench [sprites per frame] [frames]
+//
+// Draws a frame like the game's (an opaque background copied row by row,
+// translucent sprites, filled rectangles, a clip rectangle per half of the
+// screen) on a 1600x900 surface, directly and then through the compositor
+// with 1, 2, 4 ... workers. Every composited frame must have the same bytes
+// as the direct one.
+
+#include "blit.h"
+#include "compositor.h"
+#include "jobs.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SCREEN_W 1600
+#define SCREEN_H 900
+
+typedef struct {
+    int x, y, size;
+} Placement;
+
+static SDL_Surface *makeImage(int w, int h, int opaque) {
+    SDL_Surface *image = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 32,
+                                              SPRITE_RMASK, SPRITE_GMASK, SPRITE_BMASK, SPRITE_AMASK);
+    for (int y = 0; y < h; y++) {
+        Uint32 *row = (Uint32 *)((Uint8 *)image->pixels + y * image->pitch);
+        for (int x = 0; x < w; x++) {
+            Uint32 a = opaque ? 255 : (Uint32)(rand() % 3 == 0 ? 0 : rand() & 0xFF);
+            row[x] = (a << 24) | ((Uint32)rand() & 0x00FFFFFF);
+        }
+    }
+    SDL_Surface *sprite = makeSprite(image);
+    SDL_FreeSurface(image);
+    return sprite;
+}
+
+static void drawFrame(SDL_Surface *screen, SDL_Surface *back, SDL_Surface **sprites,
+                      Placement *places, int count) {
+    SDL_Rect halves[2] = {{0, 0, SCREEN_W / 2, SCREEN_H}, {SCREEN_W / 2, 0, SCREEN_W / 2, SCREEN_H}};
+
+    for (int h = 0; h < 2; h++) {
+        SDL_SetClipRect(screen, &halves[h]);
+        copySprite(back, NULL, screen, halves[h].x - 37 * h, 0);
+
+        for (int i = h; i < count; i += 2) {
+            SDL_Rect pos = {places[i].x, places[i].y, 0, 0};
+            blitSprite(sprites[places[i].size], NULL, screen, &pos);
+            if (i % 16 == 0) {
+                SDL_Rect bar = {places[i].x, places[i].y - 12, 60, 8};
+                fillRect(screen, &bar, SDL_MapRGB(screen->format, 60, 60, 60));
+            }
+        }
+    }
+    SDL_SetClipRect(screen, NULL);
+    SDL_Rect divider = {SCREEN_W / 2 - 2, 0, 4, SCREEN_H};
+    fillRect(screen, &divider, 0);
+}
+
+static double timeFrames(Compositor *comp, SDL_Surface *screen, SDL_Surface *back,
+                         SDL_Surface **sprites, Placement *places, int count, int frames) {
+    Uint64 start = timerNowUs();
+    for (int f = 0; f < frames; f++) {
+        beginComposite(comp, screen);
+        drawFrame(screen, back, sprites, places, count);
+        endComposite(comp);
+    }
+    return (timerNowUs() - start) / 1000.0 / frames;
+}
+
+int main(int argc, char *argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 400;
+    int frames = argc > 2 ? atoi(argv[2]) : 50;
+    int failed = 0;
+
+    static const int sizes[] = {32, 64, 128, 256};
+    SDL_Surface *sprites[4];
+    for (int i = 0; i < 4; i++) sprites[i] = makeImage(sizes[i], sizes[i], 0);
+    SDL_Surface *back = makeImage(SCREEN_W, SCREEN_H, 1);
+
+    Placement *places = malloc(count * sizeof(Placement));
+    for (int i = 0; i < count; i++) {
+        places[i].size = rand() % 4;
+        places[i].x = rand() % (SCREEN_W + 200) - 200;  // Some cross the edges
+        places[i].y = rand() % (SCREEN_H + 200) - 200;
+    }
+
+    SDL_Surface *screen = SDL_CreateRGBSurface(SDL_SWSURFACE, SCREEN_W, SCREEN_H, 32,
+                                               SPRITE_RMASK, SPRITE_GMASK, SPRITE_BMASK, 0);
+    SDL_Surface *reference = SDL_CreateRGBSurface(SDL_SWSURFACE, SCREEN_W, SCREEN_H, 32,
+                                                  SPRITE_RMASK, SPRITE_GMASK, SPRITE_BMASK, 0);
+    size_t bytes = (size_t)screen->pitch * screen->h;
+
+    printf("Kernel: %s, %d sprites per frame, %d frames\n", blitKernelName(blitKernel()), count, frames);
+    printf("%-12s %10s %8s\n", "renderer", "ms/frame", "speedup");
+
+    // Direct drawing, for the time and the bytes to match
+    Compositor comp;
+    initCompositor(&comp, NULL);
+    comp.serial = 1;
+    double directMs = timeFrames(&comp, screen, back, sprites, places, count, frames);
+    memcpy(reference->pixels, screen->pixels, bytes);
+    freeCompositor(&comp);
+    printf("%-12s %10.2f %8s\n", "direct", directMs, "1.00x");
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) cpus = 1;
+    for (int workers = 1; workers <= JOBS_MAX_WORKERS; workers *= 2) {
+        JobPool pool;
+        if (initJobPool(&pool, workers) < 0) break;
+        initCompositor(&comp, &pool);
+
+        memset(screen->pixels, 0, bytes);
+        double ms = timeFrames(&comp, screen, back, sprites, places, count, frames);
+        int same = memcmp(screen->pixels, reference->pixels, bytes) == 0;
+
+        char name[32];
+        snprintf(name, sizeof(name), "%d worker%s", workers, workers > 1 ? "s" : "");
+        printf("%-12s %10.2f %7.2fx  %u commands%s\n", name, ms, directMs / ms, comp.lastCommands,
+               same ? "" : "  DIFFERS FROM DIRECT");
+        if (!same) failed = 1;
+
+        freeCompositor(&comp);
+        closeJobPool(&pool);
+        if (workers >= cpus) break;
+    }
+
+    SDL_FreeSurface(reference);
+    SDL_FreeSurface(screen);
+    SDL_FreeSurface(back);
+    for (int i = 0; i < 4; i++) SDL_FreeSurface(sprites[i]);
+    free(places);
+    return failed;
+}
@@ -0,0 +1,195 @@
+#include "compositor.h"
+#include "blit.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static Compositor *recording = NULL;
+
+void initCompositor(Compositor *comp, JobPool *pool) {
+    memset(comp, 0, sizeof(*comp));
+    comp->pool = pool;
+}
+
+void freeCompositor(Compositor *comp) {
+    if (recording == comp) recording = NULL;
+    for (int i = 0; i < COMPOSITE_MAX_TILES; i++) {
+        if (comp->tileSurfaces[i]) SDL_FreeSurface(comp->tileSurfaces[i]);
+    }
+    free(comp->commands);
+    free(comp->tileCommands);
+    memset(comp, 0, sizeof(*comp));
+}
+
+int compositeRecords(SDL_Surface *dst) {
+    return recording && recording->target == dst;
+}
+
+int compositeRecord(DrawOp op, SDL_Surface *src, const SDL_Rect *srcRect,
+                    const SDL_Rect *dstRect, Uint32 color) {
+    Compositor *comp = recording;
+    if (comp->commandCount == comp->commandCapacity) {
+        int capacity = comp->commandCapacity ? comp->commandCapacity * 2 : 1024;
+        DrawCommand *grown = realloc(comp->commands, capacity * sizeof(DrawCommand));
+        if (!grown) return -1;
+        comp->commands = grown;
+        comp->commandCapacity = capacity;
+    }
+
+    DrawCommand *cmd = &comp->commands[comp->commandCount++];
+    cmd->op = op;
+    cmd->src = src;
+    if (srcRect) cmd->srcRect = *srcRect;
+    cmd->dstRect = *dstRect;
+    cmd->color = color;
+    return 0;
+}
+
+int beginComposite(Compositor *comp, SDL_Surface *target) {
+    if (recording) {
+        printf("Compositor already recording\n");
+        return -1;
+    }
+    if (!comp->pool) comp->pool = defaultJobPool();
+
+    comp->tileCount = (target->h + COMPOSITE_TILE - 1) / COMPOSITE_TILE;
+    if (comp->tileCount > COMPOSITE_MAX_TILES) {
+        printf("Screen too large for the compositor (%dx%d)\n", target->w, target->h);
+        return -1;
+    }
+    comp->target = target;
+    comp->commandCount = 0;
+    if (!comp->serial) recording = comp;
+    return 0;
+}
+
+// Counting sort of the commands into the tiles they touch: order is kept
+static int binCommands(Compositor *comp) {
+    int tileCount = comp->tileCount;
+    int counts[COMPOSITE_MAX_TILES];
+    memset(counts, 0, tileCount * sizeof(int));
+
+    int total = 0;
+    for (int i = 0; i < comp->commandCount; i++) {
+        SDL_Rect *r = &comp->commands[i].dstRect;
+        int first = r->y / COMPOSITE_TILE, last = (r->y + r->h - 1) / COMPOSITE_TILE;
+        for (int t = first; t <= last; t++) {
+            counts[t]++;
+        }
+        total += last - first + 1;
+    }
+
+    if (total > comp->tileCommandCapacity) {
+        int *grown = realloc(comp->tileCommands, total * sizeof(int));
+        if (!grown) return -1;
+        comp->tileCommands = grown;
+        comp->tileCommandCapacity = total;
+    }
+
+    comp->busyCount = 0;
+    comp->tileStart[0] = 0;
+    for (int t = 0; t < tileCount; t++) {
+        comp->tileStart[t + 1] = comp->tileStart[t] + counts[t];
+        if (counts[t]) comp->busyTiles[comp->busyCount++] = t;
+        counts[t] = comp->tileStart[t];  // Now the next free slot of the tile
+    }
+
+    for (int i = 0; i < comp->commandCount; i++) {
+        SDL_Rect *r = &comp->commands[i].dstRect;
+        int first = r->y / COMPOSITE_TILE, last = (r->y + r->h - 1) / COMPOSITE_TILE;
+        for (int t = first; t <= last; t++) {
+            comp->tileCommands[counts[t]++] = i;
+        }
+    }
+    return 0;
+}
+
+static SDL_Rect tileRect(Compositor *comp, int tile) {
+    SDL_Rect r;
+    r.x = 0;
+    r.y = tile * COMPOSITE_TILE;
+    r.w = comp->target->w;
+    r.h = comp->target->h - r.y < COMPOSITE_TILE ? comp->target->h - r.y : COMPOSITE_TILE;
+    return r;
+}
+
+// Surface over the pixels of one tile of the target, with its own clip
+// rectangle so the workers share nothing
+static SDL_Surface *tileSurface(Compositor *comp, int tile) {
+    SDL_Surface *target = comp->target;
+    SDL_PixelFormat *f = target->format;
+    SDL_Rect r = tileRect(comp, tile);
+    Uint8 *pixels = (Uint8 *)target->pixels + r.y * target->pitch + r.x * f->BytesPerPixel;
+    SDL_Surface *s = comp->tileSurfaces[tile];
+
+    if (s && s->w == r.w && s->h == r.h && s->pitch == target->pitch &&
+        s->format->BitsPerPixel == f->BitsPerPixel && s->format->Rmask == f->Rmask &&
+        s->format->Gmask == f->Gmask && s->format->Bmask == f->Bmask) {
+        s->pixels = pixels;
+        return s;
+    }
+
+    if (s) SDL_FreeSurface(s);
+    s = SDL_CreateRGBSurfaceFrom(pixels, r.w, r.h, f->BitsPerPixel, target->pitch,
+                                 f->Rmask, f->Gmask, f->Bmask, f->Amask);
+    comp->tileSurfaces[tile] = s;
+    if (!s) printf("Cannot create compositor tile: %s\n", SDL_GetError());
+    return s;
+}
+
+static void drawCommand(DrawCommand *cmd, SDL_Surface *dst, int ox, int oy) {
+    SDL_Rect d = {cmd->dstRect.x - ox, cmd->dstRect.y - oy, cmd->dstRect.w, cmd->dstRect.h};
+    SDL_Rect s = cmd->srcRect;
+    switch (cmd->op) {
+        case DRAW_SPRITE:
+            blitSprite(cmd->src, &s, dst, &d);
+            break;
+        case DRAW_COPY:
+            copySprite(cmd->src, &s, dst, d.x, d.y);
+            break;
+        case DRAW_FILL:
+            SDL_FillRect(dst, &d, cmd->color);
+            break;
+    }
+}
+
+static void drawTileJob(void *data, int index) {
+    Compositor *comp = (Compositor *)data;
+    int tile = comp->busyTiles[index];
+    SDL_Surface *surface = comp->tileSurfaces[tile];
+    if (!surface) return;
+
+    SDL_Rect r = tileRect(comp, tile);
+    for (int i = comp->tileStart[tile]; i < comp->tileStart[tile + 1]; i++) {
+        drawCommand(&comp->commands[comp->tileCommands[i]], surface, r.x, r.y);
+    }
+}
+
+void endComposite(Compositor *comp) {
+    if (recording != comp) return;
+    recording = NULL;
+
+    SDL_Surface *target = comp->target;
+    comp->lastCommands = comp->commandCount;
+    if (comp->commandCount == 0) return;
+
+    if (SDL_MUSTLOCK(target) && SDL_LockSurface(target) < 0) return;
+
+    if (binCommands(comp) < 0) {
+        // Out of memory: one thread, straight onto the target, in recording
+        // order. The rectangles were clipped when recorded.
+        SDL_Rect oldClip = target->clip_rect;
+        SDL_SetClipRect(target, NULL);
+        for (int i = 0; i < comp->commandCount; i++) {
+            drawCommand(&comp->commands[i], target, 0, 0);
+        }
+        SDL_SetClipRect(target, &oldClip);
+    } else {
+        for (int i = 0; i < comp->busyCount; i++) {
+            tileSurface(comp, comp->busyTiles[i]);
+        }
+        runJobs(comp->pool, drawTileJob, comp, comp->busyCount);
+    }
+
+    if (SDL_MUSTLOCK(target)) SDL_UnlockSurface(target);
+}
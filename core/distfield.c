@@ -0,0 +1,302 @@
+#include "distfield.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define EDT_INF ((Sint64)1 << 40)
+#define MARCH_MAX_STEPS 2048
+
+// Integer square root (floor). sqrt is exactly rounded on every IEEE
+// platform; the corrections make the result exact past 2^52 too.
+static Uint64 isqrt64(Uint64 n) {
+    Uint64 root = (Uint64)sqrt((double)n);
+    while (root * root > n) root--;
+    while ((root + 1) * (root + 1) <= n) root++;
+    return root;
+}
+
+static int floorDiv(int a, int b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+// ---------------------------------------------------------------------------
+// Transform
+
+typedef struct {
+    Sint64 *f, *d;           // Input and output of one line
+    int *v;                  // Parabolas of the lower envelope
+    Sint64 *zn, *zd;         // Their boundaries, as fractions
+} EdtScratch;
+
+// d[q] = min over p of (q - p)^2 + f[p], with f = EDT_INF where there is
+// nothing. The boundaries between parabolas are kept as fractions so the
+// whole transform stays exact in integers.
+static void edt1d(EdtScratch *s, int n) {
+    const Sint64 *f = s->f;
+    int k = -1;
+    for (int q = 0; q < n; q++) {
+        if (f[q] >= EDT_INF) continue;
+        Sint64 num = 0, den = 1;
+        while (k >= 0) {
+            int p = s->v[k];
+            num = (f[q] + (Sint64)q * q) - (f[p] + (Sint64)p * p);
+            den = 2 * (Sint64)(q - p);
+            // Parabola k is hidden when the new one crosses it before it starts
+            if (k > 0 && num * s->zd[k] <= s->zn[k] * den) {
+                k--;
+                continue;
+            }
+            break;
+        }
+        k++;
+        s->v[k] = q;
+        s->zn[k] = num;
+        s->zd[k] = den;
+    }
+
+    if (k < 0) {
+        for (int q = 0; q < n; q++) s->d[q] = EDT_INF;
+        return;
+    }
+    int top = k;
+    k = 0;
+    for (int q = 0; q < n; q++) {
+        while (k < top && s->zn[k + 1] < (Sint64)q * s->zd[k + 1]) k++;
+        Sint64 dq = q - s->v[k];
+        s->d[q] = dq * dq + f[s->v[k]];
+    }
+}
+
+// Squared distance (in cells) from every cell to the nearest cell of the set.
+// In a column the input is 0 or nothing, so the first pass is two sweeps
+// down and up the rows (every column at once, in memory order); the second
+// pass runs the lower envelope along each row.
+static void edt2d(EdtScratch *s, const Uint8 *walls, int inSet, int cols, int rows, Sint64 *out) {
+    const Sint64 far = (Sint64)cols + rows;
+    for (int col = 0; col < cols; col++) {
+        out[col] = (walls[col] != 0) == inSet ? 0 : far;
+    }
+    for (int row = 1; row < rows; row++) {
+        const Uint8 *w = walls + row * cols;
+        Sint64 *o = out + row * cols, *above = o - cols;
+        for (int col = 0; col < cols; col++) {
+            o[col] = (w[col] != 0) == inSet ? 0 : above[col] + 1;
+        }
+    }
+    for (int row = rows - 2; row >= 0; row--) {
+        Sint64 *o = out + row * cols, *below = o + cols;
+        for (int col = 0; col < cols; col++) {
+            if (below[col] + 1 < o[col]) o[col] = below[col] + 1;
+        }
+    }
+    for (int row = 0; row < rows; row++) {
+        const Sint64 *o = out + row * cols;
+        for (int col = 0; col < cols; col++) {
+            s->f[col] = o[col] >= far ? EDT_INF : o[col] * o[col];
+        }
+        edt1d(s, cols);
+        memcpy(out + row * cols, s->d, cols * sizeof(Sint64));
+    }
+}
+
+// Distance between centers in 1/DISTFIELD_ONE pixel, minus half a diagonal
+static int cellDistance(Sint64 squared, int cellSize) {
+    if (squared >= EDT_INF) return DISTFIELD_MAX;
+    Sint64 scale = (Sint64)cellSize * DISTFIELD_ONE;
+    Sint64 dist = (Sint64)isqrt64((Uint64)(squared * scale * scale)) - scale * 181 / 256;
+    return dist > DISTFIELD_MAX ? DISTFIELD_MAX : (int)dist;
+}
+
+int buildDistField(DistField *field, const Uint8 *walls, int cols, int rows, int cellSize) {
+    memset(field, 0, sizeof(*field));
+    int line = cols > rows ? cols : rows;
+    size_t cells = (size_t)cols * rows;
+    EdtScratch s;
+    s.f = malloc(line * sizeof(Sint64));
+    s.d = malloc(line * sizeof(Sint64));
+    s.v = malloc(line * sizeof(int));
+    s.zn = malloc(line * sizeof(Sint64));
+    s.zd = malloc(line * sizeof(Sint64));
+    Sint64 *outside = malloc(cells * sizeof(Sint64));
+    Sint64 *inside = malloc(cells * sizeof(Sint64));
+    field->dist = malloc(cells * sizeof(Sint16));
+
+    int result = -1;
+    if (s.f && s.d && s.v && s.zn && s.zd && outside && inside && field->dist) {
+        // Free cells: distance to the walls; wall cells: to the free cells
+        edt2d(&s, walls, 1, cols, rows, outside);
+        edt2d(&s, walls, 0, cols, rows, inside);
+        for (size_t i = 0; i < cells; i++) {
+            field->dist[i] = (Sint16)(walls[i] ? -cellDistance(inside[i], cellSize)
+                                               : cellDistance(outside[i], cellSize));
+        }
+        field->cols = cols;
+        field->rows = rows;
+        field->cellSize = cellSize;
+        field->width = cols * cellSize;
+        field->height = rows * cellSize;
+        result = 0;
+    } else {
+        free(field->dist);
+        field->dist = NULL;
+    }
+    free(s.f);
+    free(s.d);
+    free(s.v);
+    free(s.zn);
+    free(s.zd);
+    free(outside);
+    free(inside);
+    return result;
+}
+
+int buildMaskDistField(DistField *field, SDL_Surface *mask, int cellSize) {
+    if (!mask || cellSize < 1 || (SDL_MUSTLOCK(mask) && SDL_LockSurface(mask) < 0)) return -1;
+
+    int cols = (mask->w + cellSize - 1) / cellSize;
+    int rows = (mask->h + cellSize - 1) / cellSize;
+    Uint8 *walls = calloc((size_t)cols * rows, 1);
+    if (!walls) {
+        if (SDL_MUSTLOCK(mask)) SDL_UnlockSurface(mask);
+        return -1;
+    }
+
+    SDL_PixelFormat *f = mask->format;
+    int bpp = f->BytesPerPixel;
+    for (int y = 0; y < mask->h; y++) {
+        Uint8 *row = (Uint8 *)mask->pixels + y * mask->pitch;
+        Uint8 *cells = walls + (y / cellSize) * cols;
+        for (int x = 0; x < mask->w; x++) {
+            Uint32 pixel;
+            switch (bpp) {
+                case 1: pixel = row[x]; break;
+                case 2: pixel = ((Uint16 *)row)[x]; break;
+                case 4: pixel = ((Uint32 *)row)[x]; break;
+                default: pixel = row[x * 3] | row[x * 3 + 1] << 8 | row[x * 3 + 2] << 16; break;
+            }
+            int solid;
+            if (f->Amask) {
+                Uint8 r, g, b, a;
+                SDL_GetRGBA(pixel, f, &r, &g, &b, &a);
+                solid = a >= 128;
+            } else {
+                solid = !(mask->flags & SDL_SRCCOLORKEY) || pixel != f->colorkey;
+            }
+            if (solid) cells[x / cellSize] = 1;
+        }
+    }
+    if (SDL_MUSTLOCK(mask)) SDL_UnlockSurface(mask);
+
+    int result = buildDistField(field, walls, cols, rows, cellSize);
+    free(walls);
+    return result;
+}
+
+int buildTileDistField(DistField *field, const TileMap *map, int cellSize) {
+    if (!map->header || cellSize < 1) return -1;
+    int cols = (map->width + cellSize - 1) / cellSize;
+    int rows = (map->height + cellSize - 1) / cellSize;
+    Uint8 *walls = malloc((size_t)cols * rows);
+    if (!walls) return -1;
+    // A cell is a wall if its center is on a solid tile
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; col < cols; col++) {
+            walls[row * cols + col] = (Uint8)tileSolidAt(map, col * cellSize + cellSize / 2,
+                                                         row * cellSize + cellSize / 2);
+        }
+    }
+    int result = buildDistField(field, walls, cols, rows, cellSize);
+    free(walls);
+    return result;
+}
+
+void freeDistField(DistField *field) {
+    free(field->dist);
+    memset(field, 0, sizeof(*field));
+}
+
+// ---------------------------------------------------------------------------
+// Queries (positions in 1/DISTFIELD_ONE pixel)
+
+static int sampleAt(const DistField *field, int col, int row) {
+    if (col < 0) col = 0;
+    if (col >= field->cols) col = field->cols - 1;
+    if (row < 0) row = 0;
+    if (row >= field->rows) row = field->rows - 1;
+    return field->dist[row * field->cols + col];
+}
+
+static int distanceFixed(const DistField *field, int px, int py) {
+    if (!field->dist) return DISTFIELD_MAX;
+    // Position in cells from the first cell center, in 1/DISTFIELD_ONE cell
+    int gx = floorDiv(px, field->cellSize) - DISTFIELD_ONE / 2;
+    int gy = floorDiv(py, field->cellSize) - DISTFIELD_ONE / 2;
+    int col = floorDiv(gx, DISTFIELD_ONE), row = floorDiv(gy, DISTFIELD_ONE);
+    int fx = gx - col * DISTFIELD_ONE, fy = gy - row * DISTFIELD_ONE;
+
+    int d00 = sampleAt(field, col, row), d10 = sampleAt(field, col + 1, row);
+    int d01 = sampleAt(field, col, row + 1), d11 = sampleAt(field, col + 1, row + 1);
+    int top = d00 * (DISTFIELD_ONE - fx) + d10 * fx;
+    int bottom = d01 * (DISTFIELD_ONE - fx) + d11 * fx;
+    return floorDiv(top * (DISTFIELD_ONE - fy) + bottom * fy, DISTFIELD_ONE * DISTFIELD_ONE);
+}
+
+int fieldDistance(const DistField *field, int x, int y) {
+    return distanceFixed(field, x * DISTFIELD_ONE, y * DISTFIELD_ONE);
+}
+
+void fieldNormal(const DistField *field, int x, int y, int *nx, int *ny) {
+    int step = field->cellSize;
+    *nx = fieldDistance(field, x + step, y) - fieldDistance(field, x - step, y);
+    *ny = fieldDistance(field, x, y + step) - fieldDistance(field, x, y - step);
+}
+
+// Position at t (1/DISTFIELD_ONE pixel) along the segment
+static void pointAt(int x0, int y0, Sint64 dx, Sint64 dy, Sint64 t, Sint64 length, int *px, int *py) {
+    *px = x0 * DISTFIELD_ONE + (length ? (int)(dx * DISTFIELD_ONE * t / length) : 0);
+    *py = y0 * DISTFIELD_ONE + (length ? (int)(dy * DISTFIELD_ONE * t / length) : 0);
+}
+
+// Sphere tracing: step by the free distance, by half a pixel at least, and
+// stop before the clearance goes under 0. A start already in a wall may only
+// move out of it. Returns 1 on contact, with the last free position.
+static int march(const DistField *field, int x0, int y0, int x1, int y1, int radius, int *x, int *y) {
+    Sint64 dx = x1 - x0, dy = y1 - y0;
+    Sint64 length = (Sint64)isqrt64((Uint64)((dx * dx + dy * dy) * DISTFIELD_ONE * DISTFIELD_ONE));
+    int clearance = radius * DISTFIELD_ONE;
+    int px = x0 * DISTFIELD_ONE, py = y0 * DISTFIELD_ONE;
+    int lastX = px, lastY = py;
+    int previous = distanceFixed(field, px, py) - clearance;
+    int escaping = previous < 0;
+    Sint64 t = 0;
+
+    for (int step = 0; step < MARCH_MAX_STEPS; step++) {
+        int free = distanceFixed(field, px, py) - clearance;
+        if (free < 0 && (!escaping || (step > 0 && free <= previous))) break;
+        if (free >= 0) escaping = 0;
+        lastX = px;
+        lastY = py;
+        if (t >= length) {
+            *x = x1;
+            *y = y1;
+            return 0;
+        }
+        previous = free;
+        t += free > DISTFIELD_ONE / 2 ? free : DISTFIELD_ONE / 2;
+        if (t > length) t = length;
+        pointAt(x0, y0, dx, dy, t, length, &px, &py);
+    }
+    // Contact (or too many steps grazing a wall: taken as blocked)
+    *x = floorDiv(lastX, DISTFIELD_ONE);
+    *y = floorDiv(lastY, DISTFIELD_ONE);
+    return 1;
+}
+
+int fieldRaycast(const DistField *field, int x0, int y0, int x1, int y1, int *hitX, int *hitY) {
+    return march(field, x0, y0, x1, y1, 0, hitX, hitY);
+}
+
+int fieldSweepCircle(const DistField *field, int x0, int y0, int x1, int y1, int radius, int *x, int *y) {
+    return march(field, x0, y0, x1, y1, radius, x, y);
+}
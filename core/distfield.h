@@ -0,0 +1,65 @@
+#ifndef DISTFIELD_H
+#define DISTFIELD_H
+
+#include <SDL/SDL.h>
+#include "tilemap.h"
+
+// Signed distance field of a level's walls.
+//
+// Built once when the level loads, from a collision mask or from the solid
+// tiles, so geometry queries never read a surface: the field holds, for the
+// center of every cell, the distance to the nearest wall (negative inside
+// the walls). Distance, ray and swept circle queries then take a few
+// lookups each, whatever the shape of the walls.
+//
+// The transform is the exact Euclidean one, in linear time (Felzenszwalb and
+// Huttenlocher: a lower envelope of parabolas per column, then per row).
+// Distances are kept as 16-bit fixed point (1/DISTFIELD_ONE pixel), 2 bytes
+// per cell. A cell's value is the distance between cell centers minus half
+// a diagonal, so it never exceeds the true distance to the wall: queries are
+// exact to within a cell, and conservative (rays do not tunnel into walls).
+//
+// Everything is integer arithmetic: the same level gives the same answers on
+// every platform, so the game logic can use it (replays stay in sync).
+
+#define DISTFIELD_SHIFT 4
+#define DISTFIELD_ONE (1 << DISTFIELD_SHIFT)   // Fixed point of a pixel
+#define DISTFIELD_MAX 32767                   // About 2047 pixels
+
+typedef struct {
+    Sint16 *dist;            // cols * rows, 1/DISTFIELD_ONE pixel
+    int cols, rows;
+    int cellSize;            // Pixels per cell side
+    int width, height;       // Covered level, in pixels
+} DistField;
+
+// From a grid of cols * rows cells (one byte each, not 0 = wall).
+// -1 if out of memory.
+int buildDistField(DistField *field, const Uint8 *walls, int cols, int rows, int cellSize);
+// From a collision mask the size of the level: a cell is a wall if any of
+// its pixels is opaque (alpha >= 128, or not the color key), as for the nav
+// grid. -1 if the mask cannot be read.
+int buildMaskDistField(DistField *field, SDL_Surface *mask, int cellSize);
+// From the solid tiles of a level (cellSize divides the tile size best)
+int buildTileDistField(DistField *field, const TileMap *map, int cellSize);
+void freeDistField(DistField *field);
+
+// Distance from a level point to the nearest wall, in 1/DISTFIELD_ONE pixel
+// (bilinear between cell centers; negative inside a wall). Outside the field
+// the nearest border cell is used.
+int fieldDistance(const DistField *field, int x, int y);
+
+// Direction away from the nearest wall (not normalized, 0 0 where the field is flat)
+void fieldNormal(const DistField *field, int x, int y, int *nx, int *ny);
+
+// March from (x0, y0) toward (x1, y1). Returns 1 and the last point before
+// the wall in hitX, hitY, or 0 if the segment is clear.
+int fieldRaycast(const DistField *field, int x0, int y0, int x1, int y1, int *hitX, int *hitY);
+
+// Move a circle of the given radius from (x0, y0) toward (x1, y1). Returns 1
+// if it hits a wall on the way, and in x, y the last position where it does
+// not overlap one (x1, y1 when it is free). A circle resting on a wall can
+// slide along it or leave it.
+int fieldSweepCircle(const DistField *field, int x0, int y0, int x1, int y1, int radius, int *x, int *y);
+
+#endif
@@ -0,0 +1,37 @@
+#include "fileio.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+int writeAll(int fd, const void *data, size_t size) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    while (size > 0) {
+        ssize_t n = write(fd, bytes, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        bytes += n;
+        size -= n;
+    }
+    return 0;
+}
+
+// The rename itself is only durable once the folder is synced
+void syncFolder(const char *path) {
+    char folder[256];
+    snprintf(folder, sizeof(folder), "%s", path);
+    char *slash = strrchr(folder, '/');
+    if (slash) {
+        *slash = '\0';
+    } else {
+        strcpy(folder, ".");
+    }
+    int fd = open(folder[0] ? folder : "/", O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
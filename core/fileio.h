@@ -0,0 +1,16 @@
+#ifndef FILEIO_H
+#define FILEIO_H
+
+#include <stddef.h>
+
+// Helpers for the files saved by replacing them: write <path>.tmp, fsync it,
+// rename it over <path>, then syncFolder(path) so the rename itself survives
+// a crash.
+
+// write() until everything is written. -1 on error.
+int writeAll(int fd, const void *data, size_t size);
+
+// fsync the folder that contains path (after creating or renaming a file in it)
+void syncFolder(const char *path);
+
+#endif
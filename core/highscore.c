@@ -0,0 +1,289 @@
+#include "highscore.h"
+#include "fileio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static HighscoreStore sharedStore;
+static int sharedStoreReady = 0;
+
+static const char *modeNames[HIGHSCORE_MODES] = {"Solo", "Two players", "Simon"};
+
+#define TABLES_SIZE (HIGHSCORE_MODES * HIGHSCORE_TOP * sizeof(HighscoreEntry))
+
+HighscoreStore *defaultHighscores(void) {
+    if (!sharedStoreReady) {
+        openHighscores(&sharedStore, HIGHSCORE_PATH);
+        sharedStoreReady = 1;
+    }
+    return &sharedStore;
+}
+
+const char *highscoreModeName(HighscoreMode mode) {
+    return (mode >= 0 && mode < HIGHSCORE_MODES) ? modeNames[mode] : "?";
+}
+
+static void unmapHistory(HighscoreStore *store) {
+    if (store->logBase) munmap((void *)store->logBase, store->logSize);
+    store->logBase = NULL;
+    store->logSize = 0;
+    store->history = NULL;
+    store->historyCount = 0;
+}
+
+static void unmapStore(HighscoreStore *store) {
+    if (store->base) munmap((void *)store->base, store->size);
+    store->base = NULL;
+    store->size = 0;
+    store->header = NULL;
+    store->tables = NULL;
+    unmapHistory(store);
+}
+
+// Map a whole file read-only. *base stays NULL for a missing or empty file.
+static int mapFile(const char *path, const Uint8 **base, size_t *size) {
+    *base = NULL;
+    *size = 0;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return errno == ENOENT ? 0 : -1;  // No score yet
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return -1;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return -1;
+    *base = (const Uint8 *)data;
+    *size = st.st_size;
+    return 0;
+}
+
+static int validLogHeader(const HighscoreLogHeader *header) {
+    return memcmp(header->magic, HIGHSCORE_LOG_MAGIC, sizeof(HIGHSCORE_LOG_MAGIC)) == 0 &&
+           header->byteOrder == HIGHSCORE_BYTE_ORDER && header->version == HIGHSCORE_VERSION &&
+           header->recordSize == sizeof(HighscoreEntry);
+}
+
+// The history on its own: a missing or invalid log only leaves it empty
+// (appendHistory() starts a new one), the tables stay usable
+static void mapHistory(HighscoreStore *store) {
+    if (mapFile(store->logPath, &store->logBase, &store->logSize) < 0 || !store->logBase) return;
+    if (store->logSize < sizeof(HighscoreLogHeader) ||
+        !validLogHeader((const HighscoreLogHeader *)store->logBase)) {
+        printf("Invalid highscore history %s, it will be started again\n", store->logPath);
+        unmapHistory(store);
+        return;
+    }
+    store->history = (const HighscoreEntry *)(store->logBase + sizeof(HighscoreLogHeader));
+    store->historyCount = (Uint32)((store->logSize - sizeof(HighscoreLogHeader)) / sizeof(HighscoreEntry));
+}
+
+static int mapStore(HighscoreStore *store) {
+    unmapStore(store);
+    mapHistory(store);
+
+    if (mapFile(store->path, &store->base, &store->size) < 0) return -1;
+    if (store->base) {
+        const HighscoreHeader *header = (const HighscoreHeader *)store->base;
+        int valid = store->size >= sizeof(HighscoreHeader) + TABLES_SIZE &&
+                    memcmp(header->magic, HIGHSCORE_MAGIC, sizeof(HIGHSCORE_MAGIC)) == 0 &&
+                    header->byteOrder == HIGHSCORE_BYTE_ORDER && header->version == HIGHSCORE_VERSION &&
+                    header->recordSize == sizeof(HighscoreEntry);
+        for (int m = 0; valid && m < HIGHSCORE_MODES; m++) {
+            if (header->topCount[m] > HIGHSCORE_TOP) valid = 0;
+        }
+        if (!valid) {
+            munmap((void *)store->base, store->size);
+            store->base = NULL;
+            store->size = 0;
+            return -1;
+        }
+        store->header = header;
+        store->tables = (const HighscoreEntry *)(store->base + sizeof(HighscoreHeader));
+    }
+    return 0;
+}
+
+int openHighscores(HighscoreStore *store, const char *path) {
+    memset(store, 0, sizeof(*store));
+    snprintf(store->path, sizeof(store->path), "%s", path);
+    snprintf(store->logPath, sizeof(store->logPath), "%s.history", path);
+    if (mapStore(store) < 0) {
+        printf("Invalid highscore file %s, it will be replaced\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+void closeHighscores(HighscoreStore *store) {
+    unmapStore(store);
+}
+
+int highscoreCount(const HighscoreStore *store, HighscoreMode mode) {
+    if (!store->header || mode < 0 || mode >= HIGHSCORE_MODES) return 0;
+    return (int)store->header->topCount[mode];
+}
+
+const HighscoreEntry *highscoreAt(const HighscoreStore *store, HighscoreMode mode, int rank) {
+    if (rank < 0 || rank >= highscoreCount(store, mode)) return NULL;
+    return &store->tables[mode * HIGHSCORE_TOP + rank];
+}
+
+Uint32 highscoresPlayed(const HighscoreStore *store, HighscoreMode mode) {
+    if (!store->header || mode < 0 || mode >= HIGHSCORE_MODES) return 0;
+    return store->header->played[mode];
+}
+
+Uint32 highscoreHistoryCount(const HighscoreStore *store) {
+    return store->historyCount;
+}
+
+// First rank whose score is lower (the table is sorted best first)
+static int findRank(const HighscoreEntry *table, int count, int score) {
+    int low = 0, high = count;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (table[mid].score >= score) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+int highscoreRank(const HighscoreStore *store, HighscoreMode mode, int score) {
+    if (mode < 0 || mode >= HIGHSCORE_MODES) return -1;
+    int count = highscoreCount(store, mode);
+    int rank = count ? findRank(&store->tables[mode * HIGHSCORE_TOP], count, score) : 0;
+    return rank < HIGHSCORE_TOP ? rank : -1;
+}
+
+// Append one record to the history: a single write at the end of the last
+// whole record, then a sync. A missing or invalid log is started anew.
+static int appendHistory(HighscoreStore *store, const HighscoreEntry *entry) {
+    int fd = open(store->logPath, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    HighscoreLogHeader header;
+    off_t end = 0;
+    int created = 0;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return -1;
+    }
+    if ((size_t)st.st_size >= sizeof(header) && pread(fd, &header, sizeof(header), 0) == (ssize_t)sizeof(header) &&
+        validLogHeader(&header)) {
+        // A record cut short by a crash is overwritten
+        end = sizeof(header) + (st.st_size - sizeof(header)) / sizeof(HighscoreEntry) * sizeof(HighscoreEntry);
+    } else {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, HIGHSCORE_LOG_MAGIC, sizeof(HIGHSCORE_LOG_MAGIC));
+        header.byteOrder = HIGHSCORE_BYTE_ORDER;
+        header.version = HIGHSCORE_VERSION;
+        header.recordSize = sizeof(HighscoreEntry);
+        if (ftruncate(fd, 0) < 0 || writeAll(fd, &header, sizeof(header)) < 0) {
+            close(fd);
+            return -1;
+        }
+        end = sizeof(header);
+        created = 1;
+    }
+
+    int failed = pwrite(fd, entry, sizeof(*entry), end) != (ssize_t)sizeof(*entry) || fsync(fd) < 0;
+    if (close(fd) < 0) failed = 1;
+    if (!failed && created) syncFolder(store->logPath);
+    return failed ? -1 : 0;
+}
+
+int addHighscore(HighscoreStore *store, HighscoreMode mode, int score, const char *name) {
+    if (mode < 0 || mode >= HIGHSCORE_MODES) return -2;
+
+    HighscoreEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.score = score;
+    entry.date = (Uint32)time(NULL);
+    entry.mode = (Uint16)mode;
+    if (name) strncpy(entry.name, name, HIGHSCORE_NAME_MAX);
+
+    // New header and tables, from the mapped ones
+    HighscoreHeader header;
+    static HighscoreEntry tables[HIGHSCORE_MODES * HIGHSCORE_TOP];
+    if (store->header) {
+        header = *store->header;
+        memcpy(tables, store->tables, TABLES_SIZE);
+    } else {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, HIGHSCORE_MAGIC, sizeof(HIGHSCORE_MAGIC));
+        header.byteOrder = HIGHSCORE_BYTE_ORDER;
+        header.version = HIGHSCORE_VERSION;
+        header.recordSize = sizeof(HighscoreEntry);
+        memset(tables, 0, TABLES_SIZE);
+    }
+
+    int rank = highscoreRank(store, mode, score);
+    if (rank >= 0) {
+        HighscoreEntry *table = &tables[mode * HIGHSCORE_TOP];
+        int count = (int)header.topCount[mode];
+        int moved = (count < HIGHSCORE_TOP ? count : HIGHSCORE_TOP - 1) - rank;
+        memmove(&table[rank + 1], &table[rank], moved * sizeof(HighscoreEntry));
+        table[rank] = entry;
+        if (count < HIGHSCORE_TOP) header.topCount[mode]++;
+    }
+    header.played[mode]++;
+
+    // The history first: a crash before the tables are replaced only leaves
+    // a score in the history that the tables and counts do not show
+    if (appendHistory(store, &entry) < 0) {
+        printf("Cannot add to the highscore history %s\n", store->logPath);
+        return -2;
+    }
+
+    char tmpPath[sizeof(store->path) + 8];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", store->path);
+    int fd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        printf("Cannot write %s\n", tmpPath);
+        return -2;
+    }
+    int failed = writeAll(fd, &header, sizeof(header)) < 0 ||
+                 writeAll(fd, tables, TABLES_SIZE) < 0 ||
+                 fsync(fd) < 0;
+    if (close(fd) < 0) failed = 1;
+    if (failed || rename(tmpPath, store->path) < 0) {
+        printf("Cannot save the highscores to %s\n", store->path);
+        unlink(tmpPath);
+        return -2;
+    }
+    syncFolder(store->path);
+
+    if (mapStore(store) < 0) {
+        printf("Cannot map the highscores %s\n", store->path);
+    }
+    return rank;
+}
+
+void printHighscores(const HighscoreStore *store) {
+    for (int m = 0; m < HIGHSCORE_MODES; m++) {
+        printf("%s (%u played)\n", highscoreModeName(m), highscoresPlayed(store, m));
+        for (int r = 0; r < highscoreCount(store, m); r++) {
+            const HighscoreEntry *e = highscoreAt(store, m, r);
+            printf("  %2d. %-*.*s %8d\n", r + 1, HIGHSCORE_NAME_MAX, HIGHSCORE_NAME_MAX, e->name, e->score);
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef HIGHSCORE_H
+#define HIGHSCORE_H
+
+#include <SDL/SDL.h>
+#include <stddef.h>
+
+// Highscores of every game mode, kept in two binary files.
+//
+// <path>: HighscoreHeader and the top tables (HIGHSCORE_TOP records per
+// mode, best first, unused records zeroed). It is small and never modified
+// in place: addHighscore() writes the new version to <path>.tmp, syncs it
+// and renames it over the old one, so a crash leaves either the old file or
+// the new one.
+//
+// <path>.history: HighscoreLogHeader, then every score ever added, one
+// fixed-size record each. It is only appended to (one write and one sync per
+// score), so adding a score costs the same however long the history grows.
+// A record cut short by a crash is ignored; a log with a bad header is
+// started again, without touching the top tables.
+//
+// Both files are mapped read-only; the highscore screen only touches the
+// first page of the first one.
+
+#define HIGHSCORE_PATH "../highscores.dat"  // From a module folder
+#define HIGHSCORE_MAGIC "EOTHISC"
+#define HIGHSCORE_VERSION 2
+#define HIGHSCORE_LOG_MAGIC "EOTHLOG"
+#define HIGHSCORE_BYTE_ORDER 0x01020304
+#define HIGHSCORE_TOP 10
+#define HIGHSCORE_NAME_MAX 16
+
+typedef enum {
+    HIGHSCORE_SOLO,     // Gameplay, one player
+    HIGHSCORE_DUO,      // Gameplay, two players
+    HIGHSCORE_SIMON,    // Puzzle, levels completed
+    HIGHSCORE_MODES
+} HighscoreMode;
+
+typedef struct {
+    char magic[8];
+    Uint32 byteOrder;                   // HIGHSCORE_BYTE_ORDER as written
+    Uint32 version;
+    Uint32 recordSize;                  // sizeof(HighscoreEntry)
+    Uint32 topCount[HIGHSCORE_MODES];   // Used records of each top table
+    Uint32 played[HIGHSCORE_MODES];     // Scores added per mode
+} HighscoreHeader;
+
+typedef struct {
+    char magic[8];
+    Uint32 byteOrder;
+    Uint32 version;                     // HIGHSCORE_VERSION
+    Uint32 recordSize;
+    Uint32 reserved;
+} HighscoreLogHeader;
+
+typedef struct {
+    Sint32 score;
+    Uint32 date;                        // Seconds since 1970
+    Uint16 mode;                        // HighscoreMode
+    Uint16 reserved;
+    char name[HIGHSCORE_NAME_MAX];      // Not always terminated
+} HighscoreEntry;
+
+typedef struct {
+    const Uint8 *base;                  // NULL when there is no file yet
+    size_t size;
+    const HighscoreHeader *header;
+    const HighscoreEntry *tables;       // HIGHSCORE_MODES * HIGHSCORE_TOP
+    const Uint8 *logBase;               // Mapped history, NULL when empty
+    size_t logSize;
+    const HighscoreEntry *history;
+    Uint32 historyCount;                // Whole records in the history
+    char path[256];
+    char logPath[264];
+} HighscoreStore;
+
+// Store of HIGHSCORE_PATH, mapped on first use
+HighscoreStore *defaultHighscores(void);
+
+// Map the file (a missing file is an empty store). -1 if it is invalid.
+int openHighscores(HighscoreStore *store, const char *path);
+void closeHighscores(HighscoreStore *store);
+
+int highscoreCount(const HighscoreStore *store, HighscoreMode mode);
+// rank 0 is the best score. NULL past highscoreCount().
+const HighscoreEntry *highscoreAt(const HighscoreStore *store, HighscoreMode mode, int rank);
+Uint32 highscoresPlayed(const HighscoreStore *store, HighscoreMode mode);
+Uint32 highscoreHistoryCount(const HighscoreStore *store);
+
+// Rank the score would get (binary search, after equal scores), or -1 if it
+// would not enter the top table
+int highscoreRank(const HighscoreStore *store, HighscoreMode mode, int score);
+
+// Add a score to the history and, if good enough, to the top table. Returns
+// its rank, -1 if it did not enter the table, -2 if the file was not written.
+int addHighscore(HighscoreStore *store, HighscoreMode mode, int score, const char *name);
+
+const char *highscoreModeName(HighscoreMode mode);
+// Print the top tables on the console
+void printHighscores(const HighscoreStore *store);
+
+#endif
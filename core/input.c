@@ -0,0 +1,151 @@
+#include "input.h"
+#include <string.h>
+
+// bindings[key] = (player << 8 | action) + 1, 0 = not bound
+static Uint16 bindings[SDLK_LAST];
+static int bindingsReady = 0;
+
+static InputState sharedInput;
+static int sharedInputReady = 0;
+
+static const char *actionNames[ACTION_COUNT] = {
+    "left", "right", "up", "down", "attack", "confirm", "pause"
+};
+
+static void ensureBindings(void) {
+    if (!bindingsReady) resetBindings();
+}
+
+void bindKey(SDLKey key, int player, Action action) {
+    if (key <= 0 || key >= SDLK_LAST || player < 0 || player >= INPUT_MAX_PLAYERS ||
+        action < 0 || action >= ACTION_COUNT) {
+        return;
+    }
+    ensureBindings();
+    bindings[key] = (Uint16)(((player << 8) | action) + 1);
+}
+
+void unbindKey(SDLKey key) {
+    if (key <= 0 || key >= SDLK_LAST) return;
+    ensureBindings();
+    bindings[key] = 0;
+}
+
+int keyBinding(SDLKey key, int *player, Action *action) {
+    ensureBindings();
+    if (key <= 0 || key >= SDLK_LAST || !bindings[key]) return -1;
+    int value = bindings[key] - 1;
+    if (player) *player = value >> 8;
+    if (action) *action = (Action)(value & 0xFF);
+    return 0;
+}
+
+void resetBindings(void) {
+    memset(bindings, 0, sizeof(bindings));
+    bindingsReady = 1;
+
+    bindKey(SDLK_LEFT, 0, ACTION_LEFT);
+    bindKey(SDLK_RIGHT, 0, ACTION_RIGHT);
+    bindKey(SDLK_UP, 0, ACTION_UP);
+    bindKey(SDLK_DOWN, 0, ACTION_DOWN);
+    bindKey(SDLK_SPACE, 0, ACTION_ATTACK);
+    bindKey(SDLK_RETURN, 0, ACTION_CONFIRM);
+    bindKey(SDLK_ESCAPE, 0, ACTION_PAUSE);
+
+    bindKey(SDLK_a, 1, ACTION_LEFT);
+    bindKey(SDLK_d, 1, ACTION_RIGHT);
+    bindKey(SDLK_w, 1, ACTION_UP);
+    bindKey(SDLK_s, 1, ACTION_DOWN);
+    bindKey(SDLK_f, 1, ACTION_ATTACK);
+}
+
+const char *actionName(Action action) {
+    return (action >= 0 && action < ACTION_COUNT) ? actionNames[action] : "?";
+}
+
+InputState *defaultInput(void) {
+    if (!sharedInputReady) {
+        initInput(&sharedInput);
+        sharedInputReady = 1;
+    }
+    return &sharedInput;
+}
+
+void initInput(InputState *input) {
+    memset(input, 0, sizeof(*input));
+    ensureBindings();
+}
+
+void beginInputFrame(InputState *input) {
+    memset(input->pressed, 0, sizeof(input->pressed));
+    memset(input->released, 0, sizeof(input->released));
+    input->mouseClicks = 0;
+}
+
+static void releaseAllKeys(InputState *input) {
+    memset(input->keys, 0, sizeof(input->keys));
+    memset(input->keysDown, 0, sizeof(input->keysDown));
+    for (int p = 0; p < INPUT_MAX_PLAYERS; p++) {
+        input->released[p] |= input->held[p];
+        input->held[p] = 0;
+    }
+    input->mouseButtons = 0;
+}
+
+int inputEvent(InputState *input, const SDL_Event *event) {
+    switch (event->type) {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP: {
+            SDLKey key = event->key.keysym.sym;
+            if (key <= 0 || key >= SDLK_LAST) return 0;
+            int down = event->type == SDL_KEYDOWN;
+            int changed = input->keys[key] != down;
+            input->keys[key] = (Uint8)down;
+
+            int player;
+            Action action;
+            if (keyBinding(key, &player, &action) < 0) return 0;
+            if (!changed) return 1;  // Key repeat
+
+            // An action stays held while any of its keys is down
+            Uint8 *count = &input->keysDown[player][action];
+            if (down) {
+                if ((*count)++ == 0) {
+                    input->held[player] |= ACTION_BIT(action);
+                    input->pressed[player] |= ACTION_BIT(action);
+                }
+            } else if (*count > 0 && --(*count) == 0) {
+                input->held[player] &= ~ACTION_BIT(action);
+                input->released[player] |= ACTION_BIT(action);
+            }
+            return 1;
+        }
+        case SDL_MOUSEMOTION:
+            input->mouseX = event->motion.x;
+            input->mouseY = event->motion.y;
+            return 0;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP: {
+            Uint8 bit = SDL_BUTTON(event->button.button);
+            input->mouseX = event->button.x;
+            input->mouseY = event->button.y;
+            if (event->type == SDL_MOUSEBUTTONDOWN) {
+                input->mouseButtons |= bit;
+                input->mouseClicks |= bit;
+            } else {
+                input->mouseButtons &= (Uint8)~bit;
+            }
+            return 0;
+        }
+        case SDL_ACTIVEEVENT:
+            // Key releases are not delivered while another window has the focus
+            if ((event->active.state & SDL_APPINPUTFOCUS) && !event->active.gain) {
+                releaseAllKeys(input);
+            }
+            return 0;
+        case SDL_QUIT:
+            input->quit = 1;
+            return 0;
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <SDL/SDL.h>
+
+// Input snapshot: the event queue is drained once per frame into the state
+// of every key and, through a remappable binding table, into a bit mask of
+// actions per player. Game code reads the masks in constant time instead of
+// walking the events.
+//
+//   beginInputFrame(input);
+//   while (SDL_PollEvent(&event)) inputEvent(input, &event);
+//   if (actionPressed(input, 0, ACTION_ATTACK)) ...
+//
+// Every action is tracked on its own, so releasing one of two keys bound to
+// opposite actions leaves the other one held. Keys are released when the
+// window loses the keyboard focus.
+
+#define INPUT_MAX_PLAYERS 2
+
+typedef enum {
+    ACTION_LEFT,
+    ACTION_RIGHT,
+    ACTION_UP,
+    ACTION_DOWN,
+    ACTION_ATTACK,
+    ACTION_CONFIRM,
+    ACTION_PAUSE,
+    ACTION_COUNT
+} Action;
+
+typedef Uint32 ActionMask;
+#define ACTION_BIT(action) ((ActionMask)1 << (action))
+
+typedef struct {
+    Uint8 keys[SDLK_LAST];                  // 1 while the key is down
+    Uint8 keysDown[INPUT_MAX_PLAYERS][ACTION_COUNT];  // Bound keys down per action
+    ActionMask held[INPUT_MAX_PLAYERS];
+    ActionMask pressed[INPUT_MAX_PLAYERS];  // Went down during this frame
+    ActionMask released[INPUT_MAX_PLAYERS]; // Went up during this frame
+    int mouseX, mouseY;
+    Uint8 mouseButtons;                     // SDL_BUTTON(n) bits held
+    Uint8 mouseClicks;                      // SDL_BUTTON(n) bits pressed this frame
+    int quit;                               // SDL_QUIT was received
+} InputState;
+
+// Snapshot filled by the scene manager (and the modules' own loops)
+InputState *defaultInput(void);
+
+void initInput(InputState *input);
+// Clear the per-frame masks before draining the queue
+void beginInputFrame(InputState *input);
+// Apply one event. Returns 1 if it was a key bound to an action.
+int inputEvent(InputState *input, const SDL_Event *event);
+
+static inline int actionHeld(const InputState *input, int player, Action action) {
+    return (input->held[player] & ACTION_BIT(action)) != 0;
+}
+static inline int actionPressed(const InputState *input, int player, Action action) {
+    return (input->pressed[player] & ACTION_BIT(action)) != 0;
+}
+static inline int actionReleased(const InputState *input, int player, Action action) {
+    return (input->released[player] & ACTION_BIT(action)) != 0;
+}
+
+// Binding table: each key drives at most one action of one player.
+// Menu actions (UP, DOWN, CONFIRM, PAUSE) are bound to player 0.
+void bindKey(SDLKey key, int player, Action action);
+void unbindKey(SDLKey key);
+// Returns 0 and fills player/action if the key is bound
+int keyBinding(SDLKey key, int *player, Action *action);
+// Arrows + space for player 1, A/D/F for player 2, Escape/Return for menus
+void resetBindings(void);
+
+const char *actionName(Action action);
+
+#endif
@@ -0,0 +1,114 @@
+#include "jobs.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+static JobPool sharedPool;
+static int sharedPoolStarted = 0;
+
+static int workerMain(void *arg) {
+    JobPool *pool = (JobPool *)arg;
+    Uint32 seen = 0;
+
+    SDL_mutexP(pool->lock);
+    while (1) {
+        while (pool->batch == seen && !pool->stopping) {
+            SDL_CondWait(pool->start, pool->lock);
+        }
+        if (pool->stopping) break;
+        seen = pool->batch;
+
+        // Take indexes until the batch is handed out
+        while (pool->next < pool->count) {
+            int index = pool->next++;
+            SDL_mutexV(pool->lock);
+            pool->func(pool->data, index);
+            SDL_mutexP(pool->lock);
+            if (++pool->finished == pool->count) {
+                SDL_CondSignal(pool->done);
+            }
+        }
+    }
+    SDL_mutexV(pool->lock);
+    return 0;
+}
+
+static int cpuCount(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+int initJobPool(JobPool *pool, int workers) {
+    memset(pool, 0, sizeof(*pool));
+    if (workers <= 0) workers = cpuCount();
+    if (workers > JOBS_MAX_WORKERS) workers = JOBS_MAX_WORKERS;
+
+    pool->lock = SDL_CreateMutex();
+    pool->start = SDL_CreateCond();
+    pool->done = SDL_CreateCond();
+    if (!pool->lock || !pool->start || !pool->done) {
+        printf("Job pool init failed: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    // A single core gains nothing from threads: run the jobs inline
+    if (workers == 1) return 0;
+
+    for (int i = 0; i < workers; i++) {
+        pool->workers[i] = SDL_CreateThread(workerMain, pool);
+        if (!pool->workers[i]) {
+            printf("Cannot start job thread: %s\n", SDL_GetError());
+            break;
+        }
+        pool->workerCount++;
+    }
+    return 0;
+}
+
+void closeJobPool(JobPool *pool) {
+    if (!pool->lock) return;
+
+    SDL_mutexP(pool->lock);
+    pool->stopping = 1;
+    SDL_CondBroadcast(pool->start);
+    SDL_mutexV(pool->lock);
+
+    for (int i = 0; i < pool->workerCount; i++) {
+        SDL_WaitThread(pool->workers[i], NULL);
+    }
+    SDL_DestroyCond(pool->done);
+    SDL_DestroyCond(pool->start);
+    SDL_DestroyMutex(pool->lock);
+    memset(pool, 0, sizeof(*pool));
+
+    if (pool == &sharedPool) sharedPoolStarted = 0;
+}
+
+JobPool *defaultJobPool(void) {
+    if (!sharedPoolStarted) {
+        initJobPool(&sharedPool, 0);
+        sharedPoolStarted = 1;
+    }
+    return &sharedPool;
+}
+
+void runJobs(JobPool *pool, JobFunc func, void *data, int count) {
+    if (count <= 0) return;
+    if (pool->workerCount == 0) {
+        for (int i = 0; i < count; i++) func(data, i);
+        return;
+    }
+
+    SDL_mutexP(pool->lock);
+    pool->func = func;
+    pool->data = data;
+    pool->count = count;
+    pool->next = 0;
+    pool->finished = 0;
+    pool->batch++;
+    SDL_CondBroadcast(pool->start);
+    while (pool->finished < pool->count) {
+        SDL_CondWait(pool->done, pool->lock);
+    }
+    SDL_mutexV(pool->lock);
+}
@@ -0,0 +1,41 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <SDL/SDL.h>
+#include <SDL/SDL_thread.h>
+
+#define JOBS_MAX_WORKERS 8
+
+// Runs job(data, 0) ... job(data, count - 1) on the workers
+typedef void (*JobFunc)(void *data, int index);
+
+// Pool of threads for work that must finish within the frame (drawing the
+// views of a split screen ...). runJobs() hands out the indexes and returns
+// when all of them are done. The workers sleep between batches.
+typedef struct {
+    SDL_Thread *workers[JOBS_MAX_WORKERS];
+    int workerCount;
+    SDL_mutex *lock;
+    SDL_cond *start;       // A batch was posted, or shutdown
+    SDL_cond *done;        // The last job of the batch finished
+    JobFunc func;
+    void *data;
+    int count;             // Jobs in the batch
+    int next;              // Next index to hand out
+    int finished;
+    Uint32 batch;          // Incremented for every batch
+    int stopping;
+} JobPool;
+
+// workers = 0: one per CPU core
+int initJobPool(JobPool *pool, int workers);
+void closeJobPool(JobPool *pool);
+
+// Pool shared by the whole program, started on first use
+JobPool *defaultJobPool(void);
+
+// Run count jobs and wait for them. Without workers the jobs run on the
+// calling thread. Not reentrant: a job must not call runJobs.
+void runJobs(JobPool *pool, JobFunc func, void *data, int count);
+
+#endif
@@ -0,0 +1,43 @@
+// Level compiler: builds the binary .lvl files mapped by tilemap.c
+//
+// Usage: levelc level.txt...
+//
+// Each level.txt is compiled to level.lvl beside it. The game also compiles
+// a level whose .lvl is missing or older, so this is only needed to ship
+// the levels already compiled (make levels).
+
+#include "tilemap.h"
+#include <stdio.h>
+#include <string.h>
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        printf("Usage: %s level.txt...\n", argv[0]);
+        return 1;
+    }
+
+    int failed = 0;
+    for (int i = 1; i < argc; i++) {
+        char binaryPath[512];
+        snprintf(binaryPath, sizeof(binaryPath), "%s", argv[i]);
+        char *dot = strrchr(binaryPath, '.');
+        char *slash = strrchr(binaryPath, '/');
+        if (dot && (!slash || dot > slash)) *dot = '\0';
+        strncat(binaryPath, ".lvl", sizeof(binaryPath) - strlen(binaryPath) - 1);
+
+        if (compileTileMap(argv[i], binaryPath) < 0) {
+            failed = 1;
+            continue;
+        }
+        TileMap map;
+        if (loadTileMap(&map, binaryPath) < 0) {
+            failed = 1;
+            continue;
+        }
+        printf("%s: %dx%d tiles of %d pixels, %u tile types, %u objects, %zu bytes\n", binaryPath,
+               map.cols, map.rows, map.tileSize, map.header->typeCount - 1, map.header->objectCount,
+               map.size);
+        freeTileMap(&map);
+    }
+    return failed;
+}
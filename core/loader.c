@@ -0,0 +1,241 @@
+#include "loader.h"
+#include "profiler.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Show the loading screen only if the batch is not done after this long
+#define LOADING_SCREEN_DELAY_MS 100
+
+static AssetLoader sharedLoader;
+static int sharedLoaderStarted = 0;
+
+static void *decodeAsset(LoadJob *job) {
+    if (job->type == RES_FONT) return NULL;
+    return decodeResource(job->key, job->type, 0);
+}
+
+static int workerMain(void *arg) {
+    AssetLoader *loader = (AssetLoader *)arg;
+
+    SDL_mutexP(loader->lock);
+    while (1) {
+        while (!loader->pending && !loader->stopping) {
+            SDL_CondWait(loader->wake, loader->lock);
+        }
+        if (loader->stopping) break;
+
+        LoadJob *job = loader->pending;
+        loader->pending = job->next;
+        if (!loader->pending) loader->pendingTail = NULL;
+        SDL_mutexV(loader->lock);
+
+        // Decode without holding the lock so workers run in parallel
+        Uint32 start = SDL_GetTicks();
+        int zone = PROFILE_BEGIN("decode");
+        job->data = decodeAsset(job);
+        PROFILE_END(zone);
+        job->decodeMs = SDL_GetTicks() - start;
+        if (!job->data) {
+            printf("Failed to load %s: %s\n", job->path, SDL_GetError());
+        }
+
+        SDL_mutexP(loader->lock);
+        job->next = loader->finished;
+        loader->finished = job;
+    }
+    SDL_mutexV(loader->lock);
+    return 0;
+}
+
+static int cpuCount(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+int initLoader(AssetLoader *loader, int workers) {
+    memset(loader, 0, sizeof(*loader));
+    if (workers <= 0) workers = cpuCount();
+    if (workers > LOADER_MAX_WORKERS) workers = LOADER_MAX_WORKERS;
+
+    loader->lock = SDL_CreateMutex();
+    loader->wake = SDL_CreateCond();
+    if (!loader->lock || !loader->wake) {
+        printf("Loader init failed: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    for (int i = 0; i < workers; i++) {
+        loader->workers[i] = SDL_CreateThread(workerMain, loader);
+        if (!loader->workers[i]) {
+            printf("Cannot start loader thread: %s\n", SDL_GetError());
+            break;
+        }
+        loader->workerCount++;
+    }
+    return loader->workerCount > 0 ? 0 : -1;
+}
+
+void closeLoader(AssetLoader *loader) {
+    if (!loader->lock) return;
+
+    // Deliver what is already queued so nothing leaks
+    while (loader->workerCount > 0 && pumpLoader(loader) > 0) {
+        SDL_Delay(1);
+    }
+
+    SDL_mutexP(loader->lock);
+    loader->stopping = 1;
+    SDL_CondBroadcast(loader->wake);
+    SDL_mutexV(loader->lock);
+
+    for (int i = 0; i < loader->workerCount; i++) {
+        SDL_WaitThread(loader->workers[i], NULL);
+    }
+    SDL_DestroyCond(loader->wake);
+    SDL_DestroyMutex(loader->lock);
+    memset(loader, 0, sizeof(*loader));
+
+    if (loader == &sharedLoader) sharedLoaderStarted = 0;
+}
+
+AssetLoader *defaultLoader(void) {
+    if (!sharedLoaderStarted) {
+        initLoader(&sharedLoader, 0);
+        sharedLoaderStarted = 1;
+    }
+    return &sharedLoader;
+}
+
+static void deliverJob(AssetLoader *loader, LoadJob *job, void *data) {
+    if (job->target) *job->target = data;
+    if (job->done) job->done(data, job->udata);
+    loader->completed++;
+    free(job);
+}
+
+void queueAsset(AssetLoader *loader, const char *path, ResourceType type,
+                void **target, LoadCallback done, void *udata) {
+    LoadJob *job = calloc(1, sizeof(LoadJob));
+    if (!job) return;
+    strncpy(job->path, path, RESOURCE_PATH_MAX - 1);
+    job->type = type;
+    job->target = target;
+    job->done = done;
+    job->udata = udata;
+    if (target) *target = NULL;
+
+    if (loader->queued == loader->completed) {
+        // New batch
+        loader->queued = loader->completed = 0;
+        loader->batchStart = SDL_GetTicks();
+        loader->slowestMs = 0;
+    }
+    loader->queued++;
+
+    if (type == RES_FONT || resourceKey(path, job->key) < 0) {
+        printf("Resource not found: %s\n", path);
+        deliverJob(loader, job, NULL);
+        return;
+    }
+
+    // Already in memory: no need to wake a worker
+    void *cached = findCachedResource(job->key, type, 0);
+    if (cached || loader->workerCount == 0) {
+        if (!cached) {
+            job->data = decodeAsset(job);
+            cached = job->data ? addResource(job->key, type, 0, job->data) : NULL;
+        }
+        deliverJob(loader, job, cached);
+        return;
+    }
+
+    SDL_mutexP(loader->lock);
+    if (loader->pendingTail) loader->pendingTail->next = job;
+    else loader->pending = job;
+    loader->pendingTail = job;
+    SDL_CondSignal(loader->wake);
+    SDL_mutexV(loader->lock);
+}
+
+void queueImage(AssetLoader *loader, const char *path, SDL_Surface **target) {
+    queueAsset(loader, path, RES_IMAGE, (void **)target, NULL, NULL);
+}
+
+void queueSprite(AssetLoader *loader, const char *path, SDL_Surface **target) {
+    queueAsset(loader, path, RES_SPRITE, (void **)target, NULL, NULL);
+}
+
+void queueSound(AssetLoader *loader, const char *path, Mix_Chunk **target) {
+    queueAsset(loader, path, RES_SOUND, (void **)target, NULL, NULL);
+}
+
+void queueMusic(AssetLoader *loader, const char *path, Mix_Music **target) {
+    queueAsset(loader, path, RES_MUSIC, (void **)target, NULL, NULL);
+}
+
+int pumpLoader(AssetLoader *loader) {
+    if (loader->workerCount == 0) return 0;
+
+    SDL_mutexP(loader->lock);
+    LoadJob *job = loader->finished;
+    loader->finished = NULL;
+    SDL_mutexV(loader->lock);
+
+    while (job) {
+        LoadJob *next = job->next;
+        if (job->decodeMs > loader->slowestMs) loader->slowestMs = job->decodeMs;
+        void *data = job->data ? addResource(job->key, job->type, 0, job->data) : NULL;
+        deliverJob(loader, job, data);
+        job = next;
+    }
+    return loader->queued - loader->completed;
+}
+
+float loaderProgress(AssetLoader *loader) {
+    if (loader->queued == 0) return 1.0f;
+    return (float)loader->completed / loader->queued;
+}
+
+int loaderBusy(AssetLoader *loader) {
+    return loader->queued != loader->completed;
+}
+
+void drawLoadingScreen(SDL_Surface *screen, float progress) {
+    SDL_Rect frame, bar;
+
+    frame.w = screen->w / 2;
+    frame.h = 24;
+    frame.x = (screen->w - frame.w) / 2;
+    frame.y = screen->h - screen->h / 4;
+
+    // White border, black inside, then the filled part
+    bar.x = frame.x + 3;
+    bar.y = frame.y + 3;
+    bar.w = frame.w - 6;
+    bar.h = frame.h - 6;
+
+    SDL_FillRect(screen, NULL, SDL_MapRGB(screen->format, 0, 0, 0));
+    SDL_FillRect(screen, &frame, SDL_MapRGB(screen->format, 255, 255, 255));
+    SDL_FillRect(screen, &bar, SDL_MapRGB(screen->format, 0, 0, 0));
+    bar.w = (Uint16)(bar.w * progress);
+    SDL_FillRect(screen, &bar, SDL_MapRGB(screen->format, 200, 160, 40));
+}
+
+void finishLoading(AssetLoader *loader, SDL_Surface *screen) {
+    while (pumpLoader(loader) > 0) {
+        if (screen && SDL_GetTicks() - loader->batchStart > LOADING_SCREEN_DELAY_MS) {
+            drawLoadingScreen(screen, loaderProgress(loader));
+            SDL_Flip(screen);
+            SDL_PumpEvents();  // Keep the window responsive, events stay queued
+        }
+        SDL_Delay(1);
+    }
+    if (loader->queued > 0) {
+        printf("Loaded %d assets in %u ms (slowest %u ms) on %d threads\n",
+               loader->queued, SDL_GetTicks() - loader->batchStart,
+               loader->slowestMs, loader->workerCount);
+    }
+    loader->queued = loader->completed = 0;
+}
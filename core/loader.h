@@ -0,0 +1,74 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <SDL/SDL.h>
+#include <SDL/SDL_thread.h>
+#include <SDL/SDL_mixer.h>
+#include "resources.h"
+
+#define LOADER_MAX_WORKERS 8
+
+// Called on the main thread (from pumpLoader) when an asset is ready.
+// data is NULL if the file could not be loaded.
+typedef void (*LoadCallback)(void *data, void *udata);
+
+typedef struct LoadJob {
+    char path[RESOURCE_PATH_MAX];  // Path as given, for messages
+    char key[RESOURCE_PATH_MAX];   // Cache key
+    ResourceType type;
+    void **target;                 // Receives the asset (can be NULL)
+    LoadCallback done;             // Optional
+    void *udata;
+    void *data;                    // Decoded by a worker
+    Uint32 decodeMs;
+    struct LoadJob *next;
+} LoadJob;
+
+// Decodes images, sounds and music on a pool of worker threads.
+// Decoded assets go into the resource cache, so they are released with
+// releaseResource() like the ones from loadImage()/loadSound().
+// Fonts are not supported (FreeType is not thread safe): use loadFont().
+typedef struct {
+    SDL_Thread *workers[LOADER_MAX_WORKERS];
+    int workerCount;
+    SDL_mutex *lock;
+    SDL_cond *wake;              // Signaled when jobs are queued or on shutdown
+    LoadJob *pending, *pendingTail;
+    LoadJob *finished;           // Decoded, waiting for the main thread
+    int queued;                  // Jobs queued since the last reset
+    int completed;               // Jobs delivered by pumpLoader
+    int stopping;
+    Uint32 batchStart;           // SDL_GetTicks() of the first job of the batch
+    Uint32 slowestMs;            // Longest single decode of the batch
+} AssetLoader;
+
+// Start the workers. workers = 0 uses one per CPU core.
+int initLoader(AssetLoader *loader, int workers);
+void closeLoader(AssetLoader *loader);
+
+// Loader shared by every module, started on first use
+AssetLoader *defaultLoader(void);
+
+// Queue an asset. *target is written on the main thread when it is ready.
+void queueAsset(AssetLoader *loader, const char *path, ResourceType type,
+                void **target, LoadCallback done, void *udata);
+void queueImage(AssetLoader *loader, const char *path, SDL_Surface **target);
+void queueSprite(AssetLoader *loader, const char *path, SDL_Surface **target);  // See loadSprite()
+void queueSound(AssetLoader *loader, const char *path, Mix_Chunk **target);
+void queueMusic(AssetLoader *loader, const char *path, Mix_Music **target);
+
+// Deliver the finished assets (main thread). Returns the number still loading.
+int pumpLoader(AssetLoader *loader);
+
+// 0.0 to 1.0 for the current batch
+float loaderProgress(AssetLoader *loader);
+int loaderBusy(AssetLoader *loader);
+
+// Wait for the whole batch. If screen is not NULL a progress bar is shown
+// when loading takes more than a few frames. Events are left in the queue.
+void finishLoading(AssetLoader *loader, SDL_Surface *screen);
+
+// Draw the loading screen (background + progress bar), without flipping
+void drawLoadingScreen(SDL_Surface *screen, float progress);
+
+#endif
@@ -0,0 +1,242 @@
+#include "memtrack.h"
+#include "mixer.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+typedef struct {
+    void *ptr;           // NULL = free slot
+    MemKind kind;
+    size_t size;
+    const char *module;
+    const char *scene;
+    char file[MEM_SITE_MAX];  // Copied: resources.c passes the asset path
+    int line;
+} MemRecord;
+
+static MemRecord records[MEM_MAX_RECORDS];
+static MemStats modules[MEM_MAX_TAGS];
+static MemStats scenes[MEM_MAX_TAGS];
+static int moduleCount = 0, sceneCount = 0;
+static const char *currentScene = "startup";
+static size_t liveBytes = 0, peakBytes = 0;
+static int lostRecords = 0;
+
+// The loader threads create resources too
+static volatile int memLock = 0;
+#define LOCK() while (__sync_lock_test_and_set(&memLock, 1)) { }
+#define UNLOCK() __sync_lock_release(&memLock)
+
+static const char *kindNames[] = {"surface", "chunk", "music", "font"};
+
+static MemStats *statsFor(MemStats *table, int *count, const char *name) {
+    for (int i = 0; i < *count; i++) {
+        if (strcmp(table[i].name, name) == 0) return &table[i];
+    }
+    if (*count == MEM_MAX_TAGS) return NULL;
+    MemStats *stats = &table[(*count)++];
+    memset(stats, 0, sizeof(*stats));
+    stats->name = name;
+    return stats;
+}
+
+static void addBytes(MemStats *stats, long delta) {
+    if (!stats) return;
+    stats->liveBytes += delta;
+    stats->liveCount += delta >= 0 ? 1 : -1;
+    if (stats->liveBytes > stats->peakBytes) stats->peakBytes = stats->liveBytes;
+
+    if (stats->budget && stats->liveBytes > stats->budget && !stats->overBudget) {
+        printf("Memory budget exceeded for %s: %lu KB used, budget %lu KB\n", stats->name,
+               (unsigned long)(stats->liveBytes / 1024), (unsigned long)(stats->budget / 1024));
+        stats->overBudget = 1;
+    } else if (stats->liveBytes <= stats->budget) {
+        stats->overBudget = 0;
+    }
+}
+
+static size_t sizeOf(void *ptr, MemKind kind) {
+    switch (kind) {
+        case MEM_SURFACE: {
+            SDL_Surface *s = (SDL_Surface *)ptr;
+            // Pixels that point into a mapping (archive) are not ours
+            size_t pixels = (s->flags & SDL_PREALLOC) ? 0 : (size_t)s->pitch * s->h;
+            return sizeof(SDL_Surface) + pixels;
+        }
+        case MEM_CHUNK:
+            return sizeof(Mix_Chunk) + ((Mix_Chunk *)ptr)->alen;
+        case MEM_MUSIC:
+        case MEM_FONT:
+            return 0;  // Opaque, the caller passes the file size
+    }
+    return 0;
+}
+
+static unsigned slotFor(void *ptr) {
+    size_t h = (size_t)ptr;
+    h ^= h >> 17;
+    h *= 0x9E3779B1u;
+    return (unsigned)(h % MEM_MAX_RECORDS);
+}
+
+size_t memFileSize(const char *path) {
+    struct stat st;
+    return (path && stat(path, &st) == 0) ? (size_t)st.st_size : 0;
+}
+
+void memSetScene(const char *scene) {
+    currentScene = scene ? scene : "none";
+}
+
+void memSetBudget(const char *scene, size_t budget) {
+    LOCK();
+    MemStats *stats = statsFor(scenes, &sceneCount, scene);
+    if (stats) stats->budget = budget;
+    UNLOCK();
+}
+
+void *memTrack(void *ptr, MemKind kind, size_t size, const char *module, const char *file, int line) {
+    if (!ptr) return NULL;
+    if (size == 0) size = sizeOf(ptr, kind);
+
+    LOCK();
+    unsigned slot = slotFor(ptr);
+    for (int probe = 0; probe < MEM_MAX_RECORDS; probe++) {
+        MemRecord *rec = &records[(slot + probe) % MEM_MAX_RECORDS];
+        if (rec->ptr == NULL || rec->ptr == ptr) {
+            if (rec->ptr == ptr) {
+                // Already tracked (cache entry created by a tracked module)
+                UNLOCK();
+                return ptr;
+            }
+            rec->ptr = ptr;
+            rec->kind = kind;
+            rec->size = size;
+            rec->module = module;
+            rec->scene = currentScene;
+            // Keep the end of long paths, it is the part that tells files apart
+            size_t len = strlen(file);
+            const char *tail = len >= MEM_SITE_MAX ? file + len - (MEM_SITE_MAX - 1) : file;
+            strcpy(rec->file, tail);
+            rec->line = line;
+
+            liveBytes += size;
+            if (liveBytes > peakBytes) peakBytes = liveBytes;
+            addBytes(statsFor(modules, &moduleCount, module), (long)size);
+            addBytes(statsFor(scenes, &sceneCount, currentScene), (long)size);
+            UNLOCK();
+            return ptr;
+        }
+    }
+    lostRecords++;
+    UNLOCK();
+    return ptr;
+}
+
+void memUntrack(void *ptr) {
+    if (!ptr) return;
+
+    LOCK();
+    unsigned slot = slotFor(ptr);
+    for (int probe = 0; probe < MEM_MAX_RECORDS; probe++) {
+        unsigned index = (slot + probe) % MEM_MAX_RECORDS;
+        MemRecord *rec = &records[index];
+        if (rec->ptr == NULL) break;
+        if (rec->ptr != ptr) continue;
+
+        liveBytes -= rec->size;
+        addBytes(statsFor(modules, &moduleCount, rec->module), -(long)rec->size);
+        addBytes(statsFor(scenes, &sceneCount, rec->scene), -(long)rec->size);
+
+        // Move the following records of the probe chain back into the hole
+        unsigned hole = index;
+        rec->ptr = NULL;
+        for (unsigned next = (hole + 1) % MEM_MAX_RECORDS; records[next].ptr; next = (next + 1) % MEM_MAX_RECORDS) {
+            unsigned home = slotFor(records[next].ptr);
+            int movable = (next > hole) ? (home <= hole || home > next) : (home <= hole && home > next);
+            if (movable) {
+                records[hole] = records[next];
+                records[next].ptr = NULL;
+                hole = next;
+            }
+        }
+        break;
+    }
+    UNLOCK();
+}
+
+void memFreeSurface(SDL_Surface *surface) {
+    memUntrack(surface);
+    SDL_FreeSurface(surface);
+}
+
+void memFreeChunk(Mix_Chunk *chunk) {
+    stopChunkSounds(chunk);  // Like Mix_FreeChunk does for its channels
+    memUntrack(chunk);
+    Mix_FreeChunk(chunk);
+}
+
+void memFreeMusic(Mix_Music *music) {
+    memUntrack(music);
+    Mix_FreeMusic(music);
+}
+
+void memCloseFont(TTF_Font *font) {
+    memUntrack(font);
+    TTF_CloseFont(font);
+}
+
+size_t memLiveBytes(void) {
+    return liveBytes;
+}
+
+size_t memPeakBytes(void) {
+    return peakBytes;
+}
+
+const MemStats *memSceneStats(const char *scene) {
+    for (int i = 0; i < sceneCount; i++) {
+        if (strcmp(scenes[i].name, scene) == 0) return &scenes[i];
+    }
+    return NULL;
+}
+
+static void printTable(const char *title, MemStats *table, int count) {
+    printf("  %-14s %10s %10s %6s %10s\n", title, "live KB", "peak KB", "count", "budget KB");
+    for (int i = 0; i < count; i++) {
+        MemStats *s = &table[i];
+        printf("  %-14s %10lu %10lu %6d %10lu%s\n", s->name,
+               (unsigned long)(s->liveBytes / 1024), (unsigned long)(s->peakBytes / 1024),
+               s->liveCount, (unsigned long)(s->budget / 1024),
+               s->budget && s->peakBytes > s->budget ? "  OVER" : "");
+    }
+}
+
+void memReport(void) {
+    LOCK();
+    printf("Tracked resources: %lu KB live, %lu KB peak\n",
+           (unsigned long)(liveBytes / 1024), (unsigned long)(peakBytes / 1024));
+    printTable("module", modules, moduleCount);
+    printTable("scene", scenes, sceneCount);
+    if (lostRecords) {
+        printf("  %d resources were not tracked (table full)\n", lostRecords);
+    }
+    UNLOCK();
+}
+
+int memReportLeaks(void) {
+    int leaks = 0;
+    LOCK();
+    for (int i = 0; i < MEM_MAX_RECORDS; i++) {
+        MemRecord *rec = &records[i];
+        if (!rec->ptr) continue;
+        if (leaks == 0) printf("Leaked resources:\n");
+        printf("  %-7s %8lu bytes  %s", kindNames[rec->kind], (unsigned long)rec->size, rec->file);
+        if (rec->line) printf(":%d", rec->line);
+        printf("  (module %s, scene %s)\n", rec->module, rec->scene);
+        leaks++;
+    }
+    if (leaks == 0) printf("No leaked resources\n");
+    UNLOCK();
+    return leaks;
+}
@@ -0,0 +1,103 @@
+#ifndef MEMTRACK_H
+#define MEMTRACK_H
+
+// Accounting of SDL resources (surfaces, chunks, music, fonts).
+//
+// Every tracked resource is tagged with the module that created it, the
+// scene that was running and the file:line of the call. memReport() prints
+// live and peak bytes per module and per scene, memReportLeaks() lists what
+// is still alive at shutdown.
+//
+// A module opts in by defining MEM_MODULE and including this header after
+// its SDL headers: the SDL creation and free functions are then replaced by
+// tracking versions (see the end of this file). Assets of the resource cache
+// are tracked by resources.c.
+
+#include <SDL/SDL.h>
+#include <SDL/SDL_image.h>
+#include <SDL/SDL_mixer.h>
+#include <SDL/SDL_ttf.h>
+#include <stddef.h>
+
+#define MEM_MAX_RECORDS 4096   // Live resources tracked at the same time
+#define MEM_MAX_TAGS 32        // Distinct modules / scenes
+#define MEM_SITE_MAX 64        // Characters kept of the file of a tracked call
+
+typedef enum {
+    MEM_SURFACE,
+    MEM_CHUNK,
+    MEM_MUSIC,
+    MEM_FONT
+} MemKind;
+
+typedef struct {
+    const char *name;
+    size_t liveBytes;
+    size_t peakBytes;
+    int liveCount;
+    size_t budget;       // 0 = no budget
+    int overBudget;      // Warning already printed
+} MemStats;
+
+// Scene that new resources are charged to (set by the scene manager)
+void memSetScene(const char *scene);
+// Warn when the resources of a scene go over budget bytes (0 = no budget)
+void memSetBudget(const char *scene, size_t budget);
+
+// Register / forget a resource. size 0 = computed from the object.
+void *memTrack(void *ptr, MemKind kind, size_t size, const char *module, const char *file, int line);
+void memUntrack(void *ptr);
+
+size_t memLiveBytes(void);
+size_t memPeakBytes(void);
+const MemStats *memSceneStats(const char *scene);
+
+// Live and peak bytes per module and per scene
+void memReport(void);
+// List the resources still alive, returns how many
+int memReportLeaks(void);
+
+// Tracking versions of the SDL functions (used through the macros below)
+void memFreeSurface(SDL_Surface *surface);
+void memFreeChunk(Mix_Chunk *chunk);
+void memFreeMusic(Mix_Music *music);
+void memCloseFont(TTF_Font *font);
+size_t memFileSize(const char *path);
+
+#ifdef MEM_MODULE
+#define MEM_WRAP_SDL
+#else
+#define MEM_MODULE "core"
+#endif
+
+#define MEM_TRACK(ptr, kind, size) memTrack((ptr), (kind), (size), MEM_MODULE, __FILE__, __LINE__)
+// For objects built by hand (generated sounds ...)
+#define TRACK_CHUNK(chunk) ((Mix_Chunk *)MEM_TRACK(chunk, MEM_CHUNK, 0))
+#define TRACK_SURFACE(surface) ((SDL_Surface *)MEM_TRACK(surface, MEM_SURFACE, 0))
+
+#ifdef MEM_WRAP_SDL
+#undef Mix_LoadWAV
+#define Mix_LoadWAV(file) ((Mix_Chunk *)MEM_TRACK(Mix_LoadWAV_RW(SDL_RWFromFile(file, "rb"), 1), MEM_CHUNK, 0))
+#define IMG_Load(file) ((SDL_Surface *)MEM_TRACK(IMG_Load(file), MEM_SURFACE, 0))
+#define SDL_CreateRGBSurface(flags, w, h, d, r, g, b, a) \
+    ((SDL_Surface *)MEM_TRACK(SDL_CreateRGBSurface(flags, w, h, d, r, g, b, a), MEM_SURFACE, 0))
+#define SDL_DisplayFormat(s) ((SDL_Surface *)MEM_TRACK(SDL_DisplayFormat(s), MEM_SURFACE, 0))
+#define SDL_DisplayFormatAlpha(s) ((SDL_Surface *)MEM_TRACK(SDL_DisplayFormatAlpha(s), MEM_SURFACE, 0))
+#define TTF_RenderText_Solid(f, t, c) ((SDL_Surface *)MEM_TRACK(TTF_RenderText_Solid(f, t, c), MEM_SURFACE, 0))
+#define TTF_RenderText_Blended(f, t, c) ((SDL_Surface *)MEM_TRACK(TTF_RenderText_Blended(f, t, c), MEM_SURFACE, 0))
+#define Mix_LoadMUS(file) ((Mix_Music *)MEM_TRACK(Mix_LoadMUS(file), MEM_MUSIC, memFileSize(file)))
+#define TTF_OpenFont(file, size) ((TTF_Font *)MEM_TRACK(TTF_OpenFont(file, size), MEM_FONT, memFileSize(file)))
+#ifdef _SDL_rotozoom_h
+#define rotozoomSurface(s, a, z, sm) ((SDL_Surface *)MEM_TRACK(rotozoomSurface(s, a, z, sm), MEM_SURFACE, 0))
+#define zoomSurface(s, zx, zy, sm) ((SDL_Surface *)MEM_TRACK(zoomSurface(s, zx, zy, sm), MEM_SURFACE, 0))
+#endif
+#ifdef BLIT_H
+#define makeSprite(s) TRACK_SURFACE(makeSprite(s))
+#endif
+#define SDL_FreeSurface(s) memFreeSurface(s)
+#define Mix_FreeChunk(c) memFreeChunk(c)
+#define Mix_FreeMusic(m) memFreeMusic(m)
+#define TTF_CloseFont(f) memCloseFont(f)
+#endif
+
+#endif
@@ -0,0 +1,315 @@
+#include "mixer.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MIXER_X86
+#include <immintrin.h>
+#endif
+
+// Samples mixed per pass through the voices (the stream is cut in blocks)
+#define MIXER_BLOCK 2048
+
+typedef struct {
+    Mix_Chunk *chunk;
+    const Sint16 *samples;
+    Uint32 length;         // Samples, a multiple of the channel count
+    Uint32 position;
+    float gain[2];         // Left and right, chunk volume included
+    SoundPriority priority;
+    int loop;
+    int scheduled;         // Waits for startFrame before playing
+    Uint32 startFrame;
+    SoundId id;            // 0 = free
+    Uint32 order;          // Play count when started, the oldest is stolen first
+} Voice;
+
+// Written by the main thread under SDL_LockAudio, mixed by the audio thread
+static Voice voices[MIXER_MAX_VOICES];
+static int voiceCount = MIXER_DEFAULT_VOICES;
+static MixerStats stats;
+static int useScalar = 0;
+
+// Audio thread only
+static float mixBuffer[MIXER_BLOCK];
+
+static void setGain(Voice *voice, float gain, float pan) {
+    if (gain < 0.0f) gain = 0.0f;
+    if (gain > 2.0f) gain = 2.0f;
+    if (pan < -1.0f) pan = -1.0f;
+    if (pan > 1.0f) pan = 1.0f;
+    gain *= (float)voice->chunk->volume / MIX_MAX_VOLUME;
+    voice->gain[0] = pan > 0.0f ? gain * (1.0f - pan) : gain;
+    voice->gain[1] = pan < 0.0f ? gain * (1.0f + pan) : gain;
+}
+
+static Voice *findVoice(SoundId id) {
+    if (!id) return NULL;
+    Voice *voice = &voices[id & 0xFF];
+    return voice->id == id ? voice : NULL;
+}
+
+static void countActive(void) {
+    int active = 0;
+    for (int i = 0; i < voiceCount; i++) {
+        if (voices[i].id) active++;
+    }
+    stats.active = active;
+    if (active > stats.peak) stats.peak = active;
+}
+
+static SoundId startSound(Mix_Chunk *chunk, SoundPriority priority, float gain, float pan, int loop,
+                          int scheduled, Uint32 frame) {
+    if (!chunk || !chunk->abuf || chunk->alen < sizeof(Sint16) * 2) return 0;
+
+    SDL_LockAudio();
+    // A free voice, or else the lowest priority one, the oldest among equals
+    Voice *target = NULL;
+    for (int i = 0; i < voiceCount; i++) {
+        Voice *voice = &voices[i];
+        if (!voice->id) {
+            target = voice;
+            break;
+        }
+        if (!target || voice->priority < target->priority ||
+            (voice->priority == target->priority && voice->order < target->order)) {
+            target = voice;
+        }
+    }
+    if (target && target->id && target->priority > priority) {
+        stats.dropped++;
+        SDL_UnlockAudio();
+        return 0;
+    }
+    if (target->id) stats.stolen++;
+
+    int index = (int)(target - voices);
+    stats.played++;
+    target->chunk = chunk;
+    target->samples = (const Sint16 *)chunk->abuf;
+    // Whole frames only (stereo samples come in pairs)
+    target->length = (chunk->alen / sizeof(Sint16)) & ~1u;
+    target->position = 0;
+    target->priority = priority;
+    target->loop = loop;
+    target->scheduled = scheduled;
+    target->startFrame = frame;
+    target->order = stats.played;
+    target->id = (stats.played << 8) | (SoundId)index;
+    setGain(target, gain, pan);
+    SoundId id = target->id;
+    countActive();
+    SDL_UnlockAudio();
+    return id;
+}
+
+SoundId playSound(Mix_Chunk *chunk, SoundPriority priority, float gain, float pan) {
+    return startSound(chunk, priority, gain, pan, 0, 0, 0);
+}
+
+SoundId loopSound(Mix_Chunk *chunk, SoundPriority priority, float gain, float pan) {
+    return startSound(chunk, priority, gain, pan, 1, 0, 0);
+}
+
+SoundId scheduleSound(Mix_Chunk *chunk, SoundPriority priority, float gain, float pan, Uint32 frame) {
+    return startSound(chunk, priority, gain, pan, 0, 1, frame);
+}
+
+void stopSound(SoundId id) {
+    SDL_LockAudio();
+    Voice *voice = findVoice(id);
+    if (voice) voice->id = 0;
+    SDL_UnlockAudio();
+}
+
+int soundPlaying(SoundId id) {
+    SDL_LockAudio();
+    int playing = findVoice(id) != NULL;
+    SDL_UnlockAudio();
+    return playing;
+}
+
+void setSoundGain(SoundId id, float gain, float pan) {
+    SDL_LockAudio();
+    Voice *voice = findVoice(id);
+    if (voice) setGain(voice, gain, pan);
+    SDL_UnlockAudio();
+}
+
+void stopAllSounds(void) {
+    SDL_LockAudio();
+    for (int i = 0; i < MIXER_MAX_VOICES; i++) {
+        voices[i].id = 0;
+    }
+    SDL_UnlockAudio();
+}
+
+void stopChunkSounds(Mix_Chunk *chunk) {
+    SDL_LockAudio();
+    for (int i = 0; i < MIXER_MAX_VOICES; i++) {
+        if (voices[i].chunk == chunk) voices[i].id = 0;
+    }
+    SDL_UnlockAudio();
+}
+
+void setMixerVoices(int count) {
+    if (count < 1) count = 1;
+    if (count > MIXER_MAX_VOICES) count = MIXER_MAX_VOICES;
+    SDL_LockAudio();
+    for (int i = count; i < MIXER_MAX_VOICES; i++) {
+        voices[i].id = 0;
+    }
+    voiceCount = count;
+    SDL_UnlockAudio();
+}
+
+MixerStats mixerStats(void) {
+    SDL_LockAudio();
+    countActive();
+    MixerStats copy = stats;
+    copy.voices = voiceCount;
+    SDL_UnlockAudio();
+    return copy;
+}
+
+void setMixerScalar(int scalar) {
+    useScalar = scalar;
+}
+
+// mix[i] += src[i] * gain[i & 1] (mono voices have equal gains)
+static void mixVoiceScalar(float *mix, const Sint16 *src, int count, const float *gain) {
+    for (int i = 0; i < count; i++) {
+        mix[i] += src[i] * gain[i & 1];
+    }
+}
+
+// Nearest integer, ties to even like cvtps2dq (exact below 2^23)
+static inline int roundSample(float value) {
+    int sample = (int)(value + (value >= 0.0f ? 0.5f : -0.5f));
+    float tie = (float)sample - value;
+    if ((tie == 0.5f || tie == -0.5f) && (sample & 1)) sample += tie > 0.0f ? -1 : 1;
+    return sample;
+}
+
+// out[i] = clip(out[i] + mix[i])
+static void clipScalar(Sint16 *out, const float *mix, int count) {
+    for (int i = 0; i < count; i++) {
+        int sample = roundSample(out[i] + mix[i]);
+        if (sample > 32767) sample = 32767;
+        if (sample < -32768) sample = -32768;
+        out[i] = (Sint16)sample;
+    }
+}
+
+#ifdef MIXER_X86
+__attribute__((target("sse2")))
+static void mixVoiceSSE2(float *mix, const Sint16 *src, int count, const float *gain) {
+    const __m128 g = _mm_setr_ps(gain[0], gain[1], gain[0], gain[1]);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+        // Sign-extend the 8 samples to two groups of 4 ints
+        __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+        __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16));
+        _mm_storeu_ps(mix + i, _mm_add_ps(_mm_loadu_ps(mix + i), _mm_mul_ps(lo, g)));
+        _mm_storeu_ps(mix + i + 4, _mm_add_ps(_mm_loadu_ps(mix + i + 4), _mm_mul_ps(hi, g)));
+    }
+    mixVoiceScalar(mix + i, src + i, count - i, gain);
+}
+
+__attribute__((target("sse2")))
+static void clipSSE2(Sint16 *out, const float *mix, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i s = _mm_loadu_si128((__m128i *)(out + i));
+        __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+        __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16));
+        lo = _mm_add_ps(lo, _mm_loadu_ps(mix + i));
+        hi = _mm_add_ps(hi, _mm_loadu_ps(mix + i + 4));
+        // packs saturates to 16 bits: that is the clipping
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(lo), _mm_cvtps_epi32(hi));
+        _mm_storeu_si128((__m128i *)(out + i), packed);
+    }
+    clipScalar(out + i, mix + i, count - i);
+}
+#endif
+
+// Mix one voice over count samples of the block from sample done, looping
+// or ending it
+static void mixVoice(Voice *voice, int done, int count, int channels, int simd) {
+    // A mono stream gets the mean of the two gains on every sample
+    float mono = (voice->gain[0] + voice->gain[1]) * 0.5f;
+    float monoGain[2] = {mono, mono};
+    const float *gain = channels == 1 ? monoGain : voice->gain;
+    while (done < count && voice->id) {
+        int n = (int)(voice->length - voice->position);
+        if (n > count - done) n = count - done;
+#ifdef MIXER_X86
+        if (simd) {
+            mixVoiceSSE2(mixBuffer + done, voice->samples + voice->position, n, gain);
+        } else
+#endif
+        {
+            mixVoiceScalar(mixBuffer + done, voice->samples + voice->position, n, gain);
+        }
+        done += n;
+        voice->position += n;
+        if (voice->position >= voice->length) {
+            if (voice->loop) {
+                voice->position = 0;
+            } else {
+                voice->id = 0;
+            }
+        }
+    }
+    (void)simd;
+}
+
+void mixSounds(Sint16 *stream, int samples, int channels, Uint32 frame) {
+    if (channels < 1 || channels > 2) return;
+
+    int simd = 0;
+#ifdef MIXER_X86
+    static int sse2 = -1;
+    if (sse2 < 0) sse2 = __builtin_cpu_supports("sse2");
+    simd = sse2 && !useScalar;
+#endif
+
+    while (samples > 0) {
+        int count = samples < MIXER_BLOCK ? samples : MIXER_BLOCK;
+        count -= count % channels;
+        if (count <= 0) break;
+
+        int mixed = 0;
+        int frames = count / channels;
+        for (int i = 0; i < voiceCount; i++) {
+            Voice *voice = &voices[i];
+            if (!voice->id) continue;
+
+            // A scheduled sound starts on its frame, on the sample boundary
+            // inside the block; a late one starts at the block start
+            int start = 0;
+            if (voice->scheduled) {
+                Sint32 wait = (Sint32)(voice->startFrame - frame);
+                if (wait >= frames) continue;
+                if (wait > 0) start = wait * channels;
+                voice->scheduled = 0;
+            }
+            if (!mixed) memset(mixBuffer, 0, count * sizeof(float));
+            mixVoice(voice, start, count, channels, simd);
+            mixed++;
+        }
+        if (mixed) {
+#ifdef MIXER_X86
+            if (simd) {
+                clipSSE2(stream, mixBuffer, count);
+            } else
+#endif
+            {
+                clipScalar(stream, mixBuffer, count);
+            }
+        }
+        stream += count;
+        samples -= count;
+        frame += count / channels;
+    }
+}
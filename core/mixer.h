@@ -0,0 +1,82 @@
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <SDL/SDL.h>
+#include <SDL/SDL_mixer.h>
+
+// Sound effect mixer.
+//
+// Sounds are played on our own voices, mixed in the audio callback after
+// SDL_mixer has mixed the music: each voice is scaled by its left and right
+// gains into a float buffer (SSE2, 4 samples per instruction), then the
+// buffer is added to the stream and clipped to 16 bits in one pass.
+//
+// When every voice is busy, a new sound takes the voice of the lowest
+// priority sound (the oldest one among equals), if that priority is not
+// above its own; otherwise the new sound is dropped. Both cases are counted.
+//
+//   SoundId walk = loopSound(walkSound, SOUND_AMBIENT, 0.6f, 0.0f);
+//   playSound(attackSound, SOUND_EFFECT, 1.0f, -0.5f);
+//   stopSound(walk);
+//
+// A sound can also start on an exact frame of the audio clock (see
+// audioClock() in audio.h), to keep a rhythm whatever the buffer size:
+//
+//   scheduleSound(tone, SOUND_EFFECT, 1.0f, 0.0f, audioClock() + audioMsToFrames(250));
+//
+// Chunks must be in the device format (Mix_LoadWAV converts them). Freeing a
+// chunk through memtrack (Mix_FreeChunk) stops the voices playing it.
+
+#define MIXER_MAX_VOICES 256
+#define MIXER_DEFAULT_VOICES 32
+
+typedef enum {
+    SOUND_AMBIENT,    // Loops and footsteps, stolen first
+    SOUND_UI,         // Menu hovers and clicks
+    SOUND_EFFECT,     // Attacks, hits, Simon tones
+    SOUND_CRITICAL    // Deaths, success and failure jingles
+} SoundPriority;
+
+// Voice index in the low 8 bits, play count above: an id is never reused,
+// so stopping a sound that ended or was stolen does nothing
+typedef Uint32 SoundId;
+
+typedef struct {
+    int voices;       // Voices that can play at once
+    int active;       // Playing now
+    int peak;         // Most voices playing at once
+    Uint32 played;    // Sounds started
+    Uint32 stolen;    // Sounds cut to make room for a higher priority one
+    Uint32 dropped;   // Sounds not played (every voice had a higher priority)
+} MixerStats;
+
+// 1 .. MIXER_MAX_VOICES. Lowering it stops the sounds above the new count.
+void setMixerVoices(int count);
+
+// gain: 0 .. 2 (1 = as recorded), pan: -1 (left) .. 1 (right).
+// Returns 0 if the sound could not be played.
+SoundId playSound(Mix_Chunk *chunk, SoundPriority priority, float gain, float pan);
+// Same, repeating until stopped
+SoundId loopSound(Mix_Chunk *chunk, SoundPriority priority, float gain, float pan);
+// Same as playSound, the first sample played at that frame of the audio
+// clock (at once if it has gone by). The voice is taken from now on.
+SoundId scheduleSound(Mix_Chunk *chunk, SoundPriority priority, float gain, float pan, Uint32 frame);
+
+void stopSound(SoundId id);
+int soundPlaying(SoundId id);
+void setSoundGain(SoundId id, float gain, float pan);
+void stopAllSounds(void);
+// Stop every voice playing the chunk (before it is freed)
+void stopChunkSounds(Mix_Chunk *chunk);
+
+MixerStats mixerStats(void);
+
+// Mix the voices into a 16-bit stream of interleaved samples (1 or 2
+// channels) whose first frame is that frame of the audio clock. Called by
+// the audio service on the audio thread.
+void mixSounds(Sint16 *stream, int samples, int channels, Uint32 frame);
+
+// Mix with the scalar loops instead of SSE2 (for comparisons)
+void setMixerScalar(int scalar);
+
+#endif
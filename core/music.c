@@ -0,0 +1,408 @@
+#include "music.h"
+#include "audio.h"
+#include "resources.h"
+#include "timer.h"
+#include <stdio.h>
+#include <string.h>
+
+// Ring of each track in samples, a power of two: 3 s of 44100 Hz stereo
+#define MUSIC_RING_SAMPLES (1 << 18)
+#define MUSIC_RING_MASK (MUSIC_RING_SAMPLES - 1)
+// Samples a new track must have buffered before it fades in (0.37 s)
+#define MUSIC_PREROLL_SAMPLES (1 << 15)
+// The streamer tops the rings up at least this often
+#define MUSIC_STREAM_MS 10
+#define MUSIC_REQUESTS 8
+
+typedef enum {
+    TRACK_FREE,
+    TRACK_DECODING,   // Its decoder thread is running
+    TRACK_STREAMING,  // Decoded, the ring is kept full
+    TRACK_FALLBACK,   // Played by SDL_mixer as Mix_Music
+    TRACK_FAILED
+} TrackState;
+
+typedef struct {
+    char key[RESOURCE_PATH_MAX];
+    volatile int state;
+    SDL_Thread *decoder;
+    Mix_Chunk *chunk;          // Whole track in the device format
+    Mix_Music *music;          // TRACK_FALLBACK
+    Uint32 length;             // Samples in the chunk, whole frames
+    Uint32 position;           // Next sample of the chunk to stream
+    Uint32 lastUsed;           // Request count when last asked for
+
+    // Filled by the streamer, drained by the audio thread. Free-running
+    // sample counts: writePos - readPos is what is buffered.
+    Sint16 *ring;
+    volatile Uint32 writePos;
+    volatile Uint32 readPos;
+
+    // Fade: set by the streamer under SDL_LockAudio, stepped every frame by
+    // the audio thread. A silent track does not drain its ring, so it
+    // carries on from there if it is played again.
+    float gain;
+    float target;
+    float step;
+} MusicTrack;
+
+typedef enum {
+    REQUEST_PLAY,
+    REQUEST_PREROLL,
+    REQUEST_STOP
+} RequestType;
+
+typedef struct {
+    RequestType type;
+    char key[RESOURCE_PATH_MAX];
+    int fadeMs;
+} MusicRequest;
+
+static Sint16 rings[MUSIC_TRACKS][MUSIC_RING_SAMPLES];
+static MusicTrack tracks[MUSIC_TRACKS];
+static MusicStats stats;
+static volatile float musicVolume = 1.0f;
+
+// Requests from the main thread, under lock
+static SDL_mutex *lock = NULL;
+static SDL_cond *wake = NULL;
+static SDL_Thread *streamer = NULL;
+static MusicRequest requests[MUSIC_REQUESTS];
+static int requestCount = 0;
+static volatile int stopping = 0;
+
+// Streamer thread only
+static MusicTrack *current = NULL;   // Playing, or waiting for its ring to fill
+static int currentStarted = 0;
+static int currentFadeMs = 0;
+static MusicTrack *fallback = NULL;  // Track SDL_mixer is playing
+static Uint32 requestSerial = 0;
+
+// Runs on its own thread: a long file does not hold up the other rings
+static int decodeTrack(void *data) {
+    MusicTrack *track = (MusicTrack *)data;
+    int channels = audioGetSpec().channels;
+    Uint64 start = timerNowUs();
+
+    Mix_Chunk *chunk = (Mix_Chunk *)decodeResource(track->key, RES_SOUND, 0);
+    Uint32 samples = chunk ? chunk->alen / sizeof(Sint16) : 0;
+    samples -= samples % (Uint32)channels;
+    if (chunk && samples > 0) {
+        track->chunk = chunk;
+        track->length = samples;
+        track->position = 0;
+        stats.lastDecodeMs = (Uint32)((timerNowUs() - start) / 1000);
+        stats.decoded++;
+        __sync_synchronize();
+        track->state = TRACK_STREAMING;
+        return 0;
+    }
+    if (chunk) Mix_FreeChunk(chunk);
+
+    // Not a sound SDL_mixer can decode: maybe music it can play
+    track->music = (Mix_Music *)decodeResource(track->key, RES_MUSIC, 0);
+    if (!track->music) printf("Cannot decode music %s\n", track->key);
+    __sync_synchronize();
+    track->state = track->music ? TRACK_FALLBACK : TRACK_FAILED;
+    return 0;
+}
+
+static void closeTrack(MusicTrack *track) {
+    if (track->decoder) {
+        SDL_WaitThread(track->decoder, NULL);
+        track->decoder = NULL;
+    }
+
+    // The audio thread is out of the ring once the lock is taken
+    SDL_LockAudio();
+    track->state = TRACK_FREE;
+    track->gain = track->target = 0.0f;
+    SDL_UnlockAudio();
+
+    if (track->chunk) Mix_FreeChunk(track->chunk);
+    if (track->music) {
+        if (fallback == track) {
+            Mix_HaltMusic();
+            fallback = NULL;
+        }
+        Mix_FreeMusic(track->music);
+    }
+    track->chunk = NULL;
+    track->music = NULL;
+    track->key[0] = '\0';
+    if (current == track) current = NULL;
+}
+
+static MusicTrack *findTrack(const char *key) {
+    for (int i = 0; i < MUSIC_TRACKS; i++) {
+        if (tracks[i].state != TRACK_FREE && strcmp(tracks[i].key, key) == 0) return &tracks[i];
+    }
+    return NULL;
+}
+
+static MusicTrack *openTrack(const char *key) {
+    // A free slot, or else the least recently asked for of the silent
+    // ones, or else the quietest (cut in the middle of its fade)
+    MusicTrack *track = NULL;
+    for (int i = 0; i < MUSIC_TRACKS && !track; i++) {
+        if (tracks[i].state == TRACK_FREE) track = &tracks[i];
+    }
+    int evict = !track;
+    for (int i = 0; i < MUSIC_TRACKS && evict; i++) {
+        MusicTrack *candidate = &tracks[i];
+        if (candidate == current) continue;
+        int silent = candidate->gain <= 0.0f && candidate->target <= 0.0f;
+        int bestSilent = track && track->gain <= 0.0f && track->target <= 0.0f;
+        if (!track || (silent && !bestSilent) ||
+            (silent == bestSilent && (silent ? candidate->lastUsed < track->lastUsed
+                                             : candidate->gain < track->gain))) {
+            track = candidate;
+        }
+    }
+    if (track->state != TRACK_FREE) closeTrack(track);
+
+    strcpy(track->key, key);
+    track->ring = rings[track - tracks];
+    track->writePos = track->readPos = 0;
+    track->gain = track->target = track->step = 0.0f;
+    track->state = TRACK_DECODING;
+    track->decoder = SDL_CreateThread(decodeTrack, track);
+    if (!track->decoder) decodeTrack(track);
+    return track;
+}
+
+// Fade the track in and every other one out
+static void startTrack(MusicTrack *track, int fadeMs) {
+    Uint32 fadeFrames = (Uint32)fadeMs * (Uint32)audioGetSpec().frequency / 1000;
+    float step = fadeFrames ? 1.0f / (float)fadeFrames : 1.0f;
+
+    if (fallback && fallback != track) {
+        Mix_FadeOutMusic(fadeMs);
+        fallback = NULL;
+    }
+    if (track && track->state == TRACK_FALLBACK && fallback != track) {
+        Mix_FadeInMusic(track->music, -1, fadeMs);
+        fallback = track;
+    }
+
+    // Linear gains: the two tracks add up to full volume during the crossfade
+    SDL_LockAudio();
+    for (int i = 0; i < MUSIC_TRACKS; i++) {
+        MusicTrack *other = &tracks[i];
+        other->target = (other == track && other->state == TRACK_STREAMING) ? 1.0f : 0.0f;
+        other->step = step;
+    }
+    SDL_UnlockAudio();
+    if (track) stats.switches++;
+}
+
+static void handleRequest(const MusicRequest *request) {
+    if (request->type == REQUEST_STOP) {
+        current = NULL;
+        startTrack(NULL, request->fadeMs);
+        return;
+    }
+
+    MusicTrack *track = findTrack(request->key);
+    if (!track) track = openTrack(request->key);
+    track->lastUsed = ++requestSerial;
+
+    // Already playing (or about to): it goes on, it does not restart
+    if (request->type == REQUEST_PREROLL || track == current) return;
+    current = track;
+    currentStarted = 0;
+    currentFadeMs = request->fadeMs;
+}
+
+static void fillRing(MusicTrack *track) {
+    const Sint16 *samples = (const Sint16 *)track->chunk->abuf;
+    Uint32 write = track->writePos;
+    Uint32 space = MUSIC_RING_SAMPLES - (write - track->readPos);
+
+    while (space > 0) {
+        Uint32 n = track->length - track->position;
+        Uint32 at = write & MUSIC_RING_MASK;
+        if (n > space) n = space;
+        if (n > MUSIC_RING_SAMPLES - at) n = MUSIC_RING_SAMPLES - at;
+        memcpy(track->ring + at, samples + track->position, n * sizeof(Sint16));
+        write += n;
+        space -= n;
+        track->position += n;
+        if (track->position >= track->length) track->position = 0;  // Music loops
+    }
+
+    // The samples must be visible before the audio thread sees the new count
+    __sync_synchronize();
+    track->writePos = write;
+}
+
+static int trackReady(MusicTrack *track) {
+    switch (track->state) {
+        case TRACK_STREAMING:
+            return track->writePos - track->readPos >= MUSIC_PREROLL_SAMPLES;
+        case TRACK_DECODING:
+            return 0;
+        default:
+            return 1;  // Fallback, or failed: the old track fades out
+    }
+}
+
+static int streamMusic(void *data) {
+    (void)data;
+    MusicRequest pending[MUSIC_REQUESTS];
+
+    while (!stopping) {
+        SDL_mutexP(lock);
+        if (!requestCount && !stopping) SDL_CondWaitTimeout(wake, lock, MUSIC_STREAM_MS);
+        int count = requestCount;
+        memcpy(pending, requests, count * sizeof(MusicRequest));
+        requestCount = 0;
+        SDL_mutexV(lock);
+
+        for (int i = 0; i < count; i++) {
+            handleRequest(&pending[i]);
+        }
+
+        for (int i = 0; i < MUSIC_TRACKS; i++) {
+            MusicTrack *track = &tracks[i];
+            if (track->decoder && track->state != TRACK_DECODING) {
+                SDL_WaitThread(track->decoder, NULL);
+                track->decoder = NULL;
+            }
+            if (track->state == TRACK_STREAMING) fillRing(track);
+        }
+
+        if (current && !currentStarted && trackReady(current)) {
+            startTrack(current, currentFadeMs);
+            currentStarted = 1;
+        }
+    }
+    return 0;
+}
+
+static int postRequest(RequestType type, const char *path, int fadeMs) {
+    if (!audioIsOpen()) return -1;
+
+    MusicRequest request;
+    request.type = type;
+    request.fadeMs = fadeMs < 0 ? 0 : fadeMs;
+    request.key[0] = '\0';
+    // Resolved here: the streamer does not share our current directory
+    if (path && resourceKey(path, request.key) < 0) {
+        printf("Music %s not found\n", path);
+        return -1;
+    }
+
+    if (!streamer) {
+        lock = SDL_CreateMutex();
+        wake = SDL_CreateCond();
+        stopping = 0;
+        streamer = SDL_CreateThread(streamMusic, NULL);
+        if (!streamer) {
+            printf("Cannot start the music streamer\n");
+            return -1;
+        }
+    }
+
+    SDL_mutexP(lock);
+    if (requestCount == MUSIC_REQUESTS) {
+        // Only the last requests matter: make room by dropping the oldest
+        memmove(requests, requests + 1, (MUSIC_REQUESTS - 1) * sizeof(MusicRequest));
+        requestCount--;
+    }
+    requests[requestCount++] = request;
+    SDL_CondSignal(wake);
+    SDL_mutexV(lock);
+    return 0;
+}
+
+int playMusic(const char *path, int fadeMs) {
+    return postRequest(REQUEST_PLAY, path, fadeMs);
+}
+
+int prerollMusic(const char *path) {
+    return postRequest(REQUEST_PREROLL, path, 0);
+}
+
+void stopMusic(int fadeMs) {
+    postRequest(REQUEST_STOP, NULL, fadeMs);
+}
+
+void setMusicVolume(int volume) {
+    if (volume < 0) volume = 0;
+    if (volume > MIX_MAX_VOLUME) volume = MIX_MAX_VOLUME;
+    musicVolume = (float)volume / MIX_MAX_VOLUME;
+    Mix_VolumeMusic(volume);
+}
+
+MusicStats musicStats(void) {
+    return stats;
+}
+
+void mixMusic(Sint16 *stream, int samples, int channels) {
+    if (channels < 1 || channels > 2) return;
+    int frames = samples / channels;
+    float volume = musicVolume;
+
+    for (int i = 0; i < MUSIC_TRACKS; i++) {
+        MusicTrack *track = &tracks[i];
+        if (track->state != TRACK_STREAMING) continue;
+        if (track->gain <= 0.0f && track->target <= 0.0f) continue;
+
+        Uint32 read = track->readPos;
+        Uint32 available = track->writePos - read;
+        __sync_synchronize();
+        float gain = track->gain, target = track->target, step = track->step;
+        Sint16 *out = stream;
+
+        for (int f = 0; f < frames; f++) {
+            if (available < (Uint32)channels) {
+                // The streamer fell behind: silence rather than old samples
+                stats.underruns += frames - f;
+                break;
+            }
+            if (gain < target) {
+                gain += step;
+                if (gain > target) gain = target;
+            } else if (gain > target) {
+                gain -= step;
+                if (gain < target) gain = target;
+            }
+            float scale = gain * volume;
+            for (int c = 0; c < channels; c++) {
+                int sample = *out + (int)(track->ring[read & MUSIC_RING_MASK] * scale);
+                if (sample > 32767) sample = 32767;
+                if (sample < -32768) sample = -32768;
+                *out++ = (Sint16)sample;
+                read++;
+            }
+            available -= channels;
+        }
+
+        track->gain = gain;
+        __sync_synchronize();
+        track->readPos = read;
+    }
+}
+
+void closeMusic(void) {
+    if (!streamer) return;
+
+    SDL_mutexP(lock);
+    stopping = 1;
+    SDL_CondSignal(wake);
+    SDL_mutexV(lock);
+    SDL_WaitThread(streamer, NULL);
+    streamer = NULL;
+
+    for (int i = 0; i < MUSIC_TRACKS; i++) {
+        if (tracks[i].state != TRACK_FREE) closeTrack(&tracks[i]);
+    }
+    current = NULL;
+    currentStarted = 0;
+    requestCount = 0;
+    SDL_DestroyCond(wake);
+    SDL_DestroyMutex(lock);
+    wake = NULL;
+    lock = NULL;
+}
@@ -0,0 +1,63 @@
+#ifndef MUSIC_H
+#define MUSIC_H
+
+#include <SDL/SDL.h>
+#include <SDL/SDL_mixer.h>
+
+// Background music streamer.
+//
+// Tracks are decoded on background threads, never on the main thread: a
+// streamer thread keeps a ring buffer of about 3 seconds filled ahead of
+// each open track, and the audio callback mixes the rings, fading the old
+// track out while the new one fades in. A scene change only posts a request,
+// so it never waits for a file to be read or decoded.
+//
+//   prerollMusic("music.mp3");        // Next scene's track, decoded now
+//   ...
+//   playMusic("music.mp3", MUSIC_FADE_MS);   // Crossfades, no gap
+//
+// Playing the track that is already playing does nothing (it does not
+// restart). A track that is still being decoded when it is asked to play
+// starts once its ring is primed; the previous one plays until then.
+//
+// SDL_mixer 1.2 only decodes compressed files whole, so each track is
+// decoded in one go on its own thread (Mix_LoadWAV) and then streamed from
+// memory (about 10 MB per minute of 44100 Hz stereo, for each of the
+// MUSIC_TRACKS tracks). Files it can only play as music (MOD, MIDI) fall back to
+// Mix_Music with Mix_FadeInMusic, without a crossfade.
+//
+// Paths are relative to the current directory, like loadMusic().
+
+#define MUSIC_FADE_MS 1000
+#define MUSIC_TRACKS 3           // Playing, fading out and pre-rolled
+
+typedef struct {
+    Uint32 decoded;       // Tracks decoded
+    Uint32 lastDecodeMs;  // Time to decode the last one, off the main thread
+    Uint32 switches;      // Crossfades started
+    Uint32 underruns;     // Audible frames that had no data (should stay 0)
+} MusicStats;
+
+// Crossfade to the track over fadeMs. Returns -1 if the file does not exist.
+int playMusic(const char *path, int fadeMs);
+
+// Start decoding the track and filling its ring without playing it, so a
+// later playMusic() of it starts at once
+int prerollMusic(const char *path);
+
+// Fade the music out
+void stopMusic(int fadeMs);
+
+// 0 .. MIX_MAX_VOLUME, like Mix_VolumeMusic (which is set as well)
+void setMusicVolume(int volume);
+
+MusicStats musicStats(void);
+
+// Mix the audible tracks into a 16-bit stream of interleaved samples.
+// Called by the audio service on the audio thread.
+void mixMusic(Sint16 *stream, int samples, int channels);
+
+// Stop the streamer thread and free the tracks (closeAudio calls it)
+void closeMusic(void);
+
+#endif
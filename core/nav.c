@@ -0,0 +1,332 @@
+#include "nav.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STRAIGHT_COST 10
+#define DIAGONAL_COST 14
+
+// Straight steps first, then the diagonals
+static const int stepX[8] = {1, -1, 0, 0, 1, 1, -1, -1};
+static const int stepY[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+
+static int floorDiv(int a, int b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+int initNavGrid(NavGrid *grid, int width, int height, int cellSize) {
+    memset(grid, 0, sizeof(*grid));
+    if (cellSize <= 0 || width <= 0 || height <= 0) return -1;
+    grid->cellSize = cellSize;
+    grid->cols = (width + cellSize - 1) / cellSize;
+    grid->rows = (height + cellSize - 1) / cellSize;
+
+    int cells = grid->cols * grid->rows;
+    grid->heapCapacity = cells * 8 + 1;  // A cell is pushed again at most once per neighbor
+    grid->blocked = calloc(cells, 1);
+    grid->cost = malloc(cells * sizeof(Uint32));
+    grid->parent = malloc(cells * sizeof(int));
+    grid->visited = calloc(cells, sizeof(Uint32));
+    grid->heap = malloc(grid->heapCapacity * sizeof(int));
+    grid->heapKey = malloc(grid->heapCapacity * sizeof(Uint32));
+    if (!grid->blocked || !grid->cost || !grid->parent || !grid->visited || !grid->heap || !grid->heapKey) {
+        printf("Not enough memory for a %dx%d navigation grid\n", grid->cols, grid->rows);
+        freeNavGrid(grid);
+        return -1;
+    }
+    return 0;
+}
+
+void freeNavGrid(NavGrid *grid) {
+    free(grid->blocked);
+    free(grid->cost);
+    free(grid->parent);
+    free(grid->visited);
+    free(grid->heap);
+    free(grid->heapKey);
+    memset(grid, 0, sizeof(*grid));
+}
+
+void clearNavGrid(NavGrid *grid, int blocked) {
+    memset(grid->blocked, blocked ? 1 : 0, grid->cols * grid->rows);
+    grid->version++;
+}
+
+void setNavRect(NavGrid *grid, SDL_Rect rect, int blocked) {
+    if (rect.w == 0 || rect.h == 0) return;
+    int col0 = floorDiv(rect.x, grid->cellSize), row0 = floorDiv(rect.y, grid->cellSize);
+    int col1 = floorDiv(rect.x + rect.w - 1, grid->cellSize);
+    int row1 = floorDiv(rect.y + rect.h - 1, grid->cellSize);
+    if (col0 < 0) col0 = 0;
+    if (row0 < 0) row0 = 0;
+    if (col1 >= grid->cols) col1 = grid->cols - 1;
+    if (row1 >= grid->rows) row1 = grid->rows - 1;
+    if (col0 > col1 || row0 > row1) return;
+
+    for (int row = row0; row <= row1; row++) {
+        for (int col = col0; col <= col1; col++) {
+            grid->blocked[row * grid->cols + col] = blocked ? 1 : 0;
+        }
+    }
+    grid->version++;
+}
+
+int blockNavMask(NavGrid *grid, SDL_Surface *mask) {
+    if (!mask || (SDL_MUSTLOCK(mask) && SDL_LockSurface(mask) < 0)) return -1;
+
+    SDL_PixelFormat *f = mask->format;
+    int bpp = f->BytesPerPixel;
+    for (int y = 0; y < mask->h && y / grid->cellSize < grid->rows; y++) {
+        Uint8 *row = (Uint8 *)mask->pixels + y * mask->pitch;
+        Uint8 *cells = grid->blocked + (y / grid->cellSize) * grid->cols;
+        for (int x = 0; x < mask->w && x / grid->cellSize < grid->cols; x++) {
+            Uint32 pixel;
+            switch (bpp) {
+                case 1: pixel = row[x]; break;
+                case 2: pixel = ((Uint16 *)row)[x]; break;
+                case 4: pixel = ((Uint32 *)row)[x]; break;
+                default: pixel = row[x * 3] | row[x * 3 + 1] << 8 | row[x * 3 + 2] << 16; break;
+            }
+            int solid;
+            if (f->Amask) {
+                Uint8 r, g, b, a;
+                SDL_GetRGBA(pixel, f, &r, &g, &b, &a);
+                solid = a >= 128;
+            } else {
+                solid = !(mask->flags & SDL_SRCCOLORKEY) || pixel != f->colorkey;
+            }
+            if (solid) cells[x / grid->cellSize] = 1;
+        }
+    }
+    if (SDL_MUSTLOCK(mask)) SDL_UnlockSurface(mask);
+    grid->version++;
+    return 0;
+}
+
+int navCellAt(const NavGrid *grid, int x, int y) {
+    if (x < 0 || y < 0) return -1;
+    int col = x / grid->cellSize, row = y / grid->cellSize;
+    if (col >= grid->cols || row >= grid->rows) return -1;
+    return row * grid->cols + col;
+}
+
+int navBlocked(const NavGrid *grid, int col, int row) {
+    if (col < 0 || row < 0 || col >= grid->cols || row >= grid->rows) return 1;
+    return grid->blocked[row * grid->cols + col];
+}
+
+void navCellCenter(const NavGrid *grid, int cell, int *x, int *y) {
+    *x = (cell % grid->cols) * grid->cellSize + grid->cellSize / 2;
+    *y = (cell / grid->cols) * grid->cellSize + grid->cellSize / 2;
+}
+
+// Cell reached by step d from cell, or -1 if the step is not allowed. The
+// goal may be entered even when blocked (a target standing in a wall).
+static int stepCell(const NavGrid *grid, int cell, int d, int goal) {
+    int col = cell % grid->cols + stepX[d];
+    int row = cell / grid->cols + stepY[d];
+    if (col < 0 || row < 0 || col >= grid->cols || row >= grid->rows) return -1;
+    int next = row * grid->cols + col;
+    if (next != goal && grid->blocked[next]) return -1;
+    if (d >= 4 && (navBlocked(grid, col, row - stepY[d]) || navBlocked(grid, col - stepX[d], row))) {
+        return -1;  // Corner of a wall
+    }
+    return next;
+}
+
+static void heapPush(NavGrid *grid, int *size, int cell, Uint32 key) {
+    if (*size >= grid->heapCapacity) return;
+    int i = (*size)++;
+    while (i > 0) {
+        int up = (i - 1) / 2;
+        if (grid->heapKey[up] <= key) break;
+        grid->heap[i] = grid->heap[up];
+        grid->heapKey[i] = grid->heapKey[up];
+        i = up;
+    }
+    grid->heap[i] = cell;
+    grid->heapKey[i] = key;
+}
+
+static int heapPop(NavGrid *grid, int *size, Uint32 *key) {
+    int cell = grid->heap[0];
+    *key = grid->heapKey[0];
+    int lastCell = grid->heap[--(*size)];
+    Uint32 lastKey = grid->heapKey[*size];
+
+    int i = 0;
+    while (1) {
+        int child = i * 2 + 1;
+        if (child >= *size) break;
+        if (child + 1 < *size && grid->heapKey[child + 1] < grid->heapKey[child]) child++;
+        if (grid->heapKey[child] >= lastKey) break;
+        grid->heap[i] = grid->heap[child];
+        grid->heapKey[i] = grid->heapKey[child];
+        i = child;
+    }
+    grid->heap[i] = lastCell;
+    grid->heapKey[i] = lastKey;
+    return cell;
+}
+
+// Octile distance: consistent with the step costs
+static Uint32 heuristic(const NavGrid *grid, int cell, int goal) {
+    int dx = abs(cell % grid->cols - goal % grid->cols);
+    int dy = abs(cell / grid->cols - goal / grid->cols);
+    int low = dx < dy ? dx : dy, high = dx < dy ? dy : dx;
+    return (Uint32)(STRAIGHT_COST * high + (DIAGONAL_COST - STRAIGHT_COST) * low);
+}
+
+static void newSearch(NavGrid *grid) {
+    if (++grid->search == 0) {
+        memset(grid->visited, 0, grid->cols * grid->rows * sizeof(Uint32));
+        grid->search = 1;
+    }
+}
+
+int findNavPath(NavGrid *grid, int fromX, int fromY, int toX, int toY, NavPath *path) {
+    int start = navCellAt(grid, fromX, fromY);
+    int goal = navCellAt(grid, toX, toY);
+    path->count = 0;
+    path->next = 0;
+    path->goalCell = goal;
+    path->gridVersion = grid->version;
+    path->searches++;
+    if (start < 0 || goal < 0) return -1;
+    if (start == goal) return 0;
+
+    newSearch(grid);
+    int heapSize = 0;
+    grid->cost[start] = 0;
+    grid->parent[start] = -1;
+    grid->visited[start] = grid->search;
+    heapPush(grid, &heapSize, start, heuristic(grid, start, goal));
+
+    while (heapSize > 0) {
+        Uint32 key;
+        int cell = heapPop(grid, &heapSize, &key);
+        if (cell == goal) break;
+        if (key > grid->cost[cell] + heuristic(grid, cell, goal)) continue;  // Stale entry
+
+        for (int d = 0; d < 8; d++) {
+            int next = stepCell(grid, cell, d, goal);
+            if (next < 0) continue;
+            Uint32 cost = grid->cost[cell] + (d < 4 ? STRAIGHT_COST : DIAGONAL_COST);
+            if (grid->visited[next] != grid->search || cost < grid->cost[next]) {
+                grid->visited[next] = grid->search;
+                grid->cost[next] = cost;
+                grid->parent[next] = cell;
+                heapPush(grid, &heapSize, next, cost + heuristic(grid, next, goal));
+            }
+        }
+    }
+    if (grid->visited[goal] != grid->search) return -1;
+
+    int count = 0;
+    for (int cell = goal; cell != start; cell = grid->parent[cell]) count++;
+    if (count > NAV_MAX_PATH) return -1;
+    path->count = count;
+    for (int cell = goal; cell != start; cell = grid->parent[cell]) {
+        path->cells[--count] = cell;
+    }
+    return 0;
+}
+
+static int adjacentCells(const NavGrid *grid, int a, int b) {
+    return abs(a % grid->cols - b % grid->cols) <= 1 && abs(a / grid->cols - b / grid->cols) <= 1;
+}
+
+int followNavPath(NavGrid *grid, NavPath *path, int x, int y, int targetX, int targetY,
+                  int *nextX, int *nextY) {
+    int cell = navCellAt(grid, x, y);
+    int goal = navCellAt(grid, targetX, targetY);
+    if (cell < 0 || goal < 0) return 0;
+
+    int search = path->searches == 0 || goal != path->goalCell || path->gridVersion != grid->version;
+    if (!search) {
+        while (path->next < path->count && path->cells[path->next] == cell) path->next++;
+        // Pushed off the path
+        if (path->next < path->count && !adjacentCells(grid, cell, path->cells[path->next])) search = 1;
+    }
+    if (search) {
+        if (findNavPath(grid, x, y, targetX, targetY, path) < 0) return 0;
+    }
+
+    if (path->next >= path->count) return 0;
+    navCellCenter(grid, path->cells[path->next], nextX, nextY);
+    return 1;
+}
+
+int initNavField(NavField *field, const NavGrid *grid) {
+    memset(field, 0, sizeof(*field));
+    field->cells = grid->cols * grid->rows;
+    field->targetCell = -1;
+    field->dist = malloc(field->cells * sizeof(Uint32));
+    if (!field->dist) return -1;
+    memset(field->dist, 0xFF, field->cells * sizeof(Uint32));
+    return 0;
+}
+
+void freeNavField(NavField *field) {
+    free(field->dist);
+    memset(field, 0, sizeof(*field));
+}
+
+int updateNavField(NavGrid *grid, NavField *field, int targetX, int targetY) {
+    int target = navCellAt(grid, targetX, targetY);
+    if (target < 0 || !field->dist) return 0;
+    if (target == field->targetCell && field->gridVersion == grid->version) return 0;
+
+    // Dijkstra from the target: steps are symmetric, so the cost from the
+    // target to a cell is the cost from that cell to the target
+    memset(field->dist, 0xFF, field->cells * sizeof(Uint32));
+    field->dist[target] = 0;
+    int heapSize = 0;
+    heapPush(grid, &heapSize, target, 0);
+
+    while (heapSize > 0) {
+        Uint32 dist;
+        int cell = heapPop(grid, &heapSize, &dist);
+        if (dist > field->dist[cell]) continue;  // Stale entry
+
+        for (int d = 0; d < 8; d++) {
+            int next = stepCell(grid, cell, d, -1);
+            if (next < 0) continue;
+            Uint32 cost = dist + (d < 4 ? STRAIGHT_COST : DIAGONAL_COST);
+            if (cost < field->dist[next]) {
+                field->dist[next] = cost;
+                heapPush(grid, &heapSize, next, cost);
+            }
+        }
+    }
+
+    field->targetCell = target;
+    field->gridVersion = grid->version;
+    field->updates++;
+    return 1;
+}
+
+int navFieldStep(const NavGrid *grid, const NavField *field, int x, int y, int *nextX, int *nextY) {
+    int cell = navCellAt(grid, x, y);
+    if (cell < 0 || !field->dist || cell == field->targetCell) return 0;
+
+    // Neighbor closest to the target (the agent's own cell may be blocked)
+    Uint32 best = field->dist[cell];
+    int bestCell = -1;
+    for (int d = 0; d < 8; d++) {
+        int next = stepCell(grid, cell, d, field->targetCell);
+        if (next >= 0 && field->dist[next] < best) {
+            best = field->dist[next];
+            bestCell = next;
+        }
+    }
+    if (bestCell < 0) return 0;
+    navCellCenter(grid, bestCell, nextX, nextY);
+    return 1;
+}
+
+Uint32 navFieldDistance(const NavGrid *grid, const NavField *field, int x, int y) {
+    int cell = navCellAt(grid, x, y);
+    if (cell < 0 || !field->dist) return NAV_UNREACHABLE;
+    return field->dist[cell];
+}
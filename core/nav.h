@@ -0,0 +1,95 @@
+#ifndef NAV_H
+#define NAV_H
+
+#include <SDL/SDL.h>
+
+// Grid navigation for enemies.
+//
+// The level is cut into square cells, each walkable or blocked (from the
+// collision rectangles or a collision mask). Agents move between cell
+// centers, in 8 directions; a diagonal step is only taken when both cells
+// beside it are free, so agents do not cut the corners of walls. Straight
+// steps cost 10, diagonal steps 14.
+//
+// Two ways to reach a target:
+// - NavPath: A* for one agent. The path is kept and only searched again
+//   when the target moves to another cell or the grid changed.
+// - NavField: distance to the target from every cell (Dijkstra from the
+//   target), shared by every agent chasing it. It is recomputed only when
+//   the target enters a new cell, then each agent just reads the best
+//   neighbor of its cell: hundreds of chasers cost one update per frame.
+//
+// Every change to the grid bumps its version, which invalidates the paths
+// and fields computed before.
+
+#define NAV_UNREACHABLE 0xFFFFFFFFu
+#define NAV_MAX_PATH 256
+
+typedef struct {
+    int cols, rows;
+    int cellSize;            // Pixels per cell side
+    Uint8 *blocked;          // cols * rows, 1 = blocked
+    Uint32 version;
+
+    // Search scratch, shared by the A* searches and the field updates
+    Uint32 *cost;
+    int *parent;
+    Uint32 *visited;         // Search number that reached the cell
+    Uint32 search;
+    int *heap;
+    Uint32 *heapKey;
+    int heapCapacity;
+} NavGrid;
+
+typedef struct {
+    int cells[NAV_MAX_PATH]; // From the start (excluded) to the goal
+    int count;
+    int next;                // Next cell to reach
+    int goalCell;
+    Uint32 gridVersion;
+    Uint32 searches;         // A* runs, to check the cache works
+} NavPath;
+
+typedef struct {
+    Uint32 *dist;            // Cost to the target, NAV_UNREACHABLE if none
+    int cells;
+    int targetCell;
+    Uint32 gridVersion;
+    Uint32 updates;          // Recomputations
+} NavField;
+
+// Grid over a width x height level, every cell free. -1 if out of memory.
+int initNavGrid(NavGrid *grid, int width, int height, int cellSize);
+void freeNavGrid(NavGrid *grid);
+
+void clearNavGrid(NavGrid *grid, int blocked);
+// Mark every cell touched by a level rectangle
+void setNavRect(NavGrid *grid, SDL_Rect rect, int blocked);
+// Block the cells with an opaque pixel in the mask (alpha >= 128, or not
+// the color key), the mask being the size of the level. -1 if unreadable.
+int blockNavMask(NavGrid *grid, SDL_Surface *mask);
+
+// Cell index of a level position, -1 outside the grid
+int navCellAt(const NavGrid *grid, int x, int y);
+int navBlocked(const NavGrid *grid, int col, int row);
+// Level position of the center of a cell
+void navCellCenter(const NavGrid *grid, int cell, int *x, int *y);
+
+// A* from (fromX, fromY) to (toX, toY), in level pixels. -1 if there is no
+// path (or it is longer than NAV_MAX_PATH cells).
+int findNavPath(NavGrid *grid, int fromX, int fromY, int toX, int toY, NavPath *path);
+// Point to walk to from (x, y) to reach the target, searching again only
+// when needed. Returns 0 when there is no path or the target cell is reached.
+int followNavPath(NavGrid *grid, NavPath *path, int x, int y, int targetX, int targetY,
+                  int *nextX, int *nextY);
+
+int initNavField(NavField *field, const NavGrid *grid);
+void freeNavField(NavField *field);
+// Point the field at the target. Returns 1 if it was recomputed.
+int updateNavField(NavGrid *grid, NavField *field, int targetX, int targetY);
+// Center of the best neighbor cell of (x, y). Returns 0 when the target
+// is unreachable from there or the agent is in the target cell.
+int navFieldStep(const NavGrid *grid, const NavField *field, int x, int y, int *nextX, int *nextY);
+Uint32 navFieldDistance(const NavGrid *grid, const NavField *field, int x, int y);
+
+#endif
@@ -0,0 +1,135 @@
+// Benchmark of the navigation: one A* path per agent against one shared
+// flow field
+//
+// Usage: navbench [agents] [frames]
+//
+// Agents chase a target that walks across a 4800x900 level with random
+// walls, in 25 pixel cells. Each agent keeps its own A* path in the first
+// run and reads the shared field in the second. The field distances must
+// match the A* path costs.
+
+#include "nav.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LEVEL_W 4800
+#define LEVEL_H 900
+#define CELL 25
+#define SPEED 3
+
+typedef struct {
+    int x, y;
+    NavPath path;
+} Agent;
+
+static void buildLevel(NavGrid *grid) {
+    srand(7);
+    for (int i = 0; i < 180; i++) {
+        SDL_Rect wall = {rand() % LEVEL_W, rand() % LEVEL_H, 0, 0};
+        wall.w = rand() % 2 ? CELL : CELL * (2 + rand() % 10);
+        wall.h = wall.w == CELL ? CELL * (2 + rand() % 10) : CELL;
+        setNavRect(grid, wall, 1);
+    }
+}
+
+static void placeAgents(NavGrid *grid, Agent *agents, int count) {
+    srand(11);
+    for (int i = 0; i < count; i++) {
+        do {
+            agents[i].x = rand() % LEVEL_W;
+            agents[i].y = rand() % LEVEL_H;
+        } while (grid->blocked[navCellAt(grid, agents[i].x, agents[i].y)]);
+        agents[i].path.searches = 0;
+    }
+}
+
+static void moveToward(Agent *agent, int x, int y) {
+    int dx = x - agent->x, dy = y - agent->y;
+    agent->x += dx > SPEED ? SPEED : (dx < -SPEED ? -SPEED : dx);
+    agent->y += dy > SPEED ? SPEED : (dy < -SPEED ? -SPEED : dy);
+}
+
+// The target walks right and left along the middle of the level
+static void targetAt(int frame, int *x, int *y) {
+    int span = LEVEL_W - 2 * CELL;
+    int t = (frame * 4) % (2 * span);
+    *x = CELL + (t < span ? t : 2 * span - t);
+    *y = LEVEL_H / 2 + (frame / 40 % 2 ? CELL * 3 : -CELL * 3);
+}
+
+int main(int argc, char *argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 500;
+    int frames = argc > 2 ? atoi(argv[2]) : 300;
+    int failed = 0;
+
+    NavGrid grid;
+    if (initNavGrid(&grid, LEVEL_W, LEVEL_H, CELL) < 0) return 1;
+    buildLevel(&grid);
+    Agent *agents = malloc(count * sizeof(Agent));
+
+    printf("%d agents, %d frames, %dx%d cells\n", count, frames, grid.cols, grid.rows);
+    printf("%-12s %10s %10s\n", "method", "ms/frame", "searches");
+
+    // One A* path per agent
+    placeAgents(&grid, agents, count);
+    Uint64 start = timerNowUs();
+    Uint32 searches = 0;
+    for (int f = 0; f < frames; f++) {
+        int tx, ty;
+        targetAt(f, &tx, &ty);
+        for (int i = 0; i < count; i++) {
+            int nx, ny;
+            if (followNavPath(&grid, &agents[i].path, agents[i].x, agents[i].y, tx, ty, &nx, &ny)) {
+                moveToward(&agents[i], nx, ny);
+            }
+        }
+    }
+    double pathMs = (timerNowUs() - start) / 1000.0 / frames;
+    for (int i = 0; i < count; i++) searches += agents[i].path.searches;
+    printf("%-12s %10.3f %10u\n", "A* paths", pathMs, searches);
+
+    // One field for every agent
+    NavField field;
+    initNavField(&field, &grid);
+    placeAgents(&grid, agents, count);
+    start = timerNowUs();
+    for (int f = 0; f < frames; f++) {
+        int tx, ty;
+        targetAt(f, &tx, &ty);
+        updateNavField(&grid, &field, tx, ty);
+        for (int i = 0; i < count; i++) {
+            int nx, ny;
+            if (navFieldStep(&grid, &field, agents[i].x, agents[i].y, &nx, &ny)) {
+                moveToward(&agents[i], nx, ny);
+            }
+        }
+    }
+    double fieldMs = (timerNowUs() - start) / 1000.0 / frames;
+    printf("%-12s %10.3f %10u  %.1fx faster\n", "flow field", fieldMs, field.updates, pathMs / fieldMs);
+
+    // Same costs both ways, from free cells to the last target
+    int tx, ty, mismatches = 0;
+    targetAt(frames - 1, &tx, &ty);
+    updateNavField(&grid, &field, tx, ty);
+    placeAgents(&grid, agents, count);
+    for (int i = 0; i < count && i < 200; i++) {
+        NavPath path;
+        path.searches = 0;
+        Uint32 fieldCost = navFieldDistance(&grid, &field, agents[i].x, agents[i].y);
+        int found = findNavPath(&grid, agents[i].x, agents[i].y, tx, ty, &path) == 0;
+        Uint32 pathCost = found ? (path.count ? grid.cost[field.targetCell] : 0) : NAV_UNREACHABLE;
+        // A* gives up on paths longer than NAV_MAX_PATH cells (10 or more each)
+        int tooLong = !found && fieldCost != NAV_UNREACHABLE && fieldCost >= NAV_MAX_PATH * 10;
+        if (pathCost != fieldCost && !tooLong) mismatches++;
+    }
+    if (mismatches) {
+        printf("%d paths differ from the field\n", mismatches);
+        failed = 1;
+    }
+
+    freeNavField(&field);
+    freeNavGrid(&grid);
+    free(agents);
+    return failed;
+}
@@ -0,0 +1,300 @@
+// Asset packer: builds the .pak archive read by archive.c
+//
+// Usage: pack [-c] output.pak folder
+//   -c  run-length encode images when it saves at least a quarter of the size
+//
+// Every image under folder is decoded once here and stored as 32-bit pixels,
+// so the game never inflates a PNG, and premultiplied for blitSprite, so
+// sprites are used from the mapping without a conversion. Files with the
+// same content (alagard.ttf, click.wav ...) are stored once.
+
+#include "archive.h"
+#include <SDL/SDL_image.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#define MAX_ITEMS 2048   // Images count twice (pixels and sprite)
+
+typedef struct {
+    ArchiveEntry entry;
+    Uint8 *data;      // Bytes to store (compressed if entry.compression says so)
+    int blob;         // Index of the item whose blob is shared, -1 if its own
+} PackItem;
+
+static PackItem items[MAX_ITEMS];
+static int itemCount = 0;
+static int compress = 0;
+
+static const char *extension(const char *name) {
+    const char *dot = strrchr(name, '.');
+    return dot ? dot + 1 : "";
+}
+
+static int isImage(const char *name) {
+    const char *ext = extension(name);
+    return !strcasecmp(ext, "png") || !strcasecmp(ext, "jpg") ||
+           !strcasecmp(ext, "jpeg") || !strcasecmp(ext, "bmp");
+}
+
+static int isRawAsset(const char *name) {
+    const char *ext = extension(name);
+    return !strcasecmp(ext, "wav") || !strcasecmp(ext, "mp3") ||
+           !strcasecmp(ext, "ogg") || !strcasecmp(ext, "ttf");
+}
+
+static Uint8 *readFile(const char *path, Uint32 *size) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    Uint8 *data = malloc(len > 0 ? len : 1);
+    if (data && fread(data, 1, len, f) != (size_t)len) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    *size = (Uint32)len;
+    return data;
+}
+
+// Convert to the 32-bit format the game blits from: ARGB if the image has
+// any transparency (alpha channel or color key), XRGB otherwise. The unused
+// byte of XRGB is 0xFF, so the pixels are also those of the opaque sprite.
+static SDL_Surface *decodeImage(const char *path) {
+    SDL_Surface *src = IMG_Load(path);
+    if (!src) return NULL;
+
+    int alpha = src->format->Amask != 0 || (src->flags & SDL_SRCCOLORKEY);
+    SDL_Surface *dst = SDL_CreateRGBSurface(SDL_SWSURFACE, src->w, src->h, 32,
+                                            0x00FF0000, 0x0000FF00, 0x000000FF,
+                                            alpha ? 0xFF000000 : 0);
+    if (dst) {
+        SDL_FillRect(dst, NULL, 0);
+        SDL_SetAlpha(src, 0, SDL_ALPHA_OPAQUE);  // Copy the alpha channel, do not blend
+        SDL_BlitSurface(src, NULL, dst, NULL);
+        if (!alpha) {
+            for (int y = 0; y < dst->h; y++) {
+                Uint32 *row = (Uint32 *)((Uint8 *)dst->pixels + y * dst->pitch);
+                for (int x = 0; x < dst->w; x++) row[x] |= 0xFF000000;
+            }
+        }
+    }
+    SDL_FreeSurface(src);
+    return dst;
+}
+
+// x * a / 255 rounded, as makeSprite() does (blit.c)
+static Uint32 premultiply(Uint32 x, Uint32 a) {
+    Uint32 v = x * a + 128;
+    return (v + (v >> 8)) >> 8;
+}
+
+// Premultiply the pixels of an ARGB image in place (blitSprite layout)
+static void premultiplyPixels(Uint32 *pixels, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        Uint32 p = pixels[i], a = p >> 24;
+        pixels[i] = (a << 24) | (premultiply((p >> 16) & 0xFF, a) << 16) |
+                    (premultiply((p >> 8) & 0xFF, a) << 8) | premultiply(p & 0xFF, a);
+    }
+}
+
+static PackItem *newItem(const char *name) {
+    if (itemCount == MAX_ITEMS) {
+        printf("Too many assets, %s skipped\n", name);
+        return NULL;
+    }
+    PackItem *item = &items[itemCount];
+    memset(item, 0, sizeof(*item));
+    strcpy(item->entry.name, name);
+    item->blob = -1;
+    return item;
+}
+
+// Store the pixels of an image (kind ARCHIVE_PIXELS or ARCHIVE_SPRITE)
+static void addPixels(const char *name, SDL_Surface *surface, ArchiveKind kind) {
+    PackItem *item = newItem(name);
+    if (!item) return;
+
+    Uint32 size = surface->pitch * surface->h;
+    item->entry.kind = kind;
+    item->entry.w = surface->w;
+    item->entry.h = surface->h;
+    item->entry.pitch = surface->pitch;
+    item->entry.Rmask = surface->format->Rmask;
+    item->entry.Gmask = surface->format->Gmask;
+    item->entry.Bmask = surface->format->Bmask;
+    item->entry.Amask = kind == ARCHIVE_SPRITE ? 0xFF000000 : surface->format->Amask;
+    item->entry.rawSize = size;
+    item->entry.size = size;
+    item->data = malloc(size);
+    memcpy(item->data, surface->pixels, size);
+    if (kind == ARCHIVE_SPRITE && surface->format->Amask) {
+        premultiplyPixels((Uint32 *)item->data, size / 4);
+    }
+    item->entry.hash = archiveHash(item->data, size);
+
+    if (compress) {
+        // Worst case: one header word per literal word
+        Uint32 *rle = malloc(size * 2 + 8);
+        size_t words = archiveRleEncode((Uint32 *)item->data, size / 4, rle);
+        if (words * 4 <= size - size / 4) {
+            free(item->data);
+            item->data = (Uint8 *)rle;
+            item->entry.size = (Uint32)(words * 4);
+            item->entry.compression = ARCHIVE_RLE;
+        } else {
+            free(rle);
+        }
+    }
+    itemCount++;
+}
+
+static void addItem(const char *path, const char *name) {
+    if (strlen(name) >= ARCHIVE_NAME_MAX) {
+        printf("Name too long, %s skipped\n", name);
+        return;
+    }
+
+    if (isImage(name)) {
+        SDL_Surface *surface = decodeImage(path);
+        if (!surface) {
+            printf("Cannot decode %s: %s\n", path, IMG_GetError());
+            return;
+        }
+        addPixels(name, surface, ARCHIVE_PIXELS);
+        addPixels(name, surface, ARCHIVE_SPRITE);
+        SDL_FreeSurface(surface);
+    } else {
+        PackItem *item = newItem(name);
+        if (!item) return;
+        item->data = readFile(path, &item->entry.size);
+        if (!item->data) {
+            printf("Cannot read %s\n", path);
+            return;
+        }
+        item->entry.kind = ARCHIVE_RAW;
+        item->entry.rawSize = item->entry.size;
+        item->entry.hash = archiveHash(item->data, item->entry.size);
+        itemCount++;
+    }
+}
+
+static void scanFolder(const char *folder, const char *prefix) {
+    DIR *dir = opendir(folder);
+    if (!dir) return;
+
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] == '.') continue;  // ., .. and .git
+
+        char path[1024], name[1024];
+        snprintf(path, sizeof(path), "%s/%s", folder, ent->d_name);
+        snprintf(name, sizeof(name), "%s%s", prefix, ent->d_name);
+
+        struct stat st;
+        if (stat(path, &st) < 0) continue;
+        if (S_ISDIR(st.st_mode)) {
+            char sub[1024];
+            snprintf(sub, sizeof(sub), "%s/", name);
+            scanFolder(path, sub);
+        } else if (isImage(name) || isRawAsset(name)) {
+            addItem(path, name);
+        }
+    }
+    closedir(dir);
+}
+
+// Same order as the lookups of archive.c: name, then kind
+static int compareItems(const void *a, const void *b) {
+    const ArchiveEntry *x = &((const PackItem *)a)->entry, *y = &((const PackItem *)b)->entry;
+    int order = strcmp(x->name, y->name);
+    return order ? order : (int)x->kind - (int)y->kind;
+}
+
+// Blobs are shared on their bytes alone: each entry keeps its own size and masks
+static int sameContent(const PackItem *a, const PackItem *b) {
+    const ArchiveEntry *x = &a->entry, *y = &b->entry;
+    return x->hash == y->hash && x->size == y->size && x->compression == y->compression &&
+           memcmp(a->data, b->data, x->size) == 0;
+}
+
+static void padTo(FILE *f, long align) {
+    long pos = ftell(f);
+    while (pos % align) {
+        fputc(0, f);
+        pos++;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int arg = 1;
+    if (arg < argc && strcmp(argv[arg], "-c") == 0) {
+        compress = 1;
+        arg++;
+    }
+    if (argc - arg != 2) {
+        printf("Usage: %s [-c] output.pak folder\n", argv[0]);
+        return 1;
+    }
+    const char *output = argv[arg];
+    const char *folder = argv[arg + 1];
+
+    scanFolder(folder, "");
+    qsort(items, itemCount, sizeof(PackItem), compareItems);
+
+    FILE *f = fopen(output, "wb");
+    if (!f) {
+        printf("Cannot write %s\n", output);
+        return 1;
+    }
+
+    ArchiveHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    header.byteOrder = ARCHIVE_BYTE_ORDER;
+    header.version = ARCHIVE_VERSION;
+    header.entryCount = itemCount;
+    fwrite(&header, sizeof(header), 1, f);
+
+    Uint64 sourceBytes = 0, storedBytes = 0;
+    for (int i = 0; i < itemCount; i++) {
+        PackItem *item = &items[i];
+        sourceBytes += item->entry.size;
+        for (int j = 0; j < i; j++) {
+            if (items[j].blob < 0 && sameContent(&items[j], item)) {
+                item->blob = j;
+                item->entry.offset = items[j].entry.offset;
+                break;
+            }
+        }
+        if (item->blob >= 0) continue;
+
+        // Each blob starts on a page so mapped pixels are page aligned
+        padTo(f, ARCHIVE_ALIGN);
+        item->entry.offset = ftell(f);
+        fwrite(item->data, 1, item->entry.size, f);
+        storedBytes += item->entry.size;
+        header.blobCount++;
+    }
+
+    padTo(f, 8);
+    header.indexOffset = ftell(f);
+    for (int i = 0; i < itemCount; i++) {
+        fwrite(&items[i].entry, sizeof(ArchiveEntry), 1, f);
+    }
+    fseek(f, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, f);
+    fclose(f);
+
+    printf("%s: %d assets, %u blobs, %.1f MB stored (%.1f MB before deduplication)\n",
+           output, itemCount, header.blobCount,
+           storedBytes / (1024.0 * 1024.0), sourceBytes / (1024.0 * 1024.0));
+
+    for (int i = 0; i < itemCount; i++) free(items[i].data);
+    return 0;
+}
@@ -0,0 +1,86 @@
+// Benchmark of the particle pool
+//
+// Usage: particlebench [particles] [frames]
+//
+// Keeps about that many particles alive (bursts of 64 living 40 to 80
+// frames) over a 1600x900 surface, and times one frame of integration with
+// the scalar loop and with SSE2, then the drawing. Both integrations must
+// give the same particles.
+
+#include "particles.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SCREEN_W 1600
+#define SCREEN_H 900
+#define FRAME_BUDGET_MS 16.7
+
+static const ParticleEffect burst = {64, 0.0f, -3.0f, 4.0f, 40, 80, 0xFFC040, 2};
+
+// Run the frames, emitting enough bursts to stay near the target count.
+// Returns the update time per frame in ms; the draw time goes to drawMs.
+static double run(ParticlePool *pool, SDL_Surface *screen, int target, int frames, double *drawMs) {
+    Uint64 updateUs = 0, drawUs = 0;
+    int bursts = 0;
+    for (int f = 0; f < frames; f++) {
+        while (pool->count + burst.count <= target) {
+            float x = (float)(bursts * 97 % SCREEN_W);
+            float y = (float)(SCREEN_H / 2 + bursts * 31 % (SCREEN_H / 2));
+            emitParticles(pool, &burst, x, y);
+            bursts++;
+        }
+
+        Uint64 start = timerNowUs();
+        updateParticles(pool);
+        updateUs += timerNowUs() - start;
+
+        if (screen) {
+            start = timerNowUs();
+            drawParticles(pool, screen, NULL);
+            drawUs += timerNowUs() - start;
+        }
+    }
+    if (drawMs) *drawMs = drawUs / 1000.0 / frames;
+    return updateUs / 1000.0 / frames;
+}
+
+int main(int argc, char *argv[]) {
+    int target = argc > 1 ? atoi(argv[1]) : 50000;
+    int frames = argc > 2 ? atoi(argv[2]) : 300;
+
+    SDL_Surface *screen = SDL_CreateRGBSurface(SDL_SWSURFACE, SCREEN_W, SCREEN_H, 32,
+                                               0x00FF0000, 0x0000FF00, 0x000000FF, 0);
+    ParticlePool scalar, simd;
+    if (!screen || initParticles(&scalar, target) < 0 || initParticles(&simd, target) < 0) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    scalar.scalar = 1;
+
+    printf("%d particles, %d frames\n", target, frames);
+    printf("%-10s %10s %10s\n", "step", "ms/frame", "% budget");
+
+    double scalarMs = run(&scalar, NULL, target, frames, NULL);
+    printf("%-10s %10.3f %9.1f%%\n", "scalar", scalarMs, scalarMs * 100 / FRAME_BUDGET_MS);
+
+    double drawMs;
+    double simdMs = run(&simd, screen, target, frames, &drawMs);
+    printf("%-10s %10.3f %9.1f%%  %.1fx faster\n", "sse2", simdMs, simdMs * 100 / FRAME_BUDGET_MS,
+           scalarMs / simdMs);
+    printf("%-10s %10.3f %9.1f%%\n", "draw", drawMs, drawMs * 100 / FRAME_BUDGET_MS);
+
+    // Same emissions and the same float operations: the pools must match
+    int failed = scalar.count != simd.count ||
+                 memcmp(scalar.x, simd.x, scalar.count * sizeof(float)) != 0 ||
+                 memcmp(scalar.y, simd.y, scalar.count * sizeof(float)) != 0 ||
+                 memcmp(scalar.life, simd.life, scalar.count * sizeof(float)) != 0;
+    if (failed) printf("The scalar and SSE2 particles differ\n");
+    printf("%d alive, %u dropped\n", simd.count, simd.dropped);
+
+    freeParticles(&scalar);
+    freeParticles(&simd);
+    SDL_FreeSurface(screen);
+    return failed;
+}
@@ -0,0 +1,216 @@
+#include "particles.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PARTICLES_X86
+#include <immintrin.h>
+#endif
+
+int initParticles(ParticlePool *pool, int capacity) {
+    memset(pool, 0, sizeof(*pool));
+    if (capacity < 4) capacity = 4;
+    capacity = (capacity + 3) & ~3;
+
+    // Six float arrays, then the colors and the sizes: 16-byte aligned
+    // starts for the SIMD loads
+    size_t floats = (size_t)capacity * sizeof(float);
+    size_t bytes = 6 * floats + (size_t)capacity * (sizeof(Uint32) + 1);
+    Uint8 *block = NULL;
+    if (posix_memalign((void **)&block, 16, bytes) != 0) return -1;
+    memset(block, 0, bytes);
+
+    pool->block = block;
+    pool->x = (float *)block;
+    pool->y = (float *)(block + floats);
+    pool->vx = (float *)(block + 2 * floats);
+    pool->vy = (float *)(block + 3 * floats);
+    pool->life = (float *)(block + 4 * floats);
+    pool->fade = (float *)(block + 5 * floats);
+    pool->color = (Uint32 *)(block + 6 * floats);
+    pool->size = block + 6 * floats + (size_t)capacity * sizeof(Uint32);
+    pool->capacity = capacity;
+    pool->gravity = 0.25f;
+    pool->drag = 0.96f;
+    pool->seed = 0x2545F491;
+    return 0;
+}
+
+void freeParticles(ParticlePool *pool) {
+    free(pool->block);
+    memset(pool, 0, sizeof(*pool));
+}
+
+void clearParticles(ParticlePool *pool) {
+    pool->count = 0;
+}
+
+// xorshift32, separate from the game's sequence
+static Uint32 nextSeed(ParticlePool *pool) {
+    Uint32 s = pool->seed;
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return pool->seed = s;
+}
+
+// -1 .. 1
+static float randomUnit(ParticlePool *pool) {
+    return (float)(nextSeed(pool) >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+int emitParticles(ParticlePool *pool, const ParticleEffect *effect, float x, float y) {
+    int count = effect->count;
+    if (count > pool->capacity - pool->count) {
+        pool->dropped += count - (pool->capacity - pool->count);
+        count = pool->capacity - pool->count;
+    }
+    int lifeRange = effect->lifeMax - effect->lifeMin + 1;
+    int size = effect->size < 1 ? 1 : (effect->size > PARTICLE_MAX_SIZE ? PARTICLE_MAX_SIZE : effect->size);
+
+    for (int n = 0; n < count; n++) {
+        // Random point in the unit disk (no trigonometry)
+        float rx, ry;
+        do {
+            rx = randomUnit(pool);
+            ry = randomUnit(pool);
+        } while (rx * rx + ry * ry > 1.0f);
+
+        int i = pool->count++;
+        int life = effect->lifeMin + (lifeRange > 1 ? (int)(nextSeed(pool) % (Uint32)lifeRange) : 0);
+        if (life < 1) life = 1;
+        pool->x[i] = x;
+        pool->y[i] = y;
+        pool->vx[i] = effect->dirX + rx * effect->spread;
+        pool->vy[i] = effect->dirY + ry * effect->spread;
+        pool->life[i] = (float)life;
+        pool->fade[i] = 1.0f / (float)life;
+        pool->color[i] = effect->color & 0x00FFFFFF;
+        pool->size[i] = (Uint8)size;
+    }
+    return count;
+}
+
+static void integrateScalar(ParticlePool *pool) {
+    float gravity = pool->gravity, drag = pool->drag;
+    for (int i = 0; i < pool->count; i++) {
+        pool->x[i] += pool->vx[i];
+        pool->y[i] += pool->vy[i];
+        pool->vx[i] *= drag;
+        pool->vy[i] = (pool->vy[i] + gravity) * drag;
+        pool->life[i] -= 1.0f;
+    }
+}
+
+#ifdef PARTICLES_X86
+__attribute__((target("sse2")))
+static void integrateSSE2(ParticlePool *pool) {
+    const __m128 gravity = _mm_set1_ps(pool->gravity);
+    const __m128 drag = _mm_set1_ps(pool->drag);
+    const __m128 one = _mm_set1_ps(1.0f);
+    // The arrays hold a multiple of 4 slots: the last group may run over
+    // free slots, which are rewritten when emitted
+    int end = (pool->count + 3) & ~3;
+    for (int i = 0; i < end; i += 4) {
+        __m128 vx = _mm_load_ps(pool->vx + i);
+        __m128 vy = _mm_load_ps(pool->vy + i);
+        _mm_store_ps(pool->x + i, _mm_add_ps(_mm_load_ps(pool->x + i), vx));
+        _mm_store_ps(pool->y + i, _mm_add_ps(_mm_load_ps(pool->y + i), vy));
+        _mm_store_ps(pool->vx + i, _mm_mul_ps(vx, drag));
+        _mm_store_ps(pool->vy + i, _mm_mul_ps(_mm_add_ps(vy, gravity), drag));
+        _mm_store_ps(pool->life + i, _mm_sub_ps(_mm_load_ps(pool->life + i), one));
+    }
+}
+#endif
+
+void updateParticles(ParticlePool *pool) {
+#ifdef PARTICLES_X86
+    static int sse2 = -1;
+    if (sse2 < 0) sse2 = __builtin_cpu_supports("sse2");
+    if (sse2 && !pool->scalar) {
+        integrateSSE2(pool);
+    } else
+#endif
+    {
+        integrateScalar(pool);
+    }
+
+    // Remove the dead particles, the last one taking each free slot
+    int i = 0;
+    while (i < pool->count) {
+        if (pool->life[i] > 0.0f) {
+            i++;
+            continue;
+        }
+        int last = --pool->count;
+        pool->x[i] = pool->x[last];
+        pool->y[i] = pool->y[last];
+        pool->vx[i] = pool->vx[last];
+        pool->vy[i] = pool->vy[last];
+        pool->life[i] = pool->life[last];
+        pool->fade[i] = pool->fade[last];
+        pool->color[i] = pool->color[last];
+        pool->size[i] = pool->size[last];
+    }
+}
+
+// (c * a + d * (255 - a)) / 255 on two channels in the 0x00FF00FF lanes
+static inline Uint32 mixPair(Uint32 c, Uint32 d, Uint32 a) {
+    Uint32 v = c * a + d * (255 - a) + 0x00800080;
+    return ((v + ((v >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+}
+
+int drawParticles(ParticlePool *pool, SDL_Surface *screen, const Camera *camera) {
+    if (!pool->count) return 0;
+
+    int offsetX = camera ? camera->viewport.x - camera->x : 0;
+    int offsetY = camera ? camera->viewport.y - camera->y : 0;
+    SDL_Rect clip = screen->clip_rect;
+    int clipRight = clip.x + clip.w, clipBottom = clip.y + clip.h;
+    SDL_PixelFormat *format = screen->format;
+    int direct = format->BytesPerPixel == 4;
+    int drawn = 0;
+
+    if (direct && SDL_MUSTLOCK(screen) && SDL_LockSurface(screen) < 0) return 0;
+
+    for (int i = 0; i < pool->count; i++) {
+        int size = pool->size[i];
+        int left = (int)pool->x[i] + offsetX - size / 2;
+        int top = (int)pool->y[i] + offsetY - size / 2;
+        int right = left + size, bottom = top + size;
+        if (left < clip.x) left = clip.x;
+        if (top < clip.y) top = clip.y;
+        if (right > clipRight) right = clipRight;
+        if (bottom > clipBottom) bottom = clipBottom;
+        if (left >= right || top >= bottom) continue;
+        drawn++;
+
+        Uint32 rgb = pool->color[i];
+        Uint8 r = (Uint8)(rgb >> 16), g = (Uint8)(rgb >> 8), b = (Uint8)rgb;
+        if (!direct) {
+            SDL_Rect square = {(Sint16)left, (Sint16)top, (Uint16)(right - left), (Uint16)(bottom - top)};
+            SDL_FillRect(screen, &square, SDL_MapRGB(format, r, g, b));
+            continue;
+        }
+
+        // Opacity follows the remaining life
+        float alpha = pool->life[i] * pool->fade[i];
+        Uint32 a = alpha >= 1.0f ? 255 : (Uint32)(alpha * 255.0f);
+        Uint32 pixel = ((Uint32)(r >> format->Rloss) << format->Rshift) |
+                       ((Uint32)(g >> format->Gloss) << format->Gshift) |
+                       ((Uint32)(b >> format->Bloss) << format->Bshift);
+        Uint32 pixelRB = pixel & 0x00FF00FF, pixelAG = (pixel >> 8) & 0x00FF00FF;
+
+        for (int y = top; y < bottom; y++) {
+            Uint32 *row = (Uint32 *)((Uint8 *)screen->pixels + y * screen->pitch);
+            for (int x = left; x < right; x++) {
+                Uint32 d = row[x];
+                row[x] = mixPair(pixelRB, d & 0x00FF00FF, a) |
+                         (mixPair(pixelAG, (d >> 8) & 0x00FF00FF, a) << 8);
+            }
+        }
+    }
+
+    if (direct && SDL_MUSTLOCK(screen)) SDL_UnlockSurface(screen);
+    return drawn;
+}
@@ -0,0 +1,67 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <SDL/SDL.h>
+#include "camera.h"
+
+// Particle effects (hits, damage, deaths).
+//
+// The pool is allocated once with a fixed capacity and stores each property
+// in its own array, so one frame of integration is a few straight passes
+// over floats (4 particles per SSE2 instruction). Emitting never allocates:
+// when the pool is full the extra particles are dropped and counted. Dead
+// particles are removed by moving the last one into their slot.
+//
+// Particles are small squares filled directly in the screen pixels, fading
+// with their remaining life. They are drawn after endComposite(), over the
+// sprites, within the screen's clip rectangle.
+//
+// Effects use their own random numbers, so spawning them does not change the
+// game's sequence (see random.h) and replays stay identical.
+
+#define PARTICLE_MAX_SIZE 4
+
+typedef struct {
+    int count;             // Particles per burst
+    float dirX, dirY;      // Mean velocity, pixels per frame
+    float spread;          // Random velocity added, up to this length
+    int lifeMin, lifeMax;  // Frames
+    Uint32 color;          // 0xRRGGBB
+    int size;              // Side of the square, 1 .. PARTICLE_MAX_SIZE
+} ParticleEffect;
+
+typedef struct {
+    int capacity;          // Multiple of 4
+    int count;
+    float *x, *y;          // Level position
+    float *vx, *vy;
+    float *life;           // Frames left
+    float *fade;           // 1 / starting life
+    Uint32 *color;
+    Uint8 *size;
+    void *block;           // The single allocation behind the arrays
+
+    float gravity;         // Added to vy every frame
+    float drag;            // Velocity kept every frame
+    Uint32 seed;
+    int scalar;            // Integrate without SIMD (for comparisons)
+    Uint32 dropped;        // Particles not emitted because the pool was full
+} ParticlePool;
+
+// -1 if out of memory
+int initParticles(ParticlePool *pool, int capacity);
+void freeParticles(ParticlePool *pool);
+void clearParticles(ParticlePool *pool);
+
+// Burst of effect->count particles at a level position. Returns the number
+// emitted.
+int emitParticles(ParticlePool *pool, const ParticleEffect *effect, float x, float y);
+
+// One frame: move every particle and remove the dead ones
+void updateParticles(ParticlePool *pool);
+
+// Draw the particles seen by the camera (NULL = level position is screen
+// position). Returns the number drawn.
+int drawParticles(ParticlePool *pool, SDL_Surface *screen, const Camera *camera);
+
+#endif
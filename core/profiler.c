@@ -0,0 +1,240 @@
+#include "profiler.h"
+#include "timer.h"
+#include "text.h"
+#include <SDL/SDL_thread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int profilerEnabled = 0;
+
+typedef struct {
+    const char *name;
+    Uint32 lastUs;      // Total time in the last frame
+} ZoneTotal;
+
+static ProfileEvent ring[PROFILE_RING_SIZE];
+static volatile Uint32 ringHead = 0;     // Next sequence number
+static __thread int zoneDepth = 0;
+
+static Uint64 frameStartUs = 0;
+static Uint32 history[PROFILE_HISTORY];  // Frame times in microseconds
+static int historyPos = 0;
+static ZoneTotal zones[PROFILE_MAX_ZONES];
+static int zoneCount = 0;
+
+typedef struct {
+    const char *name;
+    int value;
+} Counter;
+
+static Counter counters[PROFILE_MAX_COUNTERS];
+static int counterCount = 0;
+
+static int overlayVisible = 0;
+static int profilerUsed = 0;
+static int profileWholeRun = 0;   // Set by PROFILE: recording does not follow the overlay
+static TTF_Font *overlayFont = NULL;
+
+void initProfiler(void) {
+    if (getenv("PROFILE")) {
+        profileWholeRun = 1;
+        profilerSetEnabled(1);
+    }
+}
+
+void closeProfiler(void) {
+    if (profilerUsed) {
+        profilerWriteTrace(PROFILE_TRACE_FILE);
+    }
+    profilerEnabled = 0;
+}
+
+void profilerSetEnabled(int enabled) {
+    profilerEnabled = enabled;
+    if (enabled) {
+        profilerUsed = 1;
+        frameStartUs = timerNowUs();
+    }
+}
+
+int profileBegin(const char *name) {
+    // Every thread gets its own slot, no lock needed
+    Uint32 seq = __sync_fetch_and_add(&ringHead, 1);
+    ProfileEvent *event = &ring[seq & (PROFILE_RING_SIZE - 1)];
+
+    event->name = name;
+    event->durUs = 0;
+    event->thread = SDL_ThreadID();
+    event->depth = zoneDepth++;
+    event->startUs = timerNowUs();
+    event->seq = seq;
+    return (int)(seq & 0x7fffffff);
+}
+
+void profileEnd(int zone) {
+    ProfileEvent *event = &ring[zone & (PROFILE_RING_SIZE - 1)];
+    zoneDepth--;
+    // The slot was reused if the zone lasted more than a whole ring of events
+    if ((event->seq & 0x7fffffff) != (Uint32)zone) return;
+    Uint64 dur = timerNowUs() - event->startUs;
+    event->durUs = dur > 0 ? (Uint32)dur : 1;
+}
+
+static void addZoneTime(const char *name, Uint32 us) {
+    for (int i = 0; i < zoneCount; i++) {
+        if (zones[i].name == name) {
+            zones[i].lastUs += us;
+            return;
+        }
+    }
+    if (zoneCount < PROFILE_MAX_ZONES) {
+        zones[zoneCount].name = name;
+        zones[zoneCount].lastUs = us;
+        zoneCount++;
+    }
+}
+
+void profileFrame(void) {
+    Uint64 now = timerNowUs();
+    history[historyPos] = (Uint32)(now - frameStartUs);
+    historyPos = (historyPos + 1) % PROFILE_HISTORY;
+
+    // Zone totals of the frame that just ended, for the overlay
+    if (overlayVisible) {
+        for (int i = 0; i < zoneCount; i++) zones[i].lastUs = 0;
+        Uint32 head = ringHead;
+        for (Uint32 n = 1; n <= PROFILE_RING_SIZE && n <= head; n++) {
+            ProfileEvent *event = &ring[(head - n) & (PROFILE_RING_SIZE - 1)];
+            if (event->startUs < frameStartUs) break;
+            if (event->durUs) addZoneTime(event->name, event->durUs);
+        }
+    }
+    frameStartUs = now;
+}
+
+void profilerSetCounter(const char *name, int value) {
+    for (int i = 0; i < counterCount; i++) {
+        if (counters[i].name == name || strcmp(counters[i].name, name) == 0) {
+            counters[i].value = value;
+            return;
+        }
+    }
+    if (counterCount == PROFILE_MAX_COUNTERS) return;
+    counters[counterCount].name = name;
+    counters[counterCount].value = value;
+    counterCount++;
+}
+
+int profilerHandleEvent(SDL_Event *event) {
+    if (event->type != SDL_KEYDOWN) return 0;
+
+    switch (event->key.keysym.sym) {
+        case SDLK_F3:
+            // Recording costs time in every zone, so it stops with the overlay
+            overlayVisible = !overlayVisible;
+            if (overlayVisible || !profileWholeRun) profilerSetEnabled(overlayVisible);
+            return 1;
+        case SDLK_F4:
+            if (!profilerEnabled) {
+                printf("Profiler is off, press F3 first\n");
+            } else {
+                profilerWriteTrace(PROFILE_TRACE_FILE);
+            }
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+void profilerSetFont(TTF_Font *font) {
+    overlayFont = font;
+}
+
+void drawProfilerOverlay(SDL_Surface *screen) {
+    if (!overlayVisible) return;
+
+    const int barW = 3;
+    const int graphH = 100;
+    const Uint32 fullScaleUs = 33333;   // Top of the graph: 30 fps
+    SDL_Rect box = {(Sint16)(screen->w - PROFILE_HISTORY * barW - 20), 10,
+                    PROFILE_HISTORY * barW + 10, 0};
+
+    if (overlayFont) {
+        box.h = graphH + 20 + (zoneCount + counterCount + 1) * 16;
+    } else {
+        box.h = graphH + 20 + zoneCount * 8;
+    }
+    SDL_FillRect(screen, &box, SDL_MapRGB(screen->format, 20, 20, 20));
+
+    Uint32 green = SDL_MapRGB(screen->format, 60, 200, 60);
+    Uint32 red = SDL_MapRGB(screen->format, 220, 50, 50);
+    int graphBottom = box.y + 5 + graphH;
+
+    // Frame times, oldest on the left
+    for (int i = 0; i < PROFILE_HISTORY; i++) {
+        Uint32 us = history[(historyPos + i) % PROFILE_HISTORY];
+        int h = (int)((Uint64)us * graphH / fullScaleUs);
+        if (h > graphH) h = graphH;
+        SDL_Rect bar = {(Sint16)(box.x + 5 + i * barW), (Sint16)(graphBottom - h), barW - 1, (Uint16)h};
+        SDL_FillRect(screen, &bar, us > 16667 ? red : green);
+    }
+
+    // 60 fps budget line
+    SDL_Rect budget = {(Sint16)(box.x + 5), (Sint16)(graphBottom - graphH / 2), PROFILE_HISTORY * barW, 1};
+    SDL_FillRect(screen, &budget, SDL_MapRGB(screen->format, 255, 255, 255));
+
+    // Zone breakdown of the last frame
+    int y = graphBottom + 10;
+    Uint32 lastFrame = history[(historyPos + PROFILE_HISTORY - 1) % PROFILE_HISTORY];
+    if (overlayFont) {
+        SDL_Color white = {255, 255, 255, 0};
+        char line[64];
+        snprintf(line, sizeof(line), "frame %.2f ms", lastFrame / 1000.0f);
+        renderText(screen, line, box.x + 5, y, white, overlayFont);
+        for (int i = 0; i < zoneCount; i++) {
+            y += 16;
+            snprintf(line, sizeof(line), "%-12s %6.2f ms", zones[i].name, zones[i].lastUs / 1000.0f);
+            renderText(screen, line, box.x + 5, y, white, overlayFont);
+        }
+        for (int i = 0; i < counterCount; i++) {
+            y += 16;
+            snprintf(line, sizeof(line), "%-12s %6d", counters[i].name, counters[i].value);
+            renderText(screen, line, box.x + 5, y, white, overlayFont);
+        }
+    } else {
+        for (int i = 0; i < zoneCount; i++) {
+            int w = lastFrame ? (int)((Uint64)zones[i].lastUs * (PROFILE_HISTORY * barW) / lastFrame) : 0;
+            SDL_Rect bar = {(Sint16)(box.x + 5), (Sint16)y, (Uint16)w, 6};
+            SDL_FillRect(screen, &bar, SDL_MapRGB(screen->format, 80 + 40 * (i % 4), 120, 200 - 30 * (i % 5)));
+            y += 8;
+        }
+    }
+}
+
+int profilerWriteTrace(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        printf("Cannot write %s\n", path);
+        return -1;
+    }
+
+    Uint32 head = ringHead;
+    Uint32 first = head > PROFILE_RING_SIZE ? head - PROFILE_RING_SIZE : 0;
+    int written = 0;
+
+    fprintf(f, "{\"traceEvents\":[\n");
+    for (Uint32 seq = first; seq < head; seq++) {
+        ProfileEvent *event = &ring[seq & (PROFILE_RING_SIZE - 1)];
+        if (event->seq != seq || event->durUs == 0) continue;
+        fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%u,\"pid\":1,\"tid\":%u}",
+                written ? ",\n" : "", event->name, (unsigned long long)event->startUs,
+                event->durUs, event->thread);
+        written++;
+    }
+    fprintf(f, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(f);
+
+    printf("Profiler trace: %d events written to %s\n", written, path);
+    return 0;
+}
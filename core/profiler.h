@@ -0,0 +1,73 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <SDL/SDL.h>
+#include <SDL/SDL_ttf.h>
+
+// Frame profiler: timing zones recorded into a ring buffer, an overlay with
+// the frame time graph and the zones of the last frame (F3), and a dump to
+// Chrome trace JSON (F4, open it in chrome://tracing or Perfetto).
+//
+//   int zone = PROFILE_BEGIN("update");
+//   ...
+//   PROFILE_END(zone);
+//
+// While the profiler is disabled a zone costs one test of profilerEnabled.
+// Build with -DNO_PROFILER to remove it completely.
+
+#define PROFILE_RING_SIZE 16384   // Events kept (power of 2)
+#define PROFILE_HISTORY 120       // Frames shown in the graph
+#define PROFILE_MAX_ZONES 24      // Distinct zone names in the breakdown
+#define PROFILE_MAX_COUNTERS 8    // Values shown under the zones (culled entities ...)
+#define PROFILE_TRACE_FILE "profile_trace.json"
+
+typedef struct {
+    const char *name;   // Must be a string literal (the pointer is stored)
+    Uint64 startUs;
+    Uint32 durUs;       // 0 while the zone is open
+    Uint32 thread;
+    Uint32 seq;         // Ring index that wrote the event
+    int depth;          // Nesting level on its thread
+} ProfileEvent;
+
+extern int profilerEnabled;
+
+#ifdef NO_PROFILER
+#define PROFILE_BEGIN(name) (-1)
+#define PROFILE_END(zone) ((void)(zone))
+#define PROFILE_FRAME() ((void)0)
+#else
+#define PROFILE_BEGIN(name) (profilerEnabled ? profileBegin(name) : -1)
+#define PROFILE_END(zone) do { if ((zone) >= 0) profileEnd(zone); } while (0)
+#define PROFILE_FRAME() do { if (profilerEnabled) profileFrame(); } while (0)
+#endif
+
+// Enabled from the start if the PROFILE environment variable is set
+void initProfiler(void);
+// Writes the trace if the profiler was used
+void closeProfiler(void);
+
+void profilerSetEnabled(int enabled);
+
+// Safe to call from any thread (the ring is lock free)
+int profileBegin(const char *name);
+void profileEnd(int zone);
+
+// Call once per frame, after the flip
+void profileFrame(void);
+
+// Value shown in the overlay until it is set again. name must be a string literal.
+void profilerSetCounter(const char *name, int value);
+
+// F3: overlay on/off (turns the profiler on and off, unless PROFILE keeps it
+// on for the whole run), F4: write the trace.
+// Returns 1 if the event was used.
+int profilerHandleEvent(SDL_Event *event);
+
+// Font for the zone names; without it only the bars are drawn
+void profilerSetFont(TTF_Font *font);
+void drawProfilerOverlay(SDL_Surface *screen);
+
+int profilerWriteTrace(const char *path);
+
+#endif
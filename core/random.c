@@ -0,0 +1,40 @@
+#include "random.h"
+#include <time.h>
+
+static Uint32 seed = 1;
+static Uint32 state = 1;
+
+void seedRandom(Uint32 value) {
+    seed = value;
+    state = value ? value : 0x9E3779B9u;  // xorshift never leaves 0
+}
+
+Uint32 randomSeed(void) {
+    return seed;
+}
+
+Uint32 timeSeed(void) {
+    Uint32 value = (Uint32)time(NULL) ^ SDL_GetTicks();
+    return value ? value : 1;
+}
+
+Uint32 randomState(void) {
+    return state;
+}
+
+void setRandomState(Uint32 value) {
+    state = value ? value : 0x9E3779B9u;
+}
+
+// xorshift32
+Uint32 randomNext(void) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+int randomInt(int n) {
+    if (n <= 0) return 0;
+    return (int)(randomNext() % (Uint32)n);
+}
@@ -0,0 +1,24 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <SDL/SDL.h>
+
+// Seeded random numbers for the game logic. Unlike rand(), the sequence only
+// depends on the seed (same on every platform and C library), so a replay
+// that stores the seed gets the same numbers again.
+
+void seedRandom(Uint32 seed);
+// Seed given to the last seedRandom()
+Uint32 randomSeed(void);
+// Seed for a new game when nothing is being replayed
+Uint32 timeSeed(void);
+
+// Position in the sequence, saved with the game to continue it after a load
+Uint32 randomState(void);
+void setRandomState(Uint32 value);
+
+Uint32 randomNext(void);
+// 0 .. n - 1 (0 if n <= 0)
+int randomInt(int n);
+
+#endif
@@ -0,0 +1,194 @@
+// Benchmark of the render queue
+//
+// Usage: renderbench [frames]
+//
+// 1000 to 64000 entities drawn from 16 sprite sheets (32x32 frames) at
+// random places on a 1600x900 screen, y-sorted, plus a HUD icon for one
+// entity in 8 (one layer, key 0, grouped by sheet). Prints per frame the
+// cost of recording the draws, of the radix sort against qsort, of drawing
+// in submission order against flushing the queue, and the number of runs
+// of draws from the same sheet either way. The radix order must be the
+// qsort order (key, then submission), and the flushed frame must have the
+// bytes of the same draws made directly in that order.
+
+#include "renderqueue.h"
+#include "blit.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SCREEN_W 1600
+#define SCREEN_H 900
+#define SHEETS 16
+#define FRAME 32
+#define SHEET_FRAMES 8    // Frames per sheet side
+#define LAYER_ENTITIES 1
+#define LAYER_HUD 2
+
+static const int counts[] = {1000, 4000, 16000, 64000};
+
+typedef struct {
+    int sheet, frame, x, y;
+} Entity;
+
+typedef struct {
+    Uint32 key, index;
+} SortItem;
+
+static SDL_Surface *makeSheet(void) {
+    int size = FRAME * SHEET_FRAMES;
+    SDL_Surface *image = SDL_CreateRGBSurface(SDL_SWSURFACE, size, size, 32, SPRITE_RMASK, SPRITE_GMASK,
+                                              SPRITE_BMASK, SPRITE_AMASK);
+    for (int y = 0; y < size; y++) {
+        Uint32 *row = (Uint32 *)((Uint8 *)image->pixels + y * image->pitch);
+        for (int x = 0; x < size; x++) {
+            Uint32 a = (x % FRAME < 4 || y % FRAME < 4) ? 0 : 128 + (Uint32)(rand() & 0x7F);
+            row[x] = (a << 24) | ((Uint32)rand() & 0x00FFFFFF);
+        }
+    }
+    SDL_Surface *sheet = makeSprite(image);
+    SDL_FreeSurface(image);
+    return sheet;
+}
+
+static SDL_Rect frameRect(int frame) {
+    SDL_Rect r = {(Sint16)(frame % SHEET_FRAMES * FRAME), (Sint16)(frame / SHEET_FRAMES * FRAME), FRAME, FRAME};
+    return r;
+}
+
+// The frame as the systems draw it: entities, then the HUD
+static void drawEntities(RenderQueue *queue, SDL_Surface *screen, SDL_Surface **sheets,
+                         const Entity *entities, int count) {
+    for (int i = 0; i < count; i++) {
+        const Entity *e = &entities[i];
+        if (queue) setRenderOrder(queue, LAYER_ENTITIES, e->y + FRAME, 1);
+        SDL_Rect src = frameRect(e->frame), pos = {(Sint16)e->x, (Sint16)e->y, 0, 0};
+        blitSprite(sheets[e->sheet], &src, screen, &pos);
+    }
+    if (queue) setRenderOrder(queue, LAYER_HUD, 0, 1);
+    for (int i = 0; i < count; i += 8) {
+        const Entity *e = &entities[i];
+        SDL_Rect src = frameRect(0), pos = {(Sint16)(i / 8 % 50 * FRAME), (Sint16)(i / 400 % 4 * FRAME), 0, 0};
+        blitSprite(sheets[e->sheet], &src, screen, &pos);
+    }
+}
+
+static int compareItems(const void *a, const void *b) {
+    const SortItem *x = a, *y = b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return x->index < y->index ? -1 : (x->index > y->index);
+}
+
+static int sheetRuns(const RenderQueue *queue, const Uint32 *order, int n) {
+    int runs = 0;
+    for (int i = 0; i < n; i++) {
+        SDL_Surface *src = queue->commands[order ? order[i] : (Uint32)i].draw.src;
+        if (i == 0 || src != queue->commands[order ? order[i - 1] : (Uint32)i - 1].draw.src) runs++;
+    }
+    return runs;
+}
+
+int main(int argc, char *argv[]) {
+    int frames = argc > 1 ? atoi(argv[1]) : 20;
+    int failed = 0;
+    srand(3);
+
+    SDL_Surface *screen = SDL_CreateRGBSurface(SDL_SWSURFACE, SCREEN_W, SCREEN_H, 32, SPRITE_RMASK,
+                                               SPRITE_GMASK, SPRITE_BMASK, SPRITE_AMASK);
+    SDL_Surface *reference = SDL_CreateRGBSurface(SDL_SWSURFACE, SCREEN_W, SCREEN_H, 32, SPRITE_RMASK,
+                                                  SPRITE_GMASK, SPRITE_BMASK, SPRITE_AMASK);
+    SDL_Surface *sheets[SHEETS];
+    for (int i = 0; i < SHEETS; i++) sheets[i] = makeSheet();
+    int maxCount = counts[sizeof(counts) / sizeof(counts[0]) - 1];
+    Entity *entities = malloc(maxCount * sizeof(Entity));
+    SortItem *items = malloc((maxCount + maxCount / 8 + 1) * sizeof(SortItem));
+    if (!screen || !reference || !entities || !items) return 1;
+
+    RenderQueue queue;
+    initRenderQueue(&queue);
+
+    printf("%d frames, %d sheets of %dx%d frames, one HUD icon per 8 entities\n", frames, SHEETS, FRAME, FRAME);
+    printf("%7s %9s %10s %7s %9s %7s %10s %10s %7s %7s\n", "entities", "record us", "radix us", "passes",
+           "qsort us", "faster", "direct ms", "queue ms", "runs", "sorted");
+
+    for (int c = 0; c < (int)(sizeof(counts) / sizeof(counts[0])); c++) {
+        int count = counts[c];
+        for (int i = 0; i < count; i++) {
+            entities[i].sheet = rand() % SHEETS;
+            entities[i].frame = rand() % (SHEET_FRAMES * SHEET_FRAMES);
+            entities[i].x = rand() % (SCREEN_W + FRAME) - FRAME;
+            entities[i].y = rand() % (SCREEN_H + FRAME) - FRAME;
+        }
+
+        Uint64 recordUs = 0, radixUs = 0, qsortUs = 0, directUs = 0, queueUs = 0;
+        int commands = 0, passes = 0, directRuns = 0, sortedRuns = 0;
+        for (int f = 0; f < frames; f++) {
+            // Drawn directly, in submission order
+            SDL_FillRect(reference, NULL, 0);
+            Uint64 start = timerNowUs();
+            drawEntities(NULL, reference, sheets, entities, count);
+            directUs += timerNowUs() - start;
+
+            // Recorded, then sorted both ways
+            start = timerNowUs();
+            beginRenderQueue(&queue, screen);
+            drawEntities(&queue, screen, sheets, entities, count);
+            recordUs += timerNowUs() - start;
+            commands = queue.commandCount;
+
+            start = timerNowUs();
+            sortRenderQueue(&queue);
+            radixUs += timerNowUs() - start;
+            passes = queue.lastPasses;
+
+            start = timerNowUs();
+            for (int i = 0; i < commands; i++) {
+                items[i].key = queue.commands[i].key;
+                items[i].index = i;
+            }
+            qsort(items, commands, sizeof(SortItem), compareItems);
+            qsortUs += timerNowUs() - start;
+
+            directRuns = sheetRuns(&queue, NULL, commands);
+            sortedRuns = sheetRuns(&queue, queue.sortedOrder, commands);
+            if (f == 0) {
+                for (int i = 0; i < commands; i++) {
+                    if (queue.sortedOrder[i] != items[i].index) {
+                        printf("  %d entities: radix and qsort orders differ at %d\n", count, i);
+                        failed = 1;
+                        break;
+                    }
+                }
+                // The same draws made directly in the sorted order
+                SDL_FillRect(reference, NULL, 0);
+                for (int i = 0; i < commands; i++) {
+                    DrawCommand *cmd = &queue.commands[items[i].index].draw;
+                    blitSprite(cmd->src, &cmd->srcRect, reference, &cmd->dstRect);
+                }
+            }
+
+            SDL_FillRect(screen, NULL, 0);
+            start = timerNowUs();
+            flushRenderQueue(&queue);
+            queueUs += timerNowUs() - start;
+            if (f == 0 && memcmp(screen->pixels, reference->pixels, (size_t)screen->pitch * SCREEN_H) != 0) {
+                printf("  %d entities: the flushed frame differs from the sorted draws\n", count);
+                failed = 1;
+            }
+        }
+
+        printf("%7d %9.1f %10.1f %7d %9.1f %6.1fx %10.2f %10.2f %7d %7d\n", count, (double)recordUs / frames,
+               (double)radixUs / frames, passes, (double)qsortUs / frames,
+               radixUs ? (double)qsortUs / radixUs : 0.0, directUs / 1000.0 / frames,
+               queueUs / 1000.0 / frames, directRuns, sortedRuns);
+    }
+
+    freeRenderQueue(&queue);
+    for (int i = 0; i < SHEETS; i++) SDL_FreeSurface(sheets[i]);
+    SDL_FreeSurface(screen);
+    SDL_FreeSurface(reference);
+    free(entities);
+    free(items);
+    return failed;
+}
@@ -0,0 +1,163 @@
+#include "renderqueue.h"
+#include "blit.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Queue recording the draws (main thread only)
+static RenderQueue *recording = NULL;
+
+void initRenderQueue(RenderQueue *queue) {
+    memset(queue, 0, sizeof(*queue));
+}
+
+void freeRenderQueue(RenderQueue *queue) {
+    if (recording == queue) recording = NULL;
+    free(queue->commands);
+    free(queue->items);
+    free(queue->scratch);
+    free(queue->sortedOrder);
+    memset(queue, 0, sizeof(*queue));
+}
+
+int beginRenderQueue(RenderQueue *queue, SDL_Surface *target) {
+    if (recording) {
+        printf("Render queue already recording\n");
+        return -1;
+    }
+    queue->target = target;
+    queue->commandCount = 0;
+    queue->orderKey = 0;
+    queue->batch = 0;
+    memset(queue->sheetSlots, 0, sizeof(queue->sheetSlots));
+    queue->sheetCount = 0;
+    recording = queue;
+    return 0;
+}
+
+void setRenderOrder(RenderQueue *queue, int layer, int sortKey, int batch) {
+    if (layer < 0) layer = 0;
+    if (layer > 255) layer = 255;
+    if (sortKey < -32768) sortKey = -32768;
+    if (sortKey > 32767) sortKey = 32767;
+    queue->orderKey = (Uint32)layer << 24 | (Uint32)(sortKey + 32768) << 8;
+    queue->batch = batch;
+}
+
+int renderQueueRecords(SDL_Surface *dst) {
+    return recording && recording->target == dst;
+}
+
+// Group of a sheet this frame: the order its first draw came in
+static Uint32 sheetGroup(RenderQueue *queue, SDL_Surface *sheet) {
+    if (!sheet) return 0;
+    size_t slot = ((size_t)sheet >> 4) % RENDER_SHEET_SLOTS;
+    for (int probe = 0; probe < RENDER_SHEET_SLOTS; probe++) {
+        if (queue->sheetSlots[slot] == sheet) return queue->sheetGroups[slot];
+        if (!queue->sheetSlots[slot]) {
+            queue->sheetSlots[slot] = sheet;
+            if (queue->sheetCount < RENDER_MAX_SHEETS) queue->sheetCount++;
+            queue->sheetGroups[slot] = (Uint8)queue->sheetCount;
+            return queue->sheetCount;
+        }
+        slot = (slot + 1) % RENDER_SHEET_SLOTS;
+    }
+    return RENDER_MAX_SHEETS;
+}
+
+static int growQueue(RenderQueue *queue) {
+    int capacity = queue->commandCapacity ? queue->commandCapacity * 2 : 1024;
+    RenderCommand *commands = realloc(queue->commands, capacity * sizeof(RenderCommand));
+    if (!commands) return -1;
+    queue->commands = commands;
+    Uint64 *items = realloc(queue->items, capacity * sizeof(Uint64));
+    if (items) queue->items = items;
+    Uint64 *scratch = realloc(queue->scratch, capacity * sizeof(Uint64));
+    if (scratch) queue->scratch = scratch;
+    Uint32 *order = realloc(queue->sortedOrder, capacity * sizeof(Uint32));
+    if (order) queue->sortedOrder = order;
+    if (!items || !scratch || !order) return -1;
+    queue->commandCapacity = capacity;
+    return 0;
+}
+
+int renderQueueRecord(DrawOp op, SDL_Surface *src, const SDL_Rect *srcRect,
+                      const SDL_Rect *dstRect, Uint32 color) {
+    RenderQueue *queue = recording;
+    if (queue->commandCount == queue->commandCapacity && growQueue(queue) < 0) return -1;
+
+    RenderCommand *cmd = &queue->commands[queue->commandCount++];
+    cmd->key = queue->batch ? queue->orderKey | sheetGroup(queue, src) : queue->orderKey;
+    cmd->draw.op = op;
+    cmd->draw.src = src;
+    if (srcRect) cmd->draw.srcRect = *srcRect;
+    cmd->draw.dstRect = *dstRect;
+    cmd->draw.color = color;
+    return 0;
+}
+
+// LSD radix sort of the keys, 8 bits per pass (stable). The command index
+// travels with its key so every pass reads and writes in sequence.
+void sortRenderQueue(RenderQueue *queue) {
+    int n = queue->commandCount;
+    Uint64 *items = queue->items, *sorted = queue->scratch;
+    queue->lastPasses = 0;
+    if (!n) return;
+    for (int i = 0; i < n; i++) {
+        items[i] = (Uint64)queue->commands[i].key << 32 | (Uint32)i;
+    }
+
+    for (int shift = 32; shift < 64; shift += 8) {
+        int count[256] = {0};
+        for (int i = 0; i < n; i++) count[(items[i] >> shift) & 0xFF]++;
+        if (count[(items[0] >> shift) & 0xFF] == n) continue;  // Same byte everywhere
+
+        int start = 0;
+        for (int b = 0; b < 256; b++) {
+            int c = count[b];
+            count[b] = start;
+            start += c;
+        }
+        for (int i = 0; i < n; i++) {
+            sorted[count[(items[i] >> shift) & 0xFF]++] = items[i];
+        }
+        Uint64 *swap = items;
+        items = sorted;
+        sorted = swap;
+        queue->lastPasses++;
+    }
+    for (int i = 0; i < n; i++) {
+        queue->sortedOrder[i] = (Uint32)items[i];
+    }
+}
+
+void flushRenderQueue(RenderQueue *queue) {
+    if (recording == queue) recording = NULL;
+    int n = queue->commandCount;
+    queue->lastCommands = n;
+    queue->lastBatches = 0;
+    queue->lastPasses = 0;
+    if (!n) return;
+
+    sortRenderQueue(queue);
+    Uint32 *order = queue->sortedOrder;
+    SDL_Surface *target = queue->target;
+    SDL_Surface *sheet = NULL;
+    for (int i = 0; i < n; i++) {
+        DrawCommand *cmd = &queue->commands[order[i]].draw;
+        if (i == 0 || cmd->src != sheet) queue->lastBatches++;
+        sheet = cmd->src;
+        switch (cmd->op) {
+            case DRAW_SPRITE:
+                blitSprite(cmd->src, &cmd->srcRect, target, &cmd->dstRect);
+                break;
+            case DRAW_COPY:
+                copySprite(cmd->src, &cmd->srcRect, target, cmd->dstRect.x, cmd->dstRect.y);
+                break;
+            case DRAW_FILL:
+                fillRect(target, &cmd->dstRect, cmd->color);
+                break;
+        }
+    }
+    queue->commandCount = 0;
+}
@@ -0,0 +1,76 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <SDL/SDL.h>
+#include "compositor.h"
+
+// Sorted draw queue.
+//
+// Between beginRenderQueue() and flushRenderQueue(), the blitSprite,
+// copySprite and fillRect calls aimed at the target are recorded (clipped,
+// like the compositor does) with the order set by setRenderOrder(): a layer
+// (back to front) and a sort key inside the layer, usually the y of the
+// entity's feet so that what stands lower on the screen is drawn in front.
+// The systems draw in any order; adding a kind of entity is choosing its
+// layer and key.
+//
+// flushRenderQueue() sorts the commands on a 32-bit key (layer, sort key,
+// then source sheet) with an LSD radix sort, 8 bits per pass: linear in the
+// number of commands, passes over a byte that every command shares are
+// skipped, and commands with the same key keep the order they were drawn
+// in. Draws whose order does not matter among themselves (tiles that do not
+// overlap, the HUD ...) are marked batched: the sheet then ends their key,
+// so at the same layer and sort key the draws of one sheet follow each
+// other. The sorted commands are then drawn with the same functions, so a
+// compositor recording the target records them in that order.
+//
+// As with the compositor, the surfaces must stay alive until the flush, and
+// anything drawn on the target by other means is not ordered.
+
+#define RENDER_MAX_SHEETS 255      // Sheets told apart per frame, the others share the last group
+#define RENDER_SHEET_SLOTS 512     // Hash table of the sheets seen this frame
+
+typedef struct {
+    Uint32 key;                    // layer << 24 | sort key << 8 | sheet
+    DrawCommand draw;
+} RenderCommand;
+
+typedef struct {
+    SDL_Surface *target;
+    RenderCommand *commands;
+    int commandCount, commandCapacity;
+    Uint64 *items, *scratch;       // Sort scratch: key << 32 | command index
+    Uint32 *sortedOrder;           // Command indexes after sortRenderQueue()
+    Uint32 orderKey;               // Current layer and sort key
+    int batch;                     // Group the next draws by sheet
+
+    SDL_Surface *sheetSlots[RENDER_SHEET_SLOTS];
+    Uint8 sheetGroups[RENDER_SHEET_SLOTS];   // Group of each sheet (1 ..), 0 for fills
+    int sheetCount;
+
+    Uint32 lastCommands;           // Commands of the last frame
+    Uint32 lastBatches;            // Runs of commands from the same sheet
+    Uint32 lastPasses;             // Radix passes that were not skipped
+} RenderQueue;
+
+void initRenderQueue(RenderQueue *queue);
+void freeRenderQueue(RenderQueue *queue);
+
+// Start recording the draws on target (main thread, one queue at a time)
+int beginRenderQueue(RenderQueue *queue, SDL_Surface *target);
+// Layer (0 = back, 255 = front) and key (-32768 .. 32767, lower first) of
+// the next draws; batch = 1 if they may be grouped by sheet
+void setRenderOrder(RenderQueue *queue, int layer, int sortKey, int batch);
+// Sort and draw the recorded commands, and stop recording
+void flushRenderQueue(RenderQueue *queue);
+// Only sort them, in sortedOrder (done by the flush; for measurements)
+void sortRenderQueue(RenderQueue *queue);
+
+// Used by the blitter: 1 if draws on dst are being recorded
+int renderQueueRecords(SDL_Surface *dst);
+// Append a command with clipped rectangles. -1 if it cannot be stored (the
+// caller then draws it directly).
+int renderQueueRecord(DrawOp op, SDL_Surface *src, const SDL_Rect *srcRect,
+                      const SDL_Rect *dstRect, Uint32 color);
+
+#endif
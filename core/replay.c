@@ -0,0 +1,145 @@
+#include "replay.h"
+#include <string.h>
+
+#define REPLAY_HEADER_SIZE 14
+#define REPLAY_TICK_SIZE (INPUT_MAX_PLAYERS * 3 + 4)
+
+// Masks are stored in one byte
+typedef char actionsFitInByte[ACTION_COUNT <= 8 ? 1 : -1];
+
+static void put16(Uint8 *p, Uint32 value) {
+    p[0] = (Uint8)value;
+    p[1] = (Uint8)(value >> 8);
+}
+
+static void put32(Uint8 *p, Uint32 value) {
+    put16(p, value);
+    put16(p + 2, value >> 16);
+}
+
+static Uint32 get16(const Uint8 *p) {
+    return p[0] | (Uint32)p[1] << 8;
+}
+
+static Uint32 get32(const Uint8 *p) {
+    return get16(p) | get16(p + 2) << 16;
+}
+
+int startRecording(Replay *replay, const char *path, Uint32 seed, int playerCount) {
+    memset(replay, 0, sizeof(*replay));
+    replay->file = fopen(path, "wb");
+    if (!replay->file) {
+        printf("Cannot create replay %s\n", path);
+        return -1;
+    }
+    replay->recording = 1;
+    replay->seed = seed;
+    replay->playerCount = playerCount;
+
+    Uint8 header[REPLAY_HEADER_SIZE];
+    memcpy(header, "RPLY", 4);
+    put16(header + 4, REPLAY_VERSION);
+    header[6] = (Uint8)playerCount;
+    header[7] = INPUT_MAX_PLAYERS;
+    put32(header + 8, seed);
+    put16(header + 12, ACTION_COUNT);
+    if (fwrite(header, sizeof(header), 1, replay->file) != 1) {
+        printf("Cannot write replay %s\n", path);
+        closeReplay(replay);
+        return -1;
+    }
+    return 0;
+}
+
+int writeReplayTick(Replay *replay, const InputState *input, Uint32 stateHash) {
+    if (!replay->file || !replay->recording) return -1;
+
+    Uint8 record[REPLAY_TICK_SIZE];
+    for (int p = 0; p < INPUT_MAX_PLAYERS; p++) {
+        record[p * 3] = (Uint8)input->held[p];
+        record[p * 3 + 1] = (Uint8)input->pressed[p];
+        record[p * 3 + 2] = (Uint8)input->released[p];
+    }
+    put32(record + INPUT_MAX_PLAYERS * 3, stateHash);
+    if (fwrite(record, sizeof(record), 1, replay->file) != 1) return -1;
+    replay->tick++;
+    return 0;
+}
+
+int startPlayback(Replay *replay, const char *path) {
+    memset(replay, 0, sizeof(*replay));
+    replay->file = fopen(path, "rb");
+    if (!replay->file) {
+        printf("Cannot open replay %s\n", path);
+        return -1;
+    }
+
+    Uint8 header[REPLAY_HEADER_SIZE];
+    if (fread(header, sizeof(header), 1, replay->file) != 1 || memcmp(header, "RPLY", 4) != 0) {
+        printf("%s is not a replay\n", path);
+        closeReplay(replay);
+        return -1;
+    }
+    if (get16(header + 4) != REPLAY_VERSION || header[7] != INPUT_MAX_PLAYERS ||
+        get16(header + 12) != ACTION_COUNT) {
+        printf("Replay %s was recorded by another version (version %u, %u players, %u actions)\n",
+               path, get16(header + 4), header[7], get16(header + 12));
+        closeReplay(replay);
+        return -1;
+    }
+    replay->playerCount = header[6];
+    replay->seed = get32(header + 8);
+
+    fseek(replay->file, 0, SEEK_END);
+    long size = ftell(replay->file);
+    fseek(replay->file, REPLAY_HEADER_SIZE, SEEK_SET);
+    replay->tickCount = size > REPLAY_HEADER_SIZE ? (Uint32)((size - REPLAY_HEADER_SIZE) / REPLAY_TICK_SIZE) : 0;
+    return 0;
+}
+
+int readReplayTick(Replay *replay, InputState *input) {
+    if (!replay->file || replay->recording) return -1;
+
+    Uint8 record[REPLAY_TICK_SIZE];
+    if (fread(record, sizeof(record), 1, replay->file) != 1) return -1;
+    for (int p = 0; p < INPUT_MAX_PLAYERS; p++) {
+        input->held[p] = record[p * 3];
+        input->pressed[p] = record[p * 3 + 1];
+        input->released[p] = record[p * 3 + 2];
+    }
+    replay->expectedHash = get32(record + INPUT_MAX_PLAYERS * 3);
+    replay->tick++;
+    return 0;
+}
+
+int checkReplayTick(Replay *replay, Uint32 stateHash) {
+    if (stateHash == replay->expectedHash) return 0;
+    if (replay->mismatches++ == 0) {
+        replay->firstMismatch = replay->tick - 1;
+        printf("Replay: state differs from the recording at tick %u (%08x, recorded %08x)\n",
+               replay->firstMismatch, stateHash, replay->expectedHash);
+    }
+    return -1;
+}
+
+void closeReplay(Replay *replay) {
+    if (replay->file) {
+        fclose(replay->file);
+        replay->file = NULL;
+    }
+}
+
+Uint32 hashBytes(Uint32 hash, const void *data, size_t size) {
+    const Uint8 *bytes = (const Uint8 *)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+Uint32 hashInt(Uint32 hash, int value) {
+    Uint8 bytes[4];
+    put32(bytes, (Uint32)value);
+    return hashBytes(hash, bytes, sizeof(bytes));
+}
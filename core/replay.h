@@ -0,0 +1,60 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <SDL/SDL.h>
+#include <stdio.h>
+#include "input.h"
+
+// Input recording and replay.
+//
+// A replay file holds the random seed and, for every tick (one call of the
+// game's update), the action masks of each player and a hash of the game
+// state after the update:
+//
+//   header  "RPLY", version (16 bits), game players, input players, seed,
+//           action count (16 bits)
+//   tick    held, pressed, released (one byte each, per input player),
+//           state hash (32 bits)
+//
+// Everything is little endian: 10 bytes per tick with two input players,
+// about 36 KB per minute at 60 ticks per second. There is no tick count in
+// the header, so a file cut by a crash still replays up to the cut.
+//
+// Replaying feeds the masks back instead of the keyboard and compares the
+// state hash of every tick: the first tick that differs points at the
+// change that broke determinism.
+
+#define REPLAY_VERSION 1
+
+typedef struct {
+    FILE *file;
+    int recording;           // 1 = writing, 0 = reading
+    Uint32 seed;             // seedRandom() value of the recorded game
+    int playerCount;         // Players of the recorded game
+    Uint32 tick;             // Ticks written or read so far
+    Uint32 tickCount;        // Ticks in the file (reading)
+    Uint32 expectedHash;     // Hash recorded for the tick just read
+    Uint32 mismatches;       // Ticks whose state differed from the recording
+    Uint32 firstMismatch;    // Tick of the first difference
+} Replay;
+
+// Write a new file. Returns -1 if it cannot be created.
+int startRecording(Replay *replay, const char *path, Uint32 seed, int playerCount);
+// Append one tick: the input that was applied and the state it led to
+int writeReplayTick(Replay *replay, const InputState *input, Uint32 stateHash);
+
+// Open a file to replay; fills seed and playerCount
+int startPlayback(Replay *replay, const char *path);
+// Replace the action masks of input with the next tick. -1 at the end.
+int readReplayTick(Replay *replay, InputState *input);
+// Compare the state after the tick with the recording. -1 if it differs.
+int checkReplayTick(Replay *replay, Uint32 stateHash);
+
+void closeReplay(Replay *replay);
+
+// FNV-1a, to hash the fields of a game state one after the other
+#define HASH_START 2166136261u
+Uint32 hashBytes(Uint32 hash, const void *data, size_t size);
+Uint32 hashInt(Uint32 hash, int value);
+
+#endif
@@ -0,0 +1,332 @@
+#include "resources.h"
+#include "archive.h"
+#include "memtrack.h"
+#include "blit.h"
+#include "mixer.h"
+#include <SDL/SDL_image.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static ResourceContext resources;
+
+// Streams of the music loaded from the archive: Mix_LoadMUS_RW() reads from
+// them while the music plays but does not own them, so each is closed when
+// its music is freed. Filled by the loader workers, hence the lock.
+#define MAX_MUSIC_STREAMS 32
+static struct {
+    Mix_Music *music;
+    SDL_RWops *rw;
+} musicStreams[MAX_MUSIC_STREAMS];
+static volatile int musicStreamsLock = 0;
+#define LOCK_STREAMS() while (__sync_lock_test_and_set(&musicStreamsLock, 1)) { }
+#define UNLOCK_STREAMS() __sync_lock_release(&musicStreamsLock)
+
+static int keepMusicStream(Mix_Music *music, SDL_RWops *rw) {
+    int kept = 0;
+    LOCK_STREAMS();
+    for (int i = 0; i < MAX_MUSIC_STREAMS && !kept; i++) {
+        if (!musicStreams[i].music) {
+            musicStreams[i].music = music;
+            musicStreams[i].rw = rw;
+            kept = 1;
+        }
+    }
+    UNLOCK_STREAMS();
+    return kept ? 0 : -1;
+}
+
+// Stream of a music (NULL if it was not loaded from the archive), taken
+// out of the table before the music is freed and its address reused
+static SDL_RWops *takeMusicStream(Mix_Music *music) {
+    SDL_RWops *rw = NULL;
+    LOCK_STREAMS();
+    for (int i = 0; i < MAX_MUSIC_STREAMS; i++) {
+        if (musicStreams[i].music == music) {
+            rw = musicStreams[i].rw;
+            musicStreams[i].music = NULL;
+            musicStreams[i].rw = NULL;
+            break;
+        }
+    }
+    UNLOCK_STREAMS();
+    return rw;
+}
+
+// Music streamed from the archive, its stream kept until the music is freed
+static Mix_Music *loadArchivedMusic(SDL_RWops *rw) {
+    Mix_Music *music = Mix_LoadMUS_RW(rw);
+    if (music && keepMusicStream(music, rw) < 0) {
+        printf("Too much music loaded from the archive\n");
+        Mix_FreeMusic(music);
+        music = NULL;
+    }
+    if (!music) SDL_RWclose(rw);
+    return music;
+}
+
+ResourceContext *defaultResources(void) {
+    return &resources;
+}
+
+// Absolute path without "." and ".." for a file that does not exist on disk
+static int normalizePath(const char *path, char key[RESOURCE_PATH_MAX]) {
+    char joined[RESOURCE_PATH_MAX * 2];
+    if (path[0] == '/') {
+        snprintf(joined, sizeof(joined), "%s", path);
+    } else {
+        char cwd[RESOURCE_PATH_MAX];
+        if (!getcwd(cwd, sizeof(cwd))) return -1;
+        snprintf(joined, sizeof(joined), "%s/%s", cwd, path);
+    }
+
+    size_t len = 0;
+    char *part = strtok(joined, "/");
+    while (part) {
+        if (strcmp(part, "..") == 0) {
+            while (len > 0 && key[len - 1] != '/') len--;
+            if (len > 0) len--;
+        } else if (part[0] != '\0' && strcmp(part, ".") != 0) {
+            size_t n = strlen(part);
+            if (len + n + 2 > RESOURCE_PATH_MAX) return -1;
+            key[len++] = '/';
+            memcpy(key + len, part, n);
+            len += n;
+        }
+        part = strtok(NULL, "/");
+    }
+    key[len] = '\0';
+    return 0;
+}
+
+// Build the cache key: the absolute path, so that "alagard.ttf" loaded from
+// two scene directories is not mixed up, and the same file reached through
+// two relative paths is loaded once.
+int resourceKey(const char *path, char key[RESOURCE_PATH_MAX]) {
+    char *full = realpath(path, NULL);
+    if (full) {
+        strncpy(key, full, RESOURCE_PATH_MAX - 1);
+        key[RESOURCE_PATH_MAX - 1] = '\0';
+        free(full);
+        return 0;
+    }
+    // Not on disk: it can still be in the archive
+    if (!archiveMounted()) return -1;
+    return normalizePath(path, key);
+}
+
+static Resource *findResource(const char *key, ResourceType type, int fontSize) {
+    for (int i = 0; i < resources.count; i++) {
+        Resource *res = &resources.entries[i];
+        if (res->type == type && res->fontSize == fontSize && strcmp(res->path, key) == 0) {
+            return res;
+        }
+    }
+    return NULL;
+}
+
+static void freeResourceData(Resource *res) {
+    memUntrack(res->data);
+    switch (res->type) {
+        case RES_IMAGE:
+        case RES_SPRITE: SDL_FreeSurface((SDL_Surface *)res->data); break;
+        case RES_SOUND:
+            stopChunkSounds((Mix_Chunk *)res->data);
+            Mix_FreeChunk((Mix_Chunk *)res->data);
+            break;
+        case RES_MUSIC: {
+            SDL_RWops *rw = takeMusicStream((Mix_Music *)res->data);
+            Mix_FreeMusic((Mix_Music *)res->data);
+            if (rw) SDL_RWclose(rw);
+            break;
+        }
+        case RES_FONT:  TTF_CloseFont((TTF_Font *)res->data); break;
+    }
+    res->data = NULL;
+}
+
+// Assets found in the mounted archive skip image decoding and file access
+static void *loadArchivedData(const ArchiveEntry *entry, ResourceType type, int fontSize) {
+    if (type == RES_IMAGE || type == RES_SPRITE) return archiveLoadImage(entry);
+
+    SDL_RWops *rw = archiveOpen(entry);
+    if (!rw) return NULL;
+    switch (type) {
+        case RES_SOUND: return Mix_LoadWAV_RW(rw, 1);
+        case RES_MUSIC: return loadArchivedMusic(rw);
+        case RES_FONT:  return TTF_OpenFontRW(rw, 1, fontSize);
+        case RES_IMAGE:
+        case RES_SPRITE: break;
+    }
+    SDL_RWclose(rw);
+    return NULL;
+}
+
+void *decodeResource(const char *key, ResourceType type, int fontSize) {
+    // Sprites are packed premultiplied, and used from the mapping like images
+    ArchiveKind kind = type == RES_SPRITE ? ARCHIVE_SPRITE : (type == RES_IMAGE ? ARCHIVE_PIXELS : ARCHIVE_RAW);
+    const ArchiveEntry *entry = findArchiveEntry(key, kind);
+    if (entry) {
+        void *data = loadArchivedData(entry, type, fontSize);
+        if (data) return data;
+    }
+
+    if (type == RES_SPRITE) {
+        // Not packed: the decoded image is only needed for the conversion
+        SDL_Surface *image = decodeResource(key, RES_IMAGE, 0);
+        SDL_Surface *sprite = makeSprite(image);
+        SDL_FreeSurface(image);
+        return sprite;
+    }
+
+    switch (type) {
+        case RES_IMAGE: return IMG_Load(key);
+        case RES_SOUND: return Mix_LoadWAV(key);
+        case RES_MUSIC: return Mix_LoadMUS(key);
+        case RES_FONT:  return TTF_OpenFont(key, fontSize);
+        case RES_SPRITE: break;
+    }
+    return NULL;
+}
+
+void *findCachedResource(const char *key, ResourceType type, int fontSize) {
+    Resource *res = findResource(key, type, fontSize);
+    if (!res) return NULL;
+    res->refs++;
+    resources.hits++;
+    return res->data;
+}
+
+// Room for one more entry: grow the table, or when memory is short drop the
+// unused entries. 0 if there is none.
+static int reserveEntry(void) {
+    if (resources.count < resources.capacity) return 1;
+    int capacity = resources.capacity ? resources.capacity * 2 : RESOURCES_INITIAL;
+    Resource *entries = realloc(resources.entries, capacity * sizeof(Resource));
+    if (entries) {
+        resources.entries = entries;
+        resources.capacity = capacity;
+        return 1;
+    }
+    purgeResources();
+    return resources.count < resources.capacity;
+}
+
+void *addResource(const char *key, ResourceType type, int fontSize, void *data) {
+    // Someone else loaded the same file in the meantime: keep the cached copy
+    Resource *res = findResource(key, type, fontSize);
+    if (res) {
+        Resource dup = {.type = type, .data = data};
+        freeResourceData(&dup);
+        res->refs++;
+        resources.hits++;
+        return res->data;
+    }
+    resources.misses++;
+
+    // An asset that is not in the table could never be released: fail the load
+    if (!reserveEntry()) {
+        printf("No memory to cache %s\n", key);
+        Resource lost = {.type = type, .data = data};
+        freeResourceData(&lost);
+        return NULL;
+    }
+
+    // Cached assets are charged to the scene that loaded them; the site is the file itself
+    static const MemKind kinds[] = {[RES_IMAGE] = MEM_SURFACE, [RES_SOUND] = MEM_CHUNK,
+                                    [RES_MUSIC] = MEM_MUSIC, [RES_FONT] = MEM_FONT,
+                                    [RES_SPRITE] = MEM_SURFACE};
+    size_t size = (type == RES_MUSIC || type == RES_FONT) ? memFileSize(key) : 0;
+    memTrack(data, kinds[type], size, "resources", key, 0);
+
+    res = &resources.entries[resources.count++];
+    strcpy(res->path, key);
+    res->type = type;
+    res->fontSize = fontSize;
+    res->data = data;
+    res->refs = 1;
+    return data;
+}
+
+static void *acquireResource(const char *path, ResourceType type, int fontSize) {
+    char key[RESOURCE_PATH_MAX];
+    if (resourceKey(path, key) < 0) {
+        printf("Resource not found: %s\n", path);
+        return NULL;
+    }
+
+    void *data = findCachedResource(key, type, fontSize);
+    if (data) return data;
+
+    data = decodeResource(key, type, fontSize);
+    if (!data) {
+        printf("Failed to load %s: %s\n", path, SDL_GetError());
+        return NULL;
+    }
+    return addResource(key, type, fontSize, data);
+}
+
+SDL_Surface *loadImage(const char *path) {
+    return (SDL_Surface *)acquireResource(path, RES_IMAGE, 0);
+}
+
+Mix_Chunk *loadSound(const char *path) {
+    return (Mix_Chunk *)acquireResource(path, RES_SOUND, 0);
+}
+
+Mix_Music *loadMusic(const char *path) {
+    return (Mix_Music *)acquireResource(path, RES_MUSIC, 0);
+}
+
+TTF_Font *loadFont(const char *path, int size) {
+    return (TTF_Font *)acquireResource(path, RES_FONT, size);
+}
+
+SDL_Surface *loadSprite(const char *path) {
+    return (SDL_Surface *)acquireResource(path, RES_SPRITE, 0);
+}
+
+void releaseResource(void *data) {
+    if (!data) return;
+    for (int i = 0; i < resources.count; i++) {
+        if (resources.entries[i].data == data) {
+            if (resources.entries[i].refs > 0) {
+                resources.entries[i].refs--;
+            }
+            return;
+        }
+    }
+}
+
+void purgeResources(void) {
+    int kept = 0;
+    for (int i = 0; i < resources.count; i++) {
+        Resource *res = &resources.entries[i];
+        if (res->refs > 0) {
+            resources.entries[kept++] = *res;
+        } else {
+            freeResourceData(res);
+        }
+    }
+    resources.count = kept;
+}
+
+void freeResources(void) {
+    for (int i = 0; i < resources.count; i++) {
+        freeResourceData(&resources.entries[i]);
+    }
+    free(resources.entries);
+    resources.entries = NULL;
+    resources.count = 0;
+    resources.capacity = 0;
+}
+
+void printResourceStats(void) {
+    int held = 0;
+    for (int i = 0; i < resources.count; i++) {
+        if (resources.entries[i].refs > 0) held++;
+    }
+    printf("Resources: %d resident (%d in use), %d cache hits, %d loads\n",
+           resources.count, held, resources.hits, resources.misses);
+}
@@ -0,0 +1,71 @@
+#ifndef RESOURCES_H
+#define RESOURCES_H
+
+#include <SDL/SDL.h>
+#include <SDL/SDL_mixer.h>
+#include <SDL/SDL_ttf.h>
+
+#define RESOURCES_INITIAL 256   // Entries allocated by the first load; the table doubles when full
+#define RESOURCE_PATH_MAX 256
+
+typedef enum {
+    RES_IMAGE,
+    RES_SOUND,
+    RES_MUSIC,
+    RES_FONT,
+    RES_SPRITE   // Image converted for blitSprite (premultiplied alpha, see blit.h)
+} ResourceType;
+
+// One cached asset. Entries stay resident after their last release so that
+// the next scene using the same file gets it without touching the disk.
+typedef struct {
+    char path[RESOURCE_PATH_MAX]; // Canonical (absolute) path, used as the key
+    ResourceType type;
+    int fontSize;                 // Point size for fonts, 0 otherwise
+    void *data;                   // SDL_Surface*, Mix_Chunk*, Mix_Music* or TTF_Font*
+    int refs;                     // Number of users holding the asset
+} Resource;
+
+typedef struct {
+    Resource *entries;
+    int count, capacity;
+    int hits;    // Loads served from the cache
+    int misses;  // Loads that had to read the file
+} ResourceContext;
+
+// Shared context used by every module of the program
+ResourceContext *defaultResources(void);
+
+// Load (or reuse) an asset. Relative paths are resolved against the current
+// directory. Returns NULL if the file cannot be loaded.
+SDL_Surface *loadImage(const char *path);
+Mix_Chunk *loadSound(const char *path);
+Mix_Music *loadMusic(const char *path);
+TTF_Font *loadFont(const char *path, int size);
+// Image to draw with blitSprite. Cached apart from loadImage() of the same file.
+SDL_Surface *loadSprite(const char *path);
+
+// Lower level access used by the asset loader (loader.c), which decodes
+// files on worker threads and adds them to the cache on the main thread.
+// Keys are the canonical paths returned by resourceKey().
+int resourceKey(const char *path, char key[RESOURCE_PATH_MAX]);
+void *findCachedResource(const char *key, ResourceType type, int fontSize);  // Takes a reference
+// Takes data over; NULL (data freed) if the table cannot hold it
+void *addResource(const char *key, ResourceType type, int fontSize, void *data);
+// Load from the mounted archive (archive.c) or from the file. Thread safe for
+// images, sounds and music; does not touch the cache.
+void *decodeResource(const char *key, ResourceType type, int fontSize);
+
+// Give back an asset. It stays in memory until purgeResources() or freeResources().
+// Pointers that did not come from the cache are ignored.
+void releaseResource(void *data);
+
+// Free the assets nobody holds any more
+void purgeResources(void);
+
+// Free everything (program exit)
+void freeResources(void);
+
+void printResourceStats(void);
+
+#endif
@@ -0,0 +1,96 @@
+#include "scale.h"
+#include "memtrack.h"
+#include <string.h>
+
+static SDL_Surface *createLike(SDL_Surface *src, int w, int h) {
+    SDL_PixelFormat *f = src->format;
+    SDL_Surface *surface = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 32, f->Rmask, f->Gmask, f->Bmask, f->Amask);
+    return TRACK_SURFACE(surface);
+}
+
+SDL_Surface *scaleSurface(SDL_Surface *src, int factor) {
+    if (!src || src->format->BytesPerPixel != 4 || factor < 1) return NULL;
+
+    SDL_Surface *dst = createLike(src, src->w * factor, src->h * factor);
+    if (!dst) return NULL;
+
+    if (SDL_MUSTLOCK(src)) SDL_LockSurface(src);
+    size_t rowBytes = (size_t)dst->w * 4;
+    for (int y = 0; y < src->h; y++) {
+        const Uint32 *in = (const Uint32 *)((Uint8 *)src->pixels + y * src->pitch);
+        Uint8 *first = (Uint8 *)dst->pixels + (size_t)y * factor * dst->pitch;
+        Uint32 *out = (Uint32 *)first;
+
+        // Widen one row, then copy it for the other factor - 1 rows
+        for (int x = 0; x < src->w; x++) {
+            Uint32 pixel = in[x];
+            for (int k = 0; k < factor; k++) *out++ = pixel;
+        }
+        for (int k = 1; k < factor; k++) {
+            memcpy(first + k * dst->pitch, first, rowBytes);
+        }
+    }
+    if (SDL_MUSTLOCK(src)) SDL_UnlockSurface(src);
+
+    // Keep the blending mode of the source (plain SDL_BlitSurface users)
+    if (src->flags & SDL_SRCALPHA) SDL_SetAlpha(dst, SDL_SRCALPHA, src->format->alpha);
+    return dst;
+}
+
+SDL_Surface *mirrorFrames(SDL_Surface *sheet, int frameWidth) {
+    if (!sheet || sheet->format->BytesPerPixel != 4 || frameWidth < 1) return NULL;
+
+    SDL_Surface *dst = createLike(sheet, sheet->w, sheet->h);
+    if (!dst) return NULL;
+
+    int frames = sheet->w / frameWidth;
+    for (int y = 0; y < sheet->h; y++) {
+        const Uint32 *in = (const Uint32 *)((Uint8 *)sheet->pixels + y * sheet->pitch);
+        Uint32 *out = (Uint32 *)((Uint8 *)dst->pixels + y * dst->pitch);
+        for (int f = 0; f < frames; f++) {
+            const Uint32 *from = in + f * frameWidth;
+            Uint32 *to = out + f * frameWidth + frameWidth - 1;
+            for (int x = 0; x < frameWidth; x++) *to-- = from[x];
+        }
+        // Columns after the last whole frame are copied as they are
+        for (int x = frames * frameWidth; x < sheet->w; x++) out[x] = in[x];
+    }
+
+    if (sheet->flags & SDL_SRCALPHA) SDL_SetAlpha(dst, SDL_SRCALPHA, sheet->format->alpha);
+    return dst;
+}
+
+void freeClip(SpriteClip *clip) {
+    if (clip->scaled) SDL_FreeSurface(clip->scaled);
+    if (clip->mirrored) SDL_FreeSurface(clip->mirrored);
+    memset(clip, 0, sizeof(*clip));
+}
+
+SDL_Surface *clipFrames(SpriteClip *clip, SDL_Surface *sheet, int frameWidth, int frameHeight,
+                        int scale, int mirrored) {
+    if (clip->sheet != sheet || clip->scale != scale || clip->frameWidth != frameWidth) {
+        freeClip(clip);
+        if (!sheet) return NULL;
+        clip->scaled = scaleSurface(sheet, scale);
+        if (!clip->scaled) return NULL;
+        clip->sheet = sheet;
+        clip->frameWidth = frameWidth;
+        clip->frameHeight = frameHeight;
+        clip->scale = scale;
+    }
+    if (!mirrored) return clip->scaled;
+
+    if (!clip->mirrored) {
+        clip->mirrored = mirrorFrames(clip->scaled, frameWidth * scale);
+    }
+    return clip->mirrored;
+}
+
+SDL_Rect clipFrameRect(const SpriteClip *clip, int frame, int row) {
+    SDL_Rect rect;
+    rect.x = frame * clip->frameWidth * clip->scale;
+    rect.y = row * clip->frameHeight * clip->scale;
+    rect.w = clip->frameWidth * clip->scale;
+    rect.h = clip->frameHeight * clip->scale;
+    return rect;
+}
@@ -0,0 +1,40 @@
+#ifndef SCALE_H
+#define SCALE_H
+
+#include <SDL/SDL.h>
+
+// Integer upscaling of pixel-art sprite sheets.
+//
+// SDL 1.2 blits never scale, so characters drawn bigger than their sheet
+// need scaled copies. A SpriteClip keeps the frames of one animation sheet
+// scaled once (and a mirrored copy for characters facing left, made on first
+// use), so drawing a frame stays a single unscaled blit.
+
+typedef struct {
+    SDL_Surface *sheet;     // Source sheet (not owned), frames side by side
+    SDL_Surface *scaled;    // sheet scaled by scale
+    SDL_Surface *mirrored;  // scaled with every frame flipped horizontally
+    int frameWidth;         // Frame size in the source sheet
+    int frameHeight;
+    int scale;
+} SpriteClip;
+
+// Nearest-neighbor copy of a 32-bit surface, factor times bigger
+SDL_Surface *scaleSurface(SDL_Surface *src, int factor);
+
+// Copy of a sheet with each frameWidth wide frame flipped in place,
+// so frame n stays at the same position
+SDL_Surface *mirrorFrames(SDL_Surface *sheet, int frameWidth);
+
+// Frames of sheet scaled by scale. The scaled copy is made on the first call
+// and again when sheet changes. mirrored selects the flipped frames.
+// Returns NULL if sheet is NULL or not 32-bit.
+SDL_Surface *clipFrames(SpriteClip *clip, SDL_Surface *sheet, int frameWidth, int frameHeight,
+                        int scale, int mirrored);
+
+// Source rectangle of frame (column) and row in the surface returned by clipFrames
+SDL_Rect clipFrameRect(const SpriteClip *clip, int frame, int row);
+
+void freeClip(SpriteClip *clip);
+
+#endif
@@ -0,0 +1,254 @@
+#include "scene.h"
+#include "timer.h"
+#include "profiler.h"
+#include "memtrack.h"
+#include "input.h"
+#include "music.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+void initSceneManager(SceneManager *manager, SDL_Surface *screen) {
+    memset(manager, 0, sizeof(*manager));
+    manager->screen = screen;
+    manager->running = 1;
+    manager->frameDelay = 16;
+    if (!getcwd(manager->baseDir, sizeof(manager->baseDir))) {
+        manager->baseDir[0] = '\0';
+    }
+}
+
+// Scene assets are loaded with paths relative to the scene's folder
+static void enterAssetDir(SceneManager *manager, Scene *scene) {
+    if (!scene->assetDir) return;
+    if (chdir(manager->baseDir) != 0 || chdir(scene->assetDir) != 0) {
+        printf("Cannot enter asset folder %s for scene %s\n", scene->assetDir, scene->name);
+    }
+}
+
+// Path of the scene's track from the base directory (the current directory
+// is the folder of the scene on top, which may not be this one)
+static int sceneMusicPath(SceneManager *manager, Scene *scene, char *path, size_t size) {
+    if (!scene || !scene->music || !scene->music[0]) return -1;
+    if (scene->assetDir) {
+        snprintf(path, size, "%s/%s/%s", manager->baseDir, scene->assetDir, scene->music);
+    } else {
+        snprintf(path, size, "%s", scene->music);
+    }
+    return 0;
+}
+
+void prerollSceneMusic(SceneManager *manager, Scene *scene) {
+    char path[512];
+    if (sceneMusicPath(manager, scene, path, sizeof(path)) == 0) prerollMusic(path);
+}
+
+// Crossfade to the track of the scene now on top (it goes on if it is the same)
+static void playSceneMusic(SceneManager *manager, Scene *scene) {
+    char path[512];
+    if (!scene || !scene->music) return;
+    // A missing track is silence too, not the previous scene's music
+    if (sceneMusicPath(manager, scene, path, sizeof(path)) < 0 || playMusic(path, MUSIC_FADE_MS) < 0) {
+        stopMusic(MUSIC_FADE_MS);
+    }
+}
+
+// Resources created from now on are charged to this scene
+static void chargeScene(Scene *scene) {
+    memSetScene(scene->name);
+    if (scene->memoryBudget) memSetBudget(scene->name, scene->memoryBudget);
+}
+
+static void requestTransition(SceneManager *manager, SceneOp op, Scene *scene) {
+    if (manager->pendingOp != SCENE_OP_NONE) {
+        printf("Scene transition already pending, ignoring request\n");
+        return;
+    }
+    manager->pendingOp = op;
+    manager->pendingScene = scene;
+    manager->requestUs = timerNowUs();
+
+    // The streamer decodes the next track while this frame ends
+    if (op == SCENE_OP_POP) {
+        if (manager->depth > 1) prerollSceneMusic(manager, manager->stack[manager->depth - 2]);
+    } else {
+        prerollSceneMusic(manager, scene);
+    }
+}
+
+void pushScene(SceneManager *manager, Scene *scene) {
+    requestTransition(manager, SCENE_OP_PUSH, scene);
+}
+
+void popScene(SceneManager *manager) {
+    requestTransition(manager, SCENE_OP_POP, NULL);
+}
+
+void replaceScene(SceneManager *manager, Scene *scene) {
+    requestTransition(manager, SCENE_OP_REPLACE, scene);
+}
+
+Scene *topScene(SceneManager *manager) {
+    return manager->depth > 0 ? manager->stack[manager->depth - 1] : NULL;
+}
+
+static void leaveTop(SceneManager *manager) {
+    Scene *top = topScene(manager);
+    if (!top) return;
+    enterAssetDir(manager, top);
+    if (top->leave) top->leave(top);
+    manager->depth--;
+}
+
+static void enterScene(SceneManager *manager, Scene *scene) {
+    if (manager->depth == SCENE_STACK_MAX) {
+        printf("Scene stack full, cannot enter %s\n", scene->name);
+        return;
+    }
+    scene->manager = manager;
+    manager->stack[manager->depth++] = scene;
+    enterAssetDir(manager, scene);
+    chargeScene(scene);
+    if (scene->enter) scene->enter(scene);
+}
+
+static void applyPendingTransition(SceneManager *manager) {
+    SceneOp op = manager->pendingOp;
+    Scene *scene = manager->pendingScene;
+    Scene *top = topScene(manager);
+
+    manager->pendingOp = SCENE_OP_NONE;
+    manager->pendingScene = NULL;
+
+    switch (op) {
+        case SCENE_OP_PUSH:
+            if (top && top->pause) top->pause(top);
+            enterScene(manager, scene);
+            break;
+        case SCENE_OP_POP:
+            leaveTop(manager);
+            top = topScene(manager);
+            if (top) {
+                enterAssetDir(manager, top);
+                chargeScene(top);
+                if (top->resume) top->resume(top);
+            }
+            break;
+        case SCENE_OP_REPLACE:
+            leaveTop(manager);
+            enterScene(manager, scene);
+            break;
+        case SCENE_OP_NONE:
+            return;
+    }
+    playSceneMusic(manager, topScene(manager));
+    manager->measuring = 1;
+}
+
+static void drawScenes(SceneManager *manager) {
+    // Start from the highest scene that is not an overlay
+    int first = manager->depth - 1;
+    while (first > 0 && manager->stack[first]->isOverlay) {
+        first--;
+    }
+    for (int i = first; i < manager->depth; i++) {
+        manager->stack[i]->draw(manager->stack[i], manager->screen);
+    }
+}
+
+static void recordTransition(SceneManager *manager) {
+    TransitionStats *stats = &manager->transitions;
+    float ms = timerElapsedMs(manager->requestUs);
+
+    stats->count++;
+    stats->lastMs = ms;
+    stats->totalMs += ms;
+    if (ms > stats->worstMs) stats->worstMs = ms;
+
+    Scene *top = topScene(manager);
+    printf("Scene transition to %s: %.2f ms\n", top ? top->name : "(none)", ms);
+    manager->measuring = 0;
+}
+
+void runScenes(SceneManager *manager) {
+    SDL_Event event;
+
+    // The first scene was pushed before the loop started
+    if (manager->pendingOp != SCENE_OP_NONE) {
+        applyPendingTransition(manager);
+    }
+
+    while (manager->running && manager->depth > 0) {
+        Scene *top = topScene(manager);
+
+        // The queue is drained once per frame: into the input snapshot, and to
+        // the scenes that still handle events themselves
+        int zone = PROFILE_BEGIN("input");
+        InputState *input = defaultInput();
+        beginInputFrame(input);
+        while (SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) {
+                manager->running = 0;
+                break;
+            }
+            if (profilerHandleEvent(&event)) continue;
+            if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F5) {
+                memReport();
+                continue;
+            }
+            inputEvent(input, &event);
+            if (top->handleEvent) top->handleEvent(top, &event);
+        }
+        PROFILE_END(zone);
+        if (!manager->running) break;
+
+        zone = PROFILE_BEGIN("update");
+        if (top->update) top->update(top);
+        PROFILE_END(zone);
+
+        // update() may have ended the scene (modal scenes run their own loop)
+        if (manager->pendingOp == SCENE_OP_NONE || manager->pendingOp == SCENE_OP_PUSH) {
+            zone = PROFILE_BEGIN("draw");
+            drawScenes(manager);
+            drawProfilerOverlay(manager->screen);
+            PROFILE_END(zone);
+
+            zone = PROFILE_BEGIN("flip");
+            SDL_Flip(manager->screen);
+            PROFILE_END(zone);
+            if (manager->measuring) recordTransition(manager);
+        }
+
+        if (manager->pendingOp != SCENE_OP_NONE) {
+            zone = PROFILE_BEGIN("transition");
+            applyPendingTransition(manager);
+            PROFILE_END(zone);
+        }
+
+        SDL_Delay(manager->frameDelay);
+        PROFILE_FRAME();
+    }
+}
+
+void quitScenes(SceneManager *manager) {
+    manager->running = 0;
+}
+
+void clearScenes(SceneManager *manager) {
+    while (manager->depth > 0) {
+        leaveTop(manager);
+    }
+    if (chdir(manager->baseDir) != 0) {
+        printf("Cannot return to %s\n", manager->baseDir);
+    }
+}
+
+void printTransitionStats(SceneManager *manager) {
+    TransitionStats *stats = &manager->transitions;
+    if (stats->count == 0) {
+        printf("No scene transitions\n");
+        return;
+    }
+    printf("Scene transitions: %d, average %.2f ms, worst %.2f ms, last %.2f ms\n",
+           stats->count, stats->totalMs / stats->count, stats->worstMs, stats->lastMs);
+}
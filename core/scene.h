@@ -0,0 +1,86 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <SDL/SDL.h>
+
+#define SCENE_STACK_MAX 8
+
+typedef struct Scene Scene;
+typedef struct SceneManager SceneManager;
+
+// A screen of the game (menu, gameplay, puzzle ...).
+// All callbacks are optional except draw.
+struct Scene {
+    const char *name;
+    const char *assetDir;  // Directory the scene's asset paths are relative to (NULL = keep)
+    const char *music;     // Track while the scene is on top, in assetDir (NULL = keep, "" = silence)
+    int isOverlay;         // Draw the scene below first (pause menus ...)
+    size_t memoryBudget;   // Bytes of resources the scene may hold (0 = no budget)
+    void *data;            // Scene state
+    SceneManager *manager; // Set when the scene is pushed
+
+    void (*enter)(Scene *scene);   // Pushed or replaced in: load assets
+    void (*leave)(Scene *scene);   // Popped or replaced out: release assets
+    void (*pause)(Scene *scene);   // Another scene was pushed on top
+    void (*resume)(Scene *scene);  // The scene on top was popped
+    void (*handleEvent)(Scene *scene, SDL_Event *event);  // Or read defaultInput() in update
+    void (*update)(Scene *scene);
+    void (*draw)(Scene *scene, SDL_Surface *screen);
+};
+
+// Timing of scene transitions, from the request to the first frame shown
+typedef struct {
+    int count;
+    float lastMs;
+    float worstMs;
+    float totalMs;
+} TransitionStats;
+
+typedef enum {
+    SCENE_OP_NONE,
+    SCENE_OP_PUSH,
+    SCENE_OP_POP,
+    SCENE_OP_REPLACE
+} SceneOp;
+
+struct SceneManager {
+    SDL_Surface *screen;
+    Scene *stack[SCENE_STACK_MAX];
+    int depth;
+    int running;
+    int frameDelay;          // Milliseconds to wait after each frame
+
+    // Transitions requested during a frame are applied at the end of it,
+    // so a scene never disappears while one of its callbacks is running
+    SceneOp pendingOp;
+    Scene *pendingScene;
+    Uint64 requestUs;
+    int measuring;
+    TransitionStats transitions;
+
+    char baseDir[256];       // Working directory when the manager was created
+};
+
+void initSceneManager(SceneManager *manager, SDL_Surface *screen);
+
+// Request a transition; it happens at the end of the current frame
+void pushScene(SceneManager *manager, Scene *scene);
+void popScene(SceneManager *manager);
+void replaceScene(SceneManager *manager, Scene *scene);
+
+Scene *topScene(SceneManager *manager);
+
+// Start decoding a scene's music before a transition to it is requested
+// (transitions pre-roll the next scene's track themselves, one frame ahead)
+void prerollSceneMusic(SceneManager *manager, Scene *scene);
+
+// Main loop: runs until the stack is empty or quitScenes() is called
+void runScenes(SceneManager *manager);
+void quitScenes(SceneManager *manager);
+
+// Pop every scene (calls their leave callbacks)
+void clearScenes(SceneManager *manager);
+
+void printTransitionStats(SceneManager *manager);
+
+#endif
@@ -0,0 +1,55 @@
+#include "schedule.h"
+#include "audio.h"
+#include "timer.h"
+#include <string.h>
+
+void clearSchedule(Schedule *schedule) {
+    schedule->count = 0;
+    schedule->next = 0;
+}
+
+int addScheduleEvent(Schedule *schedule, Uint32 frame, int type, int data) {
+    if (schedule->count == SCHEDULE_MAX_EVENTS) return -1;
+
+    // Insertion from the end: events are nearly always added in order
+    int i = schedule->count;
+    while (i > schedule->next && (Sint32)(schedule->events[i - 1].frame - frame) > 0) {
+        i--;
+    }
+    memmove(&schedule->events[i + 1], &schedule->events[i],
+            (schedule->count - i) * sizeof(ScheduleEvent));
+    schedule->events[i].frame = frame;
+    schedule->events[i].type = type;
+    schedule->events[i].data = data;
+    schedule->count++;
+    return 0;
+}
+
+// Half a period either way: the frame shown nearest the sound
+static int eventDue(const ScheduleEvent *event, Uint64 presentUs, Uint32 framePeriodUs) {
+    return audioFrameTimeUs(event->frame) <= presentUs + framePeriodUs / 2;
+}
+
+int nextScheduleEvent(Schedule *schedule, Uint64 presentUs, Uint32 framePeriodUs, ScheduleEvent *event) {
+    if (schedule->next >= schedule->count) return 0;
+    if (!eventDue(&schedule->events[schedule->next], presentUs, framePeriodUs)) return 0;
+    *event = schedule->events[schedule->next++];
+    return 1;
+}
+
+int scheduleDone(const Schedule *schedule) {
+    return schedule->next >= schedule->count;
+}
+
+void waitSchedule(const Schedule *schedule, Uint32 framePeriodUs) {
+    Uint64 wait = framePeriodUs;
+    if (schedule->next < schedule->count) {
+        // Wake up when its sound is heard: SDL_Delay may be a little early
+        // or late, the half period of slack in eventDue covers it
+        Uint64 due = audioFrameTimeUs(schedule->events[schedule->next].frame);
+        Uint64 now = timerNowUs();
+        wait = due > now ? due - now : 0;
+        if (wait > framePeriodUs) wait = framePeriodUs;
+    }
+    if (wait >= 1000) SDL_Delay((Uint32)(wait / 1000));
+}
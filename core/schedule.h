@@ -0,0 +1,54 @@
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include <SDL/SDL.h>
+
+// Events timed on the audio clock.
+//
+// Sounds start on an exact frame of the audio clock (scheduleSound in
+// mixer.h). What must be seen with them is queued here for the same frame,
+// and handed out on the video frame shown nearest to the time that audio
+// frame is heard (audioFrameTimeUs in audio.h). Both follow the one clock,
+// so a long sequence does not drift the way a chain of SDL_Delay does.
+//
+//   Uint32 at = audioClock() + audioMsToFrames(500);
+//   scheduleSound(tone, SOUND_EFFECT, 1.0f, 0.0f, at);
+//   addScheduleEvent(&schedule, at, FLASH_ON, button);
+//   ...
+//   while (!scheduleDone(&schedule)) {
+//       while (nextScheduleEvent(&schedule, timerNowUs(), frameUs, &event)) ...
+//       SDL_Flip(screen);
+//       waitSchedule(&schedule, frameUs);
+//   }
+
+#define SCHEDULE_MAX_EVENTS 256
+
+typedef struct {
+    Uint32 frame;  // Audio clock frame the event goes with
+    int type;      // Meaning chosen by the caller
+    int data;
+} ScheduleEvent;
+
+typedef struct {
+    ScheduleEvent events[SCHEDULE_MAX_EVENTS];  // Sorted by frame
+    int count;
+    int next;      // First event not handed out yet
+} Schedule;
+
+void clearSchedule(Schedule *schedule);
+
+// Events on the same frame keep the order they were added in.
+// Returns -1 if the schedule is full.
+int addScheduleEvent(Schedule *schedule, Uint32 frame, int type, int data);
+
+// The next event due on a video frame shown at presentUs (timerNowUs time):
+// its audio is heard before half a frame period after it. Returns 0 when no
+// event is due.
+int nextScheduleEvent(Schedule *schedule, Uint64 presentUs, Uint32 framePeriodUs, ScheduleEvent *event);
+
+int scheduleDone(const Schedule *schedule);
+
+// Sleep until the sound of the next event is heard, a frame period at most
+void waitSchedule(const Schedule *schedule, Uint32 framePeriodUs);
+
+#endif
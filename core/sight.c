@@ -0,0 +1,260 @@
+#include "sight.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ALL_BITS (~(Uint64)0)
+
+static int floorDiv(int a, int b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+int initSightGrid(SightGrid *grid, int width, int height, int cellSize) {
+    memset(grid, 0, sizeof(*grid));
+    if (cellSize <= 0 || width <= 0 || height <= 0) return -1;
+    grid->cellSize = cellSize;
+    grid->cols = (width + cellSize - 1) / cellSize;
+    grid->rows = (height + cellSize - 1) / cellSize;
+    grid->stride = (grid->cols + 63) / 64;
+    grid->bits = calloc((size_t)grid->stride * grid->rows, sizeof(Uint64));
+    if (!grid->bits) {
+        printf("Not enough memory for a %dx%d sight grid\n", grid->cols, grid->rows);
+        freeSightGrid(grid);
+        return -1;
+    }
+    return 0;
+}
+
+void freeSightGrid(SightGrid *grid) {
+    free(grid->bits);
+    memset(grid, 0, sizeof(*grid));
+}
+
+void clearSightGrid(SightGrid *grid) {
+    memset(grid->bits, 0, (size_t)grid->stride * grid->rows * sizeof(Uint64));
+    grid->version++;
+}
+
+// Set or clear the cells col0..col1 of rows row0..row1 (already clipped),
+// a word at a time
+static void fillCells(SightGrid *grid, int col0, int row0, int col1, int row1, int blocked) {
+    int w0 = col0 >> 6, w1 = col1 >> 6;
+    for (int row = row0; row <= row1; row++) {
+        Uint64 *bits = grid->bits + row * grid->stride;
+        for (int w = w0; w <= w1; w++) {
+            Uint64 mask = ALL_BITS;
+            if (w == w0) mask &= ALL_BITS << (col0 & 63);
+            if (w == w1) mask &= ALL_BITS >> (63 - (col1 & 63));
+            bits[w] = blocked ? bits[w] | mask : bits[w] & ~mask;
+        }
+    }
+}
+
+static void fillRect(SightGrid *grid, SDL_Rect rect, int blocked) {
+    if (rect.w == 0 || rect.h == 0) return;
+    int col0 = floorDiv(rect.x, grid->cellSize), row0 = floorDiv(rect.y, grid->cellSize);
+    int col1 = floorDiv(rect.x + rect.w - 1, grid->cellSize);
+    int row1 = floorDiv(rect.y + rect.h - 1, grid->cellSize);
+    if (col0 < 0) col0 = 0;
+    if (row0 < 0) row0 = 0;
+    if (col1 >= grid->cols) col1 = grid->cols - 1;
+    if (row1 >= grid->rows) row1 = grid->rows - 1;
+    if (col0 > col1 || row0 > row1) return;
+    fillCells(grid, col0, row0, col1, row1, blocked);
+}
+
+void setSightRect(SightGrid *grid, SDL_Rect rect, int blocked) {
+    fillRect(grid, rect, blocked);
+    grid->version++;
+}
+
+void blockSightTiles(SightGrid *grid, const TileMap *map) {
+    if (!map->header) return;
+    int ts = map->tileSize;
+    for (int row = 0; row < map->rows; row++) {
+        // Runs of solid tiles along the row
+        for (int col = 0; col < map->cols;) {
+            if (!(map->header->types[tileAt(map, col, row)].flags & TILE_SOLID)) {
+                col++;
+                continue;
+            }
+            int end = col + 1;
+            while (end < map->cols && (map->header->types[tileAt(map, end, row)].flags & TILE_SOLID)) end++;
+            SDL_Rect run = {(Sint16)(col * ts), (Sint16)(row * ts), (Uint16)((end - col) * ts), (Uint16)ts};
+            fillRect(grid, run, 1);
+            col = end;
+        }
+    }
+    grid->version++;
+}
+
+int blockSightMask(SightGrid *grid, SDL_Surface *mask) {
+    if (!mask || (SDL_MUSTLOCK(mask) && SDL_LockSurface(mask) < 0)) return -1;
+
+    SDL_PixelFormat *f = mask->format;
+    int bpp = f->BytesPerPixel;
+    for (int y = 0; y < mask->h && y / grid->cellSize < grid->rows; y++) {
+        Uint8 *row = (Uint8 *)mask->pixels + y * mask->pitch;
+        Uint64 *cells = grid->bits + (y / grid->cellSize) * grid->stride;
+        for (int x = 0; x < mask->w && x / grid->cellSize < grid->cols; x++) {
+            Uint32 pixel;
+            switch (bpp) {
+                case 1: pixel = row[x]; break;
+                case 2: pixel = ((Uint16 *)row)[x]; break;
+                case 4: pixel = ((Uint32 *)row)[x]; break;
+                default: pixel = row[x * 3] | row[x * 3 + 1] << 8 | row[x * 3 + 2] << 16; break;
+            }
+            int solid;
+            if (f->Amask) {
+                Uint8 r, g, b, a;
+                SDL_GetRGBA(pixel, f, &r, &g, &b, &a);
+                solid = a >= 128;
+            } else {
+                solid = !(mask->flags & SDL_SRCCOLORKEY) || pixel != f->colorkey;
+            }
+            int col = x / grid->cellSize;
+            if (solid) cells[col >> 6] |= (Uint64)1 << (col & 63);
+        }
+    }
+    if (SDL_MUSTLOCK(mask)) SDL_UnlockSurface(mask);
+    grid->version++;
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Rays
+//
+// Positions are doubled (pixel x is 2x + 1, its center) so that a ray never
+// starts or ends on a cell border; cells are 2 * cellSize wide. Crossing the
+// next vertical border takes nx / adx of the segment and the next horizontal
+// one ny / ady: comparing nx * ady with ny * adx picks the nearest, exactly.
+// ---------------------------------------------------------------------------
+
+// First blocked cell of col0..col1 in a row (lowest if right, else highest), -1 if none
+static int scanRow(const Uint64 *bits, int col0, int col1, int right) {
+    int first = col0 >> 6, last = col1 >> 6;
+    if (right) {
+        Uint64 word = bits[first] & (ALL_BITS << (col0 & 63));
+        for (int w = first;; word = bits[++w]) {
+            if (w == last) word &= ALL_BITS >> (63 - (col1 & 63));
+            if (word) return w * 64 + __builtin_ctzll(word);
+            if (w == last) return -1;
+        }
+    }
+    Uint64 word = bits[last] & (ALL_BITS >> (63 - (col1 & 63)));
+    for (int w = last;; word = bits[--w]) {
+        if (w == first) word &= ALL_BITS << (col0 & 63);
+        if (word) return w * 64 + 63 - __builtin_clzll(word);
+        if (w == first) return -1;
+    }
+}
+
+static int clampInt(int v, int lo, int hi) {
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+// Stop the ray at the border crossed after moving `along` (doubled pixels)
+// along the axis of the step. The point is kept in the last clear cell
+// (col, row): rounded to a pixel it could fall in a wall beside the ray.
+static int stopRay(SightRay *ray, int cellSize, int col, int row, int xStep, Sint64 along,
+                   int sx, int sy, int adx, int ady) {
+    int X0 = 2 * ray->x0 + 1, Y0 = 2 * ray->y0 + 1;
+    int X, Y;
+    if (xStep) {
+        X = X0 + sx * (int)along - sx;
+        Y = Y0 + sy * (int)(along * ady / adx);
+    } else {
+        X = X0 + sx * (int)(along * adx / ady);
+        Y = Y0 + sy * (int)along - sy;
+    }
+    ray->hitX = clampInt(floorDiv(X, 2), col * cellSize, (col + 1) * cellSize - 1);
+    ray->hitY = clampInt(floorDiv(Y, 2), row * cellSize, (row + 1) * cellSize - 1);
+    ray->blocked = 1;
+    return 1;
+}
+
+int castSightRay(const SightGrid *grid, SightRay *ray) {
+    int cs = grid->cellSize, S = 2 * cs;
+    int X0 = 2 * ray->x0 + 1, Y0 = 2 * ray->y0 + 1;
+    int dx = 2 * (ray->x1 - ray->x0), dy = 2 * (ray->y1 - ray->y0);
+    int sx = dx < 0 ? -1 : 1, sy = dy < 0 ? -1 : 1;
+    int adx = abs(dx), ady = abs(dy);
+    int col = floorDiv(ray->x0, cs), row = floorDiv(ray->y0, cs);
+    int endCol = floorDiv(ray->x1, cs), endRow = floorDiv(ray->y1, cs);
+
+    ray->hitX = ray->x1;
+    ray->hitY = ray->y1;
+    ray->blocked = 0;
+    ray->cells = 1;
+    if (sightBlocked(grid, col, row)) {
+        ray->hitX = ray->x0;
+        ray->hitY = ray->y0;
+        ray->blocked = 1;
+        return 1;
+    }
+
+    // Within one row: the cells in between, a word at a time
+    if (row == endRow && col != endCol) {
+        ray->cells = abs(endCol - col) + 1;
+        if (row < 0 || row >= grid->rows) return 0;
+        int c0 = sx > 0 ? col + 1 : endCol, c1 = sx > 0 ? endCol : col - 1;
+        if (c0 < 0) c0 = 0;
+        if (c1 >= grid->cols) c1 = grid->cols - 1;
+        if (c0 > c1) return 0;
+        int hit = scanRow(grid->bits + row * grid->stride, c0, c1, sx > 0);
+        if (hit < 0) return 0;
+        ray->cells = abs(hit - col) + 1;
+        int border = sx > 0 ? hit * S : (hit + 1) * S;
+        return stopRay(ray, cs, hit - sx, row, 1, sx * (border - X0), sx, sy, adx, ady);
+    }
+
+    // Distances to the next borders, then one cell per step
+    int nx = sx > 0 ? (col + 1) * S - X0 : X0 - col * S;
+    int ny = sy > 0 ? (row + 1) * S - Y0 : Y0 - row * S;
+    int steps = abs(endCol - col) + abs(endRow - row);
+    Sint64 tx = (Sint64)nx * ady, ty = (Sint64)ny * adx;
+    Sint64 txStep = (Sint64)S * ady, tyStep = (Sint64)S * adx;
+    while (steps > 0) {
+        if (tx < ty) {
+            if (sightBlocked(grid, col + sx, row)) return stopRay(ray, cs, col, row, 1, nx, sx, sy, adx, ady);
+            col += sx;
+            steps--;
+            nx += S;
+            tx += txStep;
+        } else if (tx > ty) {
+            if (sightBlocked(grid, col, row + sy)) return stopRay(ray, cs, col, row, 0, ny, sx, sy, adx, ady);
+            row += sy;
+            steps--;
+            ny += S;
+            ty += tyStep;
+        } else {
+            // Through a corner: blocked when both cells beside it are
+            if ((sightBlocked(grid, col + sx, row) && sightBlocked(grid, col, row + sy)) ||
+                sightBlocked(grid, col + sx, row + sy)) {
+                return stopRay(ray, cs, col, row, 1, nx, sx, sy, adx, ady);
+            }
+            col += sx;
+            row += sy;
+            steps -= 2;
+            nx += S;
+            ny += S;
+            tx += txStep;
+            ty += tyStep;
+        }
+        ray->cells++;
+    }
+    return 0;
+}
+
+int castSightRays(const SightGrid *grid, SightRay *rays, int count) {
+    int clear = 0;
+    for (int i = 0; i < count; i++) {
+        clear += !castSightRay(grid, &rays[i]);
+    }
+    return clear;
+}
+
+int lineOfSight(const SightGrid *grid, int x0, int y0, int x1, int y1) {
+    SightRay ray = {x0, y0, x1, y1, 0, 0, 0, 0};
+    return !castSightRay(grid, &ray);
+}
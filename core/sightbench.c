@@ -0,0 +1,190 @@
+// Benchmark of the line of sight
+//
+// Usage: sightbench [frames]
+//
+// A 6400x900 level with random platforms and walls, in 10 pixel cells.
+// Every frame, each enemy casts a ray to the head and to the middle of both
+// players (4 rays), for 256 to 4096 enemies. Prints the cost of a frame of
+// rays and of one ray, walking the bitset against stepping pixel by pixel
+// over a byte per cell, and the same for enemies on the ground level with
+// the players (rays along one row of cells). The grid walk must find every
+// wall that a fine sampling of the segments finds.
+
+#include "sight.h"
+#include "timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LEVEL_W 6400
+#define LEVEL_H 900
+#define CELL 10
+#define GROUND_Y 840
+#define FRAME_BUDGET_US 16667
+
+static const int enemyCounts[] = {256, 1024, 4096};
+
+static void buildLevel(SightGrid *grid, Uint8 *cells) {
+    srand(5);
+    SDL_Rect ground = {0, GROUND_Y + 10, LEVEL_W, LEVEL_H - GROUND_Y - 10};
+    setSightRect(grid, ground, 1);
+    for (int i = 0; i < 60; i++) {
+        SDL_Rect wall = {rand() % LEVEL_W, rand() % GROUND_Y, 0, 0};
+        int platform = rand() % 3;
+        wall.w = platform ? 50 + rand() % 300 : 20 + rand() % 30;
+        wall.h = platform ? 20 : 60 + rand() % 200;
+        setSightRect(grid, wall, 1);
+    }
+    // Low walls on the ground, under eye height
+    for (int x = 300; x < LEVEL_W; x += 700) {
+        SDL_Rect wall = {x, GROUND_Y - 30, 40, 40};
+        setSightRect(grid, wall, 1);
+    }
+    for (int row = 0; row < grid->rows; row++) {
+        for (int col = 0; col < grid->cols; col++) {
+            cells[row * grid->cols + col] = (Uint8)sightBlocked(grid, col, row);
+        }
+    }
+}
+
+// Reference: one cell lookup per pixel along the segment (Bresenham)
+static int pixelWalk(const Uint8 *cells, int cols, SightRay *ray) {
+    int x = ray->x0, y = ray->y0;
+    int dx = abs(ray->x1 - x), dy = -abs(ray->y1 - y);
+    int sx = x < ray->x1 ? 1 : -1, sy = y < ray->y1 ? 1 : -1;
+    int err = dx + dy, lastX = x, lastY = y;
+    for (;;) {
+        if (x >= 0 && y >= 0 && x < LEVEL_W && y < LEVEL_H && cells[(y / CELL) * cols + x / CELL]) {
+            ray->hitX = lastX;
+            ray->hitY = lastY;
+            return ray->blocked = 1;
+        }
+        if (x == ray->x1 && y == ray->y1) return ray->blocked = 0;
+        lastX = x;
+        lastY = y;
+        int e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y += sy;
+        }
+    }
+}
+
+// 1 if a point sampled on the segment, clearly inside a cell, is in a wall
+static int sampledBlocked(const SightGrid *grid, const SightRay *ray) {
+    double x0 = ray->x0 + 0.5, y0 = ray->y0 + 0.5;
+    double dx = ray->x1 - ray->x0, dy = ray->y1 - ray->y0;
+    int n = 8 * (abs(ray->x1 - ray->x0) + abs(ray->y1 - ray->y0)) + 1;
+    for (int k = 0; k <= n; k++) {
+        double fx = (x0 + dx * k / n) / CELL, fy = (y0 + dy * k / n) / CELL;
+        if (fabs(fx - floor(fx + 0.5)) * CELL < 0.01 || fabs(fy - floor(fy + 0.5)) * CELL < 0.01) continue;
+        if (sightBlocked(grid, (int)floor(fx), (int)floor(fy))) return 1;
+    }
+    return 0;
+}
+
+// The players walk across the level, one of them jumping
+static void playersAt(int frame, int *x, int *y) {
+    int span = LEVEL_W - 200;
+    int t = (frame * 5) % (2 * span);
+    x[0] = 100 + (t < span ? t : 2 * span - t);
+    y[0] = GROUND_Y - 60;
+    x[1] = LEVEL_W - x[0];
+    y[1] = GROUND_Y - 60 - (frame % 60 < 30 ? frame % 60 : 60 - frame % 60) * 6;
+}
+
+// 4 rays per enemy: head and middle of both players, from the enemy's eye
+static void fillRays(SightRay *rays, const int *ex, const int *ey, int enemies, int frame) {
+    int px[2], py[2];
+    playersAt(frame, px, py);
+    for (int i = 0; i < enemies; i++) {
+        for (int p = 0; p < 4; p++) {
+            SightRay *ray = &rays[i * 4 + p];
+            ray->x0 = ex[i];
+            ray->y0 = ey[i];
+            ray->x1 = px[p / 2];
+            ray->y1 = py[p / 2] - (p % 2 ? 0 : 40);
+        }
+    }
+}
+
+static void placeEnemies(const SightGrid *grid, int *ex, int *ey, int count, int ground) {
+    for (int i = 0; i < count; i++) {
+        do {
+            ex[i] = rand() % LEVEL_W;
+            ey[i] = ground ? GROUND_Y - 100 : rand() % GROUND_Y;
+        } while (sightBlocked(grid, ex[i] / CELL, ey[i] / CELL));
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int frames = argc > 1 ? atoi(argv[1]) : 120;
+    int maxEnemies = enemyCounts[sizeof(enemyCounts) / sizeof(enemyCounts[0]) - 1];
+    SightGrid grid;
+    if (initSightGrid(&grid, LEVEL_W, LEVEL_H, CELL) < 0) return 1;
+    Uint8 *cells = malloc(grid.cols * grid.rows);
+    int *ex = malloc(maxEnemies * sizeof(int));
+    int *ey = malloc(maxEnemies * sizeof(int));
+    SightRay *rays = malloc(maxEnemies * 4 * sizeof(SightRay));
+    if (!cells || !ex || !ey || !rays) return 1;
+    buildLevel(&grid, cells);
+    int failed = 0;
+
+    printf("%d frames, %dx%d level in %d pixel cells (%d KB of bits), 4 rays per enemy\n", frames, LEVEL_W,
+           LEVEL_H, CELL, (int)(grid.stride * grid.rows * sizeof(Uint64) / 1024));
+    printf("%-8s %7s %6s %8s %9s %7s %9s %9s %7s %8s\n", "enemies", "rays", "clear", "cells", "grid us",
+           "ns/ray", "% frame", "pixels us", "ns/ray", "speedup");
+
+    for (int ground = 0; ground < 2; ground++) {
+        printf("%s\n", ground ? "on the ground with the players:" : "anywhere in the level:");
+        for (int e = 0; e < (int)(sizeof(enemyCounts) / sizeof(enemyCounts[0])); e++) {
+            int enemies = enemyCounts[e], count = enemies * 4;
+            srand(9 + e);
+            placeEnemies(&grid, ex, ey, enemies, ground);
+
+            Uint64 gridUs = 0, pixelUs = 0;
+            long clear = 0, cellsVisited = 0;
+            for (int f = 0; f < frames; f++) {
+                fillRays(rays, ex, ey, enemies, f);
+                Uint64 start = timerNowUs();
+                clear += castSightRays(&grid, rays, count);
+                gridUs += timerNowUs() - start;
+                for (int i = 0; i < count; i++) cellsVisited += rays[i].cells;
+
+                // Check a few frames against the sampling
+                if (f % 20 == 0) {
+                    for (int i = 0; i < count; i++) {
+                        if (!rays[i].blocked && sampledBlocked(&grid, &rays[i])) {
+                            printf("  ray %d %d -> %d %d goes through a wall\n", rays[i].x0, rays[i].y0,
+                                   rays[i].x1, rays[i].y1);
+                            failed = 1;
+                        }
+                    }
+                }
+
+                fillRays(rays, ex, ey, enemies, f);
+                start = timerNowUs();
+                for (int i = 0; i < count; i++) pixelWalk(cells, grid.cols, &rays[i]);
+                pixelUs += timerNowUs() - start;
+            }
+
+            double perFrame = (double)gridUs / frames;
+            printf("%-8d %7d %5.0f%% %8.1f %9.1f %7.1f %8.2f%% %9.1f %7.1f %7.1fx\n", enemies, count,
+                   100.0 * clear / ((double)count * frames), (double)cellsVisited / ((double)count * frames),
+                   perFrame, 1000.0 * gridUs / ((double)count * frames), 100.0 * perFrame / FRAME_BUDGET_US,
+                   (double)pixelUs / frames, 1000.0 * pixelUs / ((double)count * frames),
+                   gridUs ? (double)pixelUs / gridUs : 0.0);
+        }
+    }
+
+    free(cells);
+    free(ex);
+    free(ey);
+    free(rays);
+    freeSightGrid(&grid);
+    return failed;
+}
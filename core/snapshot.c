@@ -0,0 +1,136 @@
+#include "snapshot.h"
+#include "fileio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define PADDED(size) (((size) + SNAPSHOT_ALIGN - 1) & ~(size_t)(SNAPSHOT_ALIGN - 1))
+
+void beginSnapshot(Snapshot *snap) {
+    memset(snap, 0, sizeof(*snap));
+}
+
+static SnapshotHeader *snapshotHeader(Snapshot *snap) {
+    return (SnapshotHeader *)snap->data;
+}
+
+static int reserve(Snapshot *snap, size_t size) {
+    if (size <= snap->capacity) return 0;
+    size_t capacity = snap->capacity ? snap->capacity : 1024;
+    while (capacity < size) capacity *= 2;
+    Uint8 *grown = realloc(snap->data, capacity);
+    if (!grown) return -1;
+    snap->data = grown;
+    snap->capacity = capacity;
+    return 0;
+}
+
+void *addChunk(Snapshot *snap, Uint32 id, Uint16 version, Uint16 index, Uint32 size) {
+    if (snap->mapped) return NULL;
+    if (snap->size == 0) {
+        if (reserve(snap, sizeof(SnapshotHeader)) < 0) return NULL;
+        SnapshotHeader *header = snapshotHeader(snap);
+        memset(header, 0, sizeof(*header));
+        memcpy(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header->byteOrder = SNAPSHOT_BYTE_ORDER;
+        header->version = SNAPSHOT_VERSION;
+        snap->size = sizeof(SnapshotHeader);
+    }
+
+    size_t total = sizeof(SnapshotChunk) + PADDED(size);
+    if (reserve(snap, snap->size + total) < 0) return NULL;
+
+    SnapshotChunk *chunk = (SnapshotChunk *)(snap->data + snap->size);
+    memset(chunk, 0, total);
+    chunk->id = id;
+    chunk->version = version;
+    chunk->index = index;
+    chunk->size = size;
+    snap->size += total;
+
+    SnapshotHeader *header = snapshotHeader(snap);
+    header->chunkCount++;
+    header->size = (Uint32)snap->size;
+    return chunk + 1;
+}
+
+int writeSnapshot(Snapshot *snap, const char *path) {
+    if (!snap->data || snap->mapped) return -1;
+
+    char tmpPath[512];
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+    int fd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        printf("Cannot write %s\n", tmpPath);
+        return -1;
+    }
+    int failed = writeAll(fd, snap->data, snap->size) < 0 || fsync(fd) < 0;
+    if (close(fd) < 0) failed = 1;
+    if (failed || rename(tmpPath, path) < 0) {
+        printf("Cannot save %s\n", path);
+        unlink(tmpPath);
+        return -1;
+    }
+    syncFolder(path);
+    return 0;
+}
+
+int readSnapshot(Snapshot *snap, const char *path) {
+    memset(snap, 0, sizeof(*snap));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(SnapshotHeader)) {
+        close(fd);
+        return -1;
+    }
+    void *base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return -1;
+
+    const SnapshotHeader *header = (const SnapshotHeader *)base;
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        header->byteOrder != SNAPSHOT_BYTE_ORDER || header->version != SNAPSHOT_VERSION ||
+        header->size != (Uint32)st.st_size) {
+        printf("Invalid save %s\n", path);
+        munmap(base, st.st_size);
+        return -1;
+    }
+
+    snap->data = (Uint8 *)base;
+    snap->size = st.st_size;
+    snap->mapped = 1;
+    return 0;
+}
+
+const void *findChunk(const Snapshot *snap, Uint32 id, Uint16 index, Uint16 *version, Uint32 *size) {
+    if (!snap->data || snap->size < sizeof(SnapshotHeader)) return NULL;
+
+    size_t offset = sizeof(SnapshotHeader);
+    while (offset + sizeof(SnapshotChunk) <= snap->size) {
+        const SnapshotChunk *chunk = (const SnapshotChunk *)(snap->data + offset);
+        size_t next = offset + sizeof(SnapshotChunk) + PADDED((size_t)chunk->size);
+        if (next > snap->size) break;  // Truncated
+        if (chunk->id == id && chunk->index == index) {
+            if (version) *version = chunk->version;
+            if (size) *size = chunk->size;
+            return chunk + 1;
+        }
+        offset = next;
+    }
+    return NULL;
+}
+
+void freeSnapshot(Snapshot *snap) {
+    if (snap->mapped) {
+        munmap(snap->data, snap->size);
+    } else {
+        free(snap->data);
+    }
+    memset(snap, 0, sizeof(*snap));
+}
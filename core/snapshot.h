@@ -0,0 +1,70 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <SDL/SDL.h>
+#include <stddef.h>
+
+// Chunked binary snapshots (save files).
+//
+// Layout: SnapshotHeader, then chunks, each a SnapshotChunk followed by its
+// payload padded to SNAPSHOT_ALIGN bytes. A payload is a plain struct of
+// fixed size fields, without pointers: surfaces, sounds and fonts are saved
+// as the path they were loaded from and loaded again from the resource cache.
+//
+// Every chunk carries its own version, and readers skip the chunks they do
+// not know, so a module can change its chunk without touching the others.
+//
+// Nothing is copied chunk by chunk: addChunk() returns the payload inside
+// the output buffer to be filled in place, and a loaded snapshot is a
+// read-only mapping of the file whose payloads findChunk() points into.
+// writeSnapshot() writes <path>.tmp, syncs it, renames it over the file and
+// syncs the folder, so a crash leaves the old save or the new one.
+
+#define SNAPSHOT_MAGIC "EOTSAVE"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_BYTE_ORDER 0x01020304
+#define SNAPSHOT_ALIGN 8
+
+// Chunk identifier from four characters: SNAPSHOT_ID('P','L','Y','R')
+#define SNAPSHOT_ID(a, b, c, d) \
+    ((Uint32)(a) | (Uint32)(b) << 8 | (Uint32)(c) << 16 | (Uint32)(d) << 24)
+
+typedef struct {
+    char magic[8];
+    Uint32 byteOrder;    // SNAPSHOT_BYTE_ORDER as written
+    Uint32 version;
+    Uint32 chunkCount;
+    Uint32 size;         // Bytes of the whole file
+} SnapshotHeader;
+
+typedef struct {
+    Uint32 id;           // SNAPSHOT_ID
+    Uint16 version;      // Version of the payload layout
+    Uint16 index;        // Instance (player 0, player 1 ...)
+    Uint32 size;         // Payload bytes, without the padding
+    Uint32 reserved;
+} SnapshotChunk;
+
+typedef struct {
+    Uint8 *data;         // Output buffer, or the mapped file
+    size_t size;
+    size_t capacity;
+    int mapped;          // data is a mapping (readSnapshot)
+} Snapshot;
+
+// Start an empty snapshot to fill with addChunk()
+void beginSnapshot(Snapshot *snap);
+// Zeroed payload of a new chunk, to fill in place. NULL if out of memory.
+// The pointer is valid until the next addChunk().
+void *addChunk(Snapshot *snap, Uint32 id, Uint16 version, Uint16 index, Uint32 size);
+// Save atomically. Returns -1 if the file was not written.
+int writeSnapshot(Snapshot *snap, const char *path);
+
+// Map a snapshot file. Returns -1 if it is missing or invalid.
+int readSnapshot(Snapshot *snap, const char *path);
+// Payload of a chunk, NULL if missing. version and size can be NULL.
+const void *findChunk(const Snapshot *snap, Uint32 id, Uint16 index, Uint16 *version, Uint32 *size);
+
+void freeSnapshot(Snapshot *snap);
+
+#endif
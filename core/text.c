@@ -0,0 +1,11 @@
+#include "text.h"
+
+void renderText(SDL_Surface *screen, const char *text, int x, int y, SDL_Color color, TTF_Font *font) {
+    if (!font || !text) return;
+    SDL_Surface *textSurface = TTF_RenderText_Solid(font, text, color);
+    if (textSurface) {
+        SDL_Rect textPosition = {x, y, textSurface->w, textSurface->h};
+        SDL_BlitSurface(textSurface, NULL, screen, &textPosition);
+        SDL_FreeSurface(textSurface);
+    }
+}
@@ -0,0 +1,10 @@
+#ifndef TEXT_H
+#define TEXT_H
+
+#include <SDL/SDL.h>
+#include <SDL/SDL_ttf.h>
+
+// Render a line of text at (x, y). Does nothing if the font is missing.
+void renderText(SDL_Surface *screen, const char *text, int x, int y, SDL_Color color, TTF_Font *font);
+
+#endif
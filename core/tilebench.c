@@ -0,0 +1,208 @@
+// Benchmark of the tile-map levels
+//
+// Usage: tilebench [frames]
+//
+// Writes a 6400 x 900 level with 16, 32 and 50 pixel tiles (sky, random
+// platforms, a solid ground and props with transparent corners on it), then
+// prints:
+//   - the time to compile the text and to load (map) the binary,
+//   - the cost of a frame scrolling across the level: composing the chunks
+//     that come into view, drawing the cached chunks, and against that
+//     drawing every visible tile from the sheet,
+//   - the cost of a frame where one tile changes (one chunk composed again).
+// Both ways of drawing must give the same pixels.
+
+#include "tilemap.h"
+#include "blit.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SCREEN_W 1600
+#define SCREEN_H 900
+#define LEVEL_W 6400
+#define LEVEL_H 900
+#define TEXT_PATH "tilebench.txt"
+#define LEVEL_PATH "tilebench.lvl"
+
+static const char symbols[] = "abcdefgh";
+static const int tileSizes[] = {16, 32, 50};
+
+static int writeLevel(int tileSize) {
+    FILE *f = fopen(TEXT_PATH, "w");
+    if (!f) return -1;
+    int cols = LEVEL_W / tileSize, rows = LEVEL_H / tileSize;
+    fprintf(f, "size %d %d %d\n", cols, rows, tileSize);
+    for (int i = 0; symbols[i]; i++) {
+        fprintf(f, "tile %c %d %06x%s\n", symbols[i], i, (rand() & 0xFFFFFF), i == 0 ? " solid" : "");
+    }
+    for (int i = 0; i < 64; i++) {
+        fprintf(f, "object crate %d %d %d %d\n", rand() % LEVEL_W, rand() % LEVEL_H, tileSize, tileSize);
+    }
+    fprintf(f, "grid\n");
+    int last = (int)strlen(symbols) - 1;
+    for (int r = 0; r < rows; r++) {
+        int run = 0;
+        char platform = '.';
+        for (int c = 0; c < cols; c++) {
+            char tile = '.';
+            if (r >= rows - 2) {
+                tile = symbols[0];
+            } else if (r == rows - 3) {
+                tile = rand() % 5 == 0 ? symbols[last] : '.';
+            } else if (r >= rows / 3 && r % 3 == 0) {
+                // Platforms of 4 to 15 tiles
+                if (!run && rand() % 12 == 0) {
+                    run = 4 + rand() % 12;
+                    platform = symbols[1 + rand() % (last - 1)];
+                }
+                if (run) {
+                    tile = platform;
+                    run--;
+                }
+            }
+            fputc(tile, f);
+        }
+        fputc('\n', f);
+    }
+    return fclose(f);
+}
+
+// One tile per symbol in a row; the last one has transparent corners
+static SDL_Surface *makeSheet(int tileSize) {
+    int count = (int)strlen(symbols);
+    SDL_Surface *sheet = SDL_CreateRGBSurface(SDL_SWSURFACE, tileSize * count, tileSize, 32, SPRITE_RMASK,
+                                              SPRITE_GMASK, SPRITE_BMASK, SPRITE_AMASK);
+    if (!sheet) return NULL;
+    for (int y = 0; y < tileSize; y++) {
+        Uint32 *row = (Uint32 *)((Uint8 *)sheet->pixels + y * sheet->pitch);
+        for (int x = 0; x < sheet->w; x++) {
+            int tile = x / tileSize, tx = x % tileSize;
+            Uint32 pixel = SPRITE_AMASK | (Uint32)(tile * 0x1F2F3F + tx * 0x030201 + y * 0x010203);
+            int corner = (tx < tileSize / 4 || tx >= tileSize * 3 / 4) && (y < tileSize / 4 || y >= tileSize * 3 / 4);
+            row[x] = tile == count - 1 && corner ? 0 : pixel;
+        }
+    }
+    return sheet;
+}
+
+// Reference: one blit per visible tile
+static int drawTiles(const TileMap *map, SDL_Surface *screen, const Camera *camera) {
+    int ts = map->tileSize;
+    int c0 = camera->x / ts, c1 = (camera->x + camera->viewport.w - 1) / ts;
+    int r0 = camera->y / ts, r1 = (camera->y + camera->viewport.h - 1) / ts;
+    int blits = 0;
+    for (int row = r0; row <= r1; row++) {
+        for (int col = c0; col <= c1; col++) {
+            int type = tileAt(map, col, row);
+            if (!type) continue;
+            SDL_Rect tile = {(Sint16)(col * ts), (Sint16)(row * ts), (Uint16)ts, (Uint16)ts};
+            SDL_Rect pos = cameraToScreen(camera, tile);
+            SDL_Rect src = {(Sint16)(map->header->types[type].sheetIndex * ts), 0, (Uint16)ts, (Uint16)ts};
+            if (map->opaqueTypes[type]) {
+                copySprite(map->tileset, &src, screen, pos.x, pos.y);
+            } else {
+                blitSprite(map->tileset, &src, screen, &pos);
+            }
+            blits++;
+        }
+    }
+    return blits;
+}
+
+int main(int argc, char *argv[]) {
+    int frames = argc > 1 ? atoi(argv[1]) : 300;
+    int failed = 0;
+    srand(1);
+
+    SDL_Surface *screen = SDL_CreateRGBSurface(SDL_SWSURFACE, SCREEN_W, SCREEN_H, 32, SPRITE_RMASK,
+                                               SPRITE_GMASK, SPRITE_BMASK, SPRITE_AMASK);
+    SDL_Surface *reference = SDL_CreateRGBSurface(SDL_SWSURFACE, SCREEN_W, SCREEN_H, 32, SPRITE_RMASK,
+                                                  SPRITE_GMASK, SPRITE_BMASK, SPRITE_AMASK);
+    if (!screen || !reference) return 1;
+
+    printf("%d frames scrolling a %dx%d level on a %dx%d screen\n", frames, LEVEL_W, LEVEL_H, SCREEN_W, SCREEN_H);
+    printf("%5s %10s %9s %11s %10s %7s %9s %7s %10s\n", "tile", "compile ms", "load ms",
+           "compose us", "chunks us", "blits", "tiles us", "blits", "1 tile us");
+
+    for (int t = 0; t < (int)(sizeof(tileSizes) / sizeof(tileSizes[0])); t++) {
+        int tileSize = tileSizes[t];
+        if (writeLevel(tileSize) < 0) return 1;
+        Uint64 start = timerNowUs();
+        if (compileTileMap(TEXT_PATH, LEVEL_PATH) < 0) return 1;
+        float compileMs = timerElapsedMs(start);
+
+        TileMap map;
+        start = timerNowUs();
+        if (loadTileMap(&map, LEVEL_PATH) < 0) return 1;
+        float loadMs = timerElapsedMs(start);
+        SDL_Surface *sheet = makeSheet(tileSize);
+        setTileMapTileset(&map, sheet);
+
+        Camera camera;
+        SDL_Rect viewport = {0, 0, SCREEN_W, SCREEN_H};
+        initCamera(&camera, viewport);
+        int span = map.width - SCREEN_W;
+
+        // Chunks: composed as they come into view, then copied
+        int chunkBlits = 0;
+        Uint64 composeUs = 0, chunkUs = 0;
+        for (int f = 0; f < frames; f++) {
+            setCameraPosition(&camera, span * f / frames, 0);
+            SDL_FillRect(screen, NULL, 0);
+            start = timerNowUs();
+            prepareTileMap(&map, &camera);
+            endTileMapFrame(&map);
+            composeUs += timerNowUs() - start;
+            start = timerNowUs();
+            chunkBlits += drawTileMap(&map, screen, &camera);
+            chunkUs += timerNowUs() - start;
+        }
+
+        int tileBlits = 0;
+        Uint64 tileUs = 0;
+        for (int f = 0; f < frames; f++) {
+            setCameraPosition(&camera, span * f / frames, 0);
+            SDL_FillRect(reference, NULL, 0);
+            start = timerNowUs();
+            tileBlits += drawTiles(&map, reference, &camera);
+            tileUs += timerNowUs() - start;
+        }
+        if (memcmp(screen->pixels, reference->pixels, (size_t)screen->pitch * SCREEN_H) != 0) {
+            printf("  tile size %d: chunks and tiles differ\n", tileSize);
+            failed = 1;
+        }
+
+        // One tile changed per frame: only its chunk is composed again
+        Uint32 builtBefore = map.chunksBuilt;
+        Uint64 editUs = 0;
+        for (int f = 0; f < frames; f++) {
+            int col = camera.x / tileSize + rand() % (SCREEN_W / tileSize);
+            int row = rand() % map.rows;
+            setTile(&map, col, row, 1 + rand() % 7);
+            start = timerNowUs();
+            prepareTileMap(&map, &camera);
+            endTileMapFrame(&map);
+            editUs += timerNowUs() - start;
+        }
+        if (map.chunksBuilt - builtBefore > (Uint32)frames * 4) {
+            printf("  tile size %d: %u chunks composed for %d tiles\n", tileSize,
+                   map.chunksBuilt - builtBefore, frames);
+            failed = 1;
+        }
+
+        printf("%5d %10.2f %9.3f %11.1f %10.1f %7.1f %9.1f %7.1f %10.1f\n", tileSize, compileMs, loadMs,
+               (double)composeUs / frames, (double)chunkUs / frames, (double)chunkBlits / frames,
+               (double)tileUs / frames, (double)tileBlits / frames, (double)editUs / frames);
+        freeTileMap(&map);
+        SDL_FreeSurface(sheet);
+    }
+
+    unlink(TEXT_PATH);
+    unlink(LEVEL_PATH);
+    SDL_FreeSurface(screen);
+    SDL_FreeSurface(reference);
+    return failed;
+}
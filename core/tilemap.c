@@ -0,0 +1,596 @@
+#include "tilemap.h"
+#include "blit.h"
+#include "resources.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TILEMAP_MAX_CELLS (1 << 24)
+#define TILEMAP_MAX_OBJECTS 4096
+#define TILEMAP_LINE_MAX 4096
+
+// TileSpan.kind
+enum { CHUNK_SPAN_EMPTY, CHUNK_SPAN_OPAQUE, CHUNK_SPAN_BLEND };
+
+// ---------------------------------------------------------------------------
+// Compiler
+
+static char *nextWord(char **cursor) {
+    char *s = *cursor;
+    while (*s && isspace((unsigned char)*s)) s++;
+    if (!*s) {
+        *cursor = s;
+        return NULL;
+    }
+    char *word = s;
+    while (*s && !isspace((unsigned char)*s)) s++;
+    if (*s) *s++ = '\0';
+    *cursor = s;
+    return word;
+}
+
+static void copyName(char *dst, size_t size, const char *src) {
+    strncpy(dst, src, size - 1);
+    dst[size - 1] = '\0';
+}
+
+int compileTileMap(const char *textPath, const char *binaryPath) {
+    FILE *in = fopen(textPath, "r");
+    if (!in) {
+        printf("Level not found: %s\n", textPath);
+        return -1;
+    }
+
+    TileMapHeader *header = calloc(1, sizeof(TileMapHeader));
+    TileObject *objects = malloc(TILEMAP_MAX_OBJECTS * sizeof(TileObject));
+    Uint8 *tiles = NULL;
+    if (!header || !objects) {
+        printf("Not enough memory to compile level %s\n", textPath);
+        fclose(in);
+        free(objects);
+        free(header);
+        return -1;
+    }
+    int symbolType[256];
+    for (int i = 0; i < 256; i++) symbolType[i] = -1;
+    symbolType['.'] = symbolType[' '] = 0;
+    header->typeCount = 1;   // 0 is the empty cell
+
+    char line[TILEMAP_LINE_MAX];
+    int lineNumber = 0;
+    int gridRow = -1;        // Next grid row, -1 before "grid"
+    int failed = 0;
+    while (!failed && fgets(line, sizeof(line), in)) {
+        lineNumber++;
+        line[strcspn(line, "\r\n")] = '\0';
+
+        if (gridRow >= 0) {
+            if (gridRow >= (int)header->rows) break;
+            Uint8 *row = tiles + (size_t)gridRow * header->cols;
+            size_t len = strlen(line);
+            for (size_t c = 0; c < len && c < header->cols; c++) {
+                int type = symbolType[(unsigned char)line[c]];
+                if (type < 0) {
+                    printf("%s:%d: unknown tile '%c'\n", textPath, lineNumber, line[c]);
+                    failed = 1;
+                    break;
+                }
+                row[c] = (Uint8)type;
+            }
+            if (len > header->cols) {
+                printf("%s:%d: row longer than %u tiles\n", textPath, lineNumber, header->cols);
+                failed = 1;
+            }
+            gridRow++;
+            continue;
+        }
+
+        // Comments are whole lines: '#' is a valid tile character
+        char *cursor = line;
+        char *directive = nextWord(&cursor);
+        if (!directive || directive[0] == '#') continue;
+
+        if (!strcmp(directive, "size")) {
+            char *cols = nextWord(&cursor), *rows = nextWord(&cursor), *size = nextWord(&cursor);
+            header->cols = cols ? (Uint32)atoi(cols) : 0;
+            header->rows = rows ? (Uint32)atoi(rows) : 0;
+            header->tileSize = size ? (Uint32)atoi(size) : 0;
+            if (!header->cols || !header->rows || !header->tileSize || tiles ||
+                (Uint64)header->cols * header->rows > TILEMAP_MAX_CELLS) {
+                printf("%s:%d: bad size\n", textPath, lineNumber);
+                failed = 1;
+                continue;
+            }
+            tiles = calloc((size_t)header->cols * header->rows, 1);
+            if (!tiles) {
+                printf("Not enough memory for the %ux%u grid of level %s\n",
+                       header->cols, header->rows, textPath);
+                failed = 1;
+            }
+        } else if (!strcmp(directive, "tileset") || !strcmp(directive, "minimap")) {
+            char *path = nextWord(&cursor);
+            if (!path || strlen(path) >= TILEMAP_PATH_MAX) {
+                printf("%s:%d: bad %s path\n", textPath, lineNumber, directive);
+                failed = 1;
+                continue;
+            }
+            copyName(directive[0] == 't' ? header->tileset : header->minimap, TILEMAP_PATH_MAX, path);
+        } else if (!strcmp(directive, "tile")) {
+            char *symbol = nextWord(&cursor), *index = nextWord(&cursor), *color = nextWord(&cursor);
+            if (!symbol || symbol[1] || !index || !color || symbolType[(unsigned char)symbol[0]] >= 0 ||
+                header->typeCount >= TILEMAP_MAX_TYPES) {
+                printf("%s:%d: bad tile (one new character, sheet index, RRGGBB color)\n",
+                       textPath, lineNumber);
+                failed = 1;
+                continue;
+            }
+            TileType *type = &header->types[header->typeCount];
+            type->symbol = symbol[0];
+            type->sheetIndex = (Uint16)atoi(index);
+            type->color = (Uint32)strtoul(color, NULL, 16) & 0xFFFFFF;
+            char *flag;
+            while ((flag = nextWord(&cursor))) {
+                if (!strcmp(flag, "solid")) {
+                    type->flags |= TILE_SOLID;
+                } else {
+                    printf("%s:%d: unknown tile flag %s\n", textPath, lineNumber, flag);
+                    failed = 1;
+                }
+            }
+            symbolType[(unsigned char)symbol[0]] = (int)header->typeCount++;
+        } else if (!strcmp(directive, "object")) {
+            char *type = nextWord(&cursor);
+            char *x = nextWord(&cursor), *y = nextWord(&cursor);
+            char *w = nextWord(&cursor), *h = nextWord(&cursor);
+            if (!type || !h || strlen(type) >= TILEMAP_NAME_MAX ||
+                header->objectCount >= TILEMAP_MAX_OBJECTS) {
+                printf("%s:%d: bad object (type x y w h)\n", textPath, lineNumber);
+                failed = 1;
+                continue;
+            }
+            TileObject *object = &objects[header->objectCount++];
+            memset(object, 0, sizeof(*object));
+            copyName(object->type, TILEMAP_NAME_MAX, type);
+            object->x = atoi(x);
+            object->y = atoi(y);
+            object->w = atoi(w);
+            object->h = atoi(h);
+        } else if (!strcmp(directive, "grid")) {
+            if (!tiles) {
+                printf("%s:%d: grid before size\n", textPath, lineNumber);
+                failed = 1;
+                continue;
+            }
+            gridRow = 0;
+        } else {
+            printf("%s:%d: unknown directive %s\n", textPath, lineNumber, directive);
+            failed = 1;
+        }
+    }
+    fclose(in);
+
+    if (!failed && !tiles) {
+        printf("%s: no size\n", textPath);
+        failed = 1;
+    }
+
+    if (!failed) {
+        memcpy(header->magic, TILEMAP_MAGIC, sizeof(TILEMAP_MAGIC));
+        header->byteOrder = TILEMAP_BYTE_ORDER;
+        header->version = TILEMAP_VERSION;
+        header->tilesOffset = sizeof(TileMapHeader);
+        header->objectsOffset = (header->tilesOffset + header->cols * header->rows + 3) & ~3u;
+
+        // Written beside it and renamed: a game mapping the old file keeps it
+        char tmpPath[512];
+        snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", binaryPath);
+        FILE *out = fopen(tmpPath, "wb");
+        static const Uint8 padding[4] = {0, 0, 0, 0};
+        size_t cells = (size_t)header->cols * header->rows;
+        if (!out ||
+            fwrite(header, sizeof(TileMapHeader), 1, out) != 1 ||
+            fwrite(tiles, 1, cells, out) != cells ||
+            fwrite(padding, 1, header->objectsOffset - header->tilesOffset - cells, out) !=
+                header->objectsOffset - header->tilesOffset - cells ||
+            fwrite(objects, sizeof(TileObject), header->objectCount, out) != header->objectCount) {
+            printf("Cannot write %s\n", tmpPath);
+            failed = 1;
+        }
+        if (out && fclose(out) != 0) failed = 1;
+        if (failed || rename(tmpPath, binaryPath) < 0) {
+            unlink(tmpPath);
+            failed = 1;
+        }
+    }
+
+    free(tiles);
+    free(objects);
+    free(header);
+    return failed ? -1 : 0;
+}
+
+// ---------------------------------------------------------------------------
+// Loading
+
+// levels/level1.lvl -> levels/level1.txt
+static void textPathOf(const char *path, char *text, size_t size) {
+    snprintf(text, size, "%s", path);
+    char *dot = strrchr(text, '.');
+    char *slash = strrchr(text, '/');
+    if (dot && (!slash || dot > slash)) *dot = '\0';
+    strncat(text, ".txt", size - strlen(text) - 1);
+}
+
+// 1 if every pixel of the tile is opaque
+static int opaqueTile(const TileMap *map, const TileType *type) {
+    if (!map->tileset) return 1;
+    SDL_Surface *sheet = map->tileset;
+    int perRow = sheet->w / map->tileSize;
+    if (perRow <= 0) return 0;
+    int sx = (type->sheetIndex % perRow) * map->tileSize;
+    int sy = (type->sheetIndex / perRow) * map->tileSize;
+    if (sy + map->tileSize > sheet->h) return 0;
+    for (int y = 0; y < map->tileSize; y++) {
+        const Uint32 *row = (const Uint32 *)((const Uint8 *)sheet->pixels + (sy + y) * sheet->pitch) + sx;
+        for (int x = 0; x < map->tileSize; x++) {
+            if ((row[x] & SPRITE_AMASK) != SPRITE_AMASK) return 0;
+        }
+    }
+    return 1;
+}
+
+// Free the sprite and spans of a chunk (composed again when next needed)
+static void freeChunk(TileMap *map, TileChunk *chunk) {
+    if (chunk->sprite) {
+        SDL_FreeSurface(chunk->sprite);
+        chunk->sprite = NULL;
+        map->cachedChunks--;
+    }
+    free(chunk->spans);
+    chunk->spans = NULL;
+    chunk->spanCount = chunk->spanCapacity = 0;
+    chunk->built = 0;
+}
+
+int loadTileMap(TileMap *map, const char *path) {
+    memset(map, 0, sizeof(*map));
+
+    // Compile the text when it is newer than the binary (or the binary is missing)
+    char textPath[512];
+    textPathOf(path, textPath, sizeof(textPath));
+    struct stat textStat, binaryStat;
+    if (stat(textPath, &textStat) == 0 &&
+        (stat(path, &binaryStat) < 0 || binaryStat.st_mtime < textStat.st_mtime)) {
+        if (compileTileMap(textPath, path) < 0) return -1;
+    }
+
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(TileMapHeader)) {
+        printf("Cannot open level %s\n", path);
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+
+    // MAP_PRIVATE and writable: setTile() changes the pages of this process
+    // only (copy on write), the file keeps the level as compiled
+    void *base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        printf("Cannot map level %s\n", path);
+        return -1;
+    }
+
+    const TileMapHeader *header = (const TileMapHeader *)base;
+    Uint64 cells = (Uint64)header->cols * header->rows;
+    if (memcmp(header->magic, TILEMAP_MAGIC, sizeof(TILEMAP_MAGIC)) != 0 ||
+        header->version != TILEMAP_VERSION ||
+        header->byteOrder != TILEMAP_BYTE_ORDER ||
+        !cells || !header->tileSize || header->typeCount > TILEMAP_MAX_TYPES ||
+        header->tilesOffset + cells > (Uint64)st.st_size ||
+        header->objectsOffset + (Uint64)header->objectCount * sizeof(TileObject) > (Uint64)st.st_size) {
+        printf("Invalid level %s (rebuild it with make levels)\n", path);
+        munmap(base, st.st_size);
+        return -1;
+    }
+
+    map->header = header;
+    map->base = base;
+    map->size = st.st_size;
+    map->tiles = (Uint8 *)base + header->tilesOffset;
+    map->objects = (const TileObject *)((const Uint8 *)base + header->objectsOffset);
+    map->cols = header->cols;
+    map->rows = header->rows;
+    map->tileSize = header->tileSize;
+    map->width = map->cols * map->tileSize;
+    map->height = map->rows * map->tileSize;
+
+    if (header->tileset[0]) {
+        // The sheet is beside the level file
+        char sheetPath[512];
+        const char *slash = strrchr(path, '/');
+        int dirLen = slash ? (int)(slash - path) + 1 : 0;
+        snprintf(sheetPath, sizeof(sheetPath), "%.*s%s", dirLen, path, header->tileset);
+        map->tileset = loadSprite(sheetPath);
+        if (!map->tileset) printf("Tileset %s missing, tiles drawn with their color\n", sheetPath);
+    }
+
+    map->chunkCols = (map->width + TILEMAP_CHUNK - 1) / TILEMAP_CHUNK;
+    map->chunkRows = (map->height + TILEMAP_CHUNK - 1) / TILEMAP_CHUNK;
+    map->chunks = calloc((size_t)map->chunkCols * map->chunkRows, sizeof(TileChunk));
+    if (!map->chunks) {
+        freeTileMap(map);
+        return -1;
+    }
+    setTileMapTileset(map, map->tileset);
+    return 0;
+}
+
+void setTileMapTileset(TileMap *map, SDL_Surface *sheet) {
+    if (map->tileset && map->tileset != sheet) releaseResource(map->tileset);
+    map->tileset = sheet;
+    for (Uint32 i = 1; i < map->header->typeCount; i++) {
+        map->opaqueTypes[i] = (Uint8)opaqueTile(map, &map->header->types[i]);
+    }
+    for (int i = 0; i < map->chunkCols * map->chunkRows; i++) {
+        map->chunks[i].built = 0;
+    }
+}
+
+void freeTileMap(TileMap *map) {
+    if (map->chunks) {
+        for (int i = 0; i < map->chunkCols * map->chunkRows; i++) {
+            freeChunk(map, &map->chunks[i]);
+        }
+        free(map->chunks);
+    }
+    if (map->tileset) releaseResource(map->tileset);
+    if (map->base) munmap(map->base, map->size);
+    memset(map, 0, sizeof(*map));
+}
+
+// ---------------------------------------------------------------------------
+// Tiles and objects
+
+int tileAt(const TileMap *map, int col, int row) {
+    if (col < 0 || row < 0 || col >= map->cols || row >= map->rows) return 0;
+    int type = map->tiles[row * map->cols + col];
+    return type < (int)map->header->typeCount ? type : 0;
+}
+
+int tileSolidAt(const TileMap *map, int x, int y) {
+    if (x < 0 || y < 0) return 0;
+    int type = tileAt(map, x / map->tileSize, y / map->tileSize);
+    return type && (map->header->types[type].flags & TILE_SOLID);
+}
+
+void setTile(TileMap *map, int col, int row, int type) {
+    if (col < 0 || row < 0 || col >= map->cols || row >= map->rows) return;
+    if (type < 0 || type >= (int)map->header->typeCount) type = 0;
+    if (map->tiles[row * map->cols + col] == type) return;
+    map->tiles[row * map->cols + col] = (Uint8)type;
+
+    // A tile can straddle up to four chunks
+    int x0 = col * map->tileSize, y0 = row * map->tileSize;
+    int x1 = x0 + map->tileSize - 1, y1 = y0 + map->tileSize - 1;
+    for (int cy = y0 / TILEMAP_CHUNK; cy <= y1 / TILEMAP_CHUNK && cy < map->chunkRows; cy++) {
+        for (int cx = x0 / TILEMAP_CHUNK; cx <= x1 / TILEMAP_CHUNK && cx < map->chunkCols; cx++) {
+            map->chunks[cy * map->chunkCols + cx].built = 0;
+        }
+    }
+}
+
+const TileObject *findTileObject(const TileMap *map, const char *type, int index) {
+    for (Uint32 i = 0; i < map->header->objectCount; i++) {
+        if (!strcmp(map->objects[i].type, type) && index-- == 0) return &map->objects[i];
+    }
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Chunks
+
+// Pixel rectangle of a chunk in the level (the last ones are cut)
+static SDL_Rect chunkBounds(const TileMap *map, int cx, int cy) {
+    SDL_Rect r;
+    r.x = (Sint16)(cx * TILEMAP_CHUNK);
+    r.y = (Sint16)(cy * TILEMAP_CHUNK);
+    r.w = (Uint16)(map->width - r.x < TILEMAP_CHUNK ? map->width - r.x : TILEMAP_CHUNK);
+    r.h = (Uint16)(map->height - r.y < TILEMAP_CHUNK ? map->height - r.y : TILEMAP_CHUNK);
+    return r;
+}
+
+static int spanKind(const TileMap *map, int type) {
+    return !type ? CHUNK_SPAN_EMPTY : map->opaqueTypes[type] ? CHUNK_SPAN_OPAQUE : CHUNK_SPAN_BLEND;
+}
+
+// Add a run of tiles of one kind to the spans, lengthening the span of the
+// tile row above when it has the same columns
+static int addSpan(TileChunk *chunk, int x, int y, int w, int h, int kind) {
+    for (int i = 0; i < chunk->spanCount; i++) {
+        TileSpan *span = &chunk->spans[i];
+        if (span->x == x && span->w == w && span->kind == kind && span->y + span->h == y) {
+            span->h = (Uint16)(span->h + h);
+            return 0;
+        }
+    }
+    if (chunk->spanCount == chunk->spanCapacity) {
+        int capacity = chunk->spanCapacity ? chunk->spanCapacity * 2 : 16;
+        TileSpan *spans = realloc(chunk->spans, capacity * sizeof(TileSpan));
+        if (!spans) return -1;
+        chunk->spans = spans;
+        chunk->spanCapacity = capacity;
+    }
+    TileSpan *span = &chunk->spans[chunk->spanCount++];
+    span->x = (Sint16)x;
+    span->y = (Sint16)y;
+    span->w = (Uint16)w;
+    span->h = (Uint16)h;
+    span->kind = (Uint8)kind;
+    return 0;
+}
+
+// Runs of opaque and of other tiles, in chunk pixels; empty cells have none
+static int buildSpans(TileMap *map, TileChunk *chunk, SDL_Rect bounds) {
+    int ts = map->tileSize;
+    int c0 = bounds.x / ts, c1 = (bounds.x + bounds.w - 1) / ts;
+    int r0 = bounds.y / ts, r1 = (bounds.y + bounds.h - 1) / ts;
+    chunk->spanCount = 0;
+    for (int row = r0; row <= r1; row++) {
+        int y0 = row * ts - bounds.y, y1 = y0 + ts;
+        if (y0 < 0) y0 = 0;
+        if (y1 > bounds.h) y1 = bounds.h;
+        int col = c0;
+        while (col <= c1) {
+            int kind = spanKind(map, tileAt(map, col, row));
+            int end = col + 1;
+            while (end <= c1 && spanKind(map, tileAt(map, end, row)) == kind) end++;
+            if (kind != CHUNK_SPAN_EMPTY) {
+                int x0 = col * ts - bounds.x, x1 = end * ts - bounds.x;
+                if (x0 < 0) x0 = 0;
+                if (x1 > bounds.w) x1 = bounds.w;
+                if (addSpan(chunk, x0, y0, x1 - x0, y1 - y0, kind) < 0) return -1;
+            }
+            col = end;
+        }
+    }
+    return 0;
+}
+
+static void buildChunk(TileMap *map, int cx, int cy) {
+    TileChunk *chunk = &map->chunks[cy * map->chunkCols + cx];
+    SDL_Rect bounds = chunkBounds(map, cx, cy);
+    if (buildSpans(map, chunk, bounds) < 0) {
+        freeChunk(map, chunk);
+        return;
+    }
+    chunk->built = 1;
+    if (!chunk->spanCount) {
+        // Nothing to draw: no sprite
+        if (chunk->sprite) {
+            SDL_FreeSurface(chunk->sprite);
+            chunk->sprite = NULL;
+            map->cachedChunks--;
+        }
+        return;
+    }
+
+    if (!chunk->sprite) {
+        chunk->sprite = SDL_CreateRGBSurface(SDL_SWSURFACE, bounds.w, bounds.h, 32, SPRITE_RMASK,
+                                             SPRITE_GMASK, SPRITE_BMASK, SPRITE_AMASK);
+        if (!chunk->sprite) {
+            freeChunk(map, chunk);
+            return;
+        }
+        map->cachedChunks++;
+    }
+    SDL_FillRect(chunk->sprite, NULL, 0);
+
+    int ts = map->tileSize;
+    int c0 = bounds.x / ts, c1 = (bounds.x + bounds.w - 1) / ts;
+    int r0 = bounds.y / ts, r1 = (bounds.y + bounds.h - 1) / ts;
+    SDL_Surface *sheet = map->tileset;
+    int perRow = sheet ? sheet->w / ts : 0;
+    for (int row = r0; row <= r1; row++) {
+        for (int col = c0; col <= c1; col++) {
+            int type = tileAt(map, col, row);
+            if (!type) continue;
+            const TileType *tile = &map->header->types[type];
+            int x = col * ts - bounds.x, y = row * ts - bounds.y;
+            if (perRow > 0) {
+                SDL_Rect src = {(Sint16)((tile->sheetIndex % perRow) * ts),
+                                (Sint16)((tile->sheetIndex / perRow) * ts), (Uint16)ts, (Uint16)ts};
+                if (map->opaqueTypes[type]) {
+                    copySprite(sheet, &src, chunk->sprite, x, y);
+                } else {
+                    SDL_Rect dst = {(Sint16)x, (Sint16)y, 0, 0};
+                    blitSprite(sheet, &src, chunk->sprite, &dst);
+                }
+            } else {
+                SDL_Rect dst = {(Sint16)x, (Sint16)y, (Uint16)ts, (Uint16)ts};
+                SDL_FillRect(chunk->sprite, &dst, SPRITE_AMASK | tile->color);
+            }
+        }
+    }
+    map->chunksBuilt++;
+}
+
+// Chunks seen by the camera
+static void visibleChunks(const TileMap *map, const Camera *camera, int *cx0, int *cy0, int *cx1, int *cy1) {
+    int x0 = camera->x < 0 ? 0 : camera->x;
+    int y0 = camera->y < 0 ? 0 : camera->y;
+    *cx0 = x0 / TILEMAP_CHUNK;
+    *cy0 = y0 / TILEMAP_CHUNK;
+    *cx1 = (camera->x + camera->viewport.w - 1) / TILEMAP_CHUNK;
+    *cy1 = (camera->y + camera->viewport.h - 1) / TILEMAP_CHUNK;
+    if (*cx1 >= map->chunkCols) *cx1 = map->chunkCols - 1;
+    if (*cy1 >= map->chunkRows) *cy1 = map->chunkRows - 1;
+}
+
+void prepareTileMap(TileMap *map, const Camera *camera) {
+    if (!map->chunks) return;
+    int cx0, cy0, cx1, cy1;
+    visibleChunks(map, camera, &cx0, &cy0, &cx1, &cy1);
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            TileChunk *chunk = &map->chunks[cy * map->chunkCols + cx];
+            chunk->lastUsed = map->frame;
+            if (!chunk->built) buildChunk(map, cx, cy);
+        }
+    }
+}
+
+void endTileMapFrame(TileMap *map) {
+    if (!map->chunks) return;
+    // Free the least recently used sprites; the ones of this frame are kept
+    // (the compositor may still draw them)
+    while (map->cachedChunks > TILEMAP_CACHE_CHUNKS) {
+        TileChunk *oldest = NULL;
+        for (int i = 0; i < map->chunkCols * map->chunkRows; i++) {
+            TileChunk *chunk = &map->chunks[i];
+            if (chunk->sprite && chunk->lastUsed != map->frame &&
+                (!oldest || chunk->lastUsed < oldest->lastUsed)) {
+                oldest = chunk;
+            }
+        }
+        if (!oldest) break;
+        freeChunk(map, oldest);
+    }
+    map->frame++;
+}
+
+int drawTileMap(TileMap *map, SDL_Surface *screen, const Camera *camera) {
+    if (!map->chunks) return 0;
+    int cx0, cy0, cx1, cy1;
+    visibleChunks(map, camera, &cx0, &cy0, &cx1, &cy1);
+    int blits = 0;
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            // Chunks that were not prepared are skipped: they are composed
+            // (and old ones freed) only in prepareTileMap(), before the frame
+            // is recorded, so the sprites a recording holds stay alive
+            TileChunk *chunk = &map->chunks[cy * map->chunkCols + cx];
+            if (!chunk->sprite || !chunk->built) continue;
+            SDL_Rect pos = cameraToScreen(camera, chunkBounds(map, cx, cy));
+
+            // One blit per span: copied when opaque, blended otherwise
+            for (int i = 0; i < chunk->spanCount; i++) {
+                const TileSpan *span = &chunk->spans[i];
+                SDL_Rect src = {span->x, span->y, span->w, span->h};
+                if (span->kind == CHUNK_SPAN_OPAQUE) {
+                    copySprite(chunk->sprite, &src, screen, pos.x + span->x, pos.y + span->y);
+                } else {
+                    SDL_Rect dst = {(Sint16)(pos.x + span->x), (Sint16)(pos.y + span->y), 0, 0};
+                    blitSprite(chunk->sprite, &src, screen, &dst);
+                }
+                blits++;
+            }
+        }
+    }
+    return blits;
+}
@@ -0,0 +1,139 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include <SDL/SDL.h>
+#include "camera.h"
+
+// Tile-map levels.
+//
+// A level is written as text (levels/*.txt) and compiled to a binary .lvl
+// file (make levels, or on load when the .lvl is missing or older than the
+// text). The binary is TileMapHeader, the tile indexes of every cell row by
+// row (one byte each), then the objects. It is mapped, not read: loading a
+// level of any size only validates the header.
+//
+// Text format, one directive per line (lines starting with # are comments):
+//
+//   size 128 18 50               columns, rows, tile size in pixels
+//   tileset assets/tiles.png     optional sheet of square tiles, row by row
+//   minimap minimap_level1.png   optional thumbnail for the minimap
+//   tile # 3 6b4f2a solid        grid character, sheet index, color drawn
+//                                when there is no sheet, flags
+//   object obstacle 100 750 50 50   named rectangle in level pixels
+//   grid                         then one line of characters per row
+//                                ('.' and ' ' are empty cells)
+//
+// Drawing goes through a cache of TILEMAP_CHUNK pixel square chunks: the
+// tiles of a chunk are composed once into a sprite, and a frame draws the
+// few visible chunks instead of every tile. A chunk keeps the rectangles its
+// tiles cover, merged across rows: runs of opaque tiles are copied, the
+// others blended, empty cells skipped. setTile() marks its chunk dirty and
+// only that chunk is composed again.
+
+#define TILEMAP_MAGIC "EOTMAP1"
+#define TILEMAP_VERSION 1
+#define TILEMAP_BYTE_ORDER 0x01020304
+#define TILEMAP_PATH_MAX 128
+#define TILEMAP_MAX_TYPES 64       // Tile types per level, 0 is the empty cell
+#define TILEMAP_NAME_MAX 16
+#define TILEMAP_CHUNK 256          // Chunk size in pixels
+#define TILEMAP_CACHE_CHUNKS 96    // Chunk sprites kept at most (256 KB each)
+
+#define TILE_SOLID 0x0001
+
+typedef struct {
+    Uint16 sheetIndex;   // Tile of the sheet, row by row
+    Uint16 flags;        // TILE_SOLID ...
+    Uint32 color;        // 0xRRGGBB, drawn when the sheet is missing
+    char symbol;         // Grid character (kept for the tools)
+    char reserved[3];
+} TileType;
+
+typedef struct {
+    char type[TILEMAP_NAME_MAX];
+    Sint32 x, y, w, h;
+} TileObject;
+
+typedef struct {
+    char magic[8];
+    Uint32 byteOrder;     // TILEMAP_BYTE_ORDER as written
+    Uint32 version;
+    Uint32 cols, rows;
+    Uint32 tileSize;
+    Uint32 typeCount;
+    Uint32 objectCount;
+    Uint32 tilesOffset;   // cols * rows bytes
+    Uint32 objectsOffset; // objectCount TileObject
+    char tileset[TILEMAP_PATH_MAX];   // Relative to the level file, "" = colors
+    char minimap[TILEMAP_PATH_MAX];
+    TileType types[TILEMAP_MAX_TYPES];
+} TileMapHeader;
+
+// Run of tiles of a chunk drawn with one blit (in chunk pixels)
+typedef struct {
+    Sint16 x, y;
+    Uint16 w, h;
+    Uint8 kind;           // Opaque tiles (copied) or not (blended)
+} TileSpan;
+
+typedef struct {
+    SDL_Surface *sprite;  // Composed tiles, NULL when empty or not cached
+    TileSpan *spans;      // Where the sprite has tiles
+    int spanCount, spanCapacity;
+    Uint32 lastUsed;      // Frame the chunk was last needed
+    int built;            // sprite and spans match the tiles
+} TileChunk;
+
+typedef struct {
+    const TileMapHeader *header;
+    Uint8 *tiles;               // cols * rows, in a private (copy on write) mapping
+    const TileObject *objects;
+    void *base;
+    size_t size;
+    int cols, rows, tileSize;
+    int width, height;          // In pixels
+
+    SDL_Surface *tileset;       // Sprite from the resource cache, or NULL
+    Uint8 opaqueTypes[TILEMAP_MAX_TYPES];
+    TileChunk *chunks;
+    int chunkCols, chunkRows;
+    int cachedChunks;           // Chunks holding a sprite
+    Uint32 frame;
+    Uint32 chunksBuilt;         // Compositions since the load (counter)
+} TileMap;
+
+// Compile a text level. Errors are printed with their line. Returns 0 or -1.
+int compileTileMap(const char *textPath, const char *binaryPath);
+
+// Map a compiled level (levels/level1.lvl), compiling the text beside it
+// (levels/level1.txt) first if the .lvl is missing or older. The tileset is
+// loaded from the level's folder. Returns 0, or -1 if there is no valid level.
+int loadTileMap(TileMap *map, const char *path);
+void freeTileMap(TileMap *map);
+
+// Draw the tiles from another sheet (a sprite, see blit.h), or with their
+// color if NULL. Every chunk is composed again. A sheet that is not from the
+// resource cache stays owned by the caller.
+void setTileMapTileset(TileMap *map, SDL_Surface *sheet);
+
+// Tile type of a cell, 0 outside the map
+int tileAt(const TileMap *map, int col, int row);
+// 1 if the level pixel is on a solid tile
+int tileSolidAt(const TileMap *map, int x, int y);
+// Change a cell; its chunk is composed again when next drawn
+void setTile(TileMap *map, int col, int row, int type);
+
+// The index-th object of a type, NULL when there are no more
+const TileObject *findTileObject(const TileMap *map, const char *type, int index);
+
+// Compose the dirty chunks seen by the camera, and free the least recently
+// used sprites past TILEMAP_CACHE_CHUNKS. Call on the main thread before the
+// frame is recorded by a compositor (the chunks it draws must stay alive).
+void prepareTileMap(TileMap *map, const Camera *camera);
+// End of the preparation of a frame (every view prepared)
+void endTileMapFrame(TileMap *map);
+
+// Draw the chunks seen by the camera; returns the number of blits
+int drawTileMap(TileMap *map, SDL_Surface *screen, const Camera *camera);
+
+#endif
@@ -0,0 +1,12 @@
+#include "timer.h"
+#include <time.h>
+
+Uint64 timerNowUs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Uint64)ts.tv_sec * 1000000u + (Uint64)(ts.tv_nsec / 1000);
+}
+
+float timerElapsedMs(Uint64 startUs) {
+    return (float)(timerNowUs() - startUs) / 1000.0f;
+}
@@ -0,0 +1,12 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <SDL/SDL.h>
+
+// Monotonic time in microseconds (SDL_GetTicks only has 1 ms resolution)
+Uint64 timerNowUs(void);
+
+// Elapsed milliseconds since a timerNowUs() value
+float timerElapsedMs(Uint64 startUs);
+
+#endif
@@ -3,12 +3,22 @@
 #include <stdio.h>
 #include "enemy.h"
 
+const ParticleEffect ENEMY_HIT_SPARKS = {24, 0.0f, -2.0f, 5.0f, 12, 24, 0xFFE080, 2};
+const ParticleEffect ENEMY_DEATH_BURST = {160, 0.0f, -4.0f, 7.0f, 30, 60, 0xC02020, 3};
+
 void initializeEnemy(Enemy *e, const char *imagePath) {
-    e->sprite = IMG_Load(imagePath);
-    if (!e->sprite) {
+    SDL_Surface *image = IMG_Load(imagePath);
+    if (!image) {
         fprintf(stderr, "Failed to load sprite: %s\n", SDL_GetError());
         exit(EXIT_FAILURE);
     }
+    // Premultiplied copy for blitSprite
+    e->sprite = makeSprite(image);
+    SDL_FreeSurface(image);
+    if (!e->sprite) {
+        fprintf(stderr, "Failed to convert sprite: %s\n", SDL_GetError());
+        exit(EXIT_FAILURE);
+    }
 
     e->direction = DIRECTION_RIGHT;
     e->state = STATE_WALKING;
@@ -17,6 +27,7 @@ void initializeEnemy(Enemy *e, const char *imagePath) {
     e->isDead = 0;
     e->deathRow = 4;
     e->animTickCounter = 0;
+    e->alreadyAttacked = 0;
 
     e->totalFramesPerRow[0] = 12; // walk right
     e->totalFramesPerRow[1] = 12; // walk left
@@ -75,13 +86,18 @@ void animateEnemy(Enemy *e) {
 }
 
 void blitEnemy(SDL_Surface *screen, Enemy *e) {
-    SDL_BlitSurface(e->sprite, &e->posSprite, screen, &e->posScreen);
+    Camera *camera = activeCamera();
+    SDL_Rect bounds = {e->posScreen.x, e->posScreen.y, FRAME_WIDTH, FRAME_HEIGHT};
+    if (!cameraVisible(camera, &bounds, 0)) return;
+
+    SDL_Rect pos = cameraToScreen(camera, e->posScreen);
+    blitSprite(e->sprite, &e->posSprite, screen, &pos);
 }
 
 void deplacerEnemy(Enemy *e, int posMin, int posMax) {
     if (e->state != STATE_WALKING || e->isDead) return;
 
-    int speed = 2;
+    int speed = ENEMY_SPEED;
 
     if (e->posScreen.x <= posMin)
         e->direction = DIRECTION_RIGHT;
@@ -97,7 +113,88 @@ void deplacerEnemy(Enemy *e, int posMin, int posMax) {
     }
 }
 
-int checkCollision(SDL_Rect a, SDL_Rect b) {
+// Start an attack when touching the target, once per contact
+static void checkEnemyAttack(Enemy *e, SDL_Rect target) {
+    if (!e->isDead && checkEnemyCollision(e->posScreen, target)) {
+        if (e->state == STATE_WALKING && !e->alreadyAttacked) {
+            e->state = STATE_ATTACKING;
+            e->currentFrame = 0;
+            e->alreadyAttacked = 1;
+        }
+    } else {
+        e->alreadyAttacked = 0;
+    }
+}
+
+// One simulation step: attack the target when touching it, otherwise patrol
+void updateEnemy(Enemy *e, SDL_Rect target, int posMin, int posMax) {
+    checkEnemyAttack(e, target);
+
+    if (e->state == STATE_WALKING) {
+        deplacerEnemy(e, posMin, posMax);
+    } else if (e->state == STATE_ATTACKING || e->state == STATE_DEAD) {
+        animateEnemy(e);
+    }
+}
+
+// Step toward the next cell center of the field, ENEMY_SPEED per axis.
+// Returns 0 when the field gives no step (target cell reached or unreachable).
+static int chaseStep(Enemy *e, const NavGrid *grid, const NavField *field) {
+    int feetX = e->posScreen.x + FRAME_WIDTH / 2;
+    int feetY = e->posScreen.y + FRAME_HEIGHT - 1;
+    int nextX, nextY;
+    if (!navFieldStep(grid, field, feetX, feetY, &nextX, &nextY)) return 0;
+
+    int dx = nextX - feetX, dy = nextY - feetY;
+    if (dx > ENEMY_SPEED) dx = ENEMY_SPEED;
+    if (dx < -ENEMY_SPEED) dx = -ENEMY_SPEED;
+    if (dy > ENEMY_SPEED) dy = ENEMY_SPEED;
+    if (dy < -ENEMY_SPEED) dy = -ENEMY_SPEED;
+    e->posScreen.x += dx;
+    e->posScreen.y += dy;
+    if (dx) e->direction = (dx > 0) ? DIRECTION_RIGHT : DIRECTION_LEFT;
+
+    e->pixelsMoved += ENEMY_SPEED;
+    if (e->pixelsMoved >= 16) {
+        animateEnemy(e);
+        e->pixelsMoved = 0;
+    }
+    return 1;
+}
+
+void updateEnemyChase(Enemy *e, SDL_Rect target, int targetSeen, const NavGrid *grid,
+                      const NavField *field, int posMin, int posMax) {
+    checkEnemyAttack(e, target);
+
+    if (e->state == STATE_WALKING) {
+        int gap = (target.x + target.w / 2) - (e->posScreen.x + FRAME_WIDTH / 2);
+        int inRange = targetSeen && gap < ENEMY_CHASE_RANGE && gap > -ENEMY_CHASE_RANGE;
+        // Standing in the target's cell: wait for the attack rather than patrol away
+        if (!inRange || (!chaseStep(e, grid, field) &&
+                         navFieldDistance(grid, field, e->posScreen.x + FRAME_WIDTH / 2,
+                                          e->posScreen.y + FRAME_HEIGHT - 1) == NAV_UNREACHABLE)) {
+            deplacerEnemy(e, posMin, posMax);
+        }
+    } else if (e->state == STATE_ATTACKING || e->state == STATE_DEAD) {
+        animateEnemy(e);
+    }
+}
+
+void damageEnemy(Enemy *e, int amount) {
+    if (e->isDead || e->health <= 0) return;
+
+    e->health -= amount;
+    if (e->health <= 0) {
+        e->health = 0;
+        e->deathRow = (e->direction == DIRECTION_RIGHT) ? 4 : 5;
+        e->state = STATE_DEAD;
+        e->currentFrame = 0;
+        e->animTickCounter = 0;
+        e->isDead = 1;
+    }
+}
+
+int checkEnemyCollision(SDL_Rect a, SDL_Rect b) {
     return (
         a.x < b.x + b.w &&
         a.x + a.w > b.x &&
@@ -109,13 +206,18 @@ int checkCollision(SDL_Rect a, SDL_Rect b) {
 void drawHealthBar(SDL_Surface *screen, Enemy *e) {
     if (e->isDead) return;
 
+    Camera *camera = activeCamera();
+    SDL_Rect bounds = {e->posScreen.x, e->posScreen.y, FRAME_WIDTH, FRAME_HEIGHT};
+    if (!cameraVisible(camera, &bounds, HEALTH_BAR_MARGIN)) return;
+    SDL_Rect pos = cameraToScreen(camera, e->posScreen);
+
     int barWidth = 60;
     int barHeight = 8;
-    int barX = e->posScreen.x + (FRAME_WIDTH - barWidth) / 2;
-    int barY = e->posScreen.y - barHeight - 5;
+    int barX = pos.x + (FRAME_WIDTH - barWidth) / 2;
+    int barY = pos.y - barHeight - 5;
 
     SDL_Rect bg = { barX, barY, barWidth, barHeight };
-    SDL_FillRect(screen, &bg, SDL_MapRGB(screen->format, 60, 60, 60));
+    fillRect(screen, &bg, SDL_MapRGB(screen->format, 60, 60, 60));
 
     int healthWidth = (e->health * barWidth) / e->maxHealth;
     SDL_Rect fg = { barX, barY, healthWidth, barHeight };
@@ -126,6 +228,6 @@ void drawHealthBar(SDL_Surface *screen, Enemy *e) {
         (e->health > 60) ? 0 : 0
     );
 
-    SDL_FillRect(screen, &fg, color);
+    fillRect(screen, &fg, color);
 }
 
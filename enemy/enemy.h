@@ -2,9 +2,19 @@
 #define ENEMY_H
 
 #include <SDL/SDL.h>
+#include "../core/blit.h"
+#include "../core/camera.h"
+#include "../core/nav.h"
+#include "../core/particles.h"
+// Track the enemy sprite (included last, it wraps the SDL calls)
+#ifndef MEM_MODULE
+#define MEM_MODULE "enemy"
+#endif
+#include "../core/memtrack.h"
 
 #define FRAME_WIDTH 100
 #define FRAME_HEIGHT 135
+#define HEALTH_BAR_MARGIN 16   // The health bar is drawn above the sprite
 
 #define DIRECTION_RIGHT 0
 #define DIRECTION_LEFT 1
@@ -14,11 +24,14 @@
 #define STATE_DEAD 2
 
 #define MAX_FRAMES 12
+#define ENEMY_SPEED 2
+#define ENEMY_CHASE_RANGE 800  // Horizontal distance at which the enemy starts chasing
+#define ENEMY_EYE_Y 30         // Height of the eyes from the top of the sprite (line of sight)
 #define MAX_ROWS 6
 
 typedef struct {
     SDL_Surface *sprite;
-    SDL_Rect posScreen;
+    SDL_Rect posScreen;    // Position in the level, drawn through activeCamera()
     SDL_Rect posSprite;
     int direction;
     int currentFrame;
@@ -30,13 +43,26 @@ typedef struct {
     int isDead;
     int deathRow;
     int animTickCounter;
+    int alreadyAttacked;
 } Enemy;
 
+// Particles on every hit and the bigger burst when the enemy dies, shared by
+// the game and the enemy demo
+extern const ParticleEffect ENEMY_HIT_SPARKS;
+extern const ParticleEffect ENEMY_DEATH_BURST;
+
 void initializeEnemy(Enemy *e, const char *imagePath);
 void animateEnemy(Enemy *e);
 void blitEnemy(SDL_Surface *screen, Enemy *e);
 void deplacerEnemy(Enemy *e, int posMin, int posMax);
-int checkCollision(SDL_Rect a, SDL_Rect b);
+void updateEnemy(Enemy *e, SDL_Rect target, int posMin, int posMax);
+// Like updateEnemy, but walks toward a target in range and in sight along
+// the flow field pointed at it (from the enemy's feet), and patrols when out
+// of range, out of sight or unreachable
+void updateEnemyChase(Enemy *e, SDL_Rect target, int targetSeen, const NavGrid *grid,
+                      const NavField *field, int posMin, int posMax);
+void damageEnemy(Enemy *e, int amount);
+int checkEnemyCollision(SDL_Rect a, SDL_Rect b);
 void drawHealthBar(SDL_Surface *screen, Enemy *e);
 
 #endif
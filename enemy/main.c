@@ -1,6 +1,8 @@
 #include <SDL/SDL.h>
 #include <SDL/SDL_image.h>
 #include "enemy.h"
+#include "../core/profiler.h"
+#include "../core/particles.h"
 
 int main(int argc, char *argv[]) {
     SDL_Surface *screen;
@@ -24,54 +26,58 @@ int main(int argc, char *argv[]) {
     SDL_Rect player = { 1000, 400, 100, 135 };
     int posMin = (1600 - FRAME_WIDTH) / 2;
     int posMax = 1600 - FRAME_WIDTH - 100;
-    int alreadyAttacked = 0;
+
+    ParticlePool particles;
+    initParticles(&particles, 4096);
+
+    initProfiler(); // F3: profiler overlay, F4: trace dump
 
     while (running) {
         SDL_Event event;
+        int zone = PROFILE_BEGIN("input");
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT)
                 running = 0;
 
-            if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_SPACE) {
-                if (!enemy.isDead && enemy.health > 0) {
-                    enemy.health -= 5;
-                    if (enemy.health <= 0) {
-                        enemy.health = 0;
-                        enemy.deathRow = (enemy.direction == DIRECTION_RIGHT) ? 4 : 5;
-                        enemy.state = STATE_DEAD;
-                        enemy.currentFrame = 0;
-                        enemy.animTickCounter = 0;
-                        enemy.isDead = 1;
-                    }
-                }
-            }
-        }
+            if (profilerHandleEvent(&event))
+                continue;
 
-        if (!enemy.isDead && checkCollision(enemy.posScreen, player)) {
-            if (enemy.state == STATE_WALKING && !alreadyAttacked) {
-                enemy.state = STATE_ATTACKING;
-                enemy.currentFrame = 0;
-                alreadyAttacked = 1;
+            if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_SPACE) {
+                int wasDead = enemy.isDead;
+                damageEnemy(&enemy, 5);
+                float x = enemy.posScreen.x + FRAME_WIDTH / 2;
+                float y = enemy.posScreen.y + FRAME_HEIGHT / 2;
+                if (!wasDead) emitParticles(&particles, &ENEMY_HIT_SPARKS, x, y);
+                if (!wasDead && enemy.isDead) emitParticles(&particles, &ENEMY_DEATH_BURST, x, y);
             }
-        } else {
-            alreadyAttacked = 0;
         }
+        PROFILE_END(zone);
 
-        if (enemy.state == STATE_WALKING) {
-            deplacerEnemy(&enemy, posMin, posMax);
-        } else if (enemy.state == STATE_ATTACKING || enemy.state == STATE_DEAD) {
-            animateEnemy(&enemy);
-        }
+        zone = PROFILE_BEGIN("update");
+        updateEnemy(&enemy, player, posMin, posMax);
+        updateParticles(&particles);
+        PROFILE_END(zone);
 
+        zone = PROFILE_BEGIN("draw");
         SDL_FillRect(screen, NULL, SDL_MapRGB(screen->format, 0, 0, 0)); // black background
         SDL_FillRect(screen, &player, SDL_MapRGB(screen->format, 255, 255, 255)); // mock white player
         blitEnemy(screen, &enemy);
         drawHealthBar(screen, &enemy);
+        drawParticles(&particles, screen, NULL);
+        drawProfilerOverlay(screen);
+        PROFILE_END(zone);
+
+        zone = PROFILE_BEGIN("flip");
         SDL_Flip(screen);
+        PROFILE_END(zone);
         SDL_Delay(16);
+        PROFILE_FRAME();
     }
 
+    closeProfiler();
+    freeParticles(&particles);
     SDL_FreeSurface(enemy.sprite);
+    memReportLeaks();
     SDL_Quit();
     return 0;
 }
@@ -5,6 +5,7 @@
 #include <SDL/SDL_image.h>
 #include <SDL/SDL_ttf.h>
 #include <SDL/SDL_mixer.h>
+#include "background/background.h"
 
 // Constants
 #define SCREEN_WIDTH 1600
@@ -74,11 +75,6 @@ typedef struct {
     int h;
 } collision;
 
-typedef struct {
-    SDL_Surface *image;
-    SDL_Rect pos;
-} background;
-
 typedef struct {
     Uint32 start_time;
     Uint32 elapsed_time;
@@ -98,6 +94,7 @@ typedef struct {
     int isDead;
     int deathRow;
     int animTickCounter;
+    int alreadyAttacked;
 } Enemy;
 
 // Function prototypes
@@ -114,12 +111,7 @@ void display_minimap(minimap m, SDL_Surface *screen);
 void Liberer_minimap(minimap *m);
 void background_animation_after_collision(minimap *m, SDL_Surface *screen);
 
-// Background
-void initback(background *bg, Mix_Music *musique);
-void initpartage(background *bg1, background *bg2, Mix_Music *musique);
-void afficher_back(background bg, SDL_Surface *ecran);
-void scrolling(background *bg, SDL_Rect *pos, int vitesse, int d);
-void clamp_player(SDL_Rect *pos, background *bg, SDL_Surface *player_surf, int view_w, int view_h);
+// Background (initback, initpartage, afficher_back, scrolling, clamp_player: background/background.h)
 void afficher_temps(SDL_Surface *ecran, TTF_Font *font, GameTime *game_time, SDL_Color color);
 
 // Enemy
@@ -127,7 +119,9 @@ void initializeEnemy(Enemy *e, const char *imagePath);
 void animateEnemy(Enemy *e);
 void blitEnemy(SDL_Surface *screen, Enemy *e);
 void deplacerEnemy(Enemy *e, int posMin, int posMax);
-int checkCollision(SDL_Rect a, SDL_Rect b);
+void updateEnemy(Enemy *e, SDL_Rect target, int posMin, int posMax);
+void damageEnemy(Enemy *e, int amount);
+int checkEnemyCollision(SDL_Rect a, SDL_Rect b);
 void drawHealthBar(SDL_Surface *screen, Enemy *e);
 
 // Collision
@@ -0,0 +1,103 @@
+#include <SDL/SDL.h>
+#include <SDL/SDL_image.h>
+#include <SDL/SDL_mixer.h>
+#include <SDL/SDL_ttf.h>
+#include <stdio.h>
+#include "../core/audio.h"
+#include "../core/resources.h"
+#include "../core/loader.h"
+#include "../core/jobs.h"
+#include "../core/archive.h"
+#include "../core/profiler.h"
+#include "../core/memtrack.h"
+#include "scenes.h"
+
+#define SCREEN_WIDTH 1600
+#define SCREEN_HEIGHT 900
+
+GameScenes gameScenes;
+
+int main(int argc, char *argv[]) {
+    (void)argc;
+    (void)argv;
+
+    // SDL, the window and the audio device are opened once for every screen
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
+        printf("SDL initialization failed: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    if (!(IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG) & IMG_INIT_PNG)) {
+        printf("IMG_Init failed: %s\n", IMG_GetError());
+        SDL_Quit();
+        return 1;
+    }
+
+    if (TTF_Init() < 0) {
+        printf("TTF_Init failed: %s\n", TTF_GetError());
+        IMG_Quit();
+        SDL_Quit();
+        return 1;
+    }
+
+    if (initAudio(audioLatencySetting()) < 0) {
+        printf("Audio init failed: %s\n", Mix_GetError());
+        TTF_Quit();
+        IMG_Quit();
+        SDL_Quit();
+        return 1;
+    }
+
+    SDL_Surface *screen = SDL_SetVideoMode(SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_SWSURFACE);
+    if (!screen) {
+        printf("SDL_SetVideoMode failed: %s\n", SDL_GetError());
+        closeAudio();
+        TTF_Quit();
+        IMG_Quit();
+        SDL_Quit();
+        return 1;
+    }
+    SDL_WM_SetCaption("Echoes of Time", NULL);
+
+    setupMainMenuScene(&gameScenes.mainMenu);
+    setupPlayerMenuScene(&gameScenes.playerMenu);
+    setupAvatarMenuScene(&gameScenes.avatarMenu);
+    setupOptionsScene(&gameScenes.options);
+    setupGameplayScene(&gameScenes.gameplay);
+    setupPuzzleScene(&gameScenes.puzzle);
+    setupHighscoresScene(&gameScenes.highscores);
+    gameScenes.playerCount = 1;
+
+    // Pre-decoded assets (built with "make assets"); loose files are used without it
+    mountArchive("../assets.pak");
+
+    // F3 shows the profiler overlay, PROFILE=1 records from the start
+    initProfiler();
+    TTF_Font *profilerFont = loadFont("../playermenu/alagard.ttf", 14);
+    profilerSetFont(profilerFont);
+
+    SceneManager manager;
+    initSceneManager(&manager, screen);
+    pushScene(&manager, &gameScenes.mainMenu);
+    runScenes(&manager);
+    clearScenes(&manager);
+
+    closeProfiler();
+    profilerSetFont(NULL);
+    releaseResource(profilerFont);
+
+    printTransitionStats(&manager);
+    printResourceStats();
+    closeLoader(defaultLoader());
+    closeJobPool(defaultJobPool());
+    freeResources();
+    unmountArchive();
+    memReport();
+    memReportLeaks();
+
+    closeAudio();
+    TTF_Quit();
+    IMG_Quit();
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include "../player/gameplay.h"
+#include "scenes.h"
+#include <string.h>
+
+static Gameplay game;
+
+static void enterGameplay(Scene *scene) {
+    (void)scene;
+    initGameplay(&game, gameScenes.playerCount > 0 ? gameScenes.playerCount : 1);
+    // Continue the game left with "Save & Quit" (same number of players)
+    resumeGameplay(&game);
+}
+
+static void leaveGameplay(Scene *scene) {
+    (void)scene;
+    saveGameplayScores(&game);
+    freeGameplay(&game);
+}
+
+static void updateGameplayScene(Scene *scene) {
+    // "Quit" in the pause menu goes back to the menus
+    if (gameplayQuitRequested(&game)) {
+        popScene(scene->manager);
+        return;
+    }
+    // Keys are read from the snapshot the scene manager filled this frame
+    updateGameplay(&game, defaultInput());
+}
+
+static void drawGameplayScene(Scene *scene, SDL_Surface *screen) {
+    (void)scene;
+    drawGameplay(&game, screen);
+}
+
+void setupGameplayScene(Scene *scene) {
+    memset(scene, 0, sizeof(*scene));
+    scene->name = "gameplay";
+    scene->assetDir = "../player";
+    scene->music = "";  // The menu music fades out
+    scene->data = &game;
+    scene->enter = enterGameplay;
+    scene->leave = leaveGameplay;
+    scene->update = updateGameplayScene;
+    scene->draw = drawGameplayScene;
+}
@@ -0,0 +1,114 @@
+#include "../core/highscore.h"
+#include "../core/resources.h"
+#include "../core/input.h"
+#include "../core/text.h"
+#include "scenes.h"
+#include <stdio.h>
+#include <string.h>
+
+// Highscore screen, opened by the Highscores button of the main menu.
+// The store is mapped and its tables are already sorted, so the board is
+// rendered once on enter (about 40 lines of text) whatever the size of the
+// history, then only blitted.
+
+#define BOARD_W 1200
+#define BOARD_H 640
+#define COLUMN_W 380
+
+static SDL_Surface *background;
+static SDL_Surface *board;
+
+static void boardText(TTF_Font *font, const char *text, int x, int y, SDL_Color color) {
+    renderText(board, text, x, y, color, font);
+}
+
+// Score aligned on the right edge of its column
+static void boardNumber(TTF_Font *font, int value, int right, int y, SDL_Color color) {
+    char text[16];
+    int w = 0;
+    snprintf(text, sizeof(text), "%d", value);
+    TTF_SizeText(font, text, &w, NULL);
+    renderText(board, text, right - w, y, color, font);
+}
+
+static void renderBoard(SDL_Surface *screen) {
+    board = SDL_CreateRGBSurface(SDL_SWSURFACE, BOARD_W, BOARD_H, 32, screen->format->Rmask,
+                                 screen->format->Gmask, screen->format->Bmask, 0);
+    if (!board) return;
+    SDL_FillRect(board, NULL, SDL_MapRGB(board->format, 20, 20, 30));
+
+    TTF_Font *titleFont = loadFont("../playermenu/alagard.ttf", 48);
+    TTF_Font *font = loadFont("../playermenu/alagard.ttf", 28);
+    SDL_Color white = {255, 255, 255, 0};
+    SDL_Color gold = {255, 210, 80, 0};
+    SDL_Color grey = {150, 150, 160, 0};
+
+    boardText(titleFont, "Highscores", BOARD_W / 2 - 120, 20, gold);
+
+    HighscoreStore *store = defaultHighscores();
+    for (int m = 0; m < HIGHSCORE_MODES; m++) {
+        int x = 30 + m * (COLUMN_W + 10);
+        char line[64];
+        boardText(font, highscoreModeName(m), x, 100, gold);
+        snprintf(line, sizeof(line), "%u played", highscoresPlayed(store, m));
+        boardText(font, line, x, 135, grey);
+
+        if (highscoreCount(store, m) == 0) {
+            boardText(font, "No score yet", x, 190, grey);
+        }
+        for (int r = 0; r < highscoreCount(store, m); r++) {
+            const HighscoreEntry *entry = highscoreAt(store, m, r);
+            snprintf(line, sizeof(line), "%d. %.*s", r + 1, HIGHSCORE_NAME_MAX, entry->name);
+            boardText(font, line, x, 190 + r * 38, r == 0 ? gold : white);
+            boardNumber(font, entry->score, x + COLUMN_W - 20, 190 + r * 38, r == 0 ? gold : white);
+        }
+    }
+    boardText(font, "Escape, Return or click to go back", 30, BOARD_H - 50, grey);
+
+    releaseResource(font);
+    releaseResource(titleFont);
+}
+
+static void enterHighscores(Scene *scene) {
+    background = loadImage("backg1.jpeg");
+    renderBoard(scene->manager->screen);
+}
+
+static void leaveHighscores(Scene *scene) {
+    (void)scene;
+    if (board) SDL_FreeSurface(board);
+    board = NULL;
+    releaseResource(background);
+    background = NULL;
+}
+
+static void updateHighscores(Scene *scene) {
+    const InputState *input = defaultInput();
+    if (actionPressed(input, 0, ACTION_PAUSE) || actionPressed(input, 0, ACTION_CONFIRM) ||
+        (input->mouseClicks & SDL_BUTTON(SDL_BUTTON_LEFT))) {
+        popScene(scene->manager);
+    }
+}
+
+static void drawHighscores(Scene *scene, SDL_Surface *screen) {
+    (void)scene;
+    if (background) {
+        SDL_BlitSurface(background, NULL, screen, NULL);
+    } else {
+        SDL_FillRect(screen, NULL, SDL_MapRGB(screen->format, 0, 0, 0));
+    }
+    if (board) {
+        SDL_Rect pos = {(screen->w - BOARD_W) / 2, (screen->h - BOARD_H) / 2, 0, 0};
+        SDL_BlitSurface(board, NULL, screen, &pos);
+    }
+}
+
+void setupHighscoresScene(Scene *scene) {
+    memset(scene, 0, sizeof(*scene));
+    scene->name = "highscores";
+    scene->assetDir = "../mainmenu";
+    scene->enter = enterHighscores;
+    scene->leave = leaveHighscores;
+    scene->update = updateHighscores;
+    scene->draw = drawHighscores;
+}
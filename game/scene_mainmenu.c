@@ -0,0 +1,54 @@
+#include "../mainmenu/header.h"
+#include "scenes.h"
+
+static MainMenu mainMenu;
+
+static void enterMainMenu(Scene *scene) {
+    init_main_menu(&mainMenu);
+    // Play is the usual next step: its music is decoded while the menu shows
+    prerollSceneMusic(scene->manager, &gameScenes.playerMenu);
+}
+
+static void leaveMainMenu(Scene *scene) {
+    (void)scene;
+    free_main_menu(&mainMenu);
+}
+
+static void handleMainMenu(Scene *scene, SDL_Event *event) {
+    switch (handle_main_menu_event(&mainMenu, event)) {
+        case MENU_BTN_PLAY:
+            pushScene(scene->manager, &gameScenes.playerMenu);
+            break;
+        case MENU_BTN_HISTORY:
+            pushScene(scene->manager, &gameScenes.puzzle);
+            break;
+        case MENU_BTN_HIGHSCORES:
+            pushScene(scene->manager, &gameScenes.highscores);
+            break;
+        case MENU_BTN_OPTIONS:
+            pushScene(scene->manager, &gameScenes.options);
+            break;
+        case MENU_BTN_EXIT:
+            quitScenes(scene->manager);
+            break;
+        case MENU_BTN_NONE:
+            break;
+    }
+}
+
+static void drawMainMenu(Scene *scene, SDL_Surface *screen) {
+    (void)scene;
+    show_main_menu(&mainMenu, screen);
+}
+
+void setupMainMenuScene(Scene *scene) {
+    memset(scene, 0, sizeof(*scene));
+    scene->name = "main menu";
+    scene->assetDir = "../mainmenu";
+    scene->music = "music.mp3";  // Crossfaded back in when the other menus are popped
+    scene->data = &mainMenu;
+    scene->enter = enterMainMenu;
+    scene->leave = leaveMainMenu;
+    scene->handleEvent = handleMainMenu;
+    scene->draw = drawMainMenu;
+}
@@ -0,0 +1,46 @@
+#include "../optionsmenu/options.h"
+#include "scenes.h"
+#include <string.h>
+
+static OptionsMenu options;
+static int currentMenu;  // Set to 0 by the options menu when Back is clicked
+
+static void enterOptions(Scene *scene) {
+    memset(&options, 0, sizeof(options));
+    initOptions(&options, scene->manager->screen);
+    currentMenu = 1;
+}
+
+static void leaveOptions(Scene *scene) {
+    (void)scene;
+    cleanupOptions(&options);
+}
+
+static void handleOptions(Scene *scene, SDL_Event *event) {
+    handleOptionsEvents(&options, event, &currentMenu);
+
+    // The display buttons reopen the video mode
+    scene->manager->screen = options.screen;
+
+    if (currentMenu == 0) {
+        popScene(scene->manager);
+    }
+}
+
+static void drawOptionsScene(Scene *scene, SDL_Surface *screen) {
+    (void)scene;
+    options.screen = screen;
+    drawOptions(&options);
+}
+
+void setupOptionsScene(Scene *scene) {
+    memset(scene, 0, sizeof(*scene));
+    scene->name = "options";
+    scene->assetDir = "../optionsmenu";
+    scene->music = "optionsmusic.mp3";
+    scene->data = &options;
+    scene->enter = enterOptions;
+    scene->leave = leaveOptions;
+    scene->handleEvent = handleOptions;
+    scene->draw = drawOptionsScene;
+}
@@ -0,0 +1,99 @@
+#include "../playermenu/players.h"
+#include "scenes.h"
+#include <string.h>
+
+static PlayerMenu playerMenu;
+static AvatarMenu avatarMenu;
+
+// Player menu: single or multi player
+
+static void enterPlayerMenu(Scene *scene) {
+    initPlayerMenu(&playerMenu, scene->manager->screen);
+}
+
+static void leavePlayerMenu(Scene *scene) {
+    (void)scene;
+    cleanupPlayerMenu(&playerMenu);
+}
+
+static void resumePlayerMenu(Scene *scene) {
+    playerMenu.screen = scene->manager->screen;
+}
+
+static void handlePlayerMenu(Scene *scene, SDL_Event *event) {
+    switch (handlePlayerMenuEvent(&playerMenu, event)) {
+        case PLAYERMENU_SINGLE:
+            gameScenes.playerCount = 1;
+            pushScene(scene->manager, &gameScenes.avatarMenu);
+            break;
+        case PLAYERMENU_MULTI:
+            gameScenes.playerCount = 2;
+            pushScene(scene->manager, &gameScenes.avatarMenu);
+            break;
+        case PLAYERMENU_BACK:
+            popScene(scene->manager);
+            break;
+        case PLAYERMENU_NONE:
+            break;
+    }
+}
+
+static void drawPlayerMenuScene(Scene *scene, SDL_Surface *screen) {
+    (void)scene;
+    playerMenu.screen = screen;
+    drawPlayerMenu(&playerMenu);
+}
+
+void setupPlayerMenuScene(Scene *scene) {
+    memset(scene, 0, sizeof(*scene));
+    scene->name = "player menu";
+    scene->assetDir = "../playermenu";
+    scene->music = "playermusic.mp3";
+    scene->data = &playerMenu;
+    scene->enter = enterPlayerMenu;
+    scene->leave = leavePlayerMenu;
+    scene->resume = resumePlayerMenu;
+    scene->handleEvent = handlePlayerMenu;
+    scene->draw = drawPlayerMenuScene;
+}
+
+// Avatar menu: validating starts the game in place of this menu
+
+static void enterAvatarMenu(Scene *scene) {
+    initAvatarMenu(&avatarMenu, scene->manager->screen);
+}
+
+static void leaveAvatarMenu(Scene *scene) {
+    (void)scene;
+    cleanupAvatarMenu(&avatarMenu);
+}
+
+static void handleAvatarMenu(Scene *scene, SDL_Event *event) {
+    switch (handleAvatarMenuEvent(&avatarMenu, event)) {
+        case AVATARMENU_VALIDATE:
+            replaceScene(scene->manager, &gameScenes.gameplay);
+            break;
+        case AVATARMENU_BACK:
+            popScene(scene->manager);
+            break;
+        case AVATARMENU_NONE:
+            break;
+    }
+}
+
+static void drawAvatarMenuScene(Scene *scene, SDL_Surface *screen) {
+    (void)scene;
+    avatarMenu.screen = screen;
+    drawAvatarMenu(&avatarMenu);
+}
+
+void setupAvatarMenuScene(Scene *scene) {
+    memset(scene, 0, sizeof(*scene));
+    scene->name = "avatar menu";
+    scene->assetDir = "../playermenu";
+    scene->data = &avatarMenu;
+    scene->enter = enterAvatarMenu;
+    scene->leave = leaveAvatarMenu;
+    scene->handleEvent = handleAvatarMenu;
+    scene->draw = drawAvatarMenuScene;
+}
@@ -0,0 +1,51 @@
+#include "../puzzle2/puzzle.h"
+#include "scenes.h"
+
+static PuzzleGame puzzle;
+static int shown;  // The first frame was flipped, the transition is done
+
+static void enterPuzzle(Scene *scene) {
+    initPuzzleGame(&puzzle, scene->manager->screen);
+    loadAssets(&puzzle);
+    shuffleButtons(puzzle.buttons);
+    shown = 0;
+}
+
+static void leavePuzzle(Scene *scene) {
+    (void)scene;
+    freePuzzleGame(&puzzle);
+}
+
+// The Simon game has its own blocking loop: run it once the scene is on
+// screen, then go back to the menu (or quit if the window was closed)
+static void updatePuzzle(Scene *scene) {
+    if (!shown) return;
+
+    gameLoop(&puzzle);
+    if (puzzle.quitRequested) {
+        quitScenes(scene->manager);
+    } else {
+        popScene(scene->manager);
+    }
+}
+
+static void drawPuzzle(Scene *scene, SDL_Surface *screen) {
+    (void)scene;
+    if (puzzle.backgroundImage) {
+        SDL_BlitSurface(puzzle.backgroundImage, NULL, screen, NULL);
+    } else {
+        SDL_FillRect(screen, NULL, SDL_MapRGB(screen->format, 0, 0, 0));
+    }
+    shown = 1;
+}
+
+void setupPuzzleScene(Scene *scene) {
+    memset(scene, 0, sizeof(*scene));
+    scene->name = "puzzle";
+    scene->assetDir = "../puzzle2";
+    scene->data = &puzzle;
+    scene->enter = enterPuzzle;
+    scene->leave = leavePuzzle;
+    scene->update = updatePuzzle;
+    scene->draw = drawPuzzle;
+}
@@ -0,0 +1,29 @@
+#ifndef SCENES_H
+#define SCENES_H
+
+#include "../core/scene.h"
+
+// Every screen of the game, wired together by the scene manager
+typedef struct {
+    Scene mainMenu;
+    Scene playerMenu;
+    Scene avatarMenu;
+    Scene options;
+    Scene gameplay;
+    Scene puzzle;
+    Scene highscores;
+    int playerCount;  // Chosen in the player menu, used by the gameplay scene
+} GameScenes;
+
+extern GameScenes gameScenes;
+
+// One setup function per module adapter (scene_*.c)
+void setupMainMenuScene(Scene *scene);
+void setupPlayerMenuScene(Scene *scene);
+void setupAvatarMenuScene(Scene *scene);
+void setupOptionsScene(Scene *scene);
+void setupGameplayScene(Scene *scene);
+void setupPuzzleScene(Scene *scene);
+void setupHighscoresScene(Scene *scene);
+
+#endif
@@ -6,13 +6,14 @@ void show_image(Image img, SDL_Surface *screen) {
 
 void free_image(Image *img) {
     if (img->image) {
-        SDL_FreeSurface(img->image);
+        // L'image reste en cache pour les autres scènes
+        releaseResource(img->image);
         img->image = NULL;
     }
 }
 
 void init_image(Image *img, const char *path, int x, int y, int w, int h) {
-    img->image = IMG_Load(path);
+    img->image = loadImage(path);
     if (img->image == NULL) {
         printf("Error Loading Image : %s\n", SDL_GetError());
         return;
@@ -29,3 +30,80 @@ int image_collision(Image img, int x, int y) {
     return (x >= img.pos.x && x <= img.pos.x + img.ipos.w &&
             y >= img.pos.y && y <= img.pos.y + img.ipos.h);
 }
+
+void init_main_menu(MainMenu *menu) {
+    // Musique en boucle, décodée en arrière-plan (fondu enchaîné avec la précédente)
+    if (playMusic("music.mp3", MUSIC_FADE_MS) < 0) {
+        printf("Error loading music: music.mp3\n");
+    }
+
+    // Initialiser les images
+    init_image(&menu->backg, "backg1.jpeg", 0, 0, WINDOW_WIDTH, WINDOW_HEIGHT); // Agrandir le fond d'écran
+    init_image(&menu->play_btn, "play.png", 600, 200, 400, 100); // Bouton Play (normal)
+    init_image(&menu->play_hover, "play_hover.png", 600, 200, 400, 100); // Bouton Play (hover)
+    init_image(&menu->history_btn, "History.png", 600, 350, 400, 100); // Bouton History (normal)
+    init_image(&menu->history_hover, "History_hover.png", 600, 350, 400, 100); // Bouton History (hover)
+    init_image(&menu->highscores_btn, "highscorespressed.png", 600, 500, 400, 100); // Bouton Highscores (normal)
+    init_image(&menu->highscores_hover, "highscorespressed_hover.png", 600, 500, 400, 100); // Bouton Highscores (hover)
+    init_image(&menu->options_btn, "optionspressed.png", 600, 650, 400, 100); // Bouton Options (normal)
+    init_image(&menu->options_hover, "optionspressed_hover.png", 600, 650, 400, 100); // Bouton Options (hover)
+}
+
+// Afficher un bouton avec effet hover
+static void show_button(Image btn, Image hover, SDL_Surface *screen, int mx, int my) {
+    if (image_collision(btn, mx, my) && hover.image) {
+        show_image(hover, screen); // Afficher l'image hover
+    } else {
+        show_image(btn, screen); // Afficher l'image normale
+    }
+}
+
+void show_main_menu(MainMenu *menu, SDL_Surface *screen) {
+    int mx, my;
+    SDL_GetMouseState(&mx, &my);
+
+    // Afficher l'arrière-plan
+    show_image(menu->backg, screen);
+
+    show_button(menu->play_btn, menu->play_hover, screen, mx, my);
+    show_button(menu->history_btn, menu->history_hover, screen, mx, my);
+    show_button(menu->highscores_btn, menu->highscores_hover, screen, mx, my);
+    show_button(menu->options_btn, menu->options_hover, screen, mx, my);
+}
+
+MenuButton handle_main_menu_event(MainMenu *menu, SDL_Event *event) {
+    switch (event->type) {
+        case SDL_KEYDOWN:
+            if (event->key.keysym.sym == SDLK_ESCAPE) {
+                return MENU_BTN_EXIT;
+            }
+            break;
+        case SDL_MOUSEBUTTONUP:
+            if (event->button.button == SDL_BUTTON_LEFT) {
+                int mx = event->button.x, my = event->button.y;
+                if (image_collision(menu->play_btn, mx, my)) {
+                    return MENU_BTN_PLAY;
+                } else if (image_collision(menu->history_btn, mx, my)) {
+                    return MENU_BTN_HISTORY;
+                } else if (image_collision(menu->highscores_btn, mx, my)) {
+                    return MENU_BTN_HIGHSCORES;
+                } else if (image_collision(menu->options_btn, mx, my)) {
+                    return MENU_BTN_OPTIONS;
+                }
+            }
+            break;
+    }
+    return MENU_BTN_NONE;
+}
+
+void free_main_menu(MainMenu *menu) {
+    free_image(&menu->backg);
+    free_image(&menu->play_btn);
+    free_image(&menu->play_hover);
+    free_image(&menu->history_btn);
+    free_image(&menu->history_hover);
+    free_image(&menu->highscores_btn);
+    free_image(&menu->highscores_hover);
+    free_image(&menu->options_btn);
+    free_image(&menu->options_hover);
+}
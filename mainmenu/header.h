@@ -8,6 +8,16 @@
 #include <SDL/SDL_ttf.h>
 #include <SDL/SDL_image.h>
 #include <SDL/SDL_mixer.h>
+#include "../core/audio.h"
+#include "../core/music.h"
+#include "../core/resources.h"
+#include "../core/profiler.h"
+#include "../core/highscore.h"
+// Suivi des surfaces et des sons du menu (inclus en dernier, remplace les appels SDL)
+#ifndef MEM_MODULE
+#define MEM_MODULE "mainmenu"
+#endif
+#include "../core/memtrack.h"
 
 #define WINDOW_WIDTH 1600
 #define WINDOW_HEIGHT 900
@@ -26,6 +36,24 @@ typedef struct {
     char txt[50];
 } Text;
 
+// Buttons of the main menu
+typedef enum {
+    MENU_BTN_NONE,
+    MENU_BTN_PLAY,
+    MENU_BTN_HISTORY,
+    MENU_BTN_HIGHSCORES,
+    MENU_BTN_OPTIONS,
+    MENU_BTN_EXIT
+} MenuButton;
+
+typedef struct {
+    Image backg;
+    Image play_btn, play_hover;
+    Image history_btn, history_hover;
+    Image highscores_btn, highscores_hover;
+    Image options_btn, options_hover;
+} MainMenu;
+
 // Fonctions pour les images
 void init_image(Image *img, const char *path, int x, int y, int w, int h);
 void show_image(Image img, SDL_Surface *screen);
@@ -39,4 +67,10 @@ void free_text(Text *t);
 // Détection de collision
 int image_collision(Image img, int x, int y);
 
+// Menu principal
+void init_main_menu(MainMenu *menu);
+void show_main_menu(MainMenu *menu, SDL_Surface *screen);
+MenuButton handle_main_menu_event(MainMenu *menu, SDL_Event *event);
+void free_main_menu(MainMenu *menu);
+
 #endif
@@ -2,7 +2,8 @@
 #include <SDL/SDL_image.h>
 #include <SDL/SDL_mixer.h>
 #include <SDL/SDL_ttf.h>
-#include "options.h"  // Assumes this header contains the pre-coded options menu functions
+#include "options.h"
+#include "../core/loader.h"  // Assumes this header contains the pre-coded options menu functions
 
 #define SCREEN_WIDTH 1600
 #define SCREEN_HEIGHT 900
@@ -49,6 +50,11 @@ int main(int argc, char *argv[]) {
     }
     SDL_WM_SetCaption("Pixel-Art Game", NULL);
 
+    // Open the audio device once, the options menu reuses it
+    if (initAudio(audioLatencySetting()) < 0) {
+        printf("Audio init failed: %s\n", Mix_GetError());
+    }
+
     // Initialize SDL_ttf for font rendering
     if (TTF_Init() < 0) {
         printf("TTF Init failed: %s\n", TTF_GetError());
@@ -97,6 +103,7 @@ int main(int argc, char *argv[]) {
         } else if (currentMenu == 1) {
             // Options menu: Draw pre-coded options interface
             drawOptions(&options);
+            SDL_Flip(options.screen);
         }
     }
 
@@ -105,8 +112,13 @@ int main(int argc, char *argv[]) {
         cleanupOptions(&options);  // Free options menu resources if active
     }
     TTF_CloseFont(font);  // Close the font
+    closeLoader(defaultLoader()); // Stop the asset loader threads
+    freeResources();      // Free the cached assets
+    memReport();          // Peak memory per module
+    memReportLeaks();     // Resources that were never freed
     TTF_Quit();           // Quit SDL_ttf
+    closeAudio();         // Close the audio device
     SDL_Quit();           // Quit SDL
 
     return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "options.h"
+#include "../core/loader.h"
 #include <stdio.h>
 
 void initOptions(OptionsMenu *options, SDL_Surface *screen) {
@@ -8,50 +9,57 @@ void initOptions(OptionsMenu *options, SDL_Surface *screen) {
     options->scale_x = (float)screen->w / 1920.0f;
     options->scale_y = (float)screen->h / 1080.0f;
 
+    // Decode every image and sound on the loader threads at the same time
+    AssetLoader *loader = defaultLoader();
+
     // Load pre-scaled background image
-    options->background = IMG_Load("background.jpeg");
-    if (!options->background) {
-        printf("Error loading background image: %s\n", IMG_GetError());
-        return;
-    }
+    queueImage(loader, "background.jpeg", &options->background);
 
     // Load pre-scaled images
-    options->box = IMG_Load("box.jpg");
-    options->btnIncrease = IMG_Load("buttonincrease.png");
-    options->btnIncreasePressed = IMG_Load("buttonincreasepressed.png");
-    options->btnDecrease = IMG_Load("buttondecrease.png");
-    options->btnDecreasePressed = IMG_Load("buttondecreasepressed.png");
-    options->btnMuteOn = IMG_Load("mutebutton.png");  // Muted state
-    options->btnMuteOff = IMG_Load("mutebuttonpressed.png");  // Unmuted state
-    options->btnFullscreen = IMG_Load("fulldisplaybutton.png");
-    options->btnFullscreenPressed = IMG_Load("fulldisplaybuttonpressed.png");
-    options->btnWindowed = IMG_Load("smalldisplaybutton.png");
-    options->btnWindowedPressed = IMG_Load("smalldisplaybuttonpressed.png");
-    options->btnBack = IMG_Load("back.png");
+    queueImage(loader, "box.jpg", &options->box);
+    queueImage(loader, "buttonincrease.png", &options->btnIncrease);
+    queueImage(loader, "buttonincreasepressed.png", &options->btnIncreasePressed);
+    queueImage(loader, "buttondecrease.png", &options->btnDecrease);
+    queueImage(loader, "buttondecreasepressed.png", &options->btnDecreasePressed);
+    queueImage(loader, "mutebutton.png", &options->btnMuteOn);  // Muted state
+    queueImage(loader, "mutebuttonpressed.png", &options->btnMuteOff);  // Unmuted state
+    queueImage(loader, "fulldisplaybutton.png", &options->btnFullscreen);
+    queueImage(loader, "fulldisplaybuttonpressed.png", &options->btnFullscreenPressed);
+    queueImage(loader, "smalldisplaybutton.png", &options->btnWindowed);
+    queueImage(loader, "smalldisplaybuttonpressed.png", &options->btnWindowedPressed);
+    queueImage(loader, "back.png", &options->btnBack);
+
+    // Background music and menu sounds (loaded once instead of on every event)
+    if (initAudio(audioLatencySetting()) < 0) {
+        printf("Mixer Init failed: %s\n", Mix_GetError());
+    }
+    queueSound(loader, "hover.mp3", &options->hoverSound);
+    queueSound(loader, "click.mp3", &options->clickSound);
+
+    // The layout below needs the image sizes
+    finishLoading(loader, screen);
 
     // Check for loading errors
-    if (!options->box || !options->btnIncrease) {
-        printf("Error loading images: %s\n", IMG_GetError());
+    if (!options->background) {
+        printf("Error loading background image: %s\n", IMG_GetError());
         return;
     }
-
-    // Load and play background music
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-        printf("Mixer Init failed: %s\n", Mix_GetError());
+    if (!options->box || !options->btnIncrease || !options->btnBack) {
+        printf("Error loading images: %s\n", IMG_GetError());
         return;
     }
-    options->music = Mix_LoadMUS("optionsmusic.mp3");
-    if (!options->music) {
-        printf("Error loading music: %s\n", Mix_GetError());
+
+    // Decoded by the music streamer, crossfaded with the menu music
+    if (playMusic("optionsmusic.mp3", MUSIC_FADE_MS) < 0) {
+        printf("Error loading music: optionsmusic.mp3\n");
     }
-    Mix_PlayMusic(options->music, -1);  // Loop indefinitely
 
     // Initialize TTF and render text (maintaining font size 32 for larger text)
     if (TTF_Init() < 0) {
         printf("TTF Init failed: %s\n", TTF_GetError());
         return;
     }
-    TTF_Font *font = TTF_OpenFont("alagard.ttf", 32); // Keeping font size at 32 for larger text
+    TTF_Font *font = loadFont("alagard.ttf", 32); // Keeping font size at 32 for larger text
     if (!font) {
         printf("Error loading font: %s\n", TTF_GetError());
         return;
@@ -59,7 +67,7 @@ void initOptions(OptionsMenu *options, SDL_Surface *screen) {
     SDL_Color white = {255, 255, 255};
     options->volumeText = TTF_RenderText_Solid(font, "Volume", white);
     options->displayText = TTF_RenderText_Solid(font, "Display", white);
-    TTF_CloseFont(font);
+    releaseResource(font);
 
     // Position the box (centered at 1600x900)
     options->boxPos.x = (screen->w - options->box->w) / 2;
@@ -138,16 +146,14 @@ void handleOptionsEvents(OptionsMenu *options, SDL_Event *event, int *currentMen
     static int prevHoverState = 0;
     int currentHoverState = options->hoverIncrease || options->hoverDecrease || options->hoverMute ||
                             options->hoverFullscreen || options->hoverWindowed || options->hoverBack;
-    if (currentHoverState && !prevHoverState) {
-        Mix_Chunk *hoverSound = Mix_LoadWAV("hover.mp3");
-        Mix_PlayChannel(-1, hoverSound, 0);
-        Mix_FreeChunk(hoverSound);
+    if (currentHoverState && !prevHoverState && options->hoverSound) {
+        playSound(options->hoverSound, SOUND_UI, 1.0f, 0.0f);
     }
     prevHoverState = currentHoverState;
 
     // Handle keyboard input
     if (event->type == SDL_KEYDOWN) {
-        Mix_Chunk *clickSound = Mix_LoadWAV("click.mp3");
+        Mix_Chunk *clickSound = options->clickSound;
         switch (event->key.keysym.sym) {
             case SDLK_PLUS:  // Increase volume (raises audio by one "tower" or level)
             case SDLK_KP_PLUS:  // NumPad +
@@ -156,8 +162,8 @@ void handleOptionsEvents(OptionsMenu *options, SDL_Event *event, int *currentMen
                     if (options->currentVolume > MIX_MAX_VOLUME) {
                         options->currentVolume = MIX_MAX_VOLUME;
                     }
-                    Mix_VolumeMusic(options->currentVolume);  // Corrected
-                    Mix_PlayChannel(-1, clickSound, 0);
+                    setMusicVolume(options->currentVolume);  // Corrected
+                    playSound(clickSound, SOUND_UI, 1.0f, 0.0f);
                 }
                 break;
 
@@ -168,60 +174,56 @@ void handleOptionsEvents(OptionsMenu *options, SDL_Event *event, int *currentMen
                     if (options->currentVolume < 0) {
                         options->currentVolume = 0;
                     }
-                    Mix_VolumeMusic(options->currentVolume);  // Corrected
-                    Mix_PlayChannel(-1, clickSound, 0);
+                    setMusicVolume(options->currentVolume);  // Corrected
+                    playSound(clickSound, SOUND_UI, 1.0f, 0.0f);
                 }
                 break;
 
             case SDLK_ESCAPE:  // Back button function (return to main menu)
-                *currentMenu = 0; // Exit options menu
-                Mix_HaltMusic();  // Corrected
-                Mix_PlayChannel(-1, clickSound, 0);
+                *currentMenu = 0; // Exit options menu (the next menu crossfades its music in)
+                playSound(clickSound, SOUND_UI, 1.0f, 0.0f);
                 break;
         }
-        Mix_FreeChunk(clickSound);
     }
 
     // Handle mouse clicks
     if (event->type == SDL_MOUSEBUTTONDOWN && event->button.button == SDL_BUTTON_LEFT) {
-        Mix_Chunk *clickSound = Mix_LoadWAV("click.mp3");
+        Mix_Chunk *clickSound = options->clickSound;
         if (options->hoverDecrease && options->currentVolume > 0) {
             options->currentVolume -= MIX_MAX_VOLUME / 5;
             if (options->currentVolume < 0) {
                 options->currentVolume = 0;
             }
-            Mix_VolumeMusic(options->currentVolume);  // Corrected
-            Mix_PlayChannel(-1, clickSound, 0);
+            setMusicVolume(options->currentVolume);  // Corrected
+            playSound(clickSound, SOUND_UI, 1.0f, 0.0f);
         }
         if (options->hoverIncrease && options->currentVolume < MIX_MAX_VOLUME) {
             options->currentVolume += MIX_MAX_VOLUME / 5;
             if (options->currentVolume > MIX_MAX_VOLUME) {
                 options->currentVolume = MIX_MAX_VOLUME;
             }
-            Mix_VolumeMusic(options->currentVolume);  // Corrected
-            Mix_PlayChannel(-1, clickSound, 0);
+            setMusicVolume(options->currentVolume);  // Corrected
+            playSound(clickSound, SOUND_UI, 1.0f, 0.0f);
         }
         if (options->hoverMute) {
             options->isMuted = !options->isMuted;
-            Mix_VolumeMusic(options->isMuted ? 0 : options->currentVolume);  // Corrected
-            Mix_PlayChannel(-1, clickSound, 0);
+            setMusicVolume(options->isMuted ? 0 : options->currentVolume);  // Corrected
+            playSound(clickSound, SOUND_UI, 1.0f, 0.0f);
         }
         if (options->hoverFullscreen && !options->isFullscreen) {
             options->isFullscreen = 1;
             options->screen = SDL_SetVideoMode(1600, 900, 32, SDL_SWSURFACE | SDL_FULLSCREEN);
-            Mix_PlayChannel(-1, clickSound, 0);
+            playSound(clickSound, SOUND_UI, 1.0f, 0.0f);
         }
         if (options->hoverWindowed && options->isFullscreen) {
             options->isFullscreen = 0;
             options->screen = SDL_SetVideoMode(1600, 900, 32, SDL_SWSURFACE);
-            Mix_PlayChannel(-1, clickSound, 0);
+            playSound(clickSound, SOUND_UI, 1.0f, 0.0f);
         }
         if (options->hoverBack) {
-            *currentMenu = 0; // Return to main menu
-            Mix_HaltMusic();  // Corrected
-            Mix_PlayChannel(-1, clickSound, 0);
+            *currentMenu = 0; // Return to main menu (the next menu crossfades its music in)
+            playSound(clickSound, SOUND_UI, 1.0f, 0.0f);
         }
-        Mix_FreeChunk(clickSound);
     }
 }
 
@@ -267,27 +269,24 @@ void drawOptions(OptionsMenu *options) {
     // Text (positioned above settings, font size 32)
     SDL_BlitSurface(options->volumeText, NULL, options->screen, &options->volumeTextPos);
     SDL_BlitSurface(options->displayText, NULL, options->screen, &options->displayTextPos);
-
-    SDL_Flip(options->screen);
 }
 
 void cleanupOptions(OptionsMenu *options) {
-    SDL_FreeSurface(options->background);
-    SDL_FreeSurface(options->box);
-    SDL_FreeSurface(options->btnIncrease);
-    SDL_FreeSurface(options->btnIncreasePressed);
-    SDL_FreeSurface(options->btnDecrease);
-    SDL_FreeSurface(options->btnDecreasePressed);
-    SDL_FreeSurface(options->btnMuteOn);
-    SDL_FreeSurface(options->btnMuteOff);
-    SDL_FreeSurface(options->btnFullscreen);
-    SDL_FreeSurface(options->btnFullscreenPressed);
-    SDL_FreeSurface(options->btnWindowed);
-    SDL_FreeSurface(options->btnWindowedPressed);
-    SDL_FreeSurface(options->btnBack);
+    releaseResource(options->background);
+    releaseResource(options->box);
+    releaseResource(options->btnIncrease);
+    releaseResource(options->btnIncreasePressed);
+    releaseResource(options->btnDecrease);
+    releaseResource(options->btnDecreasePressed);
+    releaseResource(options->btnMuteOn);
+    releaseResource(options->btnMuteOff);
+    releaseResource(options->btnFullscreen);
+    releaseResource(options->btnFullscreenPressed);
+    releaseResource(options->btnWindowed);
+    releaseResource(options->btnWindowedPressed);
+    releaseResource(options->btnBack);
     SDL_FreeSurface(options->volumeText);
     SDL_FreeSurface(options->displayText);
-    Mix_FreeMusic(options->music);
-    Mix_CloseAudio();
-    TTF_Quit();
+    releaseResource(options->hoverSound);
+    releaseResource(options->clickSound);
 }
@@ -5,11 +5,21 @@
 #include <SDL/SDL_image.h>
 #include <SDL/SDL_mixer.h>
 #include <SDL/SDL_ttf.h>
+#include "../core/audio.h"
+#include "../core/mixer.h"
+#include "../core/music.h"
+#include "../core/resources.h"
+// Track the surfaces and sounds created by the options (included last, it wraps the SDL calls)
+#ifndef MEM_MODULE
+#define MEM_MODULE "options"
+#endif
+#include "../core/memtrack.h"
 
 typedef struct {
     SDL_Surface *screen;           // Pointer to the screen surface
     SDL_Surface *background;       // Background image (background.png, 1600x1075)
-    Mix_Music *music;             // Background music (optionsmusic.mp3)
+    Mix_Chunk *hoverSound;        // hover.mp3
+    Mix_Chunk *clickSound;        // click.mp3
     SDL_Surface *box;              // box.png (700x700)
     SDL_Surface *btnIncrease;      // buttonincrease.png (80x82)
     SDL_Surface *btnIncreasePressed; // buttonincreasepressed.png (80x85)
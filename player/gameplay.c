@@ -0,0 +1,868 @@
+/*
+ * ======= مشهد اللعب =======
+ * يحتوي على منطق حلقة اللعبة (المدخلات، التحديث، الرسم)
+ * يستخدمه main.c وكذلك مدير المشاهد في مجلد game
+ */
+
+#include "gameplay.h"
+#include "../core/resources.h"
+#include "../core/loader.h"
+#include "../core/blit.h"
+#include "../core/profiler.h"
+#include "../core/compositor.h"
+#include "../core/replay.h"
+#include "../core/highscore.h"
+#include "../core/snapshot.h"
+#include "../core/random.h"
+#include "../core/timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// أجزاء ملف الحفظ: كل جزء له رقم نسخة خاص به
+#define CHUNK_GAME SNAPSHOT_ID('G', 'A', 'M', 'E')
+#define CHUNK_PLAYER SNAPSHOT_ID('P', 'L', 'Y', 'R')
+#define CHUNK_ENEMY SNAPSHOT_ID('E', 'N', 'M', 'Y')
+#define CHUNK_OBSTACLES SNAPSHOT_ID('O', 'B', 'S', 'T')
+
+// مؤثرات الجزيئات: العدد، السرعة المتوسطة، التشتت، العمر بالإطارات، اللون، الحجم
+// (شرارات الضربة وانفجار موت العدو معرفة في enemy.c)
+static const ParticleEffect DAMAGE_BLOOD = {40, 0.0f, -3.0f, 4.0f, 20, 35, 0xE01010, 2};
+static const ParticleEffect OBSTACLE_DUST = {48, 0.0f, -1.5f, 3.0f, 25, 45, 0xA08060, 2};
+
+// حالة المشهد العامة وكاميرات المناظر
+typedef struct {
+    Sint32 playerCount;
+    Uint32 randomState;          // موقع سلسلة الأرقام العشوائية
+    Sint32 viewCount;
+    Sint32 camX[MAX_VIEWS], camY[MAX_VIEWS];  // موقع الكاميرا بدقة أقل من بكسل
+    Sint32 cameraX[MAX_VIEWS], cameraY[MAX_VIEWS];  // نفس الموقع بالبكسل
+    Sint32 menuVisible, menuOption;
+} GameChunk;
+
+// لاعب واحد (index 0 أو 1): الصور تُحفظ بمجلدها
+typedef struct {
+    Sint32 x, y;
+    Sint32 lives, score, health;
+    Sint32 state, frame, frameTimer;
+    Uint8 facingRight, attacking, takingDamage, reserved;
+    char spriteDir[64];
+} PlayerChunk;
+
+typedef struct {
+    Sint32 x, y;
+    Sint32 spriteX, spriteY;
+    Sint32 direction, currentFrame, pixelsMoved, state;
+    Sint32 health, maxHealth, isDead, deathRow;
+    Sint32 animTickCounter, alreadyAttacked;
+} EnemyChunk;
+
+typedef struct {
+    Sint32 count;
+    struct {
+        Sint16 x, y, w, h;
+        Sint32 active;
+    } obstacles[MAX_OBSTACLES];
+} ObstacleChunk;
+
+/*
+ * رسم قلوب (أرواح) اللاعب
+ * @param player مؤشر إلى اللاعب
+ * @param heartSprite صورة القلب
+ * @param screen سطح الشاشة للرسم عليه
+ */
+static void drawHearts(Player *player, SDL_Surface *heartSprite, SDL_Surface *screen) {
+    if (!heartSprite) return;  // التحقق من وجود صورة القلب
+
+    SDL_Rect heartPos;         // مستطيل موقع القلب
+    heartPos.y = 10;            // المسافة من أعلى الشاشة - تم تقليلها
+    heartPos.w = 20;           // عرض القلب - تم تصغيره
+    heartPos.h = 20;           // ارتفاع القلب - تم تصغيره
+
+    // رسم قلوب اللاعب الأول (على اليسار)
+    if (!player->isPlayer2) {
+        for (int i = 0; i < player->lives; i++) {
+            heartPos.x = 20 + (i * 40);  // تقليل المسافة بين القلوب إلى 20 بكسل
+            blitSprite(heartSprite, NULL, screen, &heartPos);
+        }
+    }
+    // رسم قلوب اللاعب الثاني (على اليمين)
+    else {
+        for (int i = 0; i < player->lives; i++) {
+            heartPos.x = SCREEN_WIDTH - 130+ (i * 40);  // تعديل موقع البداية وتقليل المسافة بين القلوب
+            blitSprite(heartSprite, NULL, screen, &heartPos);
+        }
+    }
+}
+
+/*
+ * اختيار هدف العدو: اللاعب المرئي إن رأى واحدا فقط، وإلا الأقرب إليه
+ * @param seen بت لكل لاعب يراه العدو (من enemySight)
+ */
+static Player *enemyTarget(Gameplay *game, int seen) {
+    if (game->playerCount < 2 || seen == 1) return &game->player1;
+    if (seen == 2) return &game->player2;
+
+    int ex = game->enemy.posScreen.x;
+    int d1 = abs(game->player1.position.x - ex);
+    int d2 = abs(game->player2.position.x - ex);
+    return (d2 < d1) ? &game->player2 : &game->player1;
+}
+
+// مركز اللاعب الأفقي في المستوى
+static int playerCenterX(Player *player) {
+    return player->position.x + player->position.w / 2;
+}
+
+// العقبات النشطة، بت لكل عقبة
+static Uint32 activeObstacles(Gameplay *game) {
+    Uint32 mask = 0;
+    for (int i = 0; i < MAX_OBSTACLES; i++) {
+        if (game->obstacles[i].isActive) mask |= 1u << i;
+    }
+    return mask;
+}
+
+/*
+ * بناء شبكة التنقل: كل المستوى محجوب ما عدا الشريط الأرضي، ثم العقبات النشطة
+ * يُعاد البناء فقط عندما تختفي عقبة (تغيّر الشبكة يبطل الحقول القديمة)
+ */
+static void buildNavGrid(Gameplay *game) {
+    NavGrid *nav = &game->nav;
+    clearNavGrid(nav, 1);
+    SDL_Rect ground = {0, NAV_WALK_TOP, nav->cols * nav->cellSize, NAV_WALK_BOTTOM - NAV_WALK_TOP};
+    setNavRect(nav, ground, 0);
+
+    game->navObstacles = activeObstacles(game);
+    for (int i = 0; i < MAX_OBSTACLES; i++) {
+        if (game->obstacles[i].isActive) setNavRect(nav, game->obstacles[i].position, 1);
+    }
+}
+
+/*
+ * بناء شبكة الرؤية: البلاطات الصلبة ثم العقبات النشطة
+ * يُعاد البناء فقط عندما تختفي عقبة
+ */
+static void buildSightGrid(Gameplay *game) {
+    SightGrid *sight = &game->sight;
+    clearSightGrid(sight);
+    blockSightTiles(sight, &game->level);
+
+    game->sightObstacles = activeObstacles(game);
+    for (int i = 0; i < MAX_OBSTACLES; i++) {
+        if (game->obstacles[i].isActive) setSightRect(sight, game->obstacles[i].position, 1);
+    }
+}
+
+/*
+ * ما يراه العدو: شعاع من عينه إلى رأس كل لاعب وآخر إلى وسطه، كلها في طلب واحد
+ * يُرجع بتا لكل لاعب مرئي (بدون شبكة الرؤية يرى الجميع)
+ */
+static int enemySight(Gameplay *game) {
+    if (!game->sight.bits) return 3;
+
+    Player *players[2] = {&game->player1, &game->player2};
+    int eyeX = game->enemy.posScreen.x + FRAME_WIDTH / 2;
+    int eyeY = game->enemy.posScreen.y + ENEMY_EYE_Y;
+    SightRay rays[4];
+    for (int i = 0; i < game->playerCount; i++) {
+        SDL_Rect *pos = &players[i]->position;
+        SightRay head = {eyeX, eyeY, playerCenterX(players[i]), pos->y + PLAYER_HEAD_Y, 0, 0, 0, 0};
+        SightRay middle = {eyeX, eyeY, playerCenterX(players[i]), pos->y + pos->h / 2, 0, 0, 0, 0};
+        rays[2 * i] = head;
+        rays[2 * i + 1] = middle;
+    }
+    castSightRays(&game->sight, rays, 2 * game->playerCount);
+
+    int seen = 0;
+    for (int i = 0; i < game->playerCount; i++) {
+        if (!rays[2 * i].blocked || !rays[2 * i + 1].blocked) seen |= 1 << i;
+    }
+    return seen;
+}
+
+/*
+ * حدود دورية العدو بإحداثيات المستوى: من كائن "patrol" في المستوى
+ * (يظهر العدو عند طرفه الأيسر)، وإلا مسافة ثابتة يمين موقع ظهوره
+ */
+static void placeEnemyPatrol(Gameplay *game) {
+    const TileObject *patrol = game->level.header ? findTileObject(&game->level, "patrol", 0) : NULL;
+    if (patrol) {
+        game->enemy.posScreen.x = patrol->x;
+        game->patrolMin = patrol->x;
+        game->patrolMax = patrol->x + patrol->w - FRAME_WIDTH;
+    } else {
+        game->patrolMin = game->enemy.posScreen.x;
+        game->patrolMax = game->enemy.posScreen.x + (SCREEN_WIDTH - FRAME_WIDTH) / 2 - 100;
+    }
+    if (game->patrolMax < game->patrolMin) game->patrolMax = game->patrolMin;
+}
+
+/*
+ * وضع العقبات في أماكن كائنات "obstacle" في المستوى
+ * العقبات الزائدة عن كائنات المستوى تبقى غير نشطة
+ * بدون ملف المستوى تبقى المواقع الافتراضية لـ initObstacles
+ */
+static void placeObstacles(Gameplay *game) {
+    initObstacles(game->obstacles, MAX_OBSTACLES);
+    if (!game->level.header) return;
+
+    for (int i = 0; i < MAX_OBSTACLES; i++) {
+        const TileObject *object = findTileObject(&game->level, "obstacle", i);
+        if (object) {
+            game->obstacles[i].position.x = object->x;
+            game->obstacles[i].position.y = object->y;
+            game->obstacles[i].position.w = object->w;
+            game->obstacles[i].position.h = object->h;
+        } else {
+            game->obstacles[i].isActive = false;
+        }
+    }
+}
+
+/*
+ * تهيئة المناظر: منظر بكامل الشاشة، أو نصف الشاشة لكل لاعب
+ * الخلفيات تتشارك نفس صور الطبقات من الذاكرة المؤقتة
+ */
+static void initViews(Gameplay *game) {
+    game->splitScreen = game->playerCount > 1;
+    if (game->splitScreen) {
+        initpartage(&game->views[0].back, &game->views[1].back, NULL);
+        game->viewCount = 2;
+    } else {
+        initback(&game->views[0].back, NULL);
+        game->viewCount = 1;
+    }
+
+    for (int i = 0; i < game->viewCount; i++) {
+        GameView *view = &game->views[i];
+        view->area = view->back.viewport;  // نصف الشاشة الأيسر ثم الأيمن
+        if (game->splitScreen) {
+            view->follow = (i == 0) ? &game->player1 : &game->player2;
+        }
+        initCamera(&view->camera, view->back.viewport);
+    }
+}
+
+/*
+ * تهيئة مشهد اللعب
+ * @param game مؤشر إلى هيكل مشهد اللعب
+ * @param playerCount عدد اللاعبين (1 أو 2)
+ */
+void initGameplay(Gameplay *game, int playerCount) {
+    memset(game, 0, sizeof(*game));
+    game->playerCount = playerCount;
+
+    // تهيئة عناصر اللعبة
+    initPlayer(&game->player1, false);  // تهيئة اللاعب الأول
+    initPlayer(&game->player2, true);   // تهيئة اللاعب الثاني
+    initMenu(&game->menu);              // تهيئة القائمة
+    if (loadTileMap(&game->level, LEVEL_PATH) == 0) {  // المستوى: البلاطات وأماكن العقبات
+        buildTileDistField(&game->walls, &game->level, LEVEL_FIELD_CELL);
+    }
+    placeObstacles(game);               // تهيئة العقبات
+
+    // تهيئة العدو ووضعه على الأرض
+    initializeEnemy(&game->enemy, ENEMY_SPRITE_PATH);
+    game->enemy.posScreen.y = SCREEN_HEIGHT - FRAME_HEIGHT - 50;
+    placeEnemyPatrol(game);
+
+    // تحميل صورة القلب وصورة العقبة
+    // (دوال الرسم لا تحمّل الصور بنفسها لأن المناظر تُرسم من عدة خيوط)
+    queueSprite(defaultLoader(), "assets/ui/heart.png", &game->heartSprite);
+    queueSprite(defaultLoader(), "./assets/obstacles/obstacle.png", &game->obstacleSprite);
+
+    // انتظار انتهاء كل التحميلات مع عرض شاشة التحميل
+    finishLoading(defaultLoader(), SDL_GetVideoSurface());
+
+    // طبقات الخلفية (تُرسم خلفية زرقاء إذا فشل التحميل)
+    initViews(game);
+    if (game->level.header) {
+        // عرض المستوى من ملفه
+        for (int i = 0; i < game->viewCount; i++) {
+            game->views[i].back.levelW = game->level.width;
+        }
+    }
+
+    // اللاعبان يتحركان في كامل عرض المستوى
+    game->player1.levelWidth = game->views[0].back.levelW;
+    game->player2.levelWidth = game->views[0].back.levelW;
+
+    // اختيار دالة المزج الآن، قبل أن ترسم خيوط المركّب
+    blitKernel();
+    initCompositor(&game->compositor, NULL);
+    initRenderQueue(&game->renderQueue);
+    initParticles(&game->particles, PARTICLE_CAPACITY);
+
+    // شبكة التنقل بعرض المستوى، وحقل لكل لاعب
+    if (initNavGrid(&game->nav, game->views[0].back.levelW, SCREEN_HEIGHT, NAV_CELL_SIZE) == 0) {
+        buildNavGrid(game);
+        for (int i = 0; i < 2; i++) {
+            initNavField(&game->navFields[i], &game->nav);
+        }
+    }
+
+    // شبكة رؤية العدو بعرض المستوى
+    if (initSightGrid(&game->sight, game->views[0].back.levelW, SCREEN_HEIGHT, SIGHT_CELL_SIZE) == 0) {
+        buildSightGrid(game);
+    }
+}
+
+/*
+ * منع اللاعب من دخول جدران المستوى: دائرة جسمه تتحرك من موقعه السابق
+ * إلى الجديد في حقل المسافات وتتوقف قبل أول جدار (حساب بأعداد صحيحة،
+ * فالإعادة تعطي نفس النتيجة)
+ */
+static void blockPlayerMove(Gameplay *game, Player *player, SDL_Rect before) {
+    if (!game->walls.dist) return;
+    int x0 = before.x + PLAYER_WIDTH / 2, y0 = before.y + PLAYER_HEIGHT / 2;
+    int x1 = player->position.x + PLAYER_WIDTH / 2, y1 = player->position.y + PLAYER_HEIGHT / 2;
+    if (x0 == x1 && y0 == y1) return;
+
+    int x, y;
+    if (fieldSweepCircle(&game->walls, x0, y0, x1, y1, PLAYER_BODY_RADIUS, &x, &y)) {
+        player->position.x = x - PLAYER_WIDTH / 2;
+        player->position.y = y - PLAYER_HEIGHT / 2;
+    }
+}
+
+/*
+ * تحديث حالة عناصر اللعبة لإطار واحد
+ * المدخلات تُقرأ من لقطة الإطار: كل ضغطة تُعالج مرة واحدة فقط
+ * @param game مؤشر إلى هيكل مشهد اللعب
+ * @param input لقطة المدخلات للإطار الحالي
+ */
+void updateGameplay(Gameplay *game, const InputState *input) {
+    Player *players[2] = {&game->player1, &game->player2};
+    bool wasHurt[2] = {game->player1.isTakingDamage, game->player2.isTakingDamage};
+    int enemyX = game->enemy.posScreen.x + FRAME_WIDTH / 2;
+    int enemyY = game->enemy.posScreen.y + FRAME_HEIGHT / 2;
+
+    // مدخلات اللاعبين وحركتهم
+    for (int i = 0; i < game->playerCount; i++) {
+        PlayerState before = players[i]->state;
+        SDL_Rect from = players[i]->position;
+        updatePlayer(players[i], input);
+        blockPlayerMove(game, players[i], from);
+
+        // بداية هجوم جديد قريب من العدو تنقص من صحته وتعطي نقاطا
+        if (before != ATTACK && players[i]->state == ATTACK &&
+            checkCollision(players[i]->position, game->enemy.posScreen) && !game->enemy.isDead) {
+            damageEnemy(&game->enemy, 5);
+            players[i]->score += game->enemy.isDead ? SCORE_HIT + SCORE_KILL : SCORE_HIT;
+            emitParticles(&game->particles, &ENEMY_HIT_SPARKS, enemyX, enemyY);
+            if (game->enemy.isDead) {
+                emitParticles(&game->particles, &ENEMY_DEATH_BURST, enemyX, enemyY);
+            }
+        }
+    }
+
+    // معالجة القائمة
+    updateMenu(&game->menu, input, &game->player1, &game->player2);
+    if (game->menu.saveRequested) {
+        game->menu.saveRequested = false;
+        if (saveGameplay(game, GAMEPLAY_SAVE_PATH) < 0) {
+            game->menu.quitRequested = false;  // البقاء في اللعبة إذا فشل الحفظ
+        }
+    }
+
+    // في وضع اللاعب الواحد يُمرر اللاعب الأول مرتين (takeDamage لا يتكرر في نفس الإطار)
+    int zone = PROFILE_BEGIN("collision");
+    Uint32 obstaclesBefore = activeObstacles(game);
+    updateObstacles(game->obstacles, &game->player1,
+                    game->playerCount > 1 ? &game->player2 : &game->player1);
+    PROFILE_END(zone);
+
+    // غبار العقبات التي اختفت ودم اللاعب الذي بدأ يتلقى الضرر
+    zone = PROFILE_BEGIN("particles");
+    Uint32 removed = obstaclesBefore & ~activeObstacles(game);
+    for (int i = 0; i < MAX_OBSTACLES; i++) {
+        if (removed & (1u << i)) {
+            SDL_Rect *pos = &game->obstacles[i].position;
+            emitParticles(&game->particles, &OBSTACLE_DUST, pos->x + pos->w / 2, pos->y + pos->h / 2);
+        }
+    }
+    for (int i = 0; i < game->playerCount; i++) {
+        if (!wasHurt[i] && players[i]->isTakingDamage) {
+            emitParticles(&game->particles, &DAMAGE_BLOOD, playerCenterX(players[i]),
+                          players[i]->position.y + players[i]->position.h / 2);
+        }
+    }
+    updateParticles(&game->particles);
+    PROFILE_END(zone);
+
+    // كاميرا كل منظر تتبع لاعبه (أو منتصف المسافة بين اللاعبين)
+    // كل المواقع بإحداثيات المستوى، والرسم يطرح موقع الكاميرا
+    for (int i = 0; i < game->viewCount; i++) {
+        GameView *view = &game->views[i];
+        int targetX;
+        if (view->follow) {
+            targetX = playerCenterX(view->follow);
+        } else {
+            targetX = playerCenterX(&game->player1);
+            if (game->playerCount > 1) {
+                targetX = (targetX + playerCenterX(&game->player2)) / 2;
+            }
+        }
+        followCamera(&view->back, targetX, 0);
+        setCameraPosition(&view->camera, view->back.camera.x, view->back.camera.y);
+    }
+
+    // الدورية في المستوى نفسه: يعود العدو إليها من حيث طارد
+    int posMin = game->patrolMin;
+    int posMax = game->patrolMax;
+
+    // حقول المسافات تُحسب من جديد فقط إذا دخل اللاعب خلية أخرى أو تغيرت الشبكة
+    if (game->nav.blocked) {
+        zone = PROFILE_BEGIN("nav");
+        if (activeObstacles(game) != game->navObstacles) buildNavGrid(game);
+        for (int i = 0; i < game->playerCount; i++) {
+            updateNavField(&game->nav, &game->navFields[i], playerCenterX(players[i]),
+                           players[i]->position.y + players[i]->position.h - 1);
+        }
+        PROFILE_END(zone);
+    }
+
+    // العدو يطارد فقط من يراه (أشعة في شبكة الرؤية، بأعداد صحيحة)
+    zone = PROFILE_BEGIN("enemy");
+    if (game->sight.bits && activeObstacles(game) != game->sightObstacles) buildSightGrid(game);
+    int seen = enemySight(game);
+    Player *target = enemyTarget(game, seen);
+    if (game->navFields[0].dist) {
+        int index = target == &game->player2;
+        updateEnemyChase(&game->enemy, target->position, (seen >> index) & 1, &game->nav,
+                         &game->navFields[index], posMin, posMax);
+    } else {
+        updateEnemy(&game->enemy, target->position, posMin, posMax);
+    }
+    PROFILE_END(zone);
+}
+
+/*
+ * رسم منظر واحد: الخلفية ثم العناصر الظاهرة في كاميرته، داخل مستطيله فقط
+ */
+static void drawView(Gameplay *game, GameView *view, SDL_Surface *screen) {
+    RenderQueue *queue = &game->renderQueue;
+
+    // رسم طبقات الخلفية حسب موقع الكاميرا
+    setRenderOrder(queue, LAYER_BACKGROUND, 0, 0);  // طبقات متداخلة: بترتيب رسمها
+    afficher_back(&view->back, screen);
+
+    // دوال الرسم تتجاهل العناصر خارج مجال الكاميرا
+    SDL_Rect oldClip = screen->clip_rect;
+    SDL_SetClipRect(screen, &view->area);
+    setActiveCamera(&view->camera);
+
+    // بلاطات المستوى: بضع قطع جاهزة بدل رسم كل بلاطة
+    setRenderOrder(queue, LAYER_TILES, 0, 1);
+    drawTileMap(&game->level, screen, &view->camera);
+
+    // رسم عناصر اللعبة بأي ترتيب: الطابور يرتبها حسب موقع القدمين
+    for (int i = 0; i < game->playerCount; i++) {
+        Player *player = i ? &game->player2 : &game->player1;
+        setRenderOrder(queue, LAYER_ENTITIES, player->position.y + player->position.h, 1);
+        drawPlayer(player, screen);
+    }
+    for (int i = 0; i < MAX_OBSTACLES; i++) {
+        SDL_Rect *pos = &game->obstacles[i].position;
+        setRenderOrder(queue, LAYER_ENTITIES, pos->y + pos->h, 1);
+        drawObstacle(&game->obstacles[i], game->obstacleSprite, screen);
+    }
+    setRenderOrder(queue, LAYER_ENTITIES, game->enemy.posScreen.y + FRAME_HEIGHT, 1);
+    blitEnemy(screen, &game->enemy);         // رسم العدو
+    setRenderOrder(queue, LAYER_BARS, 0, 0);
+    drawHealthBar(screen, &game->enemy);     // شريط صحة العدو فوق كل العناصر
+    setActiveCamera(NULL);
+    SDL_SetClipRect(screen, &oldClip);
+}
+
+/*
+ * رسم الإطار الحالي
+ * أوامر رسم المناظر تُسجل ثم يرسمها المركّب على شرائط الشاشة بعدة خيوط،
+ * ثم تُرسم القائمة والقلوب فوق الشاشة كاملة
+ * @param game مؤشر إلى هيكل مشهد اللعب
+ * @param screen سطح الشاشة للرسم عليه
+ */
+void drawGameplay(Gameplay *game, SDL_Surface *screen) {
+    // الصور المكبرة تُجهز قبل تسجيل أوامر الرسم
+    preparePlayer(&game->player1);
+    if (game->playerCount > 1) {
+        preparePlayer(&game->player2);
+    }
+    // قطع المستوى الظاهرة (أو التي تغيرت بلاطاتها) تُركب قبل التسجيل أيضا
+    for (int i = 0; i < game->viewCount; i++) {
+        prepareTileMap(&game->level, &game->views[i].camera);
+    }
+    endTileMapFrame(&game->level);
+    profilerSetCounter("tile chunks", game->level.cachedChunks);
+
+    // أوامر الرسم تُسجل في الطابور، ثم تُرتب وتُرسل إلى المركّب
+    int composing = beginComposite(&game->compositor, screen) == 0;
+    beginRenderQueue(&game->renderQueue, screen);
+    for (int i = 0; i < game->viewCount; i++) {
+        drawView(game, &game->views[i], screen);
+    }
+    setRenderOrder(&game->renderQueue, LAYER_HUD, 0, 1);
+    if (game->splitScreen) {
+        // خط فاصل بين النصفين
+        SDL_Rect divider = {game->views[1].area.x - 2, 0, 4, screen->h};
+        fillRect(screen, &divider, SDL_MapRGB(screen->format, 0, 0, 0));
+    }
+
+    // قلوب البكسل تحت القائمة كما كانت
+    drawPlayerHearts(&game->player1, screen);
+    if (game->playerCount > 1) {
+        drawPlayerHearts(&game->player2, screen);
+    }
+
+    int zone = PROFILE_BEGIN("sort");
+    flushRenderQueue(&game->renderQueue);
+    profilerSetCounter("draw commands", game->renderQueue.lastCommands);
+    profilerSetCounter("draw batches", game->renderQueue.lastBatches);
+    PROFILE_END(zone);
+
+    if (composing) {
+        int compositeZone = PROFILE_BEGIN("composite");
+        endComposite(&game->compositor);
+        PROFILE_END(compositeZone);
+    }
+
+    // الجزيئات تُكتب مباشرة في بكسلات الشاشة فوق الأشكال، داخل كل منظر
+    zone = PROFILE_BEGIN("particles");
+    SDL_Rect oldClip = screen->clip_rect;
+    for (int i = 0; i < game->viewCount; i++) {
+        SDL_SetClipRect(screen, &game->views[i].area);
+        drawParticles(&game->particles, screen, &game->views[i].camera);
+    }
+    SDL_SetClipRect(screen, &oldClip);
+    profilerSetCounter("particles", game->particles.count);
+    PROFILE_END(zone);
+
+    // عدادات العناصر المرسومة والمستبعدة في كل المناظر
+    int tested = 0, culled = 0;
+    for (int i = 0; i < game->viewCount; i++) {
+        cameraEndFrame(&game->views[i].camera);
+        tested += game->views[i].camera.lastTested;
+        culled += game->views[i].camera.lastCulled;
+    }
+    profilerSetCounter("culled", culled);
+    profilerSetCounter("drawn", tested - culled);
+
+    drawMenu(&game->menu, screen);  // رسم القائمة (نصوص SDL_ttf بعد المركّب)
+
+    // رسم قلوب اللاعبين
+    drawHearts(&game->player1, game->heartSprite, screen);
+    if (game->playerCount > 1) {
+        drawHearts(&game->player2, game->heartSprite, screen);
+    }
+}
+
+// بصمة لاعب واحد: كل ما يتغير أثناء اللعب (بدون الصور والأصوات)
+static Uint32 hashPlayer(Uint32 hash, const Player *player) {
+    hash = hashInt(hash, player->position.x);
+    hash = hashInt(hash, player->position.y);
+    hash = hashInt(hash, player->lives);
+    hash = hashInt(hash, player->score);
+    hash = hashInt(hash, player->state);
+    hash = hashInt(hash, player->isFacingRight);
+    hash = hashInt(hash, player->isAttacking);
+    hash = hashInt(hash, player->isTakingDamage);
+    hash = hashInt(hash, player->frame);
+    hash = hashInt(hash, player->frameTimer);
+    return hashInt(hash, player->health);
+}
+
+/*
+ * بصمة حالة اللعبة بعد التحديث
+ * الحقول تُضاف واحدا واحدا (الحشو بين حقول الهياكل والمؤشرات ليست جزءا من الحالة)
+ * @param game مؤشر إلى هيكل مشهد اللعب
+ */
+Uint32 hashGameplay(const Gameplay *game) {
+    Uint32 hash = HASH_START;
+    hash = hashPlayer(hash, &game->player1);
+    if (game->playerCount > 1) {
+        hash = hashPlayer(hash, &game->player2);
+    }
+
+    const Enemy *enemy = &game->enemy;
+    hash = hashInt(hash, enemy->posScreen.x);
+    hash = hashInt(hash, enemy->posScreen.y);
+    hash = hashInt(hash, enemy->direction);
+    hash = hashInt(hash, enemy->currentFrame);
+    hash = hashInt(hash, enemy->pixelsMoved);
+    hash = hashInt(hash, enemy->state);
+    hash = hashInt(hash, enemy->health);
+    hash = hashInt(hash, enemy->isDead);
+    hash = hashInt(hash, enemy->animTickCounter);
+    hash = hashInt(hash, enemy->alreadyAttacked);
+
+    for (int i = 0; i < MAX_OBSTACLES; i++) {
+        hash = hashInt(hash, game->obstacles[i].position.x);
+        hash = hashInt(hash, game->obstacles[i].position.y);
+        hash = hashInt(hash, game->obstacles[i].isActive);
+    }
+
+    hash = hashInt(hash, game->menu.isVisible);
+    hash = hashInt(hash, game->menu.selectedOption);
+    for (int i = 0; i < game->viewCount; i++) {
+        hash = hashInt(hash, game->views[i].camera.x);
+    }
+    return hash;
+}
+
+static void savePlayer(Snapshot *snap, const Player *player, int index) {
+    PlayerChunk *chunk = addChunk(snap, CHUNK_PLAYER, 1, index, sizeof(PlayerChunk));
+    if (!chunk) return;
+    chunk->x = player->position.x;
+    chunk->y = player->position.y;
+    chunk->lives = player->lives;
+    chunk->score = player->score;
+    chunk->health = player->health;
+    chunk->state = player->state;
+    chunk->frame = player->frame;
+    chunk->frameTimer = player->frameTimer;
+    chunk->facingRight = player->isFacingRight;
+    chunk->attacking = player->isAttacking;
+    chunk->takingDamage = player->isTakingDamage;
+    memcpy(chunk->spriteDir, player->spriteDir, sizeof(chunk->spriteDir));
+}
+
+static void loadPlayer(const Snapshot *snap, Player *player, int index) {
+    Uint16 version;
+    Uint32 size;
+    const PlayerChunk *chunk = findChunk(snap, CHUNK_PLAYER, index, &version, &size);
+    if (!chunk || version != 1 || size < sizeof(PlayerChunk)) return;
+
+    player->position.x = chunk->x;
+    player->position.y = chunk->y;
+    player->lives = chunk->lives;
+    player->score = chunk->score;
+    player->health = chunk->health;
+    player->state = (PlayerState)chunk->state;
+    player->frame = chunk->frame;
+    player->frameTimer = chunk->frameTimer;
+    player->isFacingRight = chunk->facingRight;
+    player->isAttacking = chunk->attacking;
+    player->isTakingDamage = chunk->takingDamage;
+
+    // الصور تُحمّل من جديد فقط إذا تغيرت الشخصية
+    char spriteDir[sizeof(chunk->spriteDir) + 1];
+    memcpy(spriteDir, chunk->spriteDir, sizeof(chunk->spriteDir));
+    spriteDir[sizeof(chunk->spriteDir)] = '\0';
+    if (spriteDir[0] && strcmp(spriteDir, player->spriteDir) != 0) {
+        setPlayerSprites(player, spriteDir);
+    }
+}
+
+/*
+ * حفظ حالة اللعبة كاملة في ملف
+ * كل هيكل يُكتب مباشرة في ذاكرة الملف (بدون نسخ وسيطة) ثم يُكتب الملف مرة واحدة
+ * @param game مؤشر إلى هيكل مشهد اللعب
+ * @param path مسار ملف الحفظ
+ */
+int saveGameplay(Gameplay *game, const char *path) {
+    Uint64 startUs = timerNowUs();
+    Snapshot snap;
+    beginSnapshot(&snap);
+
+    GameChunk *state = addChunk(&snap, CHUNK_GAME, 1, 0, sizeof(GameChunk));
+    if (state) {
+        state->playerCount = game->playerCount;
+        state->randomState = randomState();
+        state->viewCount = game->viewCount;
+        for (int i = 0; i < game->viewCount; i++) {
+            state->camX[i] = game->views[i].back.camX;
+            state->camY[i] = game->views[i].back.camY;
+            state->cameraX[i] = game->views[i].back.camera.x;
+            state->cameraY[i] = game->views[i].back.camera.y;
+        }
+        state->menuVisible = game->menu.isVisible;
+        state->menuOption = game->menu.selectedOption;
+    }
+
+    savePlayer(&snap, &game->player1, 0);
+    if (game->playerCount > 1) {
+        savePlayer(&snap, &game->player2, 1);
+    }
+
+    EnemyChunk *enemy = addChunk(&snap, CHUNK_ENEMY, 1, 0, sizeof(EnemyChunk));
+    if (enemy) {
+        const Enemy *e = &game->enemy;
+        enemy->x = e->posScreen.x;
+        enemy->y = e->posScreen.y;
+        enemy->spriteX = e->posSprite.x;
+        enemy->spriteY = e->posSprite.y;
+        enemy->direction = e->direction;
+        enemy->currentFrame = e->currentFrame;
+        enemy->pixelsMoved = e->pixelsMoved;
+        enemy->state = e->state;
+        enemy->health = e->health;
+        enemy->maxHealth = e->maxHealth;
+        enemy->isDead = e->isDead;
+        enemy->deathRow = e->deathRow;
+        enemy->animTickCounter = e->animTickCounter;
+        enemy->alreadyAttacked = e->alreadyAttacked;
+    }
+
+    ObstacleChunk *obstacles = addChunk(&snap, CHUNK_OBSTACLES, 1, 0, sizeof(ObstacleChunk));
+    if (obstacles) {
+        obstacles->count = MAX_OBSTACLES;
+        for (int i = 0; i < MAX_OBSTACLES; i++) {
+            obstacles->obstacles[i].x = game->obstacles[i].position.x;
+            obstacles->obstacles[i].y = game->obstacles[i].position.y;
+            obstacles->obstacles[i].w = game->obstacles[i].position.w;
+            obstacles->obstacles[i].h = game->obstacles[i].position.h;
+            obstacles->obstacles[i].active = game->obstacles[i].isActive;
+        }
+    }
+
+    int result = (state && enemy && obstacles) ? writeSnapshot(&snap, path) : -1;
+    if (result == 0) {
+        game->saved = true;
+        printf("Game saved to %s (%u bytes, %.2f ms)\n", path, (unsigned)snap.size, timerElapsedMs(startUs));
+    }
+    freeSnapshot(&snap);
+    return result;
+}
+
+/*
+ * استرجاع لعبة محفوظة
+ * الأجزاء المفقودة أو ذات نسخة غير معروفة تُترك كما جهزتها initGameplay
+ * @param game مؤشر إلى هيكل مشهد اللعب (بعد initGameplay)
+ * @param path مسار ملف الحفظ
+ */
+int loadGameplay(Gameplay *game, const char *path) {
+    Snapshot snap;
+    if (readSnapshot(&snap, path) < 0) return -1;
+
+    Uint16 version;
+    Uint32 size;
+    const GameChunk *state = findChunk(&snap, CHUNK_GAME, 0, &version, &size);
+    if (!state || version != 1 || size < sizeof(GameChunk) || state->playerCount != game->playerCount) {
+        freeSnapshot(&snap);
+        return -1;
+    }
+
+    setRandomState(state->randomState);
+    for (int i = 0; i < game->viewCount && i < state->viewCount; i++) {
+        background *back = &game->views[i].back;
+        back->camX = state->camX[i];
+        back->camY = state->camY[i];
+        back->camera.x = state->cameraX[i];
+        back->camera.y = state->cameraY[i];
+        setCameraPosition(&game->views[i].camera, back->camera.x, back->camera.y);
+    }
+    game->menu.isVisible = false;  // اللعبة تُستأنف دائما بدون القائمة
+    game->menu.selectedOption = MENU_RESUME;
+
+    loadPlayer(&snap, &game->player1, 0);
+    if (game->playerCount > 1) {
+        loadPlayer(&snap, &game->player2, 1);
+    }
+
+    const EnemyChunk *enemy = findChunk(&snap, CHUNK_ENEMY, 0, &version, &size);
+    if (enemy && version == 1 && size >= sizeof(EnemyChunk)) {
+        Enemy *e = &game->enemy;
+        e->posScreen.x = enemy->x;
+        e->posScreen.y = enemy->y;
+        e->posSprite.x = enemy->spriteX;
+        e->posSprite.y = enemy->spriteY;
+        e->direction = enemy->direction;
+        e->currentFrame = enemy->currentFrame;
+        e->pixelsMoved = enemy->pixelsMoved;
+        e->state = enemy->state;
+        e->health = enemy->health;
+        e->maxHealth = enemy->maxHealth;
+        e->isDead = enemy->isDead;
+        e->deathRow = enemy->deathRow;
+        e->animTickCounter = enemy->animTickCounter;
+        e->alreadyAttacked = enemy->alreadyAttacked;
+    }
+
+    const ObstacleChunk *obstacles = findChunk(&snap, CHUNK_OBSTACLES, 0, &version, &size);
+    if (obstacles && version == 1 && size >= sizeof(ObstacleChunk)) {
+        for (int i = 0; i < MAX_OBSTACLES && i < obstacles->count; i++) {
+            game->obstacles[i].position.x = obstacles->obstacles[i].x;
+            game->obstacles[i].position.y = obstacles->obstacles[i].y;
+            game->obstacles[i].position.w = obstacles->obstacles[i].w;
+            game->obstacles[i].position.h = obstacles->obstacles[i].h;
+            game->obstacles[i].isActive = obstacles->obstacles[i].active;
+        }
+    }
+
+    freeSnapshot(&snap);
+    return 0;
+}
+
+/*
+ * استئناف لعبة "Save & Quit"
+ * الملف يُحذف بعد الاسترجاع حتى لا تُستأنف نفس اللعبة مرتين
+ */
+bool resumeGameplay(Gameplay *game) {
+    if (loadGameplay(game, GAMEPLAY_SAVE_PATH) < 0) return false;
+    remove(GAMEPLAY_SAVE_PATH);
+    printf("Resumed the game saved in %s\n", GAMEPLAY_SAVE_PATH);
+    return true;
+}
+
+/*
+ * حفظ نقاط اللاعبين في جدول أفضل النتائج
+ * كل لاعب يُحفظ باسمه في جدول وضع اللعب (لاعب واحد أو لاعبان)
+ * @param game مؤشر إلى هيكل مشهد اللعب
+ */
+void saveGameplayScores(Gameplay *game) {
+    if (game->saved) return;  // اللعبة لم تنته: ستُستأنف لاحقا
+    HighscoreMode mode = game->playerCount > 1 ? HIGHSCORE_DUO : HIGHSCORE_SOLO;
+    int rank = addHighscore(defaultHighscores(), mode, game->player1.score, "Player 1");
+    if (rank >= 0) {
+        printf("Player 1: %d points, rank %d (%s)\n", game->player1.score, rank + 1, highscoreModeName(mode));
+    }
+    if (game->playerCount > 1) {
+        rank = addHighscore(defaultHighscores(), mode, game->player2.score, "Player 2");
+        if (rank >= 0) {
+            printf("Player 2: %d points, rank %d (%s)\n", game->player2.score, rank + 1, highscoreModeName(mode));
+        }
+    }
+}
+
+bool gameplayQuitRequested(Gameplay *game) {
+    return game->menu.quitRequested;
+}
+
+/*
+ * تحرير موارد مشهد اللعب
+ * @param game مؤشر إلى هيكل مشهد اللعب
+ */
+void freeGameplay(Gameplay *game) {
+    for (int i = 0; i < game->viewCount; i++) {
+        printCullStats(&game->views[i].camera, i == 0 ? "gameplay" : "gameplay, view 2");
+    }
+    freePlayer(&game->player1);  // تحرير موارد اللاعب الأول
+    freePlayer(&game->player2);  // تحرير موارد اللاعب الثاني
+    freeMenu(&game->menu);       // تحرير موارد القائمة
+
+    if (game->enemy.sprite) {
+        SDL_FreeSurface(game->enemy.sprite);
+        game->enemy.sprite = NULL;
+    }
+
+    // الصور المشتركة تبقى في الذاكرة المؤقتة للمشاهد الأخرى
+    for (int i = 0; i < game->viewCount; i++) {
+        liberer_back(&game->views[i].back);
+    }
+    game->viewCount = 0;
+    freeCompositor(&game->compositor);
+    freeRenderQueue(&game->renderQueue);
+    freeParticles(&game->particles);
+    for (int i = 0; i < 2; i++) {
+        freeNavField(&game->navFields[i]);
+    }
+    freeNavGrid(&game->nav);
+    freeSightGrid(&game->sight);
+    freeTileMap(&game->level);
+    freeDistField(&game->walls);
+    releaseResource(game->heartSprite);
+    game->heartSprite = NULL;
+    releaseResource(game->obstacleSprite);
+    game->obstacleSprite = NULL;
+}
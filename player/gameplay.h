@@ -0,0 +1,125 @@
+#ifndef GAMEPLAY_H
+#define GAMEPLAY_H
+
+#include "player.h"
+#include "../enemy/enemy.h"
+#include "../background/background.h"
+#include "../core/compositor.h"
+#include "../core/renderqueue.h"
+#include "../core/nav.h"
+#include "../core/particles.h"
+#include "../core/tilemap.h"
+#include "../core/distfield.h"
+#include "../core/sight.h"
+
+// مسار صورة العدو (من مجلد اللاعب)
+#define ENEMY_SPRITE_PATH "../enemy/walk_sheet_6rows_death_final.png"
+
+// المستوى المترجم (يُترجم من levels/level1.txt إذا كان أقدم منه)
+#define LEVEL_PATH "levels/level1.lvl"
+
+// حقل المسافات إلى جدران المستوى: حجم الخلية، ونصف قطر دائرة جسم اللاعب
+#define LEVEL_FIELD_CELL 10
+#define PLAYER_BODY_RADIUS (PLAYER_WIDTH / 4)
+
+// ملف "Save & Quit" (من مجلد اللاعب أو مجلد game)
+#define GAMEPLAY_SAVE_PATH "../savegame.dat"
+
+// نقاط ضربة العدو ونقاط القضاء عليه
+#define SCORE_HIT 10
+#define SCORE_KILL 100
+
+// شبكة تنقل العدو: حجم الخلية، والشريط الأرضي الذي يمشي فيه (مواقع القدمين)
+#define NAV_CELL_SIZE 25
+#define NAV_WALK_TOP (SCREEN_HEIGHT - 150)
+#define NAV_WALK_BOTTOM (SCREEN_HEIGHT - 25)
+
+// خط رؤية العدو: حجم خلية شبكة الرؤية، وارتفاع رأس اللاعب من أعلى صورته
+#define SIGHT_CELL_SIZE 10
+#define PLAYER_HEAD_Y 10
+
+// أقصى عدد للجزيئات الحية (تُحجز مرة واحدة عند التهيئة)
+#define PARTICLE_CAPACITY 16384
+
+// طبقات طابور الرسم من الخلف إلى الأمام
+// داخل طبقة العناصر يُرسم الأسفل على الشاشة (موقع القدمين) أمام الأعلى
+#define LAYER_BACKGROUND 0
+#define LAYER_TILES 1
+#define LAYER_ENTITIES 2
+#define LAYER_BARS 3
+#define LAYER_HUD 4
+
+// عدد المناظر في وضع الشاشة المقسومة
+#define MAX_VIEWS 2
+
+// منظر واحد من المستوى: خلفية وكاميرا خاصة به
+// في الشاشة المقسومة يأخذ كل منظر نصف الشاشة
+typedef struct {
+    background back;         // الخلفية متعددة الطبقات
+    Camera camera;           // الكاميرا التي تستعملها دوال الرسم
+    SDL_Rect area;           // موقع المنظر على الشاشة (مستطيل القص)
+    Player *follow;          // اللاعب الذي تتبعه الكاميرا (NULL = منتصف اللاعبين)
+} GameView;
+
+// هيكل بيانات مشهد اللعب
+// يجمع كل عناصر اللعبة حتى يمكن تشغيلها من main.c أو من مدير المشاهد
+typedef struct {
+    Player player1, player2;         // اللاعبان
+    int playerCount;                 // عدد اللاعبين (1 أو 2)
+    Menu menu;                       // قائمة الإيقاف المؤقت
+    Obstacle obstacles[MAX_OBSTACLES]; // العقبات
+    Enemy enemy;                     // العدو
+    int patrolMin, patrolMax;        // حدود دورية العدو في المستوى (كائن "patrol" أو حول موقع ظهوره)
+    GameView views[MAX_VIEWS];       // منظر واحد، أو منظر لكل لاعب
+    TileMap level;                   // بلاطات المستوى وأماكن العقبات (ملف مُسقط في الذاكرة)
+    DistField walls;                 // المسافة إلى أقرب بلاطة صلبة، تُحسب مرة عند التحميل
+    int viewCount;
+    bool splitScreen;                // شاشة مقسومة (لاعبان)
+    SDL_Surface *heartSprite;        // صورة القلب
+    SDL_Surface *obstacleSprite;     // صورة العقبة
+    Compositor compositor;           // رسم الإطار على شرائط بعدة خيوط
+    RenderQueue renderQueue;         // أوامر رسم الإطار مرتبة حسب الطبقة والموقع قبل المركّب
+    NavGrid nav;                     // خلايا المستوى المحجوبة (خارج الشريط الأرضي والعقبات)
+    NavField navFields[2];           // حقل مسافات نحو كل لاعب، يتشاركه كل من يطارده
+    Uint32 navObstacles;             // العقبات النشطة عند بناء الشبكة (بت لكل عقبة)
+    SightGrid sight;                 // الخلايا التي تحجب رؤية العدو (البلاطات الصلبة والعقبات)
+    Uint32 sightObstacles;           // العقبات النشطة عند بناء شبكة الرؤية
+    ParticlePool particles;          // شرارات الضربات والضرر والموت (للعرض فقط، لا تدخل في البصمة)
+    bool saved;                      // حُفظت اللعبة للاستئناف (النقاط لم تنته بعد)
+} Gameplay;
+
+// تهيئة مشهد اللعب وتحميل موارده
+void initGameplay(Gameplay *game, int playerCount);
+
+// تحديث حالة اللعبة لإطار واحد من لقطة المدخلات (اللاعبان والقائمة)
+void updateGameplay(Gameplay *game, const InputState *input);
+
+// رسم الإطار الحالي (بدون SDL_Flip)
+void drawGameplay(Gameplay *game, SDL_Surface *screen);
+
+// بصمة حالة اللعبة بعد التحديث (مواقع وحالات اللاعبين والعدو والعقبات والقائمة)
+// تُحفظ مع كل إطار في ملف الإعادة للتأكد من أن الإعادة تعطي نفس اللعبة
+Uint32 hashGameplay(const Gameplay *game);
+
+// حفظ حالة اللعبة كاملة في ملف (اللاعبان، العدو، العقبات، الكاميرات)
+// الصور والأصوات تُحفظ بمسارها فقط. تُرجع -1 إذا فشل الحفظ
+int saveGameplay(Gameplay *game, const char *path);
+
+// استرجاع لعبة محفوظة بعد initGameplay بنفس عدد اللاعبين
+// تُرجع -1 إذا لم يوجد الملف أو لم يكن لنفس عدد اللاعبين
+int loadGameplay(Gameplay *game, const char *path);
+
+// استئناف لعبة "Save & Quit" إن وجدت، ثم حذف ملفها
+bool resumeGameplay(Gameplay *game);
+
+// حفظ نقاط اللاعبين في جدول أفضل النتائج (لاعب واحد أو لاعبان)
+// تُستدعى مرة واحدة عند نهاية اللعبة، وليس أثناء الإعادة
+void saveGameplayScores(Gameplay *game);
+
+// هل اختار اللاعب الخروج من القائمة
+bool gameplayQuitRequested(Gameplay *game);
+
+// تحرير موارد مشهد اللعب
+void freeGameplay(Gameplay *game);
+
+#endif // GAMEPLAY_H
@@ -6,7 +6,7 @@
  * SDL_image.h  - مكتبة تحميل الصور
  * SDL_ttf.h    - مكتبة معالجة الخطوط
  * SDL_mixer.h  - مكتبة الصوت
- * player.h     - ملف رأسي يحتوي على تعريفات اللعبة
+ * gameplay.h   - ملف رأسي يحتوي على منطق مشهد اللعب
  * stdio.h      - مكتبة الإدخال والإخراج
  * stdbool.h    - مكتبة القيم المنطقية
  */
@@ -15,55 +15,72 @@
 #include <SDL_image.h>
 #include <SDL_ttf.h>
 #include <SDL_mixer.h>
-#include "player.h"
+#include "gameplay.h"
+#include "../core/resources.h"
+#include "../core/loader.h"
+#include "../core/jobs.h"
+#include "../core/profiler.h"
+#include "../core/audio.h"
+#include "../core/random.h"
+#include "../core/replay.h"
+#include "../core/timer.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 
 // المتغيرات العامة
 SDL_Surface *screen = NULL;      // سطح الشاشة الرئيسي
-SDL_Surface *background = NULL;   // صورة الخلفية
-SDL_Surface *heartSprite = NULL;  // صورة القلب
-TTF_Font *font = NULL;           // الخط المستخدم
 
 // حالة اللعبة
 bool gameRunning = true;         // مؤشر استمرار اللعبة
-Player player1, player2;         // كائنات اللاعبين
-Menu menu;                       // القائمة الرئيسية
-Obstacle obstacles[MAX_OBSTACLES]; // مصفوفة العقبات
+Gameplay game;                   // عناصر اللعبة (اللاعبان، القائمة، العقبات، العدو)
 
 /*
- * رسم قلوب (أرواح) اللاعب
- * @param player مؤشر إلى اللاعب
- * @param screen سطح الشاشة للرسم عليه
+ * الدالة الرئيسية للبرنامج
+ * الخيارات:
+ *   --record file    حفظ مدخلات كل إطار في ملف إعادة
+ *   --replay file    إعادة اللعبة المحفوظة بدل لوحة المفاتيح، بأقصى سرعة
+ *   --headless       مع --replay: بدون نافذة ولا رسم (اختبار وقياس الأداء)
  */
-void drawHearts(Player *player, SDL_Surface *screen) {
-    if (!heartSprite) return;  // التحقق من وجود صورة القلب
-    
-    SDL_Rect heartPos;         // مستطيل موقع القلب
-    heartPos.y = 10;            // المسافة من أعلى الشاشة - تم تقليلها
-    heartPos.w = 20;           // عرض القلب - تم تصغيره
-    heartPos.h = 20;           // ارتفاع القلب - تم تصغيره
-    
-    // رسم قلوب اللاعب الأول (على اليسار)
-    if (!player->isPlayer2) {
-        for (int i = 0; i < player->lives; i++) {
-            heartPos.x = 20 + (i * 40);  // تقليل المسافة بين القلوب إلى 20 بكسل
-            SDL_BlitSurface(heartSprite, NULL, screen, &heartPos);
+int main(int argc, char *argv[]) {
+    const char *recordPath = NULL;
+    const char *replayPath = NULL;
+    bool headless = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else {
+            printf("Usage: %s [--record file | --replay file [--headless]]\n", argv[0]);
+            return -1;
         }
     }
-    // رسم قلوب اللاعب الثاني (على اليمين)
-    else {
-        for (int i = 0; i < player->lives; i++) {
-            heartPos.x = SCREEN_WIDTH - 130+ (i * 40);  // تعديل موقع البداية وتقليل المسافة بين القلوب
-            SDL_BlitSurface(heartSprite, NULL, screen, &heartPos);
-        }
+
+    // ملف الإعادة يحدد البذرة وعدد اللاعبين
+    Replay replay;
+    bool replaying = replayPath != NULL;
+    int playerCount = 2;
+    Uint32 seed = timeSeed();
+    if (replaying) {
+        if (startPlayback(&replay, replayPath) < 0) return -1;
+        seed = replay.seed;
+        playerCount = replay.playerCount;
+    } else if (recordPath) {
+        if (startRecording(&replay, recordPath, seed, playerCount) < 0) return -1;
+    }
+    headless = headless && replaying;
+    seedRandom(seed);
+
+    // بدون نافذة: برامج تشغيل SDL الوهمية للصورة والصوت
+    if (headless) {
+        putenv("SDL_VIDEODRIVER=dummy");
+        putenv("SDL_AUDIODRIVER=dummy");
     }
-}
 
-/*
- * الدالة الرئيسية للبرنامج
- */
-int main(void) {
     // تهيئة SDL والأنظمة الفرعية
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0) {
         printf("SDL could not initialize! SDL_Error: %s\n", SDL_GetError());
@@ -83,10 +100,11 @@ int main(void) {
     }
 
     // تهيئة نظام الصوت
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
+    if (initAudio(audioLatencySetting()) < 0) {
         printf("SDL_mixer could not initialize! Error: %s\n", Mix_GetError());
         return -1;
     }
+    audioPrintInfo();
 
     // إنشاء نافذة اللعبة
     screen = SDL_SetVideoMode(SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_SWSURFACE);
@@ -96,93 +114,115 @@ int main(void) {
     }
     SDL_WM_SetCaption("Player Game", NULL);  // تعيين عنوان النافذة
 
-    // تهيئة عناصر اللعبة
-    initPlayer(&player1, false);  // تهيئة اللاعب الأول
-    initPlayer(&player2, true);   // تهيئة اللاعب الثاني
-    initMenu(&menu);              // تهيئة القائمة
-    initObstacles(obstacles, MAX_OBSTACLES);  // تهيئة العقبات
-
-    // تحميل صورة الخلفية
-    background = IMG_Load("assets/backgrounds/main_bg.png");
-    if (!background) {
-        printf("Failed to load background: %s\n", IMG_GetError());
-        printf("Creating fallback background\n");
-        // إنشاء خلفية بديلة في حالة فشل التحميل
-        background = SDL_CreateRGBSurface(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, 0, 0, 0, 0);
-        SDL_FillRect(background, NULL, SDL_MapRGB(screen->format, 0, 0, 128));
-    }
+    // تهيئة المحلل الزمني (F3 لعرضه، F4 لحفظ الملف)
+    initProfiler();
 
-    // تحميل صورة القلب
-    heartSprite = IMG_Load("assets/ui/heart.png");
-    if (!heartSprite) {
-        printf("Failed to load heart sprite: %s\n", IMG_GetError());
-    }
+    // تهيئة عناصر اللعبة (لاعبان، أو عدد لاعبي اللعبة المحفوظة)
+    initGameplay(&game, playerCount);
+    profilerSetFont(game.menu.font);  // نفس خط القائمة
 
-    // تحميل الخط للقائمة
-    menu.font = TTF_OpenFont("/home/user/Desktop/player_/assets/ui/alagard.ttf", 24);
-    if (menu.font == NULL) {
-        printf("Unable to load font! SDL_ttf Error: %s\n", TTF_GetError());
-        // محاولة تحميل الخط من المجلد الحالي كخيار بديل
-        menu.font = TTF_OpenFont("./assets/ui/alagard.ttf", 24);
-        if (menu.font == NULL) {
-            printf("Fallback font load failed! SDL_ttf Error: %s\n", TTF_GetError());
-        }
+    // استئناف لعبة "Save & Quit" (التسجيل والإعادة يبدآن دائما من البداية)
+    if (!replaying && !recordPath) {
+        resumeGameplay(&game);
     }
 
     // ====== حلقة اللعبة الرئيسية ======
+    InputState *input = defaultInput();
+    InputState replayInput;          // مدخلات الإطار من ملف الإعادة
+    initInput(&replayInput);
+    Uint64 startUs = timerNowUs();
     while (gameRunning) {
         SDL_Event event;
-        // معالجة الأحداث
-        while (SDL_PollEvent(&event)) {
+        // تفريغ طابور الأحداث في لقطة المدخلات مرة واحدة في كل إطار
+        int zone = PROFILE_BEGIN("input");
+        beginInputFrame(input);
+        while (!headless && SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 gameRunning = false;  // إنهاء اللعبة عند الضغط على زر الإغلاق
             }
+            if (profilerHandleEvent(&event)) continue;  // مفاتيح المحلل الزمني
             
-            // معالجة مدخلات اللاعبين والقائمة
-            handlePlayerInput(&player1, &event);
-            handlePlayerInput(&player2, &event);
-            updateMenu(&menu, &event, &player1, &player2);
+            inputEvent(input, &event);  // حالة المفاتيح وأفعال اللاعبين
+        }
+        // أثناء الإعادة لا تصل لوحة المفاتيح إلى اللعبة
+        if (replaying) {
+            input = &replayInput;
+            if (readReplayTick(&replay, input) < 0) {
+                gameRunning = false;  // نهاية الملف
+            }
+        }
+        PROFILE_END(zone);
+        if (gameplayQuitRequested(&game)) {
+            gameRunning = false;  // تم اختيار "Quit" من القائمة
         }
 
+        if (!gameRunning) break;
+
         // تحديث حالة عناصر اللعبة
-        updatePlayer(&player1, NULL);
-        updatePlayer(&player2, NULL);
-        updateObstacles(obstacles, &player1, &player2);
+        zone = PROFILE_BEGIN("update");
+        updateGameplay(&game, input);
+        PROFILE_END(zone);
+
+        // حفظ المدخلات وبصمة الحالة، أو مقارنتها بالتسجيل
+        if (replaying) {
+            checkReplayTick(&replay, hashGameplay(&game));
+        } else if (recordPath) {
+            writeReplayTick(&replay, input, hashGameplay(&game));
+        }
 
-        // ====== الرسم على الشاشة ======
-        // رسم الخلفية
-        if (background) {
-            SDL_BlitSurface(background, NULL, screen, NULL);
-        } else {
-            SDL_FillRect(screen, NULL, SDL_MapRGB(screen->format, 0, 0, 128));
+        if (headless) {
+            PROFILE_FRAME();
+            continue;
         }
+
+        // ====== الرسم على الشاشة ======
+        zone = PROFILE_BEGIN("draw");
+        drawGameplay(&game, screen);
+        drawProfilerOverlay(screen);
+        PROFILE_END(zone);
         
-        // رسم عناصر اللعبة
-        drawPlayer(&player1, screen);  // رسم اللاعب الأول
-        drawPlayer(&player2, screen);  // رسم اللاعب الثاني
-        drawObstacles(obstacles, screen);  // رسم العقبات
-        drawMenu(&menu, screen);  // رسم القائمة
-        
-        // رسم قلوب اللاعبين
-        drawHearts(&player1, screen);
-        drawHearts(&player2, screen);
-        
+        zone = PROFILE_BEGIN("flip");
         SDL_Flip(screen);  // تحديث الشاشة
-        SDL_Delay(16);     // تأخير لتحقيق 60 إطار في الثانية
+        PROFILE_END(zone);
+        if (!replaying) {
+            SDL_Delay(16);     // تأخير لتحقيق 60 إطار في الثانية
+        }
+        PROFILE_FRAME();   // نهاية الإطار
+    }
+    closeProfiler();  // حفظ ملف التتبع إذا تم استخدام المحلل
+
+    // نتيجة الإعادة: الإطارات المختلفة عن التسجيل تجعل البرنامج يعيد 1
+    int result = 0;
+    if (replaying) {
+        float ms = timerElapsedMs(startUs);
+        printf("Replay: %u/%u ticks in %.1f ms (%.3f ms per tick), %u differ from the recording\n",
+               replay.tick, replay.tickCount, ms, replay.tick ? ms / replay.tick : 0.0f,
+               replay.mismatches);
+        result = replay.mismatches ? 1 : 0;
+        closeReplay(&replay);
+    } else if (recordPath) {
+        printf("Recorded %u ticks to %s (seed %u)\n", replay.tick, recordPath, seed);
+        closeReplay(&replay);
+    }
+
+    // حفظ النقاط في جدول أفضل النتائج (اللعبة المعادة سبق حفظها)
+    if (!replaying) {
+        saveGameplayScores(&game);
     }
 
     // ====== تنظيف الموارد ======
-    freePlayer(&player1);  // تحرير موارد اللاعب الأول
-    freePlayer(&player2);  // تحرير موارد اللاعب الثاني
-    freeMenu(&menu);       // تحرير موارد القائمة
-    
-    if (heartSprite) SDL_FreeSurface(heartSprite);  // تحرير صورة القلب
+    freeGameplay(&game);   // تحرير موارد اللاعبين والقائمة والعدو
+    closeLoader(defaultLoader());  // إيقاف خيوط التحميل
+    closeJobPool(defaultJobPool());  // إيقاف خيوط رسم المناظر
+    freeResources();       // تحرير الصور والخطوط المحملة
+    memReport();           // ذروة استهلاك الذاكرة لكل وحدة
+    memReportLeaks();      // الموارد التي لم تُحرر
     
     // إغلاق الأنظمة الفرعية
-    Mix_CloseAudio();  // إغلاق نظام الصوت
+    closeAudio();      // إغلاق نظام الصوت
     TTF_Quit();        // إغلاق نظام الخطوط
     IMG_Quit();        // إغلاق نظام الصور
     SDL_Quit();        // إغلاق SDL
 
-    return 0;
+    return result;
 }
@@ -1,4 +1,8 @@
 #include "player.h"
+#include "../core/resources.h"
+#include "../core/loader.h"
+#include "../core/blit.h"
+#include "../core/mixer.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
@@ -21,10 +25,8 @@
  * stdbool.h    - مكتبة القيم المنطقية (true/false)
  */
 
-// أبعاد الصور في ملف الحركة
-#define PLAYER_WIDTH 32   // عرض كل إطار في ملف الحركة
-#define PLAYER_HEIGHT 32  // ارتفاع كل إطار في ملف الحركة
-#define PLAYER_SCALE 2.0  // معامل تكبير اللاعب على الشاشة
+// أسماء ملفات الحركات بترتيب مصفوفة sprite (مشتركة بين initPlayer و setPlayerSprites)
+static const char *const spriteFiles[5] = {"idle.png", "walk.png", "attack.png", "damage.png", "dying.png"};
 
 /*
 * تهيئة بيانات اللاعب
@@ -35,57 +37,57 @@
 void initPlayer(Player *player, bool isPlayer2) {
     // تحديد المسار الأساسي للصور حسب نوع اللاعب
     const char* basePath = isPlayer2 ? "assets/players/player2/" : "assets/players/player1/";
-    // قائمة بأسماء ملفات الحركات
-    const char* spriteFiles[] = {"idle.png", "walk.png", "attack.png", "damage.png", "dead.png"};
+    snprintf(player->spriteDir, sizeof(player->spriteDir), "%s", basePath);
+
+    // الصور والأصوات تُحمّل في الخلفية على عدة خيوط (threads)
+    // يجب استدعاء finishLoading قبل أول رسم للاعب
+    AssetLoader *loader = defaultLoader();
 
     // تحميل صور الحركات
     for (int i = 0; i < 5; i++) {
         char fullPath[256];  // مصفوفة لتخزين المسار الكامل
         sprintf(fullPath, "%s%s", basePath, spriteFiles[i]);  // دمج المسار مع اسم الملف
-        player->sprite[i] = IMG_Load(fullPath);  // تحميل الصورة
-        if (!player->sprite[i]) {
-            printf("Failed to load %s: %s\n", fullPath, IMG_GetError());
-        }
+        queueSprite(loader, fullPath, &player->sprite[i]);  // طلب تحميل الصورة (ألفا مضروبة مسبقا لـ blitSprite)
     }
+
+    // صورة القلب: تُحمّل هنا مرة واحدة لأن دوال الرسم لا تحمّل الصور
+    queueSprite(loader, "./assets/ui/pixel_heart.png", &player->heartSprite);
     
     // تحميل الأصوات
     const char* soundBasePath = isPlayer2 ? "assets/sounds/player2/" : "assets/sounds/player1/";
     char soundPath[256];
+    player->sounds.walkVoice = 0;
     
     // تحميل صوت المشي
     snprintf(soundPath, sizeof(soundPath), "%swalk.wav", soundBasePath);
-    player->sounds.walkSound = Mix_LoadWAV(soundPath);
+    queueSound(loader, soundPath, &player->sounds.walkSound);
     
     // تحميل صوت الهجوم
     snprintf(soundPath, sizeof(soundPath), "%sattack.wav", soundBasePath);
-    player->sounds.attackSound = Mix_LoadWAV(soundPath);
+    queueSound(loader, soundPath, &player->sounds.attackSound);
     
     // تحميل صوت تلقي الضرر
     snprintf(soundPath, sizeof(soundPath), "%sdamage.wav", soundBasePath);
-    player->sounds.damageSound = Mix_LoadWAV(soundPath);
+    queueSound(loader, soundPath, &player->sounds.damageSound);
     
     // تحميل صوت الموت
     snprintf(soundPath, sizeof(soundPath), "%sdead.wav", soundBasePath);
-    player->sounds.deadSound = Mix_LoadWAV(soundPath);
-    
-    // التحقق من نجاح تحميل الأصوات
-    if (!player->sounds.walkSound || !player->sounds.attackSound || 
-        !player->sounds.damageSound || !player->sounds.deadSound) {
-        printf("Failed to load some sounds: %s\n", Mix_GetError());
-    }
+    queueSound(loader, soundPath, &player->sounds.deadSound);
     
     // تعيين موقع وحجم اللاعب على الشاشة
     player->position.x = isPlayer2 ? SCREEN_WIDTH - 200 : 200;  // موقع البداية حسب نوع اللاعب
-    player->position.y = isPlayer2 ? SCREEN_HEIGHT - (PLAYER_HEIGHT * PLAYER_SCALE) - 50 
-                                 : SCREEN_HEIGHT - (PLAYER_HEIGHT * PLAYER_SCALE) - 50;
-    player->position.w = PLAYER_WIDTH * PLAYER_SCALE;   // عرض اللاعب مع التكبير
-    player->position.h = PLAYER_HEIGHT * PLAYER_SCALE;  // ارتفاع اللاعب مع التكبير
+    player->position.y = isPlayer2 ? SCREEN_HEIGHT - PLAYER_HEIGHT - 50 
+                                 : SCREEN_HEIGHT - PLAYER_HEIGHT - 50;
+    player->levelWidth = SCREEN_WIDTH;   // المستوى بعرض الشاشة ما لم يحدده مشهد اللعب
+    player->position.w = PLAYER_WIDTH;   // عرض اللاعب مع التكبير
+    player->position.h = PLAYER_HEIGHT;  // ارتفاع اللاعب مع التكبير
     
-    // تعيين منطقة القص من ملف الحركة
+    // تعيين منطقة القص من ملف الحركة (بأبعاد الصورة الأصلية)
     player->spriteRect.x = 0;
     player->spriteRect.y = 0;
-    player->spriteRect.w = PLAYER_WIDTH;
-    player->spriteRect.h = PLAYER_HEIGHT;
+    player->spriteRect.w = PLAYER_FRAME_WIDTH;
+    player->spriteRect.h = PLAYER_FRAME_HEIGHT;
+    memset(player->clips, 0, sizeof(player->clips));  // لا توجد صور مكبرة بعد
     
     // تعيين القيم الابتدائية للاعب
     player->lives = 3;           // عدد الأرواح
@@ -104,15 +106,15 @@ void initPlayer(Player *player, bool isPlayer2) {
 * تحديث حالة اللاعب
 * تعالج المدخلات وتحرك اللاعب وتحدث الحركات
 * @param player مؤشر إلى هيكل اللاعب
-* @param event مؤشر إلى حدث SDL
+* @param input لقطة المدخلات (NULL = بدون مدخلات)
 */
-void updatePlayer(Player *player, SDL_Event *event) {
+void updatePlayer(Player *player, const InputState *input) {
     // حفظ الحالة السابقة للاعب
     PlayerState prevState = player->state;
     
     // معالجة المدخلات إذا وجدت
-    if (event) {
-        handlePlayerInput(player, event);
+    if (input) {
+        handlePlayerInput(player, input);
     }
     
     // تحريك الصور
@@ -127,165 +129,117 @@ void updatePlayer(Player *player, SDL_Event *event) {
         }
     }
     
-    // تشغيل الصوت المناسب عند تغيير الحالة
+    // صوت المشي يتكرر ما دام اللاعب يمشي، ولا يبدأ من أوله عند كل تغيير للحالة
+    if (player->state == WALK) {
+        if (player->sounds.walkSound && !soundPlaying(player->sounds.walkVoice)) {
+            player->sounds.walkVoice = loopSound(player->sounds.walkSound, SOUND_AMBIENT, 0.7f, 0.0f);
+        }
+    } else if (player->sounds.walkVoice) {
+        stopSound(player->sounds.walkVoice);
+        player->sounds.walkVoice = 0;
+    }
+
+    // تشغيل الصوت المناسب عند تغيير الحالة (الموت له الأولوية على باقي الأصوات)
     if (prevState != player->state) {
         switch (player->state) {
-            case WALK:
-                if (player->sounds.walkSound) Mix_PlayChannel(-1, player->sounds.walkSound, 0);
-                break;
             case ATTACK:
-                if (player->sounds.attackSound) Mix_PlayChannel(-1, player->sounds.attackSound, 0);
+                playSound(player->sounds.attackSound, SOUND_EFFECT, 1.0f, 0.0f);
                 break;
             case DAMAGE:
-                if (player->sounds.damageSound) Mix_PlayChannel(-1, player->sounds.damageSound, 0);
+                playSound(player->sounds.damageSound, SOUND_EFFECT, 1.0f, 0.0f);
                 break;
             case DEAD:
-                if (player->sounds.deadSound) Mix_PlayChannel(-1, player->sounds.deadSound, 0);
+                playSound(player->sounds.deadSound, SOUND_CRITICAL, 1.0f, 0.0f);
                 break;
             default:
                 break;
         }
     }
     
-    // التحقق من حدود الشاشة
+    // التحقق من حدود المستوى
     if (player->position.x < 0) player->position.x = 0;  // منع الخروج من اليسار
-    if (player->position.x > SCREEN_WIDTH - PLAYER_WIDTH) 
-        player->position.x = SCREEN_WIDTH - PLAYER_WIDTH;  // منع الخروج من اليمين
+    if (player->position.x > player->levelWidth - PLAYER_WIDTH) 
+        player->position.x = player->levelWidth - PLAYER_WIDTH;  // منع الخروج من اليمين
 }
 
 /*
 * رسم اللاعب على الشاشة
 * تعرض الإطار الحالي للاعب مع مراعاة الاتجاه
+* الصور المكبرة (والمعكوسة عند الاتجاه لليسار) تُنشأ مرة واحدة عند أول رسم
+* (أو مسبقا بواسطة preparePlayer)، لذلك يبقى رسم كل إطار عملية نسخ واحدة بدون تكبير
+* القلوب تُرسم بشكل منفصل بواسطة drawPlayerHearts
 * @param player مؤشر إلى هيكل اللاعب
 * @param screen سطح الشاشة للرسم عليه
 */
 void drawPlayer(Player *player, SDL_Surface *screen) {
+    // عدم رسم اللاعب إذا كان خارج مجال الكاميرا
+    Camera *camera = activeCamera();
+    if (!cameraVisible(camera, &player->position, 0)) return;
+
     if (player->state >= 0 && player->state < 5 && player->sprite[player->state]) {
-        SDL_Rect destRect = player->position;
-        SDL_Rect srcRect = player->spriteRect;
-        
-        // Flip the sprite horizontally if facing left
-        if (!player->isFacingRight) {
-            SDL_Surface* flippedSprite = SDL_CreateRGBSurface(
-                SDL_SWSURFACE,
-                player->sprite[player->state]->w,
-                player->sprite[player->state]->h,
-                32,
-                0x00FF0000,
-                0x0000FF00,
-                0x000000FF,
-                0xFF000000
-            );
-            
-            for (int y = 0; y < player->sprite[player->state]->h; y++) {
-                for (int x = 0; x < player->sprite[player->state]->w; x++) {
-                    Uint32* pixels = (Uint32*)player->sprite[player->state]->pixels;
-                    Uint32* flippedPixels = (Uint32*)flippedSprite->pixels;
-                    flippedPixels[y * flippedSprite->w + (flippedSprite->w - 1 - x)] = 
-                        pixels[y * player->sprite[player->state]->w + x];
-                }
-            }
-            
-            SDL_BlitSurface(flippedSprite, &srcRect, screen, &destRect);
-            SDL_FreeSurface(flippedSprite);
-        } else {
-            SDL_BlitSurface(player->sprite[player->state], &srcRect, screen, &destRect);
+        SpriteClip *clip = &player->clips[player->state];
+        SDL_Surface *frames = clipFrames(clip, player->sprite[player->state],
+                                         PLAYER_FRAME_WIDTH, PLAYER_FRAME_HEIGHT,
+                                         PLAYER_SCALE, !player->isFacingRight);
+        if (frames) {
+            SDL_Rect destRect = cameraToScreen(camera, player->position);
+            // تحويل منطقة القص إلى أبعاد الصورة المكبرة
+            SDL_Rect srcRect = clipFrameRect(clip, player->spriteRect.x / PLAYER_FRAME_WIDTH,
+                                             player->spriteRect.y / PLAYER_FRAME_HEIGHT);
+            blitSprite(frames, &srcRect, screen, &destRect);
         }
     }
-    drawPlayerHearts(player, screen);
 }
 
 /*
-* معالجة مدخلات المستخدم
-* تستجيب لضغطات المفاتيح وتغير حالة اللاعب
+* تجهيز صور اللاعب المكبرة والمعكوسة لكل الحالات
+* بعدها لا ينشئ drawPlayer أي صورة، فيمكن رسم اللاعب من عدة خيوط في نفس الوقت
 * @param player مؤشر إلى هيكل اللاعب
-* @param event مؤشر إلى حدث SDL
 */
-void handlePlayerInput(Player *player, SDL_Event *event) {
-    if (event->type == SDL_KEYDOWN) {
-        switch (event->key.keysym.sym) {
-            // ------ Player 1 Controls ------
-            case SDLK_LEFT:
-                if (!player->isPlayer2) {
-                    player->state = WALK;
-                    player->isFacingRight = false;
-                }
-                break;
-                
-            case SDLK_RIGHT:
-                if (!player->isPlayer2) {
-                    player->state = WALK;
-                    player->isFacingRight = true;
-                }
-                break;
-                
-            case SDLK_SPACE:
-                if (!player->isPlayer2) {
-                    player->state = ATTACK;
-                    player->isAttacking = true;
-                }
-                break;
+void preparePlayer(Player *player) {
+    for (int i = 0; i < 5; i++) {
+        if (!player->sprite[i]) continue;
+        clipFrames(&player->clips[i], player->sprite[i], PLAYER_FRAME_WIDTH, PLAYER_FRAME_HEIGHT,
+                   PLAYER_SCALE, 0);
+        clipFrames(&player->clips[i], player->sprite[i], PLAYER_FRAME_WIDTH, PLAYER_FRAME_HEIGHT,
+                   PLAYER_SCALE, 1);
+    }
+}
 
-            // ------ Player 2 Controls ------
-            case SDLK_a:
-                if (player->isPlayer2) {
-                    player->state = WALK;
-                    player->isFacingRight = false;
-                }
-                break;
-                
-            case SDLK_d:
-                if (player->isPlayer2) {
-                    player->state = WALK;
-                    player->isFacingRight = true;
-                }
-                break;
-                
-            case SDLK_f:
-                if (player->isPlayer2) {
-                    player->state = ATTACK;
-                    player->isAttacking = true;
-                }
-                break;
+/*
+* معالجة مدخلات المستخدم
+* تقرأ أفعال اللاعب من لقطة المدخلات (مرة واحدة في كل إطار) وتغير حالته
+* اللاعب الأول هو رقم 0 واللاعب الثاني رقم 1 في جدول المفاتيح
+* @param player مؤشر إلى هيكل اللاعب
+* @param input لقطة المدخلات للإطار الحالي
+*/
+void handlePlayerInput(Player *player, const InputState *input) {
+    int index = player->isPlayer2 ? 1 : 0;
 
-            default:
-                break; // Ignore any other keys
-        }
+    // بداية الهجوم عند الضغط، وإيقافه عند رفع المفتاح
+    if (actionPressed(input, index, ACTION_ATTACK)) {
+        player->state = ATTACK;
+        player->isAttacking = true;
+    } else if (actionReleased(input, index, ACTION_ATTACK) && player->state == ATTACK) {
+        player->isAttacking = false;
+        player->state = IDLE;
     }
-    
-    if (event->type == SDL_KEYUP) {
-        switch (event->key.keysym.sym) {
-            case SDLK_LEFT:
-            case SDLK_RIGHT:
-                if (!player->isPlayer2 && player->state == WALK) {
-                    player->state = IDLE;
-                }
-                break;
-                
-            case SDLK_a:
-            case SDLK_d:
-                if (player->isPlayer2 && player->state == WALK) {
-                    player->state = IDLE;
-                }
-                break;
-                
-            case SDLK_SPACE:
-                if (!player->isPlayer2 && player->state == ATTACK) {
-                    player->isAttacking = false;
-                    player->state = IDLE;
-                }
-                break;
-                
-            case SDLK_f:
-                if (player->isPlayer2 && player->state == ATTACK) {
-                    player->isAttacking = false;
-                    player->state = IDLE;
-                }
-                break;
-                
-            default:
-                break; // Ignore any other keys
-        }
+
+    // المشي من حالة الوقوف فقط (لا يقطع الهجوم أو تلقي الضرر)
+    if (player->state != IDLE && player->state != WALK) return;
+
+    bool left = actionHeld(input, index, ACTION_LEFT);
+    bool right = actionHeld(input, index, ACTION_RIGHT);
+    if (left && right) {
+        // السهمان مضغوطان: الاتجاه الأخير الذي ضُغط
+        if (actionPressed(input, index, ACTION_RIGHT)) player->isFacingRight = true;
+        else if (actionPressed(input, index, ACTION_LEFT)) player->isFacingRight = false;
+        player->state = WALK;
+    } else if (left || right) {
+        player->isFacingRight = right;
+        player->state = WALK;
+    } else {
+        player->state = IDLE;
     }
 }
 
@@ -324,7 +278,7 @@ void animatePlayer(Player *player) {
         if (player->frame < frames[DEAD] - 1) {
             if (player->frameTimer >= speeds[DEAD]) {
                 player->frame++;  // الانتقال للإطار التالي
-                player->spriteRect.x = player->frame * PLAYER_WIDTH;  // تحديث موقع القص
+                player->spriteRect.x = player->frame * PLAYER_FRAME_WIDTH;  // تحديث موقع القص
                 player->frameTimer = 0;  // إعادة ضبط المؤقت
             }
         }
@@ -337,7 +291,7 @@ void animatePlayer(Player *player) {
             // تحديث رقم الإطار الحالي بشكل دائري
             player->frame = (player->frame + 1) % frames[player->state];
             // تحديث موقع القص من ملف الحركة
-            player->spriteRect.x = player->frame * PLAYER_WIDTH;
+            player->spriteRect.x = player->frame * PLAYER_FRAME_WIDTH;
             // إعادة ضبط المؤقت
             player->frameTimer = 0;
             
@@ -396,8 +350,8 @@ void resetPlayer(Player *player) {
     player->isTakingDamage = false;  // إلغاء حالة تلقي الضرر
     // إعادة تعيين الموقع حسب نوع اللاعب
     player->position.x = player->isPlayer2 ? SCREEN_WIDTH - 200 : 200;
-    player->position.y = player->isPlayer2 ? SCREEN_HEIGHT - (PLAYER_HEIGHT * PLAYER_SCALE) - 150 
-                                         : SCREEN_HEIGHT - (PLAYER_HEIGHT * PLAYER_SCALE) - 50;
+    player->position.y = player->isPlayer2 ? SCREEN_HEIGHT - PLAYER_HEIGHT - 150 
+                                         : SCREEN_HEIGHT - PLAYER_HEIGHT - 50;
 }
 
 /*
@@ -406,19 +360,22 @@ void resetPlayer(Player *player) {
 * @param player مؤشر إلى هيكل اللاعب
 */
 void freePlayer(Player *player) {
-    // تحرير صور الحركات
+    // تحرير صور الحركات (تبقى في الذاكرة المؤقتة المشتركة)
     for (int i = 0; i < 5; i++) {
-        if (player->sprite[i]) {
-            SDL_FreeSurface(player->sprite[i]);
-            player->sprite[i] = NULL;
-        }
+        freeClip(&player->clips[i]);  // النسخ المكبرة خاصة باللاعب
+        releaseResource(player->sprite[i]);
+        player->sprite[i] = NULL;
     }
+    releaseResource(player->heartSprite);
+    player->heartSprite = NULL;
     
     // تحرير الأصوات
-    if (player->sounds.walkSound) Mix_FreeChunk(player->sounds.walkSound);
-    if (player->sounds.attackSound) Mix_FreeChunk(player->sounds.attackSound);
-    if (player->sounds.damageSound) Mix_FreeChunk(player->sounds.damageSound);
-    if (player->sounds.deadSound) Mix_FreeChunk(player->sounds.deadSound);
+    stopSound(player->sounds.walkVoice);
+    releaseResource(player->sounds.walkSound);
+    releaseResource(player->sounds.attackSound);
+    releaseResource(player->sounds.damageSound);
+    releaseResource(player->sounds.deadSound);
+    memset(&player->sounds, 0, sizeof(player->sounds));
 }
 
 /*
@@ -428,26 +385,31 @@ void freePlayer(Player *player) {
 * @param newSpritePath مسار ملفات الصور الجديدة
 */
 void changePlayerSprite(Player *player, const char *newSpritePath) {
+    // تحديد المسار الجديد للصور
+    const char* basePath = strstr(newSpritePath, "player1") ? "assets/players/player1/" : "assets/players/player2/";
+    setPlayerSprites(player, basePath);
+}
+
+/*
+* تحميل صور الحركات من مجلد
+* @param player مؤشر إلى هيكل اللاعب
+* @param spriteDir مجلد الصور (ينتهي بـ /)
+*/
+void setPlayerSprites(Player *player, const char *spriteDir) {
     // تحرير الصور القديمة
     for (int i = 0; i < 5; i++) {
-        if (player->sprite[i]) {
-            SDL_FreeSurface(player->sprite[i]);
-            player->sprite[i] = NULL;
-        }
+        freeClip(&player->clips[i]);
+        releaseResource(player->sprite[i]);
+        player->sprite[i] = NULL;
     }
     
-    // تحديد المسار الجديد للصور
-    const char* basePath = strstr(newSpritePath, "player1") ? "players/player1/" : "players/player2/";
-    const char* spriteFiles[] = {"idle.png", "walk.png", "attack.png", "damage.png", "dead.png"};
+    snprintf(player->spriteDir, sizeof(player->spriteDir), "%s", spriteDir);
     
     // تحميل الصور الجديدة
     for (int i = 0; i < 5; i++) {
         char fullPath[256];
-        sprintf(fullPath, "%s%s", basePath, spriteFiles[i]);
-        player->sprite[i] = IMG_Load(fullPath);
-        if (!player->sprite[i]) {
-            printf("Failed to load %s: %s\n", fullPath, IMG_GetError());
-        }
+        snprintf(fullPath, sizeof(fullPath), "%s%s", player->spriteDir, spriteFiles[i]);
+        player->sprite[i] = loadSprite(fullPath);
     }
 }
 
@@ -459,9 +421,11 @@ void changePlayerSprite(Player *player, const char *newSpritePath) {
 void initMenu(Menu *menu) {
     menu->isVisible = false;  // إخفاء القائمة عند البداية
     menu->selectedOption = MENU_RESUME;  // تحديد الخيار الافتراضي
+    menu->quitRequested = false;  // لم يطلب الخروج بعد
+    menu->saveRequested = false;  // لم يطلب الحفظ بعد
     
-    // تحميل الخط
-    menu->font = TTF_OpenFont("./assets/ui/alagard.ttf", 24);
+    // تحميل الخط (من الذاكرة المؤقتة المشتركة)
+    menu->font = loadFont("./assets/ui/alagard.ttf", 24);
     if (menu->font == NULL) {
         printf("Unable to load font! SDL_ttf Error: %s\n", TTF_GetError());
         exit(1);
@@ -481,44 +445,41 @@ void initMenu(Menu *menu) {
 * تحديث حالة القائمة
 * معالجة اختيارات المستخدم في القائمة
 * @param menu مؤشر إلى هيكل القائمة
-* @param event مؤشر إلى حدث SDL
+* @param input لقطة المدخلات (أفعال القائمة مربوطة باللاعب 0)
 * @param player1 مؤشر إلى اللاعب الأول
 * @param player2 مؤشر إلى اللاعب الثاني
 */
-void updateMenu(Menu *menu, SDL_Event *event, Player *player1, Player *player2) {
-    // معالجة ضغطات المفاتيح
-    if (event->type == SDL_KEYDOWN) {
-        switch (event->key.keysym.sym) {
-            case SDLK_ESCAPE:  // مفتاح ESC لإظهار/إخفاء القائمة
-                menu->isVisible = !menu->isVisible;
+void updateMenu(Menu *menu, const InputState *input, Player *player1, Player *player2) {
+    // مفتاح ESC لإظهار/إخفاء القائمة
+    if (actionPressed(input, 0, ACTION_PAUSE)) {
+        menu->isVisible = !menu->isVisible;
+    }
+    if (!menu->isVisible) return;
+
+    // السهمان لأعلى ولأسفل للتنقل بين الخيارات
+    if (actionPressed(input, 0, ACTION_UP)) {
+        menu->selectedOption = (menu->selectedOption - 1 + 4) % 4;
+    }
+    if (actionPressed(input, 0, ACTION_DOWN)) {
+        menu->selectedOption = (menu->selectedOption + 1) % 4;
+    }
+
+    // مفتاح Enter لتنفيذ الخيار المحدد
+    if (actionPressed(input, 0, ACTION_CONFIRM)) {
+        switch (menu->selectedOption) {
+            case MENU_RESUME:  // استئناف اللعب
+                menu->isVisible = false;
                 break;
-            case SDLK_UP:  // السهم لأعلى للتنقل بين الخيارات
-                if (menu->isVisible) {
-                    menu->selectedOption = (menu->selectedOption - 1 + 4) % 4;
-                }
+            case MENU_CHANGE_CHARACTER:  // تغيير الشخصية
+                changePlayerSprite(player1, player1->isPlayer2 ? "player2.png" : "player1.png");
+                changePlayerSprite(player2, player2->isPlayer2 ? "player2.png" : "player1.png");
                 break;
-            case SDLK_DOWN:  // السهم لأسفل للتنقل بين الخيارات
-                if (menu->isVisible) {
-                    menu->selectedOption = (menu->selectedOption + 1) % 4;
-                }
+            case MENU_SAVE_QUIT:  // حفظ اللعبة ثم الخروج (يحفظها مشهد اللعب)
+                menu->saveRequested = true;
+                menu->quitRequested = true;
                 break;
-            case SDLK_RETURN:  // مفتاح Enter لتنفيذ الخيار المحدد
-                if (menu->isVisible) {
-                    switch (menu->selectedOption) {
-                        case MENU_RESUME:  // استئناف اللعب
-                            menu->isVisible = false;
-                            break;
-                        case MENU_CHANGE_CHARACTER:  // تغيير الشخصية
-                            changePlayerSprite(player1, player1->isPlayer2 ? "player2.png" : "player1.png");
-                            changePlayerSprite(player2, player2->isPlayer2 ? "player2.png" : "player1.png");
-                            break;
-                        case MENU_SETTINGS:  // الإعدادات (لم يتم تنفيذها بعد)
-                            break;
-                        case MENU_QUIT:  // الخروج من اللعبة
-                            exit(0);
-                            break;
-                    }
-                }
+            case MENU_QUIT:  // الخروج من اللعبة (تنهيه الحلقة الرئيسية)
+                menu->quitRequested = true;
                 break;
         }
     }
@@ -534,7 +495,7 @@ void drawMenu(Menu *menu, SDL_Surface *screen) {
     if (!menu->isVisible) return;  // لا نرسم القائمة إذا كانت مخفية
 
     // قائمة الخيارات المتاحة
-    const char *options[] = {"Resume", "Change Character", "Settings", "Quit"};
+    const char *options[] = {"Resume", "Change Character", "Save & Quit", "Quit"};
     
     // تحديد موقع وحجم خلفية القائمة
     SDL_Rect menuPos = {SCREEN_WIDTH / 2 - 150, SCREEN_HEIGHT / 2 - 150, 300, 300};
@@ -568,7 +529,7 @@ void drawMenu(Menu *menu, SDL_Surface *screen) {
 */
 void freeMenu(Menu *menu) {
     if (menu->font) {
-        TTF_CloseFont(menu->font);  // تحرير الخط
+        releaseResource(menu->font);  // تحرير الخط
         menu->font = NULL;
     }
 }
@@ -626,26 +587,34 @@ void updateObstacles(Obstacle obstacles[], Player *player1, Player *player2) {
 /*
 * رسم العقبات على الشاشة
 * عرض العقبات النشطة فقط
+* لا تحمّل الصورة بنفسها حتى يمكن استدعاؤها من خيوط الرسم
 * @param obstacles مصفوفة العقبات
+* @param obstacleSprite صورة العقبة (من loadSprite)
 * @param screen سطح الشاشة للرسم عليه
 */
-void drawObstacles(Obstacle obstacles[], SDL_Surface *screen) {
-    // تحميل صورة العقبة
-    SDL_Surface *obstacleSprite = IMG_Load("./assets/obstacles/obstacle.png");
-    if (!obstacleSprite) {
-        printf("Unable to load obstacle sprite: %s\n", IMG_GetError());
-        return;
+void drawObstacles(Obstacle obstacles[], SDL_Surface *obstacleSprite, SDL_Surface *screen) {
+    for (int i = 0; i < MAX_OBSTACLES; i++) {
+        drawObstacle(&obstacles[i], obstacleSprite, screen);
     }
+}
 
-    // رسم العقبات النشطة فقط
-    for (int i = 0; i < MAX_OBSTACLES; i++) {
-        if (obstacles[i].isActive) {
-            SDL_BlitSurface(obstacleSprite, NULL, screen, &obstacles[i].position);
-        }
+/*
+* رسم عقبة واحدة إذا كانت نشطة وظاهرة في الكاميرا
+* (ليأخذ كل منها ترتيبه في طابور الرسم حسب موقعها)
+* @param obstacle مؤشر إلى العقبة
+* @param obstacleSprite صورة العقبة (من loadSprite)
+* @param screen سطح الشاشة للرسم عليه
+*/
+void drawObstacle(Obstacle *obstacle, SDL_Surface *obstacleSprite, SDL_Surface *screen) {
+    if (!obstacleSprite || !obstacle->isActive) {
+        return;
     }
 
-    // تحرير صورة العقبة
-    SDL_FreeSurface(obstacleSprite);
+    Camera *camera = activeCamera();
+    if (cameraVisible(camera, &obstacle->position, 0)) {
+        SDL_Rect pos = cameraToScreen(camera, obstacle->position);
+        blitSprite(obstacleSprite, NULL, screen, &pos);
+    }
 }
 
 /*
@@ -670,10 +639,9 @@ bool checkCollision(SDL_Rect a, SDL_Rect b) {
 * @param screen سطح الشاشة للرسم عليه
 */
 void drawPlayerHearts(Player *player, SDL_Surface *screen) {
-    // تحميل صورة القلب
-    SDL_Surface *heartSprite = IMG_Load("./assets/ui/pixel_heart.png");
+    // صورة القلب (حُمّلت في initPlayer)
+    SDL_Surface *heartSprite = player->heartSprite;
     if (!heartSprite) {
-        printf("Unable to load heart sprite: %s\n", IMG_GetError());
         return;
     }
 
@@ -692,9 +660,6 @@ void drawPlayerHearts(Player *player, SDL_Surface *screen) {
             heartRect.w,
             heartRect.h
         };
-        SDL_BlitSurface(heartSprite, &heartRect, screen, &heartPos);
+        blitSprite(heartSprite, &heartRect, screen, &heartPos);
     }
-    
-    // تحرير صورة القلب
-    SDL_FreeSurface(heartSprite);
 }
@@ -6,16 +6,27 @@
 #include <SDL_ttf.h>
 #include <SDL_mixer.h>
 #include <stdbool.h>
+#include "../core/scale.h"
+#include "../core/camera.h"
+#include "../core/input.h"
+#include "../core/mixer.h"
+// تتبع الصور والأصوات التي ينشئها اللاعب (يُضمَّن أخيرا لأنه يستبدل دوال SDL)
+#ifndef MEM_MODULE
+#define MEM_MODULE "player"
+#endif
+#include "../core/memtrack.h"
 
 // أبعاد الشاشة
 #define SCREEN_WIDTH 1600
 #define SCREEN_HEIGHT 900
 
 // أبعاد اللاعب وسرعته
-#define PLAYER_WIDTH 300
-#define PLAYER_HEIGHT 300
+#define PLAYER_FRAME_WIDTH 32   // عرض كل إطار في ملف الحركة
+#define PLAYER_FRAME_HEIGHT 32  // ارتفاع كل إطار في ملف الحركة
+#define PLAYER_SCALE 5          // معامل تكبير اللاعب (عدد صحيح للحفاظ على البكسلات)
+#define PLAYER_WIDTH (PLAYER_FRAME_WIDTH * PLAYER_SCALE)    // عرض اللاعب على الشاشة
+#define PLAYER_HEIGHT (PLAYER_FRAME_HEIGHT * PLAYER_SCALE)  // ارتفاع اللاعب على الشاشة
 #define PLAYER_SPEED 5
-#define PLAYER_SCALE 5.0  // زيادة حجم اللاعب من 2.0 إلى 3.0
 #define MAX_OBSTACLES 10
 
 // تعريف حالات اللاعب المختلفة
@@ -31,7 +42,7 @@ typedef enum {
 typedef enum {
     MENU_RESUME,           // استئناف اللعب
     MENU_CHANGE_CHARACTER, // تغيير الشخصية
-    MENU_SETTINGS,         // الإعدادات
+    MENU_SAVE_QUIT,        // حفظ اللعبة ثم الخروج
     MENU_QUIT             // الخروج من اللعبة
 } MenuOption;
 
@@ -41,12 +52,17 @@ typedef struct {
     Mix_Chunk *attackSound;  // صوت الهجوم
     Mix_Chunk *damageSound;  // صوت تلقي الضرر
     Mix_Chunk *deadSound;    // صوت الموت
+    SoundId walkVoice;       // صوت المشي المتكرر ما دام اللاعب يمشي (0 = متوقف)
 } PlayerSounds;
 
 // هيكل بيانات اللاعب الرئيسي
 typedef struct {
     SDL_Surface *sprite[5];  // مصفوفة تحتوي على صور الحركات المختلفة
-    SDL_Rect position;       // موقع اللاعب على الشاشة
+    char spriteDir[64];      // مجلد صور الحركات (يُحفظ في ملف الحفظ بدل مؤشرات الصور)
+    SpriteClip clips[5];     // نسخ الصور المكبرة (تُنشأ عند أول رسم لكل حركة)
+    SDL_Surface *heartSprite; // صورة قلب البكسل لعرض الأرواح (تُحمّل مع اللاعب)
+    SDL_Rect position;       // موقع اللاعب في المستوى (يُرسم عبر الكاميرا النشطة)
+    int levelWidth;          // عرض المستوى الذي يتحرك فيه اللاعب
     SDL_Rect spriteRect;     // موقع الصورة الحالية في ملف الحركة
     int lives;              // عدد الأرواح المتبقية
     int score;              // النقاط المحرزة
@@ -68,20 +84,16 @@ typedef struct {
     TTF_Font *font;           // الخط المستخدم
     SDL_Color textColor;      // لون النص العادي
     SDL_Color selectedColor;  // لون النص المحدد
+    bool quitRequested;       // هل اختار اللاعب الخروج
+    bool saveRequested;       // هل اختار اللاعب الحفظ (يحفظه مشهد اللعب)
 } Menu;
 
 // هيكل بيانات العقبات
 typedef struct {
-    SDL_Rect position;  // موقع العقبة
+    SDL_Rect position;  // موقع العقبة في المستوى
     bool isActive;      // هل العقبة نشطة
 } Obstacle;
 
-// المتغيرات العامة المشتركة
-extern SDL_Surface *screen;     // سطح الشاشة الرئيسي
-extern SDL_Surface *heartSprite; // صورة القلب للأرواح
-extern TTF_Font *font;          // الخط المستخدم
-extern SDL_Surface *background; // صورة الخلفية
-
 // ======= دوال اللاعب =======
 
 // تهيئة بيانات اللاعب الأساسية
@@ -90,15 +102,23 @@ void initPlayer(Player *player, bool isPlayer2);
 
 // تحديث حالة اللاعب في كل إطار
 // تتحكم في حركة اللاعب وتحديث حالته وتشغيل الأصوات
-void updatePlayer(Player *player, SDL_Event *event);
+void updatePlayer(Player *player, const InputState *input);
 
 // رسم اللاعب على الشاشة
 // تقوم برسم الإطار الحالي للاعب مع مراعاة الاتجاه
+// الرسم آمن من عدة خيوط بعد preparePlayer (لا يحمّل أي مورد)
 void drawPlayer(Player *player, SDL_Surface *screen);
 
+// تجهيز الصور المكبرة والمعكوسة لكل الحالات مسبقا
+// تُستدعى من الخيط الرئيسي قبل رسم اللاعب من خيوط أخرى (الشاشة المقسومة)
+void preparePlayer(Player *player);
+
+// رسم قلوب (أرواح) اللاعب بتصميم البكسل في أعلى الشاشة
+void drawPlayerHearts(Player *player, SDL_Surface *screen);
+
 // معالجة مدخلات المستخدم
-// تستجيب لضغطات المفاتيح وتغير حالة اللاعب
-void handlePlayerInput(Player *player, SDL_Event *event);
+// تقرأ أفعال اللاعب من لقطة المدخلات وتغير حالته
+void handlePlayerInput(Player *player, const InputState *input);
 
 // تحريك صور اللاعب
 // تتحكم في تتابع إطارات الحركة وسرعتها
@@ -120,6 +140,10 @@ void freePlayer(Player *player);
 // تحميل مجموعة صور جديدة للاعب
 void changePlayerSprite(Player *player, const char *newSpritePath);
 
+// تحميل صور الحركات من مجلد (ينتهي بـ /) وحفظ اسمه في spriteDir
+// تُستخدم أيضا عند استرجاع لعبة محفوظة
+void setPlayerSprites(Player *player, const char *spriteDir);
+
 // ======= دوال القائمة =======
 
 // تهيئة القائمة الرئيسية
@@ -128,7 +152,7 @@ void initMenu(Menu *menu);
 
 // تحديث حالة القائمة
 // معالجة اختيارات المستخدم في القائمة
-void updateMenu(Menu *menu, SDL_Event *event, Player *player1, Player *player2);
+void updateMenu(Menu *menu, const InputState *input, Player *player1, Player *player2);
 
 // رسم القائمة على الشاشة
 // عرض الخيارات مع تمييز الخيار المحدد
@@ -149,8 +173,10 @@ void initObstacles(Obstacle obstacles[], int count);
 void updateObstacles(Obstacle obstacles[], Player *player1, Player *player2);
 
 // رسم العقبات على الشاشة
-// عرض العقبات النشطة فقط
-void drawObstacles(Obstacle obstacles[], SDL_Surface *screen);
+// عرض العقبات النشطة فقط بالصورة المعطاة (محملة مسبقا)
+void drawObstacles(Obstacle obstacles[], SDL_Surface *obstacleSprite, SDL_Surface *screen);
+// رسم عقبة واحدة (نشطة وظاهرة فقط)
+void drawObstacle(Obstacle *obstacle, SDL_Surface *obstacleSprite, SDL_Surface *screen);
 
 // التحقق من التصادم
 // تحديد ما إذا كان هناك تداخل بين مستطيلين
@@ -18,8 +18,8 @@ int main(int argc, char *argv[]) {
         return -1;
     }
 
-    if (Mix_OpenAudio(22050, AUDIO_S16SYS, 2, 4096) == -1) {
-        printf("Mix_OpenAudio failed: %s\n", Mix_GetError());
+    if (initAudio(audioLatencySetting()) == -1) {
+        printf("Audio init failed: %s\n", Mix_GetError());
         IMG_Quit();
         SDL_Quit();
         return -1;
@@ -27,7 +27,7 @@ int main(int argc, char *argv[]) {
 
     if (TTF_Init() == -1) {
         printf("TTF_Init failed: %s\n", TTF_GetError());
-        Mix_CloseAudio();
+        closeAudio();
         IMG_Quit();
         SDL_Quit();
         return -1;
@@ -38,7 +38,7 @@ int main(int argc, char *argv[]) {
     if (!screen) {
         printf("SDL_SetVideoMode failed: %s\n", SDL_GetError());
         TTF_Quit();
-        Mix_CloseAudio();
+        closeAudio();
         IMG_Quit();
         SDL_Quit();
         return -1;
@@ -53,10 +53,13 @@ int main(int argc, char *argv[]) {
 
     // Clean up the Player Menu
     cleanupPlayerMenu(&playerMenu);
+    freeResources();
+    memReport();
+    memReportLeaks();
 
     // Clean up SDL
     TTF_Quit();
-    Mix_CloseAudio();
+    closeAudio();
     IMG_Quit();
     SDL_Quit();
 
@@ -1,4 +1,5 @@
 #include "players.h"
+#include <string.h>
 
 // Function to load button with images and sounds
 void loadButton(Button *btn, const char *path, const char *hoverPath, int x, int y, int width, int height) {
@@ -58,20 +59,39 @@ int isMouseOver(Button btn, int x, int y) {
     return isButtonClicked(btn, x, y);
 }
 
-// Render text function
-void renderText(SDL_Surface *screen, const char *text, int x, int y, SDL_Color color, TTF_Font *font) {
-    if (!font) return;
-    SDL_Surface *textSurface = TTF_RenderText_Solid(font, text, color);
-    if (textSurface) {
-        SDL_Rect textPosition = {x, y, 0, 0};
-        SDL_BlitSurface(textSurface, NULL, screen, &textPosition);
-        SDL_FreeSurface(textSurface);
+// Draw the buttons of a menu and play the hover sound when the mouse enters one
+static void drawMenuButtons(SDL_Surface *screen, Button *buttons[], int count, int previousHoverState[], Mix_Chunk *hoverSound) {
+    int mouseX, mouseY;
+    SDL_GetMouseState(&mouseX, &mouseY);
+
+    for (int i = 0; i < count; i++) {
+        int currentlyHovering = isMouseOver(*buttons[i], mouseX, mouseY);
+
+        // Play hover sound when mouse first enters button area
+        if (currentlyHovering && !previousHoverState[i]) {
+            if (hoverSound) {
+                playSound(hoverSound, SOUND_UI, 1.0f, 0.0f);
+            }
+            buttons[i]->hover = 1;
+        } else if (!currentlyHovering) {
+            buttons[i]->hover = 0;
+        }
+
+        previousHoverState[i] = currentlyHovering;
+
+        // Render appropriate button image
+        SDL_BlitSurface(
+            buttons[i]->hover ? buttons[i]->hoverImage : buttons[i]->image,
+            NULL,
+            screen,
+            &buttons[i]->position
+        );
     }
 }
 
 void initPlayerMenu(PlayerMenu *menu, SDL_Surface *screen) {
     menu->screen = screen;
-    menu->bg = IMG_Load("background.png");
+    menu->bg = loadImage("background.png");
     if (!menu->bg) {
         printf("Error loading background: %s\n", IMG_GetError());
     }
@@ -80,130 +100,101 @@ void initPlayerMenu(PlayerMenu *menu, SDL_Surface *screen) {
     loadButton(&menu->btn_singlePlayer, "singleplayer.png", "singleplayer_hover.png", 600, 450, 400, 200);
     loadButton(&menu->btn_multiPlayer, "multiplayer.png", "multiplayer_hover.png", 600, 700, 400, 200);
     loadButton(&menu->btn_back, "back.png", "back_hover.png", 50, 800, 150, 75);
+    memset(menu->previousHoverState, 0, sizeof(menu->previousHoverState));
 
-    // Initialize audio with better quality
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
+    // Make sure the audio device is open (does nothing if main already opened it)
+    if (initAudio(audioLatencySetting()) < 0) {
         printf("Error initializing audio: %s\n", Mix_GetError());
     }
 
     // Load sounds with error checking - using WAV files instead of MP3
-    menu->hoverSound = Mix_LoadWAV("hover.wav");
+    menu->hoverSound = loadSound("hover.wav");
     if (!menu->hoverSound) {
         printf("Error loading hover sound: %s\n", Mix_GetError());
     }
 
-    menu->clickSound = Mix_LoadWAV("click.wav");
+    menu->clickSound = loadSound("click.wav");
     if (!menu->clickSound) {
         printf("Error loading click sound: %s\n", Mix_GetError());
     }
 
-    // For background music, MP3 is supported but needs SDL_mixer with MP3 support
-    menu->backgroundMusic = Mix_LoadMUS("playermusic.mp3");
-    if (!menu->backgroundMusic) {
-        // Try WAV format if MP3 fails
-        menu->backgroundMusic = Mix_LoadMUS("playermusic.wav");
-        if (!menu->backgroundMusic) {
-            printf("Error loading background music: %s\n", Mix_GetError());
+    // Background music, decoded by the music streamer and crossfaded in.
+    // It goes on (without restarting) when we come back from the avatar menu.
+    setMusicVolume(MIX_MAX_VOLUME / 2); // Set music to 50% volume
+    if (playMusic("playermusic.mp3", MUSIC_FADE_MS) < 0) {
+        // Try WAV format if there is no MP3
+        if (playMusic("playermusic.wav", MUSIC_FADE_MS) < 0) {
+            printf("Error loading background music\n");
         }
     }
 
-    if (menu->backgroundMusic) {
-        Mix_VolumeMusic(MIX_MAX_VOLUME / 2); // Set music to 50% volume
-        Mix_PlayMusic(menu->backgroundMusic, -1); // Start playing music on loop
+    menu->font = loadFont("alagard.ttf", 100);
+    if (!menu->font) {
+        printf("Error loading font: %s\n", TTF_GetError());
     }
 }
 
-void showPlayerMenu(PlayerMenu *menu) {
-    int running = 1;
-    SDL_Event event;
-    int mouseX, mouseY;
-    int previousHoverState[3] = {0, 0, 0}; // Track previous hover states
+void drawPlayerMenu(PlayerMenu *menu) {
+    SDL_BlitSurface(menu->bg, NULL, menu->screen, NULL);
+    SDL_Color textColor = {255, 255, 255};
+    renderText(menu->screen, "Player Menu", 500, 30, textColor, menu->font);
 
-    menu->font = TTF_OpenFont("alagard.ttf", 100);
-    if (!menu->font) {
-        printf("Error loading font: %s\n", TTF_GetError());
-        return;
+    Button *buttons[] = {&menu->btn_singlePlayer, &menu->btn_multiPlayer, &menu->btn_back};
+    drawMenuButtons(menu->screen, buttons, 3, menu->previousHoverState, menu->hoverSound);
+}
+
+PlayerMenuAction handlePlayerMenuEvent(PlayerMenu *menu, SDL_Event *event) {
+    if (event->type != SDL_MOUSEBUTTONDOWN) {
+        return PLAYERMENU_NONE;
     }
 
-    // Ensure background music is playing
-    if (!Mix_PlayingMusic() && menu->backgroundMusic) {
-        Mix_PlayMusic(menu->backgroundMusic, -1);
+    // Play click sound for any button click
+    if (menu->clickSound) {
+        playSound(menu->clickSound, SOUND_UI, 1.0f, 0.0f);
     }
 
-    while (running) {
-        SDL_BlitSurface(menu->bg, NULL, menu->screen, NULL);
-        SDL_GetMouseState(&mouseX, &mouseY);
-        SDL_Color textColor = {255, 255, 255};
-        renderText(menu->screen, "Player Menu", 500, 30, textColor, menu->font);
-
-        Button *buttons[] = {&menu->btn_singlePlayer, &menu->btn_multiPlayer, &menu->btn_back};
-
-        // Handle button hover states and sounds
-        for (int i = 0; i < 3; i++) {
-            int currentlyHovering = isMouseOver(*buttons[i], mouseX, mouseY);
-            
-            // Play hover sound when mouse first enters button area
-            if (currentlyHovering && !previousHoverState[i]) {
-                if (menu->hoverSound) {
-                    Mix_PlayChannel(-1, menu->hoverSound, 0);
-                }
-                buttons[i]->hover = 1;
-            } else if (!currentlyHovering) {
-                buttons[i]->hover = 0;
-            }
-            
-            previousHoverState[i] = currentlyHovering;
-
-            // Render appropriate button image
-            SDL_BlitSurface(
-                buttons[i]->hover ? buttons[i]->hoverImage : buttons[i]->image,
-                NULL,
-                menu->screen,
-                &buttons[i]->position
-            );
-        }
+    if (isButtonClicked(menu->btn_singlePlayer, event->button.x, event->button.y)) {
+        printf("Single Player Selected\n");
+        return PLAYERMENU_SINGLE;
+    }
+    if (isButtonClicked(menu->btn_multiPlayer, event->button.x, event->button.y)) {
+        printf("Multiplayer Selected\n");
+        return PLAYERMENU_MULTI;
+    }
+    if (isButtonClicked(menu->btn_back, event->button.x, event->button.y)) {
+        printf("Returning to Main Menu\n");
+        return PLAYERMENU_BACK;
+    }
+    return PLAYERMENU_NONE;
+}
 
+void showPlayerMenu(PlayerMenu *menu) {
+    int running = 1;
+    SDL_Event event;
+
+    while (running) {
+        drawPlayerMenu(menu);
         SDL_Flip(menu->screen);
 
         while (SDL_PollEvent(&event)) {
-            switch (event.type) {
-                case SDL_QUIT:
+            if (event.type == SDL_QUIT) {
+                running = 0;
+                break;
+            }
+
+            switch (handlePlayerMenuEvent(menu, &event)) {
+                case PLAYERMENU_SINGLE:
+                case PLAYERMENU_MULTI: {
+                    AvatarMenu avatarMenu;
+                    initAvatarMenu(&avatarMenu, menu->screen);
+                    showAvatarMenu(&avatarMenu);
+                    cleanupAvatarMenu(&avatarMenu);
+                    break;
+                }
+                case PLAYERMENU_BACK:
                     running = 0;
                     break;
-                case SDL_MOUSEBUTTONDOWN:
-                    // Play click sound for any button click
-                    if (menu->clickSound) {
-                        Mix_PlayChannel(-1, menu->clickSound, 0);
-                    }
-
-                    if (isButtonClicked(menu->btn_singlePlayer, event.button.x, event.button.y)) {
-                        printf("Single Player Selected\n");
-                        AvatarMenu avatarMenu;
-                        initAvatarMenu(&avatarMenu, menu->screen);
-                        showAvatarMenu(&avatarMenu);
-                        cleanupAvatarMenu(&avatarMenu);
-                        
-                        // Restore background music after returning from avatar menu
-                        if (menu->backgroundMusic) {
-                            Mix_PlayMusic(menu->backgroundMusic, -1);
-                        }
-                    }
-                    if (isButtonClicked(menu->btn_multiPlayer, event.button.x, event.button.y)) {
-                        printf("Multiplayer Selected\n");
-                        AvatarMenu avatarMenu;
-                        initAvatarMenu(&avatarMenu, menu->screen);
-                        showAvatarMenu(&avatarMenu);
-                        cleanupAvatarMenu(&avatarMenu);
-                        
-                        // Restore background music after returning from avatar menu
-                        if (menu->backgroundMusic) {
-                            Mix_PlayMusic(menu->backgroundMusic, -1);
-                        }
-                    }
-                    if (isButtonClicked(menu->btn_back, event.button.x, event.button.y)) {
-                        printf("Returning to Main Menu\n");
-                        running = 0;
-                    }
+                case PLAYERMENU_NONE:
                     break;
             }
         }
@@ -213,18 +204,12 @@ void showPlayerMenu(PlayerMenu *menu) {
 }
 
 void cleanupPlayerMenu(PlayerMenu *menu) {
-    if (menu->backgroundMusic) Mix_FreeMusic(menu->backgroundMusic);
-    if (menu->hoverSound) Mix_FreeChunk(menu->hoverSound);
-    if (menu->clickSound) Mix_FreeChunk(menu->clickSound);
-    
-    Mix_HaltMusic();
-    Mix_CloseAudio();
-    Mix_Quit();  // Add this line to properly quit SDL_mixer
-
-    TTF_CloseFont(menu->font);
-    TTF_Quit();
-
-    SDL_FreeSurface(menu->bg);
+    // Shared assets stay cached for the other scenes
+    releaseResource(menu->hoverSound);
+    releaseResource(menu->clickSound);
+    releaseResource(menu->font);
+    releaseResource(menu->bg);
+
     SDL_FreeSurface(menu->btn_singlePlayer.image);
     SDL_FreeSurface(menu->btn_singlePlayer.hoverImage);
     SDL_FreeSurface(menu->btn_multiPlayer.image);
@@ -236,7 +221,7 @@ void cleanupPlayerMenu(PlayerMenu *menu) {
 
 void initAvatarMenu(AvatarMenu *menu, SDL_Surface *screen) {
     menu->screen = screen;
-    menu->bg = IMG_Load("background.png");
+    menu->bg = loadImage("background.png");
     if (!menu->bg) {
         printf("Error loading background: %s\n", IMG_GetError());
     }
@@ -247,109 +232,87 @@ void initAvatarMenu(AvatarMenu *menu, SDL_Surface *screen) {
     loadButton(&menu->input2, "input2.png", "input2_hover.png", 950, 400, 300, 150);
     loadButton(&menu->btn_validate, "validate.png", "validate_hover.png", 650, 600, 300, 150);
     loadButton(&menu->btn_back, "back.png", "back_hover.png", 1300, 750, 300, 150);
-
-    menu->backgroundMusic = NULL;
+    memset(menu->previousHoverState, 0, sizeof(menu->previousHoverState));
 
     // Load sounds with WAV format
-    menu->clickSound = Mix_LoadWAV("click.wav");
+    menu->clickSound = loadSound("click.wav");
     if (!menu->clickSound) {
         printf("Error loading click sound: %s\n", Mix_GetError());
     }
 
-    menu->hoverSound = Mix_LoadWAV("hover.wav");
+    menu->hoverSound = loadSound("hover.wav");
     if (!menu->hoverSound) {
         printf("Error loading hover sound: %s\n", Mix_GetError());
     }
-}
 
-void showAvatarMenu(AvatarMenu *menu) {
-    int menuRunning = 1;
-    SDL_Event event;
-    int mouseX, mouseY;
-    int previousHoverState[4] = {0}; // Initialize hover state tracking
-    
-    Button *buttons[] = {&menu->input1, &menu->input2, &menu->btn_validate, &menu->btn_back};
-    menu->font = TTF_OpenFont("alagard.ttf", 100);
+    menu->font = loadFont("alagard.ttf", 100);
     if (!menu->font) {
         printf("Error loading font: %s\n", TTF_GetError());
-        return;
     }
-    
-    while (menuRunning) {
-        SDL_BlitSurface(menu->bg, NULL, menu->screen, NULL);
-        SDL_GetMouseState(&mouseX, &mouseY);
-        SDL_Color textColor = {255, 255, 255};
-        renderText(menu->screen, "Player Menu", 550, 60, textColor, menu->font);
-
-        // Handle button hover states and sounds
-        for (int i = 0; i < 4; i++) {
-            int currentlyHovering = isMouseOver(*buttons[i], mouseX, mouseY);
-            
-            if (currentlyHovering && !previousHoverState[i]) {
-                if (menu->hoverSound) {
-                    Mix_PlayChannel(-1, menu->hoverSound, 0);
-                }
-                buttons[i]->hover = 1;
-            } else if (!currentlyHovering) {
-                buttons[i]->hover = 0;
+}
+
+void drawAvatarMenu(AvatarMenu *menu) {
+    SDL_BlitSurface(menu->bg, NULL, menu->screen, NULL);
+    SDL_Color textColor = {255, 255, 255};
+    renderText(menu->screen, "Player Menu", 550, 60, textColor, menu->font);
+
+    Button *buttons[] = {&menu->input1, &menu->input2, &menu->btn_validate, &menu->btn_back};
+    drawMenuButtons(menu->screen, buttons, 4, menu->previousHoverState, menu->hoverSound);
+}
+
+AvatarMenuAction handleAvatarMenuEvent(AvatarMenu *menu, SDL_Event *event) {
+    switch (event->type) {
+        case SDL_MOUSEBUTTONDOWN:
+            if (menu->clickSound) {
+                playSound(menu->clickSound, SOUND_UI, 1.0f, 0.0f);
             }
-            
-            previousHoverState[i] = currentlyHovering;
-
-            SDL_BlitSurface(
-                buttons[i]->hover ? buttons[i]->hoverImage : buttons[i]->image,
-                NULL,
-                menu->screen,
-                &buttons[i]->position
-            );
-        }
+            if (isButtonClicked(menu->input1, event->button.x, event->button.y)) {
+                printf("Input 1 Selected\n");
+            } else if (isButtonClicked(menu->input2, event->button.x, event->button.y)) {
+                printf("Input 2 Selected\n");
+            }
+            if (isButtonClicked(menu->btn_validate, event->button.x, event->button.y)) {
+                printf("Moving to Highscore Menu\n");
+                return AVATARMENU_VALIDATE;
+            }
+            if (isButtonClicked(menu->btn_back, event->button.x, event->button.y)) {
+                printf("Returning to Player Menu\n");
+                return AVATARMENU_BACK;
+            }
+            break;
+        case SDL_KEYDOWN:
+            if (event->key.keysym.sym == SDLK_RETURN) {
+                printf("Enter pressed: move to highscore Menu\n");
+                return AVATARMENU_VALIDATE;
+            }
+            break;
+    }
+    return AVATARMENU_NONE;
+}
 
+void showAvatarMenu(AvatarMenu *menu) {
+    int menuRunning = 1;
+    SDL_Event event;
+
+    while (menuRunning) {
+        drawAvatarMenu(menu);
         SDL_Flip(menu->screen);
 
         while (SDL_PollEvent(&event)) {
-            switch (event.type) {
-                case SDL_QUIT:
-                    menuRunning = 0;
-                    break;
-                case SDL_MOUSEBUTTONDOWN:
-                    if (menu->clickSound) {
-                        Mix_PlayChannel(-1, menu->clickSound, 0);
-                    }
-                    if (isButtonClicked(menu->input1, event.button.x, event.button.y)) {
-                        printf("Input 1 Selected\n");
-                    } else if (isButtonClicked(menu->input2, event.button.x, event.button.y)) {
-                        printf("Input 2 Selected\n");
-                    }
-                    if (isButtonClicked(menu->btn_validate, event.button.x, event.button.y)) {
-                        printf("Moving to Highscore Menu\n");
-                        menuRunning = 0;
-                    }
-                    if (isButtonClicked(menu->btn_back, event.button.x, event.button.y)) {
-                        printf("Returning to Player Menu\n");
-                        menuRunning = 0;
-                    }
-                    break;
-                case SDL_KEYDOWN:
-                    if (event.key.keysym.sym == SDLK_RETURN) {
-                        printf("Enter pressed: move to highscore Menu\n");
-                        menuRunning = 0;
-                    }
-                    break;
+            if (event.type == SDL_QUIT || handleAvatarMenuEvent(menu, &event) != AVATARMENU_NONE) {
+                menuRunning = 0;
             }
         }
     }
 }
 
 void cleanupAvatarMenu(AvatarMenu *menu) {
-    Mix_HaltMusic();
-    if (menu->backgroundMusic) Mix_FreeMusic(menu->backgroundMusic);
-    if (menu->clickSound) Mix_FreeChunk(menu->clickSound);
-    if (menu->hoverSound) Mix_FreeChunk(menu->hoverSound);
-    
-    Mix_CloseAudio();
-    Mix_Quit();  // Add this line to properly quit SDL_mixer
-
-    SDL_FreeSurface(menu->bg);
+    releaseResource(menu->clickSound);
+    releaseResource(menu->hoverSound);
+    releaseResource(menu->font);
+    releaseResource(menu->bg);
+    // The audio device stays open: the player menu keeps using it
+
     SDL_FreeSurface(menu->avatar1.image);
     SDL_FreeSurface(menu->avatar1.hoverImage);
     SDL_FreeSurface(menu->avatar2.image);
@@ -362,8 +325,4 @@ void cleanupAvatarMenu(AvatarMenu *menu) {
     SDL_FreeSurface(menu->btn_validate.hoverImage);
     SDL_FreeSurface(menu->btn_back.image);
     SDL_FreeSurface(menu->btn_back.hoverImage);
-    
-    if (menu->font) {
-        TTF_CloseFont(menu->font);
-    }
 }
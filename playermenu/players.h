@@ -5,6 +5,16 @@
 #include <SDL/SDL_image.h>
 #include <SDL/SDL_mixer.h>
 #include <SDL/SDL_ttf.h>
+#include "../core/audio.h"
+#include "../core/mixer.h"
+#include "../core/music.h"
+#include "../core/resources.h"
+#include "../core/text.h"
+// Track the surfaces and sounds created by the menu (included last, it wraps the SDL calls)
+#ifndef MEM_MODULE
+#define MEM_MODULE "playermenu"
+#endif
+#include "../core/memtrack.h"
 
 // Button structure
 typedef struct {
@@ -14,39 +24,57 @@ typedef struct {
     int hover;
 } Button;
 
+// Result of an event in the player menu
+typedef enum {
+    PLAYERMENU_NONE,
+    PLAYERMENU_SINGLE,
+    PLAYERMENU_MULTI,
+    PLAYERMENU_BACK
+} PlayerMenuAction;
+
+// Result of an event in the avatar menu
+typedef enum {
+    AVATARMENU_NONE,
+    AVATARMENU_VALIDATE,
+    AVATARMENU_BACK
+} AvatarMenuAction;
+
 // PlayerMenu structure
 typedef struct {
     SDL_Surface *screen; 
     SDL_Surface *bg;
-    Mix_Music *backgroundMusic;
     Mix_Chunk *clickSound;
     Mix_Chunk *hoverSound;
     TTF_Font *font;
     Button btn_singlePlayer;
     Button btn_multiPlayer;
     Button btn_back;
+    int previousHoverState[3];
 } PlayerMenu;
 
 // AvatarMenu structure
 typedef struct {
     SDL_Surface *screen;
     SDL_Surface *bg;
-    Mix_Music *backgroundMusic;
     Mix_Chunk *clickSound;
     Mix_Chunk *hoverSound; 
     TTF_Font *font;
     Button avatar1,avatar2,input1,input2,btn_validate,btn_back;
+    int previousHoverState[4];
 } AvatarMenu;
 
 // Function prototypes
 void loadButton(Button *btn, const char *path, const char *hoverPath, int x, int y, int width, int height);
-void renderText(SDL_Surface *screen, const char *text, int x, int y, SDL_Color color, TTF_Font *font);
 int isButtonClicked(Button btn, int x, int y);
 int isMouseOver(Button btn, int x, int y);
 void initPlayerMenu(PlayerMenu *menu,SDL_Surface *screen);
+void drawPlayerMenu(PlayerMenu *menu);
+PlayerMenuAction handlePlayerMenuEvent(PlayerMenu *menu, SDL_Event *event);
 void showPlayerMenu(PlayerMenu *menu);
 void cleanupPlayerMenu(PlayerMenu *menu);
 void initAvatarMenu(AvatarMenu *menu, SDL_Surface *screen);
+void drawAvatarMenu(AvatarMenu *menu);
+AvatarMenuAction handleAvatarMenuEvent(AvatarMenu *menu, SDL_Event *event);
 void showAvatarMenu(AvatarMenu *menu);
 void cleanupAvatarMenu(AvatarMenu *menu);
 
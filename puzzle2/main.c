@@ -6,12 +6,14 @@ int main(int argc, char* argv[]) {
     
     // Initialize SDL and load assets
     initSDL(&game);
+    initProfiler();  // F4 writes a Chrome trace of the game loop
     loadAssets(&game);
     shuffleButtons(game.buttons);
     // Run the game loop
     gameLoop(&game);
     
     // Clean up resources
+    closeProfiler();
     cleanup(&game);
     
     return 0;
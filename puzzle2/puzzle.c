@@ -26,7 +26,7 @@ Mix_Chunk* generateTone(double frequency) {
     chunk->abuf = (Uint8*)buffer;
     chunk->volume = MIX_MAX_VOLUME;
 
-    return chunk;
+    return TRACK_CHUNK(chunk);
 }
 
 
@@ -61,7 +61,7 @@ Mix_Chunk* generateLevelStartSound(int level) {
     chunk->abuf = (Uint8*)buffer;
     chunk->volume = MIX_MAX_VOLUME;
 
-    return chunk;
+    return TRACK_CHUNK(chunk);
 }
 
 // Generate a success sound (ascending major triad)
@@ -92,7 +92,7 @@ Mix_Chunk* generateSuccessSound() {
     chunk->abuf = (Uint8*)buffer;
     chunk->volume = MIX_MAX_VOLUME;
 
-    return chunk;
+    return TRACK_CHUNK(chunk);
 }
 
 // Generate a failure sound (descending minor triad)
@@ -123,7 +123,7 @@ Mix_Chunk* generateFailureSound() {
     chunk->abuf = (Uint8*)buffer;
     chunk->volume = MIX_MAX_VOLUME;
 
-    return chunk;
+    return TRACK_CHUNK(chunk);
 }
 
 
@@ -131,8 +131,15 @@ Mix_Chunk* generateFailureSound() {
 // Asset loading functions
 // =====================
 
+// Buttons are drawn with blitSprite: replace an image by its premultiplied copy
+static SDL_Surface* convertToSprite(SDL_Surface* image) {
+    SDL_Surface* sprite = makeSprite(image);
+    SDL_FreeSurface(image);
+    return sprite;
+}
+
 // Load a button with its images and sound
-void loadButton(Button* btn, const char* path, const char* clickedPath, int x, int y, int width, int height) {
+void loadPuzzleButton(Button* btn, const char* path, const char* clickedPath, int x, int y, int width, int height) {
     // Load button images
     btn->image = IMG_Load(path);
     btn->clickedImage = IMG_Load(clickedPath);
@@ -144,6 +151,12 @@ void loadButton(Button* btn, const char* path, const char* clickedPath, int x, i
         renderText(SDL_GetVideoSurface(), IMG_GetError(), 200, 10, errorColor, NULL);
         SDL_Flip(SDL_GetVideoSurface());
         SDL_Delay(3000);
+
+        // Keep the button consistent: both images or none
+        if (btn->image) SDL_FreeSurface(btn->image);
+        if (btn->clickedImage) SDL_FreeSurface(btn->clickedImage);
+        btn->image = NULL;
+        btn->clickedImage = NULL;
         return;
     }
 
@@ -179,6 +192,8 @@ void loadButton(Button* btn, const char* path, const char* clickedPath, int x, i
         btn->image = resized;
         btn->clickedImage = resized_clicked;
     }
+    btn->image = convertToSprite(btn->image);
+    btn->clickedImage = convertToSprite(btn->clickedImage);
 
     // Initialize button state
     btn->clicked = 0;
@@ -198,7 +213,7 @@ void loadButton(Button* btn, const char* path, const char* clickedPath, int x, i
 // Load all game assets
 void loadAssets(PuzzleGame* game) {
     // Load background image
-    game->backgroundImage = IMG_Load("background.png");
+    game->backgroundImage = loadImage("background.png");
     if (!game->backgroundImage) {
         SDL_Color errorColor = { 255, 0, 0 };
         renderText(SDL_GetVideoSurface(), "Error loading background image: ", 10, 10, errorColor, NULL);
@@ -222,10 +237,10 @@ void loadAssets(PuzzleGame* game) {
     int startY = (SCREEN_HEIGHT - totalHeight) / 2;
 
     // Load the buttons and set their positions for 2x2 grid
-    loadButton(&game->buttons[0], "Red.png", "Red1.png", startX, startY, buttonWidth, buttonHeight);
-    loadButton(&game->buttons[1], "green.png", "green1.png", startX + buttonWidth + buttonGap, startY, buttonWidth, buttonHeight);
-    loadButton(&game->buttons[2], "blue.png", "blue1.png", startX, startY + buttonHeight + buttonGap, buttonWidth, buttonHeight);
-    loadButton(&game->buttons[3], "yellow.png", "yellow1.png", startX + buttonWidth + buttonGap, startY + buttonHeight + buttonGap, buttonWidth, buttonHeight);
+    loadPuzzleButton(&game->buttons[0], "Red.png", "Red1.png", startX, startY, buttonWidth, buttonHeight);
+    loadPuzzleButton(&game->buttons[1], "green.png", "green1.png", startX + buttonWidth + buttonGap, startY, buttonWidth, buttonHeight);
+    loadPuzzleButton(&game->buttons[2], "blue.png", "blue1.png", startX, startY + buttonHeight + buttonGap, buttonWidth, buttonHeight);
+    loadPuzzleButton(&game->buttons[3], "yellow.png", "yellow1.png", startX + buttonWidth + buttonGap, startY + buttonHeight + buttonGap, buttonWidth, buttonHeight);
 }
 // Shuffle button colors and sounds while keeping positions
 void shuffleButtons(Button buttons[4]) {
@@ -243,7 +258,7 @@ void shuffleButtons(Button buttons[4]) {
     
     // Fisher-Yates shuffle algorithm
     for (int i = 3; i > 0; i--) {
-        int j = rand() % (i + 1);
+        int j = randomInt(i + 1);
         
         // Swap properties
         SDL_Surface* tempImg = buttons[i].image;
@@ -280,7 +295,7 @@ void initSDL(PuzzleGame* game) {
     }
     
     // Initialize SDL_mixer
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
+    if (initAudio(audioLatencySetting()) < 0) {
         printf("Mixer initialization failed: %s\n", Mix_GetError());
         TTF_Quit();
         SDL_Quit();
@@ -291,7 +306,7 @@ void initSDL(PuzzleGame* game) {
     game->screen = SDL_SetVideoMode(SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_SWSURFACE);
     if (!game->screen) {
         printf("Video mode set failed: %s\n", SDL_GetError());
-        Mix_CloseAudio();
+        closeAudio();
         TTF_Quit();
         SDL_Quit();
         exit(1);
@@ -299,19 +314,29 @@ void initSDL(PuzzleGame* game) {
     
     // Set window title
     SDL_WM_SetCaption("Simon Game", NULL);
-    
-    // Load font
-    game->font = TTF_OpenFont("alagard.ttf", 24);
+
+    initPuzzleGame(game, game->screen);
     if (!game->font) {
-        printf("Font loading failed: %s\n", TTF_GetError());
-        Mix_CloseAudio();
+        closeAudio();
         TTF_Quit();
         SDL_Quit();
         exit(1);
     }
+}
+
+// Initialize the game state
+void initPuzzleGame(PuzzleGame* game, SDL_Surface* screen) {
+    memset(game, 0, sizeof(*game));
+    game->screen = screen;
+
+    // Load font
+    game->font = loadFont("alagard.ttf", 24);
+    if (!game->font) {
+        printf("Font loading failed: %s\n", TTF_GetError());
+    }
     
-    // Initialize random seed
-    srand(time(NULL));
+    // Initialize random seed (the same seed gives the same sequences)
+    seedRandom(timeSeed());
     
     // Initialize game variables
     game->gameRunning = true;
@@ -379,7 +404,7 @@ void showAnimatedMessage(PuzzleGame* game, const char* text, SDL_Color color) {
     const int CENTER_Y = SCREEN_HEIGHT/2;
     
     // Load larger font for message
-    TTF_Font* largeFont = TTF_OpenFont("alagard.ttf", 72);
+    TTF_Font* largeFont = loadFont("alagard.ttf", 72);
     if (!largeFont) {
         largeFont = game->font; // Fallback to default font if loading fails
     }
@@ -432,7 +457,7 @@ void showAnimatedMessage(PuzzleGame* game, const char* text, SDL_Color color) {
     
     // Cleanup
     if (largeFont != game->font) {
-        TTF_CloseFont(largeFont);
+        releaseResource(largeFont);
     }
     
     // Restore normal screen
@@ -458,16 +483,6 @@ void formatTime(SDL_Surface* screen, int totalSeconds, int x, int y, SDL_Color c
     renderFormattedTime(screen, minutes, seconds, x, y, color, font);
 }
 
-// Render text on the screen
-void renderText(SDL_Surface* screen, const char* text, int x, int y, SDL_Color color, TTF_Font* font) {
-    SDL_Surface* textSurface = TTF_RenderText_Solid(font, text, color);
-    if (textSurface != NULL) {
-        // Render the text directly without a background
-        SDL_Rect textRect = { x, y, textSurface->w, textSurface->h };
-        SDL_BlitSurface(textSurface, NULL, screen, &textRect);
-        SDL_FreeSurface(textSurface);
-    }
-}
 // Add this helper function in puzzle.c
 void renderNumber(SDL_Surface* screen, int number, int x, int y, SDL_Color color, TTF_Font* font) {
     char str[32];
@@ -517,7 +532,7 @@ void renderGame(PuzzleGame* game) {
     
     // Draw buttons
     for (int i = 0; i < 4; i++) {
-        SDL_BlitSurface(
+        blitSprite(
             game->buttons[i].clicked ? game->buttons[i].clickedImage : game->buttons[i].image,
             NULL,
             game->screen,
@@ -562,15 +577,29 @@ void renderGame(PuzzleGame* game) {
 void generateSequence(PuzzleGame* game) {
     // For the first level, just generate one random button
     if (game->level == 1 && game->currentSequenceLength == 0) {
-        game->sequence[0] = rand() % 4;
+        game->sequence[0] = randomInt(4);
         game->currentSequenceLength = 1;
     } else {
         // For subsequent levels, add one new random button to the existing sequence
-        game->sequence[game->currentSequenceLength] = rand() % 4;
+        game->sequence[game->currentSequenceLength] = randomInt(4);
         game->currentSequenceLength++;
     }
 }
 
+// Tone of a button panned toward its side of the screen
+static float buttonPan(const Button* btn) {
+    int center = btn->position.x + btn->position.w / 2;
+    return 0.5f * (center - SCREEN_WIDTH / 2) / (SCREEN_WIDTH / 2);
+}
+
+// Sequence timing on the audio clock, in ms
+#define SEQUENCE_LEAD_MS 1000   // "Watch the sequence..." before the first tone
+#define SEQUENCE_PRESS_MS 500   // Pressed state of a button
+#define SEQUENCE_GAP_MS 250     // Pause between buttons
+#define SEQUENCE_FRAME_US 16000 // Video frame period the flashes are shown on
+
+enum { SEQUENCE_PRESS, SEQUENCE_RELEASE };
+
 // Play the sequence for the player to remember
 void playSequence(PuzzleGame* game) {
     game->playingSequence = 1;
@@ -580,24 +609,39 @@ void playSequence(PuzzleGame* game) {
     SDL_Color color = {255, 255, 255};
     renderText(game->screen, "Watch the sequence...", SCREEN_WIDTH/2-100, 20, color, game->font);
     SDL_Flip(game->screen);
-    SDL_Delay(1000);
     
+    // Every tone starts on its own frame of the audio clock, computed from
+    // the start of the sequence (no delays adding up), and each press is
+    // shown on the video frame nearest to when its tone is heard
+    Schedule schedule;
+    clearSchedule(&schedule);
+    Uint32 at = audioClock() + audioMsToFrames(SEQUENCE_LEAD_MS);
     for (int i = 0; i < game->currentSequenceLength; i++) {
         int btnIndex = game->sequence[i];
         Button* btn = &game->buttons[btnIndex];
         
-        // Visual feedback (show clicked image)
-        SDL_BlitSurface(btn->clickedImage, NULL, game->screen, &btn->position);
-        SDL_Flip(game->screen);
-        
         // Audio feedback - use the pre-generated sound
-        Mix_PlayChannel(-1, btn->clickSound, 0);
-        SDL_Delay(500); // Show pressed state
-        
-        // Return to normal
-        SDL_BlitSurface(btn->image, NULL, game->screen, &btn->position);
-        SDL_Flip(game->screen);
-        SDL_Delay(250); // Brief pause between buttons
+        scheduleSound(btn->clickSound, SOUND_EFFECT, 1.0f, buttonPan(btn), at);
+        addScheduleEvent(&schedule, at, SEQUENCE_PRESS, btnIndex);
+        at += audioMsToFrames(SEQUENCE_PRESS_MS);
+        addScheduleEvent(&schedule, at, SEQUENCE_RELEASE, btnIndex);
+        at += audioMsToFrames(SEQUENCE_GAP_MS);
+    }
+    
+    while (!scheduleDone(&schedule)) {
+        ScheduleEvent event;
+        int changed = 0;
+        while (nextScheduleEvent(&schedule, timerNowUs(), SEQUENCE_FRAME_US, &event)) {
+            Button* btn = &game->buttons[event.data];
+            // Visual feedback (clicked image while the tone plays)
+            SDL_Surface* image = event.type == SEQUENCE_PRESS ? btn->clickedImage : btn->image;
+            blitSprite(image, NULL, game->screen, &btn->position);
+            changed = 1;
+        }
+        if (changed) {
+            SDL_Flip(game->screen);
+        }
+        waitSchedule(&schedule, SEQUENCE_FRAME_US);
     }
     
     game->playingSequence = 0;
@@ -629,7 +673,7 @@ void handleMouseClick(PuzzleGame* game, int x, int y) {
             renderGame(game);
             
             // Play the sound
-            Mix_PlayChannel(-1, game->buttons[i].clickSound, 0);
+            playSound(game->buttons[i].clickSound, SOUND_EFFECT, 1.0f, buttonPan(&game->buttons[i]));
             SDL_Delay(200);
             
             // Unhighlight the button
@@ -648,7 +692,7 @@ void handleMouseClick(PuzzleGame* game, int x, int y) {
                     // Play success sound
                     Mix_Chunk* successSound = generateSuccessSound();
                     if (successSound) {
-                        Mix_PlayChannel(-1, successSound, 0);
+                        playSound(successSound, SOUND_CRITICAL, 1.0f, 0.0f);
                         SDL_Delay(1000);
                         Mix_FreeChunk(successSound);
                     }
@@ -661,7 +705,7 @@ void handleMouseClick(PuzzleGame* game, int x, int y) {
                 // Play failure sound
                 Mix_Chunk* failureSound = generateFailureSound();
                 if (failureSound) {
-                    Mix_PlayChannel(-1, failureSound, 0);
+                    playSound(failureSound, SOUND_CRITICAL, 1.0f, 0.0f);
                     
                     // Display failure message with animation
                     SDL_Color failureRed = {255, 50, 50, 255};
@@ -670,6 +714,9 @@ void handleMouseClick(PuzzleGame* game, int x, int y) {
                     SDL_Delay(500);  // Reduced delay after animation
                     Mix_FreeChunk(failureSound);
                 }
+
+                // The levels completed before the mistake are the score
+                savePuzzleScore(game->level - 1);
                 
                 // Display game over message
                 SDL_Color color = { 255, 0, 0 };
@@ -699,6 +746,66 @@ void handleMouseClick(PuzzleGame* game, int x, int y) {
     }
 }
 
+// Add the levels completed to the Simon highscores
+void savePuzzleScore(int levels) {
+    int rank = addHighscore(defaultHighscores(), HIGHSCORE_SIMON, levels, "Player 1");
+    if (rank >= 0) {
+        printf("Simon: %d levels, rank %d\n", levels, rank + 1);
+    }
+}
+
+#define PUZZLE_CHUNK SNAPSHOT_ID('S', 'I', 'M', 'N')
+
+typedef struct {
+    Sint32 level;
+    Sint32 sequenceLength;
+    Sint32 sequence[MAX_LEVELS];
+    Uint32 randomState;
+} PuzzleChunk;
+
+// Save the level and the sequence (the buttons and sounds are loaded again)
+int savePuzzleProgress(PuzzleGame* game) {
+    Snapshot snap;
+    beginSnapshot(&snap);
+    PuzzleChunk* chunk = addChunk(&snap, PUZZLE_CHUNK, 1, 0, sizeof(PuzzleChunk));
+    int result = -1;
+    if (chunk) {
+        chunk->level = game->level;
+        chunk->sequenceLength = game->currentSequenceLength;
+        for (int i = 0; i < MAX_LEVELS; i++) {
+            chunk->sequence[i] = game->sequence[i];
+        }
+        chunk->randomState = randomState();
+        result = writeSnapshot(&snap, PUZZLE_SAVE_PATH);
+    }
+    freeSnapshot(&snap);
+    return result;
+}
+
+// Restore the saved progress once, then delete it
+int loadPuzzleProgress(PuzzleGame* game) {
+    Snapshot snap;
+    if (readSnapshot(&snap, PUZZLE_SAVE_PATH) < 0) return -1;
+
+    Uint16 version;
+    Uint32 size;
+    const PuzzleChunk* chunk = findChunk(&snap, PUZZLE_CHUNK, 0, &version, &size);
+    int valid = chunk && version == 1 && size >= sizeof(PuzzleChunk) &&
+                chunk->level >= 1 && chunk->level <= MAX_LEVELS &&
+                chunk->sequenceLength >= 1 && chunk->sequenceLength <= MAX_LEVELS;
+    if (valid) {
+        game->level = chunk->level;
+        game->currentSequenceLength = chunk->sequenceLength;
+        for (int i = 0; i < MAX_LEVELS; i++) {
+            game->sequence[i] = chunk->sequence[i] & 3;
+        }
+        setRandomState(chunk->randomState);
+    }
+    freeSnapshot(&snap);
+    remove(PUZZLE_SAVE_PATH);
+    return valid ? 0 : -1;
+}
+
 // Move to the next level
 void nextLevel(PuzzleGame* game) {
     game->level++;
@@ -707,6 +814,7 @@ void nextLevel(PuzzleGame* game) {
     int centerY = SCREEN_HEIGHT / 2;
     
     if (game->level > MAX_LEVELS) {
+        savePuzzleScore(MAX_LEVELS);
         SDL_Color congratsColor = { 0, 255, 0 };
         renderText(game->screen, "Congratulations! You've completed all levels!", 
                   centerX - 200, centerY - 50, congratsColor, game->font);
@@ -719,7 +827,7 @@ void nextLevel(PuzzleGame* game) {
     // Play success sound and show message
     Mix_Chunk* successSound = generateSuccessSound();
     if (successSound) {
-        Mix_PlayChannel(-1, successSound, 0);
+        playSound(successSound, SOUND_CRITICAL, 1.0f, 0.0f);
         SDL_Color successGreen = {50, 255, 50, 255};
         showAnimatedMessage(game, "SUCCESS!", successGreen);
         SDL_Delay(500);
@@ -737,7 +845,7 @@ void nextLevel(PuzzleGame* game) {
     // Next level announcement
     Mix_Chunk* levelStartSound = generateLevelStartSound(game->level);
     if (levelStartSound) {
-        Mix_PlayChannel(-1, levelStartSound, 0);
+        playSound(levelStartSound, SOUND_EFFECT, 1.0f, 0.0f);
         char nextLevelText[32];
         sprintf(nextLevelText, "Moving to Level %d", game->level);
         renderText(game->screen, nextLevelText, centerX - 100, centerY + 50, color, game->font);
@@ -769,10 +877,10 @@ void gameLoop(PuzzleGame* game) {
     int centerY = SCREEN_HEIGHT / 2;
     bool startScreen = true;
 // Load background
-     game->startBackground = IMG_Load("background.png");
+     game->startBackground = loadImage("background.png");
     // Load all sounds with error checking
-    game->buttonClickSound = Mix_LoadWAV("click.wav");
-    game->buttonHoverSound = Mix_LoadWAV("hover.wav");
+    game->buttonClickSound = loadSound("click.wav");
+    game->buttonHoverSound = loadSound("hover.wav");
     game->startSound = Mix_LoadWAV("startsound.wav");
     game->gameMusic = Mix_LoadWAV("gamemusic.wav");
     if (!game->startBackground) {
@@ -782,7 +890,7 @@ void gameLoop(PuzzleGame* game) {
     if (!game->startSound) {
         printf("Warning: Failed to load start sound: %s\n", Mix_GetError());
     } else {
-        Mix_PlayChannel(-1, game->startSound, 0);
+        playSound(game->startSound, SOUND_EFFECT, 1.0f, 0.0f);
     }
 
     if (!game->buttonClickSound || !game->buttonHoverSound) {
@@ -791,7 +899,7 @@ void gameLoop(PuzzleGame* game) {
 
     // Create and load start button using loadButton function - adjusted size and position
     
-    loadButton(&game->startButton, "start.png", "darkstart.png",centerX - 150,centerY + 180,300,150);          
+    loadPuzzleButton(&game->startButton, "start.png", "darkstart.png",centerX - 150,centerY + 180,300,150);          
 
     // Updated title and instructions text
     const char* gameTitle = "SIMON GAME";
@@ -817,6 +925,7 @@ void gameLoop(PuzzleGame* game) {
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 game->gameRunning = false;
+                game->quitRequested = true;
                 startScreen = false;
                 break;
             }
@@ -831,7 +940,7 @@ void gameLoop(PuzzleGame* game) {
                                 mouseY <= game->startButton.position.y + game->startButton.position.h);
                 
                 if (!game->wasHovered && isHovered && game->buttonHoverSound) {
-                    Mix_PlayChannel(-1, game->buttonHoverSound, 0);
+                    playSound(game->buttonHoverSound, SOUND_UI, 1.0f, 0.0f);
                 }
                 
                 game->wasHovered = isHovered;
@@ -848,7 +957,7 @@ void gameLoop(PuzzleGame* game) {
                     mouseY <= game->startButton.position.y + game->startButton.position.h) {
                     
                     if (game->buttonClickSound) {
-                        Mix_PlayChannel(-1, game->buttonClickSound, 0);
+                        playSound(game->buttonClickSound, SOUND_UI, 1.0f, 0.0f);
                         SDL_Delay(100);
                     }
                     startScreen = false;
@@ -888,7 +997,7 @@ void gameLoop(PuzzleGame* game) {
         }
 
         // Draw the start button
-        SDL_BlitSurface(
+        blitSprite(
             game->startButton.clicked ? game->startButton.clickedImage : game->startButton.image,
             NULL,
             game->screen,
@@ -902,15 +1011,17 @@ void gameLoop(PuzzleGame* game) {
 
     // If game is still running, start the actual game
     if (game->gameRunning) {
-        // Initialize game state
-        game->level = 1;
-        game->currentSequenceLength = 0;
-        generateSequence(game);
+        // Initialize game state, or continue the game left with Escape
+        if (loadPuzzleProgress(game) < 0) {
+            game->level = 1;
+            game->currentSequenceLength = 0;
+            generateSequence(game);
+        }
         
         // Play start sound
-        Mix_Chunk* levelStartSound = generateLevelStartSound(1);
+        Mix_Chunk* levelStartSound = generateLevelStartSound(game->level);
         if (levelStartSound) {
-            Mix_PlayChannel(-1, levelStartSound, 0);
+            playSound(levelStartSound, SOUND_EFFECT, 1.0f, 0.0f);
             Mix_FreeChunk(levelStartSound);
         }
 
@@ -920,10 +1031,17 @@ void gameLoop(PuzzleGame* game) {
 
         // Main game loop
         while (game->gameRunning) {
+            int zone = PROFILE_BEGIN("input");
             while (SDL_PollEvent(&event)) {
+                if (profilerHandleEvent(&event)) {
+                    continue;
+                }
                 if (event.type == SDL_QUIT) {
+                    savePuzzleProgress(game);
                     game->gameRunning = false;
-                } else if (event.key.keysym.sym == SDLK_ESCAPE) {
+                    game->quitRequested = true;
+                } else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE) {
+                    savePuzzleProgress(game);
                     game->gameRunning = false;
                 } else if (event.type == SDL_MOUSEBUTTONDOWN) {
                     int x, y;
@@ -932,30 +1050,35 @@ void gameLoop(PuzzleGame* game) {
                 }
             }
 
+            PROFILE_END(zone);
+
+            // renderGame flips the screen itself
+            zone = PROFILE_BEGIN("draw");
             renderGame(game);
+            PROFILE_END(zone);
             SDL_Delay(10);
+            PROFILE_FRAME();
         }
     }
 }
 
-// Clean up resources
-void cleanup(PuzzleGame* game) {
+// Free the game assets
+void freePuzzleGame(PuzzleGame* game) {
     if (!game) return;
-  // Free background image
-    SDL_FreeSurface(game->backgroundImage);
     // Stop all sounds
-    Mix_HaltChannel(-1);
-    Mix_HaltMusic();
+    stopAllSounds();
+
+    // Shared assets go back to the cache
+    releaseResource(game->backgroundImage);
+    releaseResource(game->startBackground);
+    releaseResource(game->buttonClickSound);
+    releaseResource(game->buttonHoverSound);
+    game->backgroundImage = NULL;
+    game->startBackground = NULL;
+    game->buttonClickSound = NULL;
+    game->buttonHoverSound = NULL;
 
     // Cleanup sounds
-    if (game->buttonClickSound) {
-        Mix_FreeChunk(game->buttonClickSound);
-        game->buttonClickSound = NULL;
-    }
-    if (game->buttonHoverSound) {
-        Mix_FreeChunk(game->buttonHoverSound);
-        game->buttonHoverSound = NULL;
-    }
     if (game->startSound) {
         Mix_FreeChunk(game->startSound);
         game->startSound = NULL;
@@ -969,15 +1092,14 @@ void cleanup(PuzzleGame* game) {
         Button* btn = &game->buttons[i];
         if (btn->clickSound) {
             Mix_FreeChunk(btn->clickSound);
+            btn->clickSound = NULL;
         }
         SDL_FreeSurface(btn->image);
         SDL_FreeSurface(btn->clickedImage);
+        btn->image = NULL;
+        btn->clickedImage = NULL;
     }
     // Cleanup surfaces
-    if (game->startBackground) {
-        SDL_FreeSurface(game->startBackground);
-        game->startBackground = NULL;
-    }
     if (game->startButton.image) {
         SDL_FreeSurface(game->startButton.image);
         game->startButton.image = NULL;
@@ -986,18 +1108,24 @@ void cleanup(PuzzleGame* game) {
         SDL_FreeSurface(game->startButton.clickedImage);
         game->startButton.clickedImage = NULL;
     }
-    if (game->screen) {
-        SDL_FreeSurface(game->screen);
-        game->screen = NULL;
-    }
     if (game->font) {
-        TTF_CloseFont(game->font);
+        releaseResource(game->font);
         game->font = NULL;
     }
+    // The screen belongs to SDL, it is freed by SDL_Quit
+    game->screen = NULL;
+}
+
+// Clean up resources
+void cleanup(PuzzleGame* game) {
+    if (!game) return;
+    freePuzzleGame(game);
+    freeResources();
+    memReport();
+    memReportLeaks();
 
     // Close SDL subsystems
-    Mix_CloseAudio();
-    TTF_CloseFont(game->font);
+    closeAudio();
     TTF_Quit();
     Mix_Quit();
     SDL_Quit();
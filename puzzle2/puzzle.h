@@ -5,11 +5,27 @@
 #include "SDL/SDL_image.h"
 #include "SDL/SDL_ttf.h"
 #include "SDL/SDL_mixer.h"
+#include "../core/audio.h"
+#include "../core/mixer.h"
+#include "../core/schedule.h"
+#include "../core/timer.h"
+#include "../core/resources.h"
+#include "../core/text.h"
+#include "../core/profiler.h"
+#include "../core/blit.h"
+#include "../core/random.h"
+#include "../core/highscore.h"
+#include "../core/snapshot.h"
 #include <SDL/SDL_rotozoom.h>
 #include <stdbool.h>
 #include <time.h>
 #include <math.h>
 #include <string.h>
+// Track the images and sounds created by the puzzle (included last, it wraps the SDL calls)
+#ifndef MEM_MODULE
+#define MEM_MODULE "puzzle"
+#endif
+#include "../core/memtrack.h"
 
 // Constants for audio generation
 #define SAMPLE_RATE 44100  // Standard sample rate (44.1kHz)
@@ -94,6 +110,7 @@ typedef struct {
     SDL_Surface* startBackground;
     Button startButton;
     bool wasHovered;
+    bool quitRequested;                 // The window was closed (not just ESC)
 } PuzzleGame;
 
 
@@ -106,9 +123,11 @@ Mix_Chunk* generateSuccessSound();
 Mix_Chunk* generateFailureSound();
 Mix_Chunk* generateButtonSound(int buttonIndex);
 
-void loadButton(Button* btn, const char* path, const char* clickedPath, int x, int y, int width, int height);
+void loadPuzzleButton(Button* btn, const char* path, const char* clickedPath, int x, int y, int width, int height);
 // Initialize SDL, fonts, and sound
 void initSDL(PuzzleGame* game);
+// Initialize the game state on an already opened screen
+void initPuzzleGame(PuzzleGame* game, SDL_Surface* screen);
 
 // Load all images and sounds (buttons, background, etc.)
 void loadAssets(PuzzleGame* game);
@@ -119,7 +138,6 @@ void shuffleButtons(Button buttons[4]);
 
 // Render the main game screen (buttons, sequence, etc.)
 void renderGame(PuzzleGame* game);
-void renderText(SDL_Surface *screen, const char *text, int x, int y, SDL_Color color, TTF_Font *font);
 void renderNumber(SDL_Surface* screen, int number, int x, int y, SDL_Color color, TTF_Font* font);
 void renderFormattedTime(SDL_Surface* screen, int minutes, int seconds, int x, int y, SDL_Color color, TTF_Font* font);
 
@@ -152,11 +170,22 @@ void updateTimer(PuzzleGame* game);
 void generateSequence(PuzzleGame* game);
 void playSequence(PuzzleGame* game);
 void nextLevel(PuzzleGame* game);
+// Add the levels completed to the Simon highscores
+void savePuzzleScore(int levels);
+
+// Progress kept when the player leaves a game with Escape, resumed by the
+// next game: level, sequence and random state
+#define PUZZLE_SAVE_PATH "../simon.dat"
+int savePuzzleProgress(PuzzleGame* game);
+int loadPuzzleProgress(PuzzleGame* game);
 
 void gameLoop(PuzzleGame* game);
 
 
 
+// Free the game assets (SDL stays initialized)
+void freePuzzleGame(PuzzleGame* game);
+// Free the game assets and shut SDL down
 void cleanup(PuzzleGame* game);
 #endif // PUZZLE_H
 